@@ -0,0 +1,17 @@
+#!/bin/bash
+# Compare the throughput and restart time of write-ahead and write-behind
+# logging. Without an NVM file system the log lives on tmpfs (/dev/shm).
+SCALE=1
+WRITE=0.5
+BACKENDS=4
+filename="wal_vs_wbl_${WRITE}.log"
+rm -f $filename
+# 1 : NVM WAL, 4 : NVM WBL
+for logging in 1 4
+do
+	./logger -e 5 -l ${logging} -k ${SCALE} -u ${WRITE} -b ${BACKENDS}
+	sleep 1
+	echo "-e 5 -l ${logging} -k ${SCALE} -u ${WRITE} -b ${BACKENDS}" >> $filename
+	tail -n 1 outputfile.summary >> $filename
+done
+cat $filename
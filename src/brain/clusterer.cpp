@@ -68,7 +68,8 @@ column_map_type Clusterer::GetPartitioning(oid_t tile_count) const {
   PL_ASSERT(tile_count >= 1);
   PL_ASSERT(tile_count <= sample_column_count_);
 
-  std::map<double, oid_t> frequencies;
+  // clusters with the same fraction are all kept
+  std::multimap<double, oid_t> frequencies;
   oid_t cluster_itr = START_OID;
   oid_t cluster_count;
 
@@ -87,13 +88,14 @@ column_map_type Clusterer::GetPartitioning(oid_t tile_count) const {
        ++entry) {
     LOG_TRACE(" %u :: %.3lf", entry->second, entry->first);
 
-    // first, check if remaining columns less than tile count
+    // first, check if remaining columns less than tile count, in which case
+    // they share the next tile
     if (remaining_column_count <= tile_count) {
       oid_t column_itr;
       for (column_itr = 0; column_itr < sample_column_count_; column_itr++) {
         if (column_to_tile_map.count(column_itr) == 0) {
           column_to_tile_map[column_itr] = tile_itr;
-          tile_itr++;
+          remaining_column_count--;
         }
       }
     }
@@ -114,16 +116,34 @@ column_map_type Clusterer::GetPartitioning(oid_t tile_count) const {
     if (tile_itr >= tile_count) tile_itr--;
   }
 
+  // columns that no cluster enabled go to the last tile
+  for (oid_t column_itr = 0; column_itr < sample_column_count_;
+       column_itr++) {
+    if (column_to_tile_map.count(column_itr) == 0) {
+      column_to_tile_map[column_itr] = tile_itr;
+    }
+  }
+
   // check if all columns are present in partitioning
   PL_ASSERT(column_to_tile_map.size() == sample_column_count_);
 
+  // number the tiles that got any column from zero on
+  std::map<oid_t, oid_t> tile_offsets;
+  for (auto entry : column_to_tile_map) {
+    tile_offsets[entry.second] = 0;
+  }
+  oid_t tile_offset = START_OID;
+  for (auto &entry : tile_offsets) {
+    entry.second = tile_offset++;
+  }
+
   // build partitioning
   column_map_type partitioning;
   std::map<oid_t, oid_t> tile_column_count_map;
 
   for (auto entry : column_to_tile_map) {
     auto column_id = entry.first;
-    auto tile_id = entry.second;
+    auto tile_id = tile_offsets[entry.second];
 
     // figure out how many columns in given tile
     auto exists = tile_column_count_map.find(tile_id);
@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// layout_tuner.cpp
+//
+// Identification: src/brain/layout_tuner.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "brain/layout_tuner.h"
+
+#include "catalog/manager.h"
+#include "common/logger.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile_group.h"
+
+namespace peloton {
+namespace brain {
+
+LayoutTuner &LayoutTuner::GetInstance() {
+  static LayoutTuner layout_tuner;
+  return layout_tuner;
+}
+
+LayoutTuner::~LayoutTuner() { Stop(); }
+
+void LayoutTuner::Start(size_t interval, double cpu_budget) {
+  if (interval == 0 || cpu_budget <= 0 || tuner_thread_ != nullptr) return;
+
+  LOG_TRACE("Starting layout tuner");
+  cpu_budget_ = std::min(cpu_budget, 1.0);
+  is_running_ = true;
+  tuner_thread_.reset(new std::thread(&LayoutTuner::Running, this, interval));
+}
+
+void LayoutTuner::Stop() {
+  if (tuner_thread_ == nullptr) return;
+
+  LOG_TRACE("Stopping layout tuner");
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+  }
+  stop_cv_.notify_all();
+
+  tuner_thread_->join();
+  tuner_thread_.reset();
+}
+
+void LayoutTuner::Running(size_t interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    stop_cv_.wait_for(lock, std::chrono::seconds(interval));
+    if (is_running_ == false) break;
+
+    lock.unlock();
+    auto tile_group_count = TuneOnce();
+    lock.lock();
+
+    if (tile_group_count > 0) {
+      LOG_TRACE("Moved %lu tile groups to a new layout", tile_group_count);
+    }
+  }
+}
+
+bool LayoutTuner::Throttle(std::chrono::steady_clock::duration busy_time) {
+  if (cpu_budget_ >= 1.0) return true;
+
+  auto idle_time = std::chrono::duration_cast<std::chrono::microseconds>(
+      busy_time * ((1 - cpu_budget_) / cpu_budget_));
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (is_running_ == true) {
+    stop_cv_.wait_for(lock, idle_time);
+  }
+  return is_running_;
+}
+
+size_t LayoutTuner::TuneOnce() {
+  size_t tile_group_count = 0;
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto database_count = catalog_manager.GetDatabaseCount();
+  for (oid_t database_itr = 0; database_itr < database_count;
+       database_itr++) {
+    auto database = catalog_manager.GetDatabase(database_itr);
+    if (database == nullptr) continue;
+
+    auto table_count = database->GetTableCount();
+    for (oid_t table_itr = 0; table_itr < table_count; table_itr++) {
+      auto table = database->GetTable(table_itr);
+      if (table == nullptr) continue;
+
+      tile_group_count += TuneTable(table);
+      if (tuner_thread_ != nullptr && is_running_ == false) {
+        return tile_group_count;
+      }
+    }
+  }
+
+  return tile_group_count;
+}
+
+size_t LayoutTuner::TuneTable(storage::DataTable *table) {
+  auto table_id = table->GetOid();
+  bool partition_updated = table->UpdateDefaultPartition();
+
+  auto tile_count = table->GetColumnMapStats().size();
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto &table_stats = stats_[table_id];
+    table_stats.tile_count = tile_count;
+    if (partition_updated == true) table_stats.partition_update_count++;
+  }
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  size_t tile_group_count = 0;
+  auto table_tile_group_count = table->GetTileGroupCount();
+  for (oid_t tile_group_itr = 0; tile_group_itr < table_tile_group_count;
+       tile_group_itr++) {
+    // Compressed tile groups would only grow, evicted ones stay on disk
+    auto tile_group = table->PeekTileGroup(tile_group_itr);
+    if (tile_group == nullptr || tile_group->IsCompressed() == true ||
+        tile_group->IsEvicted() == true) {
+      continue;
+    }
+    if (tile_group->GetSchemaDifference(table->GetDefaultPartition()) <
+        LAYOUT_TUNER_THETA) {
+      continue;
+    }
+
+    auto begin_time = std::chrono::steady_clock::now();
+
+    // While the transaction is alive, no slot of the tile group is recycled
+    txn_manager.BeginTransaction();
+    auto new_tile_group = table->TransformTileGroup(
+        tile_group_itr, LAYOUT_TUNER_THETA, true);
+    txn_manager.CommitTransaction();
+
+    auto busy_time = std::chrono::steady_clock::now() - begin_time;
+    if (new_tile_group != nullptr) {
+      tile_group_count++;
+
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      auto &table_stats = stats_[table_id];
+      table_stats.transformed_tile_group_count++;
+      table_stats.transform_time +=
+          std::chrono::duration<double>(busy_time).count();
+    }
+
+    if (tuner_thread_ != nullptr && Throttle(busy_time) == false) break;
+  }
+
+  return tile_group_count;
+}
+
+std::map<oid_t, LayoutTunerStats> LayoutTuner::GetStats() {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+}  // End brain namespace
+}  // End peloton namespace
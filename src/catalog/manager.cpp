@@ -17,6 +17,7 @@
 #include "catalog/foreign_key.h"
 #include "storage/database.h"
 #include "storage/data_table.h"
+#include "storage/tile_group_evictor.h"
 #include "concurrency/transaction_manager_factory.h"
 
 namespace peloton {
@@ -47,6 +48,9 @@ void Manager::DropTileGroup(const oid_t oid) {
 
   // drop the catalog reference to the tile group
   locator.Erase(oid);
+
+  // and its copy in the eviction file
+  storage::TileGroupEvictor::GetInstance().DropTileGroup(oid);
 }
 
 std::shared_ptr<storage::TileGroup> Manager::GetTileGroup(const oid_t oid) {
@@ -54,6 +58,22 @@ std::shared_ptr<storage::TileGroup> Manager::GetTileGroup(const oid_t oid) {
 
   locator.Find(oid, location);
 
+  if (location != nullptr) {
+    auto &evictor = storage::TileGroupEvictor::GetInstance();
+    location->RecordAccess(evictor.GetRound());
+    if (location->IsEvicted() == true) {
+      evictor.FaultIn(location.get());
+    }
+  }
+
+  return location;
+}
+
+std::shared_ptr<storage::TileGroup> Manager::PeekTileGroup(const oid_t oid) {
+  std::shared_ptr<storage::TileGroup> location;
+
+  locator.Find(oid, location);
+
   return location;
 }
 
@@ -71,6 +91,8 @@ void Manager::AddDatabase(storage::Database *database) {
     std::lock_guard<std::mutex> lock(catalog_mutex);
     databases.push_back(database);
   }
+
+  IncrementCatalogVersion();
 }
 
 storage::Database *Manager::GetDatabaseWithOid(const oid_t database_oid) const {
@@ -98,6 +120,8 @@ void Manager::DropDatabaseWithOid(const oid_t database_oid) {
     // Drop the database
     databases.erase(databases.begin() + database_offset);
   }
+
+  IncrementCatalogVersion();
 }
 
 storage::Database *Manager::GetDatabase(const oid_t database_offset) const {
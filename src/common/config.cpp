@@ -14,7 +14,86 @@
 #include <gflags/gflags.h>
 
 DEFINE_uint64(port, 5432, "Peloton port (default: 5432)");
-DEFINE_uint64(max_connections, 64,
-              "Maximum number of connections (default: 64)");
+DEFINE_uint64(max_connections, 8192,
+              "Maximum number of connections (default: 8192)");
 DEFINE_string(socket_family, "AF_INET", "Socket family (AF_UNIX, AF_INET)");
 DEFINE_bool(h, false, "Show help");
+
+// Wire server
+DEFINE_uint64(reactor_threads, 0,
+              "Number of threads doing client socket I/O, 0 picks one per "
+              "four cores (default: 0)");
+DEFINE_uint64(worker_threads, 0,
+              "Number of threads executing queries, 0 picks one per core "
+              "(default: 0)");
+DEFINE_uint64(client_write_timeout_ms, 30000,
+              "Time a query streaming its result waits for a client that "
+              "stopped reading before it is canceled (default: 30000)");
+
+// Plan cache
+DEFINE_uint64(plan_cache_size, 4096,
+              "Number of query plans shared by all sessions, 0 disables the "
+              "plan cache (default: 4096)");
+
+// Bulk load
+DEFINE_uint64(copy_threads, 0,
+              "Number of threads parsing the data of COPY FROM STDIN, 0 picks "
+              "one per core (default: 0)");
+
+// Admission control
+DEFINE_uint64(max_active_queries, 0,
+              "Maximum number of queries executing at once, 0 picks one per "
+              "core (default: 0)");
+DEFINE_uint64(max_analytic_queries, 0,
+              "Maximum number of analytic queries executing at once, 0 picks "
+              "a quarter of max_active_queries (default: 0)");
+DEFINE_uint64(admission_timeout_ms, 5000,
+              "Time a query waits for admission before it is canceled "
+              "(default: 5000)");
+
+// Tile group memory
+DEFINE_bool(huge_pages, true,
+            "Back tile groups with 2 MB huge pages, reserved ones if there "
+            "are any, else transparent ones (default: true)");
+DEFINE_bool(numa_aware_allocation, true,
+            "Place tile groups on the NUMA node of the inserting thread "
+            "(default: true)");
+
+// Tile group insertion
+DEFINE_uint64(active_tile_group_count, 1,
+              "Tile groups of a table that inserts go to at once, spread "
+              "over the inserting threads (default: 1)");
+
+// Data file
+DEFINE_uint64(data_file_compaction_interval, 10,
+              "Seconds between moves of tiles out of sparse parts of the data "
+              "file, 0 disables compaction (default: 10)");
+
+// Tile group compression
+DEFINE_uint64(tile_group_compression_interval, 0,
+              "Seconds between compressions of cold in-memory tile groups, "
+              "0 disables compression (default: 0)");
+
+// Layout tuner
+DEFINE_uint64(layout_tuner_interval, 0,
+              "Seconds between moves of tile groups to the layout the "
+              "workload favors, 0 disables the tuner (default: 0)");
+DEFINE_double(layout_tuner_cpu_budget, 0.1,
+              "Fraction of a core the layout tuner may take (default: 0.1)");
+
+// Anti-caching
+DEFINE_uint64(anti_caching_interval, 0,
+              "Seconds between evictions of cold in-memory tile groups to "
+              "disk, 0 disables eviction (default: 0)");
+DEFINE_uint64(anti_caching_memory_limit, 0,
+              "MB of tile groups to keep in memory, 0 evicts every cold "
+              "tile group (default: 0)");
+
+// Log shipping
+DEFINE_uint64(rpc_port, 0, "Peloton rpc port, 0 disables rpc (default: 0)");
+DEFINE_uint64(plan_stream_idle_timeout, 60,
+              "Seconds a plan shipped by another site keeps the rest of its "
+              "result and its transaction between fetches, 0 keeps them "
+              "until fetched (default: 60)");
+DEFINE_string(replicas, "",
+              "Comma separated ip:port list of replicas to ship the log to");
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// crc32c.cpp
+//
+// Identification: src/common/crc32c.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <cstring>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include "common/crc32c.h"
+
+namespace peloton {
+
+#ifndef __SSE4_2__
+namespace {
+
+// Reflected Castagnoli polynomial
+const uint32_t kCrc32cPolynomial = 0x82F63B78;
+
+// Lookup table for the byte-at-a-time software fallback
+struct Crc32cTable {
+  uint32_t entries[256];
+
+  Crc32cTable() {
+    for (uint32_t byte = 0; byte < 256; byte++) {
+      uint32_t crc = byte;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) ? (crc >> 1) ^ kCrc32cPolynomial : (crc >> 1);
+      }
+      entries[byte] = crc;
+    }
+  }
+};
+
+const Crc32cTable crc32c_table;
+
+}  // namespace
+#endif
+
+uint32_t Crc32c::Compute(const void *data, size_t length, uint32_t crc) {
+  const unsigned char *cursor = reinterpret_cast<const unsigned char *>(data);
+  crc = ~crc;
+
+#ifdef __SSE4_2__
+  // Use the crc32 instruction eight bytes at a time when it is available
+  uint64_t crc64 = crc;
+  while (length >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, cursor, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+    cursor += sizeof(word);
+    length -= sizeof(word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  while (length > 0) {
+    crc = _mm_crc32_u8(crc, *cursor);
+    cursor++;
+    length--;
+  }
+#else
+  while (length > 0) {
+    crc = crc32c_table.entries[(crc ^ *cursor) & 0xFF] ^ (crc >> 8);
+    cursor++;
+    length--;
+  }
+#endif
+
+  return ~crc;
+}
+
+}  // namespace peloton
@@ -14,6 +14,9 @@
 #include "common/init.h"
 
 #include "libcds/cds/init.h"
+#include "brain/layout_tuner.h"
+#include "storage/tile_group_compressor.h"
+#include "storage/tile_group_evictor.h"
 
 #include <google/protobuf/stubs/common.h>
 
@@ -24,10 +27,31 @@ void PelotonInit::Initialize() {
   // Initialize CDS library
   cds::Initialize();
 
+  // Start compressing cold tile groups
+  storage::TileGroupCompressor::GetInstance().Start(
+      FLAGS_tile_group_compression_interval);
+
+  // Start adapting the table layouts
+  brain::LayoutTuner::GetInstance().Start(FLAGS_layout_tuner_interval,
+                                          FLAGS_layout_tuner_cpu_budget);
+
+  // Start evicting cold tile groups to disk
+  storage::TileGroupEvictor::GetInstance().Start(
+      FLAGS_anti_caching_interval, FLAGS_anti_caching_memory_limit);
+
 }
 
 void PelotonInit::Shutdown() {
 
+  // Stop evicting tile groups
+  storage::TileGroupEvictor::GetInstance().Stop();
+
+  // Stop adapting the table layouts
+  brain::LayoutTuner::GetInstance().Stop();
+
+  // Stop compressing tile groups
+  storage::TileGroupCompressor::GetInstance().Stop();
+
   // Terminate CDS library
   cds::Terminate();
 
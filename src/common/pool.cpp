@@ -11,20 +11,43 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <atomic>
 #include <cstring>
 
 #include "common/pool.h"
+#include "common/logger.h"
 #include "common/macros.h"
 
 namespace peloton {
 
 static const size_t TEMP_POOL_CHUNK_SIZE = 512;  // 512 B
 
+// Whether a block is handed out
+enum VarlenBlockState {
+  VARLEN_BLOCK_STATE_FREE = 0,
+  VARLEN_BLOCK_STATE_USED = 1
+};
+
+struct VarlenBlockHeader {
+  VarlenPool *pool;
+
+  // of the whole block, header included
+  uint32_t size;
+
+  uint16_t state;
+
+  // shard the block was carved out for, and goes back to
+  uint16_t shard_index;
+};
+
+static_assert(sizeof(VarlenBlockHeader) <= VARLEN_BLOCK_HEADER_SIZE,
+              "varlen block header does not fit");
+
 VarlenPool::VarlenPool(BackendType backend_type)
     : backend_type(backend_type),
       allocation_size(TEMP_POOL_CHUNK_SIZE),
       max_chunk_count(1),
-      current_chunk_index(0) {
+      next_chunk_index(0) {
   Init();
 }
 
@@ -33,7 +56,7 @@ VarlenPool::VarlenPool(BackendType backend_type, uint64_t allocation_size,
     : backend_type(backend_type),
       allocation_size(allocation_size),
       max_chunk_count(static_cast<std::size_t>(max_chunk_count)),
-      current_chunk_index(0) {
+      next_chunk_index(0) {
   Init();
 }
 
@@ -57,64 +80,113 @@ VarlenPool::~VarlenPool() {
   }
 }
 
-// Allocate a continous block of memory of the specified size.
-void *VarlenPool::Allocate(std::size_t size) {
-  void *retval = nullptr;
+std::size_t VarlenPool::GetBlockSize(std::size_t size_class) {
+  std::size_t small_class_count = VARLEN_SMALL_BLOCK_SIZE / 16;
+  if (size_class < small_class_count) {
+    return (size_class + 1) * 16;
+  }
 
-  // Protect using pool lock
-  // TODO: Can make locking more fine-grained
-  {
-    std::lock_guard<std::mutex> pool_lock(pool_mutex);
+  return static_cast<std::size_t>(VARLEN_SMALL_BLOCK_SIZE)
+         << (size_class - small_class_count + 1);
+}
 
-    // See if there is space in the current chunk
-    Chunk *current_chunk = &chunks[current_chunk_index];
-    if (size > current_chunk->size - current_chunk->offset) {
-      // Not enough space. Check if it is greater than our allocation size.
-      if (size > allocation_size) {
-        // Allocate an oversize chunk that will not be reused.
-        auto &storage_manager = storage::StorageManager::GetInstance();
-        char *storage = reinterpret_cast<char *>(
-            storage_manager.Allocate(backend_type, size));
+std::size_t VarlenPool::GetSizeClass(std::size_t block_size) {
+  if (block_size <= VARLEN_SMALL_BLOCK_SIZE) {
+    return (block_size + 15) / 16 - 1;
+  }
 
-        oversize_chunks.push_back(Chunk(nexthigher(size), storage));
-        Chunk &newChunk = oversize_chunks.back();
-        newChunk.offset = size;
-        return newChunk.chunk_data;
-      }
+  std::size_t size_class = VARLEN_SMALL_BLOCK_SIZE / 16;
+  while (GetBlockSize(size_class) < block_size) size_class++;
+  return size_class;
+}
 
-      // Check if there is an already allocated chunk we can use.
-      current_chunk_index++;
+std::size_t VarlenPool::GetShardIndex() {
+  // Threads take the shards in turns
+  static std::atomic<std::size_t> next_shard_index(0);
+  static thread_local std::size_t shard_index =
+      next_shard_index++ % VARLEN_POOL_SHARD_COUNT;
+  return shard_index;
+}
 
-      if (current_chunk_index < chunks.size()) {
-        current_chunk = &chunks[current_chunk_index];
-        current_chunk->offset = size;
-        return current_chunk->chunk_data;
-      } else {
-        // Need to allocate a new chunk
-        auto &storage_manager = storage::StorageManager::GetInstance();
-        char *storage = reinterpret_cast<char *>(
-            storage_manager.Allocate(backend_type, allocation_size));
+void VarlenPool::NextChunk(Shard &shard) {
+  // Check if there is an already allocated chunk we can use.
+  if (next_chunk_index == chunks.size()) {
+    auto &storage_manager = storage::StorageManager::GetInstance();
+    char *storage = reinterpret_cast<char *>(
+        storage_manager.Allocate(backend_type, allocation_size));
 
-        chunks.push_back(Chunk(allocation_size, storage));
-        Chunk &new_chunk = chunks.back();
-        new_chunk.offset = size;
-        return new_chunk.chunk_data;
-      }
-    }
+    chunks.push_back(Chunk(allocation_size, storage));
+  }
+
+  Chunk &chunk = chunks[next_chunk_index++];
+  shard.chunk_data = chunk.chunk_data;
+  shard.chunk_offset = 0;
+  shard.chunk_size = chunk.size;
+}
+
+void *VarlenPool::AllocateOversize(std::size_t block_size) {
+  // Allocate an oversize chunk that is freed on its own.
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  char *storage = reinterpret_cast<char *>(
+      storage_manager.Allocate(backend_type, block_size));
+
+  std::lock_guard<std::mutex> pool_lock(pool_mutex);
+  oversize_chunks.push_back(Chunk(block_size, storage));
+  oversize_chunks.back().offset = block_size;
+  return storage;
+}
+
+// Allocate a continous block of memory of the specified size.
+void *VarlenPool::Allocate(std::size_t size) {
+  std::size_t block_size = size + VARLEN_BLOCK_HEADER_SIZE;
+  std::size_t size_class = GetSizeClass(block_size);
+  std::size_t shard_index = GetShardIndex();
+  char *block = nullptr;
 
-    // Get the offset into the current chunk. Then increment the
-    // offset counter by the amount being allocated.
-    retval = current_chunk->chunk_data + current_chunk->offset;
-    current_chunk->offset += size;
+  if (GetBlockSize(size_class) > allocation_size) {
+    // Check if it is greater than our allocation size.
+    block_size = (block_size + 15) & ~static_cast<std::size_t>(15);
+    block = reinterpret_cast<char *>(AllocateOversize(block_size));
+  } else {
+    block_size = GetBlockSize(size_class);
+    auto &shard = shards[shard_index];
+    shard.lock.Lock();
+
+    auto &free_list = shard.free_lists[size_class];
+    if (free_list.empty() == false) {
+      block = free_list.back();
+      free_list.pop_back();
+      shard.free_bytes -= block_size;
+    } else {
+      // Not enough space in the current chunk, the rest of it is lost
+      if (shard.chunk_data == nullptr ||
+          block_size > shard.chunk_size - shard.chunk_offset) {
+        std::lock_guard<std::mutex> pool_lock(pool_mutex);
+        try {
+          NextChunk(shard);
+        } catch (...) {
+          shard.lock.Unlock();
+          throw;
+        }
+      }
 
-    // Ensure 8 byte alignment of future allocations
-    current_chunk->offset += (8 - (current_chunk->offset % 8));
-    if (current_chunk->offset > current_chunk->size) {
-      current_chunk->offset = current_chunk->size;
+      // Get the offset into the current chunk. Then increment the
+      // offset counter by the amount being allocated.
+      block = shard.chunk_data + shard.chunk_offset;
+      shard.chunk_offset += block_size;
     }
+
+    shard.lock.Unlock();
   }
 
-  return retval;
+  VarlenBlockHeader header;
+  header.pool = this;
+  header.size = static_cast<uint32_t>(block_size);
+  header.state = VARLEN_BLOCK_STATE_USED;
+  header.shard_index = static_cast<uint16_t>(shard_index);
+  PL_MEMCPY(block, &header, sizeof(header));
+
+  return block + VARLEN_BLOCK_HEADER_SIZE;
 }
 
 // Allocate a continous block of memory of the specified size conveniently
@@ -123,8 +195,59 @@ void *VarlenPool::AllocateZeroes(std::size_t size) {
   return PL_MEMSET(Allocate(size), 0, size);
 }
 
+bool VarlenPool::IsOwner(const void *address) const {
+  if (address == nullptr) return false;
+
+  VarlenBlockHeader header;
+  PL_MEMCPY(&header,
+            reinterpret_cast<const char *>(address) - VARLEN_BLOCK_HEADER_SIZE,
+            sizeof(header));
+  return header.pool == this && header.state == VARLEN_BLOCK_STATE_USED;
+}
+
+void VarlenPool::Free(void *address) {
+  if (IsOwner(address) == false) {
+    LOG_TRACE("Block at %p is not from this pool", address);
+    return;
+  }
+
+  char *block = reinterpret_cast<char *>(address) - VARLEN_BLOCK_HEADER_SIZE;
+  VarlenBlockHeader header;
+  PL_MEMCPY(&header, block, sizeof(header));
+  header.state = VARLEN_BLOCK_STATE_FREE;
+  PL_MEMCPY(block, &header, sizeof(header));
+
+  if (header.size > allocation_size) {
+    // Oversize chunks go back to the storage manager
+    std::lock_guard<std::mutex> pool_lock(pool_mutex);
+    for (auto chunk_itr = oversize_chunks.begin();
+         chunk_itr != oversize_chunks.end(); chunk_itr++) {
+      if (chunk_itr->chunk_data == block) {
+        auto &storage_manager = storage::StorageManager::GetInstance();
+        storage_manager.Release(backend_type, block);
+        oversize_chunks.erase(chunk_itr);
+        break;
+      }
+    }
+    return;
+  }
+
+  // The block goes back to the shard it came from. Old versions are freed
+  // by the garbage collector thread, their space is for the threads that
+  // allocate from the shard.
+  auto &shard = shards[header.shard_index];
+  shard.lock.Lock();
+  shard.free_lists[GetSizeClass(header.size)].push_back(block);
+  shard.free_bytes += header.size;
+  shard.lock.Unlock();
+}
+
 void VarlenPool::Purge() {
-  // Protect using pool lock
+  // Protect using the shard locks, then the pool lock
+  for (auto &shard : shards) {
+    shard.lock.Lock();
+  }
+
   {
     std::lock_guard<std::mutex> pool_lock(pool_mutex);
 
@@ -136,8 +259,8 @@ void VarlenPool::Purge() {
     }
     oversize_chunks.clear();
 
-    // Set the current chunk to the first in the list
-    current_chunk_index = 0;
+    // Set the next chunk to the first in the list
+    next_chunk_index = 0;
     std::size_t num_chunks = chunks.size();
 
     // If more then maxChunkCount chunks are allocated erase all extra chunks
@@ -148,15 +271,23 @@ void VarlenPool::Purge() {
       }
       chunks.resize(max_chunk_count);
     }
+  }
 
-    num_chunks = chunks.size();
-    for (std::size_t ii = 0; ii < num_chunks; ii++) {
-      chunks[ii].offset = 0;
+  for (auto &shard : shards) {
+    shard.chunk_data = nullptr;
+    shard.chunk_offset = 0;
+    shard.chunk_size = 0;
+    for (auto &free_list : shard.free_lists) {
+      free_list.clear();
     }
+    shard.free_bytes = 0;
+    shard.lock.Unlock();
   }
 }
 
 int64_t VarlenPool::GetAllocatedMemory() {
+  std::lock_guard<std::mutex> pool_lock(pool_mutex);
+
   int64_t total = 0;
   total += chunks.size() * allocation_size;
   for (uint32_t i = 0; i < oversize_chunks.size(); i++) {
@@ -165,4 +296,14 @@ int64_t VarlenPool::GetAllocatedMemory() {
   return total;
 }
 
+int64_t VarlenPool::GetFreeMemory() {
+  int64_t total = 0;
+  for (auto &shard : shards) {
+    shard.lock.Lock();
+    total += shard.free_bytes;
+    shard.lock.Unlock();
+  }
+  return total;
+}
+
 }  // End peloton namespace
@@ -13,17 +13,23 @@
 
 #include "common/portal.h"
 #include "common/logger.h"
+#include "common/pool.h"
 #include "common/statement.h"
+#include "executor/plan_executor.h"
 
 namespace peloton {
 
 
 Portal::Portal(const std::string& portal_name,
                std::shared_ptr<Statement> statement,
-               const std::vector<std::pair<int, std::string>>& bind_parameters)
+               std::vector<Value> parameters,
+               std::unique_ptr<VarlenPool> parameter_pool,
+               std::vector<int16_t> result_formats)
 : portal_name(portal_name),
   statement(statement),
-  bind_parameters(bind_parameters) {
+  parameters(std::move(parameters)),
+  parameter_pool(std::move(parameter_pool)),
+  result_formats(std::move(result_formats)) {
 
   LOG_INFO("Portal created : %s", portal_name.c_str());
 
@@ -31,8 +37,14 @@ Portal::Portal(const std::string& portal_name,
 
 Portal::~Portal() {
 
+  // the execution uses the plan and the parameters
+  execution.reset();
   statement.reset();
 
+  // the parameters point into the pool
+  parameters.clear();
+  parameter_pool.reset();
+
   LOG_INFO("Portal destroyed : %s", portal_name.c_str());
 
 }
@@ -41,5 +53,21 @@ std::shared_ptr<Statement> Portal::GetStatement() const {
   return statement;
 }
 
+const std::vector<Value>& Portal::GetParameters() const {
+  return parameters;
+}
+
+const std::vector<int16_t>& Portal::GetResultFormats() const {
+  return result_formats;
+}
+
+bridge::PlanExecution* Portal::GetExecution() const {
+  return execution.get();
+}
+
+void Portal::SetExecution(bridge::PlanExecution* execution) {
+  this->execution.reset(execution);
+}
+
 
 }  // namespace peloton
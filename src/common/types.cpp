@@ -199,6 +199,20 @@ BackendType StringToBackendType(std::string str) {
   return BACKEND_TYPE_INVALID;
 }
 
+std::string CompressionTypeToString(CompressionType type) {
+  switch (type) {
+    case (COMPRESSION_TYPE_NONE):
+      return "NONE";
+    case (COMPRESSION_TYPE_DICTIONARY):
+      return "DICTIONARY";
+    case (COMPRESSION_TYPE_BITPACKING):
+      return "BITPACKING";
+    case (COMPRESSION_TYPE_RLE):
+      return "RLE";
+    default: { return "UNKNOWN " + std::to_string(type); }
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // Value <--> String Utilities
 //===--------------------------------------------------------------------===//
@@ -741,6 +755,7 @@ std::string ParseNodeTypeToString(ParseNodeType type) {
     case PARSE_NODE_TYPE_SELECT: { return "SELECT"; }
     case PARSE_NODE_TYPE_JOIN_EXPR: { return "JOIN_EXPR"; }
     case PARSE_NODE_TYPE_TABLE: { return "TABLE"; }
+    case PARSE_NODE_TYPE_COPY: { return "COPY"; }
     case PARSE_NODE_TYPE_MOCK: { return "MOCK"; }
   }
   return "INVALID";
@@ -771,6 +786,8 @@ ParseNodeType StringToParseNodeType(const std::string& str) {
     return PARSE_NODE_TYPE_JOIN_EXPR;
   } else if (str == "TABLE") {
     return PARSE_NODE_TYPE_TABLE;
+  } else if (str == "COPY") {
+    return PARSE_NODE_TYPE_COPY;
   } else if (str == "MOCK") {
     return PARSE_NODE_TYPE_MOCK;
   }
@@ -985,6 +1002,64 @@ ValueType PostgresValueTypeToPelotonValueType(
   return value_type;
 }
 
+PostgresValueType PelotonValueTypeToPostgresValueType(ValueType value_type) {
+  PostgresValueType postgres_value_type = POSTGRES_VALUE_TYPE_INVALID;
+
+  switch (value_type) {
+    case VALUE_TYPE_BOOLEAN:
+      postgres_value_type = POSTGRES_VALUE_TYPE_BOOLEAN;
+      break;
+
+    /* INTEGER, postgres has no one byte integer */
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+      postgres_value_type = POSTGRES_VALUE_TYPE_SMALLINT;
+      break;
+    case VALUE_TYPE_INTEGER:
+      postgres_value_type = POSTGRES_VALUE_TYPE_INTEGER;
+      break;
+    case VALUE_TYPE_BIGINT:
+      postgres_value_type = POSTGRES_VALUE_TYPE_BIGINT;
+      break;
+
+    /* DOUBLE */
+    case VALUE_TYPE_REAL:
+      postgres_value_type = POSTGRES_VALUE_TYPE_REAL;
+      break;
+    case VALUE_TYPE_DOUBLE:
+      postgres_value_type = POSTGRES_VALUE_TYPE_DOUBLE;
+      break;
+
+    /* CHAR */
+    case VALUE_TYPE_VARCHAR:
+    case VALUE_TYPE_VARBINARY:
+      postgres_value_type = POSTGRES_VALUE_TYPE_VARCHAR2;
+      break;
+
+    /* DATE */
+    case VALUE_TYPE_DATE:
+      postgres_value_type = POSTGRES_VALUE_TYPE_DATE;
+      break;
+
+    /* TIMESTAMPS */
+    case VALUE_TYPE_TIMESTAMP:
+      postgres_value_type = POSTGRES_VALUE_TYPE_TIMESTAMPS;
+      break;
+
+    /* DECIMAL */
+    case VALUE_TYPE_DECIMAL:
+      postgres_value_type = POSTGRES_VALUE_TYPE_DECIMAL;
+      break;
+
+    /* INVALID VALUE TYPE */
+    default:
+      LOG_TRACE("INVALID VALUE TYPE : %d ", value_type);
+      postgres_value_type = POSTGRES_VALUE_TYPE_INVALID;
+      break;
+  }
+  return postgres_value_type;
+}
+
 ConstraintType PostgresConstraintTypeToPelotonConstraintType(
     PostgresConstraintType PostgresConstrType) {
   ConstraintType constraintType = CONSTRAINT_TYPE_INVALID;
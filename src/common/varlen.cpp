@@ -29,6 +29,17 @@ Varlen *Varlen::Create(size_t size, VarlenPool *data_pool) {
   return retval;
 }
 
+void Varlen::Destroy(Varlen *varlen, VarlenPool *data_pool) {
+  if (varlen == NULL || data_pool == NULL) return;
+  if (varlen->varlen_temp_pool == true || !data_pool->IsOwner(varlen)) {
+    return;
+  }
+
+  data_pool->Free(varlen->varlen_string_ptr);
+  varlen->~Varlen();
+  data_pool->Free(varlen);
+}
+
 Varlen *Varlen::Clone(const Varlen &src, VarlenPool *data_pool) {
   // Create a new instance, back pointer is set inside
   Varlen *rv = Create(src.varlen_size - sizeof(Varlen *), data_pool);
@@ -130,7 +130,7 @@ bool OptimisticTxnManager::PerformInsert(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header = manager.PeekTileGroup(tile_group_id)->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // Set MVCC info
@@ -156,10 +156,10 @@ void OptimisticTxnManager::PerformUpdate(const ItemPointer &old_location,
   auto transaction_id = current_txn->GetTransactionId();
 
   auto tile_group_header = catalog::Manager::GetInstance()
-                               .GetTileGroup(old_location.block)
+                               .PeekTileGroup(old_location.block)
                                ->GetHeader();
   auto new_tile_group_header = catalog::Manager::GetInstance()
-                                   .GetTileGroup(new_location.block)
+                                   .PeekTileGroup(new_location.block)
                                    ->GetHeader();
 
   // if we can perform update, then we must have already locked the older
@@ -190,7 +190,7 @@ void OptimisticTxnManager::PerformUpdate(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header = manager.PeekTileGroup(tile_group_id)->GetHeader();
 
   PL_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
             current_txn->GetTransactionId());
@@ -209,10 +209,10 @@ void OptimisticTxnManager::PerformDelete(const ItemPointer &old_location,
   auto transaction_id = current_txn->GetTransactionId();
 
   auto tile_group_header = catalog::Manager::GetInstance()
-                               .GetTileGroup(old_location.block)
+                               .PeekTileGroup(old_location.block)
                                ->GetHeader();
   auto new_tile_group_header = catalog::Manager::GetInstance()
-                                   .GetTileGroup(new_location.block)
+                                   .PeekTileGroup(new_location.block)
                                    ->GetHeader();
 
   // if we can perform update, then we must have already locked the older
@@ -242,7 +242,7 @@ void OptimisticTxnManager::PerformDelete(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header = manager.PeekTileGroup(tile_group_id)->GetHeader();
 
   PL_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
             current_txn->GetTransactionId());
@@ -274,7 +274,7 @@ Result OptimisticTxnManager::CommitTransaction() {
     // validate read set.
     for (auto &tile_group_entry : rw_set) {
       oid_t tile_group_id = tile_group_entry.first;
-      auto tile_group = manager.GetTileGroup(tile_group_id);
+      auto tile_group = manager.PeekTileGroup(tile_group_id);
       auto tile_group_header = tile_group->GetHeader();
       for (auto &tuple_entry : tile_group_entry.second) {
         auto tuple_slot = tuple_entry.first;
@@ -307,13 +307,13 @@ Result OptimisticTxnManager::CommitTransaction() {
   auto &log_manager = logging::LogManager::GetInstance();
   log_manager.PrepareLogging();
   // generate transaction id.
-  cid_t end_commit_id = GetNextCommitId();
+  cid_t end_commit_id = BeginCommit();
   current_txn->SetEndCommitId(end_commit_id);
   LOG_INFO("Before the loops");
   // validate read set.
   for (auto &tile_group_entry : rw_set) {
     oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
+    auto tile_group = manager.PeekTileGroup(tile_group_id);
     auto tile_group_header = tile_group->GetHeader();
     for (auto &tuple_entry : tile_group_entry.second) {
       auto tuple_slot = tuple_entry.first;
@@ -343,6 +343,7 @@ Result OptimisticTxnManager::CommitTransaction() {
                   tile_group_header->GetEndCommitId(tuple_slot));
         // otherwise, validation fails. abort transaction.
         log_manager.DoneLogging();
+        EndCommit(end_commit_id);
         return AbortTransaction();
       }
     }
@@ -353,7 +354,7 @@ Result OptimisticTxnManager::CommitTransaction() {
   // install everything.
   for (auto &tile_group_entry : rw_set) {
     oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
+    auto tile_group = manager.PeekTileGroup(tile_group_id);
     auto tile_group_header = tile_group->GetHeader();
     for (auto &tuple_entry : tile_group_entry.second) {
       auto tuple_slot = tuple_entry.first;
@@ -370,7 +371,11 @@ Result OptimisticTxnManager::CommitTransaction() {
         // visible.
         // we do not change begin cid for old tuple.
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
+
+        // mark both tile groups dirty for incremental checkpoints
+        tile_group_header->SetDirtyCommitId(end_commit_id);
+        new_tile_group_header->SetDirtyCommitId(end_commit_id);
 
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
         new_tile_group_header->SetBeginCommitId(new_version.offset,
@@ -396,7 +401,11 @@ Result OptimisticTxnManager::CommitTransaction() {
 
         // we do not change begin cid for old tuple.
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
+
+        // mark both tile groups dirty for incremental checkpoints
+        tile_group_header->SetDirtyCommitId(end_commit_id);
+        new_tile_group_header->SetDirtyCommitId(end_commit_id);
 
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
         new_tile_group_header->SetBeginCommitId(new_version.offset,
@@ -420,6 +429,7 @@ Result OptimisticTxnManager::CommitTransaction() {
         ItemPointer insert_location(tile_group_id, tuple_slot);
         log_manager.LogInsert(end_commit_id, insert_location);
 
+        tile_group_header->SetDirtyCommitId(end_commit_id);
         tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
         tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
 
@@ -441,6 +451,9 @@ Result OptimisticTxnManager::CommitTransaction() {
       }
     }
   }
+  // every write carries its commit id, checkpoints may now pass it
+  EndCommit(end_commit_id);
+
   log_manager.LogCommitTransaction(end_commit_id);
   EndTransaction();
 
@@ -455,7 +468,7 @@ Result OptimisticTxnManager::AbortTransaction() {
 
   for (auto &tile_group_entry : rw_set) {
     oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
+    auto tile_group = manager.PeekTileGroup(tile_group_id);
     auto tile_group_header = tile_group->GetHeader();
 
     for (auto &tuple_entry : tile_group_entry.second) {
@@ -466,7 +479,7 @@ Result OptimisticTxnManager::AbortTransaction() {
             tile_group_header->GetNextItemPointer(tuple_slot);
 
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
         new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
@@ -493,7 +506,7 @@ Result OptimisticTxnManager::AbortTransaction() {
             tile_group_header->GetNextItemPointer(tuple_slot);
 
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
 
         new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
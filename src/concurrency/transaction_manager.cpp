@@ -12,6 +12,9 @@
 
 
 #include "concurrency/transaction_manager.h"
+
+#include <thread>
+
 #include "expression/container_tuple.h"
 
 namespace peloton {
@@ -20,9 +23,49 @@ namespace concurrency {
 // Current transaction for the backend thread
 thread_local Transaction *current_txn;
 
+/**
+ * The commit id is drawn under the lock of the bucket, so a checkpoint that
+ * reads the buckets after taking its commit id sees every commit below it
+ * that is still installing.
+ */
+cid_t TransactionManager::BeginCommit() {
+  auto &bucket = GetCommitBucket();
+  bucket.lock.Lock();
+  cid_t commit_id = GetNextCommitId();
+  bucket.commit_ids.insert(commit_id);
+  bucket.lock.Unlock();
+  return commit_id;
+}
+
+void TransactionManager::EndCommit(const cid_t &commit_id) {
+  auto &bucket = GetCommitBucket();
+  bucket.lock.Lock();
+  bucket.commit_ids.erase(commit_id);
+  bucket.lock.Unlock();
+}
+
+cid_t TransactionManager::GetOldestInFlightCommitId() {
+  cid_t oldest_commit_id = MAX_CID;
+  for (auto &bucket : commit_buckets_) {
+    bucket.lock.Lock();
+    if (bucket.commit_ids.empty() == false &&
+        *bucket.commit_ids.begin() < oldest_commit_id) {
+      oldest_commit_id = *bucket.commit_ids.begin();
+    }
+    bucket.lock.Unlock();
+  }
+  return oldest_commit_id;
+}
+
+TransactionManager::CommitBucket &TransactionManager::GetCommitBucket() {
+  auto thread_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return commit_buckets_[thread_hash % RUNNING_TXN_BUCKET_NUM];
+}
+
 bool TransactionManager::IsOccupied(const ItemPointer &position) {
-  auto tile_group_header =
-      catalog::Manager::GetInstance().GetTileGroup(position.block)->GetHeader();
+  auto tile_group_header = catalog::Manager::GetInstance()
+                               .PeekTileGroup(position.block)
+                               ->GetHeader();
   auto tuple_id = position.offset;
 
   txn_id_t tuple_txn_id = tile_group_header->GetTransactionId(tuple_id);
@@ -132,7 +132,7 @@ bool TsOrderTxnManager::PerformRead(const ItemPointer &location) {
 
   LOG_TRACE("Perform read");
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group = manager.GetTileGroup(tile_group_id);
+  auto tile_group = manager.PeekTileGroup(tile_group_id);
   auto tile_group_header = tile_group->GetHeader();
 
   if (IsOwner(tile_group_header, tuple_id)) {
@@ -159,7 +159,7 @@ bool TsOrderTxnManager::PerformInsert(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header = manager.PeekTileGroup(tile_group_id)->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // Set MVCC info
@@ -181,10 +181,10 @@ void TsOrderTxnManager::PerformUpdate(const ItemPointer &old_location,
   LOG_TRACE("Performing Write %u %u", old_location.block, old_location.offset);
 
   auto tile_group_header = catalog::Manager::GetInstance()
-                               .GetTileGroup(old_location.block)
+                               .PeekTileGroup(old_location.block)
                                ->GetHeader();
   auto new_tile_group_header = catalog::Manager::GetInstance()
-                                   .GetTileGroup(new_location.block)
+                                   .PeekTileGroup(new_location.block)
                                    ->GetHeader();
 
   auto transaction_id = current_txn->GetTransactionId();
@@ -218,7 +218,7 @@ void TsOrderTxnManager::PerformUpdate(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header = manager.PeekTileGroup(tile_group_id)->GetHeader();
 
   PL_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
             current_txn->GetTransactionId());
@@ -238,10 +238,10 @@ void TsOrderTxnManager::PerformDelete(const ItemPointer &old_location,
   LOG_TRACE("Performing Delete");
 
   auto tile_group_header = catalog::Manager::GetInstance()
-                               .GetTileGroup(old_location.block)
+                               .PeekTileGroup(old_location.block)
                                ->GetHeader();
   auto new_tile_group_header = catalog::Manager::GetInstance()
-                                   .GetTileGroup(new_location.block)
+                                   .PeekTileGroup(new_location.block)
                                    ->GetHeader();
 
   auto transaction_id = current_txn->GetTransactionId();
@@ -270,7 +270,7 @@ void TsOrderTxnManager::PerformDelete(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group_header = manager.PeekTileGroup(tile_group_id)->GetHeader();
 
   PL_ASSERT(tile_group_header->GetTransactionId(tuple_id) ==
             current_txn->GetTransactionId());
@@ -311,7 +311,7 @@ Result TsOrderTxnManager::CommitTransaction() {
 
   for (auto &tile_group_entry : rw_set) {
     oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
+    auto tile_group = manager.PeekTileGroup(tile_group_id);
     auto tile_group_header = tile_group->GetHeader();
     for (auto &tuple_entry : tile_group_entry.second) {
       auto tuple_slot = tuple_entry.first;
@@ -324,7 +324,12 @@ Result TsOrderTxnManager::CommitTransaction() {
             tile_group_header->GetNextItemPointer(tuple_slot);
 
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
+
+        // mark both tile groups dirty for incremental checkpoints
+        tile_group_header->SetDirtyCommitId(end_commit_id);
+        new_tile_group_header->SetDirtyCommitId(end_commit_id);
+
         new_tile_group_header->SetBeginCommitId(new_version.offset,
                                                 end_commit_id);
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
@@ -343,7 +348,12 @@ Result TsOrderTxnManager::CommitTransaction() {
             tile_group_header->GetNextItemPointer(tuple_slot);
 
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
+
+        // mark both tile groups dirty for incremental checkpoints
+        tile_group_header->SetDirtyCommitId(end_commit_id);
+        new_tile_group_header->SetDirtyCommitId(end_commit_id);
+
         new_tile_group_header->SetBeginCommitId(new_version.offset,
                                                 end_commit_id);
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
@@ -362,6 +372,7 @@ Result TsOrderTxnManager::CommitTransaction() {
         //PL_ASSERT(tile_group_header->GetTransactionId(tuple_slot) ==
         //          current_txn->GetTransactionId());
         // set the begin commit id to persist insert
+        tile_group_header->SetDirtyCommitId(end_commit_id);
         tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
         tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
@@ -398,7 +409,7 @@ Result TsOrderTxnManager::AbortTransaction() {
 
   for (auto &tile_group_entry : rw_set) {
     oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
+    auto tile_group = manager.PeekTileGroup(tile_group_id);
     auto tile_group_header = tile_group->GetHeader();
 
     for (auto &tuple_entry : tile_group_entry.second) {
@@ -409,7 +420,7 @@ Result TsOrderTxnManager::AbortTransaction() {
         ItemPointer new_version =
             tile_group_header->GetNextItemPointer(tuple_slot);
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
         new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
@@ -436,7 +447,7 @@ Result TsOrderTxnManager::AbortTransaction() {
         ItemPointer new_version =
             tile_group_header->GetNextItemPointer(tuple_slot);
         auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+            manager.PeekTileGroup(new_version.block)->GetHeader();
         new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
         new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// append_only_array.cpp
+//
+// Identification: src/container/append_only_array.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "container/append_only_array.h"
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "common/platform.h"
+#include "common/types.h"
+
+namespace peloton {
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+APPEND_ONLY_ARRAY_TYPE::AppendOnlyArray() : reserved_size_(0), size_(0) {
+  for (size_t chunk_itr = 0; chunk_itr < APPEND_ONLY_ARRAY_CHUNK_COUNT;
+       chunk_itr++) {
+    chunks_[chunk_itr].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+APPEND_ONLY_ARRAY_TYPE::~AppendOnlyArray() {
+  for (size_t chunk_itr = 0; chunk_itr < APPEND_ONLY_ARRAY_CHUNK_COUNT;
+       chunk_itr++) {
+    delete[] chunks_[chunk_itr].load();
+  }
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+size_t APPEND_ONLY_ARRAY_TYPE::Append(const ValueType &item) {
+  size_t offset = reserved_size_.fetch_add(1);
+  if (offset >= APPEND_ONLY_ARRAY_CHUNK_SIZE * APPEND_ONLY_ARRAY_CHUNK_COUNT) {
+    throw Exception("Append only array is full");
+  }
+
+  auto chunk = GetChunk(offset / APPEND_ONLY_ARRAY_CHUNK_SIZE);
+  chunk[offset % APPEND_ONLY_ARRAY_CHUNK_SIZE] = item;
+
+  // Wait for the appenders before us, then publish the item
+  size_t expected_size = offset;
+  while (size_.compare_exchange_weak(expected_size, offset + 1,
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire) == false) {
+    expected_size = offset;
+    _mm_pause();
+  }
+
+  return offset;
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+ValueType APPEND_ONLY_ARRAY_TYPE::Get(const size_t &offset) const {
+  PL_ASSERT(offset < GetSize());
+  auto chunk = chunks_[offset / APPEND_ONLY_ARRAY_CHUNK_SIZE].load(
+      std::memory_order_acquire);
+  return chunk[offset % APPEND_ONLY_ARRAY_CHUNK_SIZE];
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+size_t APPEND_ONLY_ARRAY_TYPE::GetSize() const {
+  return size_.load(std::memory_order_acquire);
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+bool APPEND_ONLY_ARRAY_TYPE::Contains(const ValueType &item) const {
+  auto size = GetSize();
+  for (size_t offset = 0; offset < size; offset++) {
+    if (Get(offset) == item) return true;
+  }
+  return false;
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+void APPEND_ONLY_ARRAY_TYPE::Clear() {
+  // The chunks stay around for the next items
+  size_.store(0);
+  reserved_size_.store(0);
+}
+
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+ValueType *APPEND_ONLY_ARRAY_TYPE::GetChunk(const size_t &chunk_offset) {
+  auto &chunk_slot = chunks_[chunk_offset];
+  auto chunk = chunk_slot.load(std::memory_order_acquire);
+  if (chunk != nullptr) return chunk;
+
+  // Several appenders may race to allocate the chunk, one of them wins
+  auto new_chunk = new ValueType[APPEND_ONLY_ARRAY_CHUNK_SIZE];
+  if (chunk_slot.compare_exchange_strong(chunk, new_chunk,
+                                         std::memory_order_acq_rel)) {
+    return new_chunk;
+  }
+
+  delete[] new_chunk;
+  return chunk;
+}
+
+// Explicit template instantiation
+template class AppendOnlyArray<oid_t>;
+
+}  // namespace peloton
@@ -17,11 +17,14 @@
 #include <utility>
 #include <vector>
 
+#include "brain/layout_tuner.h"
+#include "brain/sample.h"
 #include "common/types.h"
 #include "executor/logical_tile.h"
 #include "executor/logical_tile_factory.h"
 #include "expression/abstract_expression.h"
 #include "expression/container_tuple.h"
+#include "expression/expression_util.h"
 #include "storage/data_table.h"
 #include "storage/tile_group.h"
 
@@ -54,8 +57,39 @@ bool AbstractScanExecutor::DInit() {
 
   column_ids_ = std::move(node.GetColumnIds());
 
+  // Let the layout tuner know which columns the scan touches
+  auto target_table = node.GetTable();
+  if (target_table != nullptr && children_.size() == 0 &&
+      brain::LayoutTuner::GetInstance().IsRunning() == true) {
+    RecordLayoutSample(target_table);
+  }
+
   return true;
 }
 
+void AbstractScanExecutor::RecordLayoutSample(storage::DataTable *table) {
+  auto column_count = table->GetSchema()->GetColumnCount();
+  std::vector<double> columns_accessed(column_count, 0);
+
+  // No column ids means all of them
+  if (column_ids_.empty()) {
+    std::fill(columns_accessed.begin(), columns_accessed.end(), 1);
+  }
+  for (auto column_id : column_ids_) {
+    if (column_id < column_count) columns_accessed[column_id] = 1;
+  }
+
+  std::vector<int> predicate_column_ids;
+  expression::ExpressionUtil::ExtractTupleValuesColumnIdx(
+      predicate_, predicate_column_ids);
+  for (auto column_id : predicate_column_ids) {
+    if (column_id >= 0 && static_cast<oid_t>(column_id) < column_count) {
+      columns_accessed[column_id] = 1;
+    }
+  }
+
+  table->RecordSample(brain::Sample(columns_accessed));
+}
+
 }  // namespace executor
 }  // namespace peloton
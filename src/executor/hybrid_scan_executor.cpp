@@ -32,8 +32,10 @@
 #include "planner/hybrid_scan_plan.h"
 #include "executor/hybrid_scan_executor.h"
 #include "storage/data_table.h"
+#include "storage/tile_group_evictor.h"
 #include "storage/tile_group_header.h"
 #include "storage/tile.h"
+#include "storage/zone_map.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "common/logger.h"
 
@@ -185,7 +187,28 @@ bool HybridScanExecutor::SeqScanUtil() {
   // Retrieve next tile group.
   while (current_tile_group_offset_ < table_tile_group_count_) {
     LOG_TRACE("Current tile group offset : %u", current_tile_group_offset_);
-    auto tile_group = table_->GetTileGroup(current_tile_group_offset_++);
+    // The zone map of an evicted tile group is still in memory
+    auto tile_group = table_->PeekTileGroup(current_tile_group_offset_++);
+
+    // Skip tile groups whose values can't satisfy the predicate
+    if (predicate_ != nullptr &&
+        tile_group->GetZoneMap()->CouldMatch(predicate_,
+                                             executor_context_) == false) {
+      continue;
+    }
+
+    // Have the next tile group read from disk while this one is scanned
+    if (current_tile_group_offset_ < table_tile_group_count_) {
+      auto next_tile_group = table_->PeekTileGroup(current_tile_group_offset_);
+      if (next_tile_group->IsEvicted() == true) {
+        storage::TileGroupEvictor::GetInstance().RequestFaultIn(
+            next_tile_group->GetTileGroupId());
+      }
+    }
+
+    // Brings the tile group back if it was evicted
+    tile_group = table_->GetTileGroup(current_tile_group_offset_ - 1);
+
     auto tile_group_header = tile_group->GetHeader();
 
     oid_t active_tuple_count = tile_group->GetNextTupleSlot();
@@ -79,26 +79,33 @@ bool InsertExecutor::DExecute() {
     auto target_table_schema = target_table->GetSchema();
     auto column_count = target_table_schema->GetColumnCount();
 
-    std::unique_ptr<storage::Tuple> tuple(
-        new storage::Tuple(target_table_schema, true));
-
-    // Go over the logical tile
+    // Materialize the logical tile tuples
+    std::vector<std::unique_ptr<storage::Tuple>> tuples;
     for (oid_t tuple_id : *logical_tile) {
       expression::ContainerTuple<LogicalTile> cur_tuple(logical_tile.get(),
                                                         tuple_id);
 
-      // Materialize the logical tile tuple
+      std::unique_ptr<storage::Tuple> tuple(
+          new storage::Tuple(target_table_schema, true));
       for (oid_t column_itr = 0; column_itr < column_count; column_itr++)
         tuple->SetValue(column_itr, cur_tuple.GetValue(column_itr),
                         executor_pool);
+      tuples.push_back(std::move(tuple));
+    }
 
-      peloton::ItemPointer location = target_table->InsertTuple(tuple.get());
-      if (location.block == INVALID_OID) {
-        transaction_manager.SetTransactionResult(
-            peloton::Result::RESULT_FAILURE);
-        return false;
-      }
+    if (tuples.empty()) return true;
+
+    // Insert them as a batch, which copies them into the tile groups a run
+    // of columns at a time
+    std::vector<ItemPointer> locations;
+    locations.reserve(tuples.size());
+    if (target_table->InsertTuples(tuples, locations, nullptr) == false) {
+      transaction_manager.SetTransactionResult(
+          peloton::Result::RESULT_FAILURE);
+      return false;
+    }
 
+    for (auto &location : locations) {
       auto res = transaction_manager.PerformInsert(location);
       if (!res) {
         transaction_manager.SetTransactionResult(RESULT_FAILURE);
@@ -142,6 +142,24 @@ cleanup:
   return p_status;
 }
 
+/*
+ * Keeps every output tile, for callers that want the whole result at once
+ */
+class LogicalTileCollector : public ResultSink {
+ public:
+  LogicalTileCollector(
+      std::vector<std::unique_ptr<executor::LogicalTile>> &logical_tile_list)
+      : logical_tile_list_(logical_tile_list) {}
+
+  bool Consume(std::unique_ptr<executor::LogicalTile> &tile) override {
+    logical_tile_list_.push_back(std::move(tile));
+    return true;
+  }
+
+ private:
+  std::vector<std::unique_ptr<executor::LogicalTile>> &logical_tile_list_;
+};
+
 /**
  * @brief Build a executor tree and execute it.
  * Use std::vector<Value> as params to make it more elegant for networking
@@ -152,95 +170,181 @@ cleanup:
 int PlanExecutor::ExecutePlan(
     const planner::AbstractPlan *plan, const std::vector<Value> &params,
     std::vector<std::unique_ptr<executor::LogicalTile>> &logical_tile_list) {
+  LogicalTileCollector collector(logical_tile_list);
+  return ExecutePlan(plan, params, collector);
+}
+
+/**
+ * @brief Build a executor tree and execute it, handing every output tile to
+ * the sink as soon as the root executor produces it.
+ * @return number of executed tuples
+ */
+int PlanExecutor::ExecutePlan(const planner::AbstractPlan *plan,
+                              const std::vector<Value> &params,
+                              ResultSink &sink) {
   if (plan == nullptr) return -1;
 
-  LOG_TRACE("PlanExecutor Start ");
+  PlanExecution execution(plan, params);
+  int processed = execution.Run(sink);
 
-  bool status;
-  bool init_failure = false;
-  bool single_statement_txn = false;
+  // a sink that fills up has to go through a PlanExecution of its own
+  if (execution.IsSuspended()) {
+    LOG_ERROR("Result sink is full, dropping the rest of the result");
+    return -1;
+  }
+  return processed;
+}
 
-  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
-  auto txn = peloton::concurrency::current_txn;
+//===--------------------------------------------------------------------===//
+// Plan Execution
+//===--------------------------------------------------------------------===//
 
-  // This happens for single statement queries in PG
-  if (txn == nullptr) {
-    single_statement_txn = true;
-    txn = txn_manager.BeginTransaction();
+PlanExecution::PlanExecution(const planner::AbstractPlan *plan,
+                             const std::vector<Value> &params)
+    : plan_(plan), params_(params) {}
+
+PlanExecution::~PlanExecution() {
+  // a portal that is closed while suspended gives up its transaction
+  if (txn_ != nullptr && finished_ == false) {
+    Abort();
   }
-  PL_ASSERT(txn);
+}
 
-  LOG_TRACE("Txn ID = %lu ", txn->GetTransactionId());
-  LOG_TRACE("Building the executor tree");
+int PlanExecution::Run(ResultSink &sink) {
+  if (plan_ == nullptr || finished_) return -1;
 
-  // Use const std::vector<Value> &params to make it more elegant for network
-  std::unique_ptr<executor::ExecutorContext> executor_context(
-      BuildExecutorContext(params, txn));
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
 
-  // Build the executor tree
-  std::unique_ptr<executor::AbstractExecutor> executor_tree(
-      BuildExecutorTree(nullptr, plan, executor_context.get()));
+  if (txn_ == nullptr) {
+    LOG_TRACE("PlanExecutor Start ");
 
-  LOG_TRACE("Initializing the executor tree");
+    txn_ = peloton::concurrency::current_txn;
 
-  // Initialize the executor tree
-  status = executor_tree->Init();
+    // This happens for single statement queries in PG
+    if (txn_ == nullptr) {
+      single_statement_txn_ = true;
+      txn_ = txn_manager.BeginTransaction();
+    }
+    PL_ASSERT(txn_);
 
-  // Abort and cleanup
-  if (status == false) {
-    init_failure = true;
-    txn->SetResult(Result::RESULT_FAILURE);
-    goto cleanup;
+    LOG_TRACE("Txn ID = %lu ", txn_->GetTransactionId());
+    LOG_TRACE("Building the executor tree");
+
+    executor_context_.reset(BuildExecutorContext(params_, txn_));
+    executor_tree_.reset(
+        BuildExecutorTree(nullptr, plan_, executor_context_.get()));
+
+    LOG_TRACE("Initializing the executor tree");
+
+    // Abort and cleanup
+    if (executor_tree_->Init() == false) {
+      txn_->SetResult(Result::RESULT_FAILURE);
+      Finish(true);
+      return -1;
+    }
+  } else if (single_statement_txn_) {
+    // a suspended execution may be resumed on another thread
+    peloton::concurrency::current_txn = txn_;
   }
 
   LOG_TRACE("Running the executor tree");
+  suspended_ = false;
 
-  // Execute the tree until we get result tiles from root node
-  for (;;) {
-    status = executor_tree->Execute();
+  // First hand over what the sink left last time
+  if (pending_tile_ != nullptr) {
+    if (sink.Consume(pending_tile_) == false) {
+      Abort();
+      return -1;
+    }
+    suspended_ = (pending_tile_ != nullptr);
+  }
 
-    // Stop
-    if (status == false) {
+  // Execute the tree until the root node runs out of tiles or the sink fills
+  while (suspended_ == false) {
+    if (executor_tree_->Execute() == false) {
       break;
     }
 
     std::unique_ptr<executor::LogicalTile> logical_tile(
-        executor_tree->GetOutput());
+        executor_tree_->GetOutput());
 
     // Some executors don't return logical tiles (e.g., Update).
     if (logical_tile.get() == nullptr) {
       continue;
     }
 
-    logical_tile_list.push_back(std::move(logical_tile));
+    if (sink.Consume(logical_tile) == false) {
+      Abort();
+      return -1;
+    }
+
+    if (logical_tile != nullptr) {
+      pending_tile_ = std::move(logical_tile);
+      suspended_ = true;
+    }
   }
 
-// final cleanup
-cleanup:
+  if (suspended_) {
+    // the transaction stays with the execution until it is resumed
+    if (single_statement_txn_) {
+      peloton::concurrency::current_txn = nullptr;
+    }
+    return 0;
+  }
+
+  if (Finish(false) == false) {
+    return -1;
+  }
+  return executor_context_->num_processed;
+}
+
+void PlanExecution::Abort() {
+  // only our own transaction is rolled back, the caller decides on theirs
+  if (single_statement_txn_) {
+    txn_->SetResult(Result::RESULT_FAILURE);
+  }
+  Finish(false);
+}
 
+bool PlanExecution::Finish(bool init_failure) {
   LOG_TRACE("About to commit: single stmt: %d, init_failure: %d, status: %d",
-            single_statement_txn, init_failure, txn->GetResult());
+            single_statement_txn_, init_failure, txn_->GetResult());
+
+  finished_ = true;
+  suspended_ = false;
+  pending_tile_.reset();
 
   // clean up executor tree
-  CleanExecutorTree(executor_tree.get());
+  CleanExecutorTree(executor_tree_.get());
 
   // should we commit or abort ?
-  if (single_statement_txn == true || init_failure == true) {
-    auto status = txn->GetResult();
-    switch (status) {
-      case Result::RESULT_SUCCESS:
-        // Commit
-        return executor_context->num_processed;
+  if (single_statement_txn_ == false && init_failure == false) return true;
 
-        break;
+  // the execution may end on another thread than it started on
+  auto previous_txn = peloton::concurrency::current_txn;
+  peloton::concurrency::current_txn = txn_;
 
-      case Result::RESULT_FAILURE:
-      default:
-        // Abort
-        return -1;
-    }
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  bool committed = false;
+  switch (txn_->GetResult()) {
+    case Result::RESULT_SUCCESS:
+      // Commit
+      LOG_TRACE("Commit Transaction");
+      committed = (txn_manager.CommitTransaction() == Result::RESULT_SUCCESS);
+      break;
+
+    case Result::RESULT_FAILURE:
+    default:
+      // Abort
+      LOG_TRACE("Abort Transaction");
+      txn_manager.AbortTransaction();
+      break;
+  }
+
+  if (previous_txn != txn_) {
+    peloton::concurrency::current_txn = previous_txn;
   }
-  return executor_context->num_processed;
+  return committed;
 }
 
 /**
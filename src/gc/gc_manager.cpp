@@ -15,6 +15,8 @@
 #include "gc/gc_manager.h"
 #include "gc/gc_manager_factory.h"
 #include "index/index.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
 #include "concurrency/transaction_manager_factory.h"
 
 #include <list>
@@ -73,6 +75,13 @@ bool GCManager::ResetTuple(const TupleMetadata &tuple_metadata) {
     return false;
   }
 
+  // Compressed tiles are read only, so their slots are never reused
+  if (tile_group->IsCompressed() == true) {
+    LOG_TRACE("Garbage tuple(%u, %u) is in a compressed tile group",
+              tuple_metadata.tile_group_id, tuple_metadata.tuple_slot_id);
+    return false;
+  }
+
   // From now on, the tile group shared pointer is held by us
   // It's safe to set headers from now on.
 
@@ -91,6 +100,12 @@ bool GCManager::ResetTuple(const TupleMetadata &tuple_metadata) {
       tile_group_header->GetReservedFieldRef(tuple_metadata.tuple_slot_id), 0,
       storage::TileGroupHeader::GetReservedSize());
 
+  // No transaction sees the version anymore, so its strings can go
+  for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount(); tile_itr++) {
+    tile_group->GetTile(tile_itr)
+        ->FreeUninlinedData(tuple_metadata.tuple_slot_id);
+  }
+
   LOG_TRACE("Garbage tuple(%u, %u) in table %u is reset",
             tuple_metadata.tile_group_id, tuple_metadata.tuple_slot_id,
             tuple_metadata.table_id);
@@ -32,7 +32,8 @@ enum ExperimentType {
   EXPERIMENT_TYPE_THROUGHPUT = 1,
   EXPERIMENT_TYPE_RECOVERY = 2,
   EXPERIMENT_TYPE_STORAGE = 3,
-  EXPERIMENT_TYPE_LATENCY = 4
+  EXPERIMENT_TYPE_LATENCY = 4,
+  EXPERIMENT_TYPE_COMPARISON = 5  // throughput and restart time
 };
 
 enum BenchmarkType {
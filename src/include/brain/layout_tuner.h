@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// layout_tuner.h
+//
+// Identification: src/include/brain/layout_tuner.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <gflags/gflags.h>
+
+#include "common/types.h"
+
+DECLARE_uint64(layout_tuner_interval);
+DECLARE_double(layout_tuner_cpu_budget);
+
+// Fraction of columns in other tiles, below which a tile group stays as it is
+#define LAYOUT_TUNER_THETA 0.1
+
+namespace peloton {
+
+namespace storage {
+class DataTable;
+}
+
+namespace brain {
+
+// Layout and migration metrics of a table
+struct LayoutTunerStats {
+  // tiles in the default partition
+  size_t tile_count = 0;
+
+  // times the default partition changed
+  size_t partition_update_count = 0;
+
+  // tile groups moved to the default partition
+  size_t transformed_tile_group_count = 0;
+
+  // seconds spent moving them
+  double transform_time = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// Layout Tuner
+//===--------------------------------------------------------------------===//
+
+/*
+ * LayoutTuner - Adapts the layout of the tables to the workload. Scans
+ * 	record which columns they access while the tuner runs. Every round,
+ * 	the samples of a table are clustered into its default partition, and
+ * 	the frozen tile groups of the table are moved to that partition one
+ * 	at a time. Tile groups that are written to are left alone, so that
+ * 	transactions are never blocked. The tuner sleeps between tile groups
+ * 	so that it stays within its CPU budget.
+ */
+class LayoutTuner {
+ public:
+  LayoutTuner(const LayoutTuner &) = delete;
+  LayoutTuner &operator=(const LayoutTuner &) = delete;
+
+  static LayoutTuner &GetInstance();
+
+  // Tune every interval seconds in the background, taking up to the given
+  // fraction of a core
+  void Start(size_t interval, double cpu_budget);
+
+  void Stop();
+
+  // Whether the scans should record samples
+  bool IsRunning() const { return is_running_; }
+
+  // One round over all the tables. Returns the number of tile groups moved.
+  size_t TuneOnce();
+
+  size_t TuneTable(storage::DataTable *table);
+
+  std::map<oid_t, LayoutTunerStats> GetStats();
+
+ private:
+  LayoutTuner() {}
+
+  ~LayoutTuner();
+
+  void Running(size_t interval);
+
+  // Sleep off the time spent working. Returns false once stopped.
+  bool Throttle(std::chrono::steady_clock::duration busy_time);
+
+  // per table, by oid
+  std::map<oid_t, LayoutTunerStats> stats_;
+
+  std::mutex stats_mutex_;
+
+  double cpu_budget_ = 1.0;
+
+  std::unique_ptr<std::thread> tuner_thread_;
+
+  std::mutex mutex_;
+
+  std::condition_variable stop_cv_;
+
+  std::atomic<bool> is_running_ = ATOMIC_VAR_INIT(false);
+};
+
+}  // End brain namespace
+}  // End peloton namespace
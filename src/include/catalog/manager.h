@@ -65,8 +65,14 @@ class Manager {
 
   void DropTileGroup(const oid_t oid);
 
+  // Brings an evicted tile group back before returning it
   std::shared_ptr<storage::TileGroup> GetTileGroup(const oid_t oid);
 
+  // Returns the tile group as it is, which may be an evicted stub. Used by
+  // background tasks that must not fault every tile group in, and by the
+  // transaction managers, which only touch the header.
+  std::shared_ptr<storage::TileGroup> PeekTileGroup(const oid_t oid);
+
   void ClearTileGroup(void);
 
   //===--------------------------------------------------------------------===//
@@ -83,6 +89,16 @@ class Manager {
 
   void DropDatabaseWithOid(const oid_t database_oid);
 
+  //===--------------------------------------------------------------------===//
+  // CATALOG VERSION
+  //===--------------------------------------------------------------------===//
+
+  // Bumped by every change to the databases, tables or indexes, so that
+  // cached plans can tell whether they are stale
+  uint64_t GetCatalogVersion() const { return catalog_version; }
+
+  void IncrementCatalogVersion() { catalog_version++; }
+
   //===--------------------------------------------------------------------===//
   // CONVENIENCE WRAPPERS
   //===--------------------------------------------------------------------===//
@@ -107,6 +123,8 @@ class Manager {
 
   std::atomic<oid_t> oid = ATOMIC_VAR_INIT(START_OID);
 
+  std::atomic<uint64_t> catalog_version = ATOMIC_VAR_INIT(0);
+
   lookup_dir locator;
 
   // DATABASES
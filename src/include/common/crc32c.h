@@ -0,0 +1,32 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// crc32c.h
+//
+// Identification: src/include/common/crc32c.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace peloton {
+
+//===--------------------------------------------------------------------===//
+// CRC32C (Castagnoli)
+//===--------------------------------------------------------------------===//
+
+class Crc32c {
+ public:
+  // Compute the checksum of the given buffer. Pass the result of a previous
+  // call as crc to extend a checksum over several buffers.
+  static uint32_t Compute(const void *data, size_t length, uint32_t crc = 0);
+};
+
+}  // namespace peloton
@@ -21,6 +21,7 @@
 #include <string.h>
 #include <mutex>
 
+#include "common/platform.h"
 #include "storage/storage_manager.h"
 
 namespace peloton {
@@ -56,10 +57,25 @@ inline T nexthigher(T k) {
 // Memory Pool
 //===--------------------------------------------------------------------===//
 
+// Threads are spread over this many shards of a pool
+#define VARLEN_POOL_SHARD_COUNT 8
+
+// Every block starts with a header naming its pool and size
+#define VARLEN_BLOCK_HEADER_SIZE 16
+
+// Blocks up to this size come in 16 byte steps, larger ones in powers of two
+#define VARLEN_SMALL_BLOCK_SIZE 256
+
+#define VARLEN_SIZE_CLASS_COUNT 64
+
 /**
- * A memory pool that provides fast allocation and deallocation. The
- * only way to release memory is to free all memory in the pool by
- * calling purge.
+ * A memory pool that provides fast allocation and deallocation. Blocks come
+ * in size classes, and freed blocks are kept on a free list per class for
+ * the next allocation of that class. Each thread works on one of a few
+ * shards of the pool, with its own chunk and free lists, so that threads
+ * inserting into the same tile do not wait on each other. A freed block
+ * goes back to the shard it came from, whichever thread frees it. Chunks
+ * are only given back by purge or when the pool goes away.
  */
 class VarlenPool {
   VarlenPool(const VarlenPool &) = delete;
@@ -82,22 +98,64 @@ class VarlenPool {
   // initialized to 0s
   void *AllocateZeroes(std::size_t size);
 
+  // Give a block back to the pool. Blocks of other pools are left alone.
+  void Free(void *address);
+
+  // Whether the block was allocated from this pool and is not freed yet
+  bool IsOwner(const void *address) const;
+
   void Purge();
 
   int64_t GetAllocatedMemory();
 
+  // Bytes in the free lists
+  int64_t GetFreeMemory();
+
  private:
+  struct Shard {
+    Spinlock lock;
+
+    // the chunk blocks are carved out of
+    char *chunk_data = nullptr;
+
+    uint64_t chunk_offset = 0;
+
+    uint64_t chunk_size = 0;
+
+    std::vector<char *> free_lists[VARLEN_SIZE_CLASS_COUNT];
+
+    int64_t free_bytes = 0;
+  };
+
+  // Block size of the size class, header included
+  static std::size_t GetBlockSize(std::size_t size_class);
+
+  static std::size_t GetSizeClass(std::size_t block_size);
+
+  // Shard of the calling thread
+  static std::size_t GetShardIndex();
+
+  // Hand the shard a chunk, with the pool lock held
+  void NextChunk(Shard &shard);
+
+  void *AllocateOversize(std::size_t block_size);
+
   // backend type
   BackendType backend_type;
 
   const uint64_t allocation_size;
   std::size_t max_chunk_count;
-  std::size_t current_chunk_index;
+
+  // chunks from here on are not used by any shard
+  std::size_t next_chunk_index;
   std::vector<Chunk> chunks;
 
-  // Oversize chunks that will be freed and not reused.
+  // Oversize chunks that are freed one by one
   std::vector<Chunk> oversize_chunks;
 
+  Shard shards[VARLEN_POOL_SHARD_COUNT];
+
+  // protects the chunk lists, taken after the shard lock
   std::mutex pool_mutex;
 };
 
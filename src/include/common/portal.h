@@ -17,9 +17,16 @@
 #include <vector>
 #include <memory>
 
+#include "common/value.h"
+
 namespace peloton {
 
 class Statement;
+class VarlenPool;
+
+namespace bridge {
+class PlanExecution;
+}
 
 class Portal {
 
@@ -31,14 +38,28 @@ class Portal {
   Portal(Portal &&) = delete;
   Portal &operator=(Portal &&) = delete;
 
+  // The portal takes over the pool that holds the strings among the
+  // parameters
   Portal(const std::string& portal_name,
          std::shared_ptr<Statement> statement,
-         const std::vector<std::pair<int, std::string>>& bind_parameters);
+         std::vector<Value> parameters,
+         std::unique_ptr<VarlenPool> parameter_pool,
+         std::vector<int16_t> result_formats);
 
   ~Portal();
 
   std::shared_ptr<Statement> GetStatement() const;
 
+  const std::vector<Value>& GetParameters() const;
+
+  const std::vector<int16_t>& GetResultFormats() const;
+
+  // The execution of a suspended portal, nullptr if it is not running
+  bridge::PlanExecution* GetExecution() const;
+
+  // Takes over the execution, replacing (and aborting) the current one
+  void SetExecution(bridge::PlanExecution* execution);
+
  private:
 
   // Portal name
@@ -47,8 +68,17 @@ class Portal {
   // Prepared statement
   std::shared_ptr<Statement> statement;
 
-  // Group the parameter types and the parameters in this vector
-  std::vector<std::pair<int, std::string>> bind_parameters;
+  // Bound parameters, already decoded from their wire format
+  std::vector<Value> parameters;
+
+  // Backs the varlen parameters
+  std::unique_ptr<VarlenPool> parameter_pool;
+
+  // Format code of every result column (0 is text, 1 is binary)
+  std::vector<int16_t> result_formats;
+
+  // Kept between the Execute messages of a suspended portal
+  std::unique_ptr<bridge::PlanExecution> execution;
 
 };
 
@@ -55,6 +55,7 @@ enum LoggerMappingStrategyType {
 enum CheckpointType {
   CHECKPOINT_TYPE_INVALID = 0,
   CHECKPOINT_TYPE_NORMAL = 1,
+  CHECKPOINT_TYPE_PARALLEL = 2,
 };
 
 enum GCType {
@@ -413,6 +414,13 @@ enum BackendType {
   BACKEND_TYPE_HDD = 4       // on hdd
 };
 
+enum CompressionType {
+  COMPRESSION_TYPE_NONE = 0,        // full width values
+  COMPRESSION_TYPE_DICTIONARY = 1,  // codes into the distinct values
+  COMPRESSION_TYPE_BITPACKING = 2,  // offsets from the smallest integer
+  COMPRESSION_TYPE_RLE = 3          // runs of equal codes
+};
+
 //===--------------------------------------------------------------------===//
 // Index Types
 //===--------------------------------------------------------------------===//
@@ -476,6 +484,9 @@ enum ParseNodeType {
   PARSE_NODE_TYPE_JOIN_EXPR = 51,  // a join tree
   PARSE_NODE_TYPE_TABLE = 52,      // a single table
 
+  // Bulk Load Nodes
+  PARSE_NODE_TYPE_COPY = 60,
+
   // Test
   PARSE_NODE_TYPE_MOCK = 80
 };
@@ -766,6 +777,14 @@ enum CheckpointStatus {
   CHECKPOINT_STATUS_CHECKPOINTING = 4,
 };
 
+// Frames in a parallel checkpoint file
+enum CheckpointFrameType {
+  CHECKPOINT_FRAME_TYPE_INVALID = 0,
+  CHECKPOINT_FRAME_TYPE_HEADER = 1,
+  CHECKPOINT_FRAME_TYPE_TILE_GROUP = 2,
+  CHECKPOINT_FRAME_TYPE_FOOTER = 3,
+};
+
 static const int INVALID_FILE_DESCRIPTOR = -1;
 
 // ------------------------------------------------------------------
@@ -941,6 +960,8 @@ void AtomicUpdateItemPointer(ItemPointer *src_ptr, const ItemPointer &value);
 std::string BackendTypeToString(BackendType type);
 BackendType StringToBackendType(const std::string &str);
 
+std::string CompressionTypeToString(CompressionType type);
+
 std::string ValueTypeToString(ValueType type);
 ValueType StringToValueType(const std::string &str);
 ValueType PostgresStringToValueType(std::string str);
@@ -967,6 +988,7 @@ std::string LogRecordTypeToString(LogRecordType type);
 
 ValueType PostgresValueTypeToPelotonValueType(
     PostgresValueType PostgresValType);
+PostgresValueType PelotonValueTypeToPostgresValueType(ValueType value_type);
 ConstraintType PostgresConstraintTypeToPelotonConstraintType(
     PostgresConstraintType PostgresConstrType);
 
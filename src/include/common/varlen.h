@@ -48,6 +48,10 @@ class Varlen {
   /// temporary Pool
   ~Varlen();
 
+  /// Give the string and the Varlen object back to the pool they were
+  /// created in. Varlens of other pools, or on the heap, are left alone.
+  static void Destroy(Varlen *varlen, VarlenPool *data_pool);
+
   /**
    * @brief Clone (deep copy) the source Varlen in the provided data pool.
    */
@@ -64,6 +64,8 @@ class OptimisticTxnManager : public TransactionManager {
 
   virtual Result AbortTransaction();
 
+  virtual bool TracksDirtyTileGroups() const { return true; }
+
   virtual Transaction *BeginTransaction() {
     txn_id_t txn_id = GetNextTransactionId();
     cid_t begin_cid = GetNextCommitId();
@@ -16,6 +16,7 @@
 #include <atomic>
 #include <unordered_map>
 #include <list>
+#include <set>
 #include <utility>
 
 #include "storage/tile_group_header.h"
@@ -23,6 +24,7 @@
 #include "concurrency/epoch_manager.h"
 #include "catalog/manager.h"
 #include "common/logger.h"
+#include "common/platform.h"
 
 #include "libcuckoo/cuckoohash_map.hh"
 
@@ -64,6 +66,16 @@ class TransactionManager {
 
   cid_t GetCurrentCommitId() { return next_cid_.load(); }
 
+  // Draw the commit id of a transaction that is about to install its writes,
+  // it stays in flight until EndCommit
+  cid_t BeginCommit();
+
+  void EndCommit(const cid_t &commit_id);
+
+  // Smallest commit id that is drawn but not installed yet, MAX_CID if none.
+  // Everything below it carries its commit id and dirty tile groups.
+  cid_t GetOldestInFlightCommitId();
+
   bool IsOccupied(const ItemPointer &position);
 
   virtual bool IsVisible(
@@ -118,6 +130,10 @@ class TransactionManager {
 
   virtual Result AbortTransaction() = 0;
 
+  // Whether the commit path stamps the dirty commit id of every tile group
+  // it writes to. Delta checkpoints rely on it.
+  virtual bool TracksDirtyTileGroups() const { return false; }
+
   void ResetStates() {
     next_txn_id_ = START_TXN_ID;
     next_cid_ = START_CID;
@@ -144,9 +160,19 @@ class TransactionManager {
       std::make_pair(INVALID_CID, INVALID_CID);
 
  private:
+  // commit ids in flight, spread over buckets by thread
+  struct CommitBucket {
+    Spinlock lock;
+    std::set<cid_t> commit_ids;
+  };
+
+  CommitBucket &GetCommitBucket();
+
   std::atomic<txn_id_t> next_txn_id_;
   std::atomic<cid_t> next_cid_;
   std::atomic<cid_t> maximum_grant_cid_;
+
+  CommitBucket commit_buckets_[RUNNING_TXN_BUCKET_NUM];
 };
 }  // End storage namespace
 }  // End peloton namespace
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// append_only_array.h
+//
+// Identification: src/include/container/append_only_array.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+
+namespace peloton {
+
+// APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+#define APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS template <typename ValueType>
+
+// APPEND_ONLY_ARRAY_TYPE
+#define APPEND_ONLY_ARRAY_TYPE AppendOnlyArray<ValueType>
+
+// Items per chunk
+#define APPEND_ONLY_ARRAY_CHUNK_SIZE 1024
+
+// Chunks per array
+#define APPEND_ONLY_ARRAY_CHUNK_COUNT 4096
+
+/*
+ * AppendOnlyArray - Array that only grows at its end, without locks.
+ * 	Items live in fixed size chunks that are never moved, so readers
+ * 	don't synchronize with appenders. An appender reserves its offset,
+ * 	stores its item and then waits for the appenders before it, so items
+ * 	become visible in order and every item below GetSize() is complete.
+ */
+APPEND_ONLY_ARRAY_TEMPLATE_ARGUMENTS
+class AppendOnlyArray {
+ public:
+  AppendOnlyArray(const AppendOnlyArray &) = delete;
+  AppendOnlyArray &operator=(const AppendOnlyArray &) = delete;
+
+  AppendOnlyArray();
+  ~AppendOnlyArray();
+
+  // Appends an item, returns its offset
+  size_t Append(const ValueType &item);
+
+  // Returns the item at offset, which must be below GetSize()
+  ValueType Get(const size_t &offset) const;
+
+  // Returns the number of visible items
+  size_t GetSize() const;
+
+  // Checks whether the array contains item (linear)
+  bool Contains(const ValueType &item) const;
+
+  // Drops all items (not thread safe)
+  void Clear();
+
+ private:
+  // Returns the chunk, allocating it on first use
+  ValueType *GetChunk(const size_t &chunk_offset);
+
+  std::atomic<ValueType *> chunks_[APPEND_ONLY_ARRAY_CHUNK_COUNT];
+
+  // offsets handed out to appenders
+  std::atomic<size_t> reserved_size_;
+
+  // offsets whose items are stored
+  std::atomic<size_t> size_;
+};
+
+}  // namespace peloton
@@ -40,6 +40,9 @@ class AbstractScanExecutor : public AbstractExecutor {
 
   virtual bool DExecute() = 0;
 
+  // Record the columns the scan accesses, for the layout tuner
+  void RecordLayoutSample(storage::DataTable *table);
+
  protected:
   //===--------------------------------------------------------------------===//
   // Plan Info
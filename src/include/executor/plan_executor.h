@@ -19,10 +19,6 @@
 namespace peloton {
 namespace bridge {
 
-//===--------------------------------------------------------------------===//
-// Plan Executor
-//===--------------------------------------------------------------------===//
-
 typedef struct peloton_status {
   peloton::Result m_result;
   int *m_result_slots;
@@ -44,6 +40,85 @@ typedef struct peloton_status {
 
 } peloton_status;
 
+//===--------------------------------------------------------------------===//
+// Result Sink
+//===--------------------------------------------------------------------===//
+
+/*
+ * ResultSink - Receives the output tiles of a plan as soon as the root
+ * executor produces them, so results do not have to be materialized before
+ * they are sent.
+ */
+class ResultSink {
+ public:
+  virtual ~ResultSink() {}
+
+  // Take the rows of an output tile. A sink that is full leaves the rows it
+  // did not take in the tile; the execution is then suspended and offers the
+  // tile again once resumed. Returns false to abort the execution.
+  virtual bool Consume(std::unique_ptr<executor::LogicalTile> &tile) = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// Plan Execution
+//===--------------------------------------------------------------------===//
+
+/*
+ * PlanExecution - A plan that is run piecewise. The executor tree and the
+ * transaction are kept between runs, so a suspended execution can be resumed
+ * later, on any thread.
+ */
+class PlanExecution {
+ public:
+  PlanExecution(const PlanExecution &) = delete;
+  PlanExecution &operator=(const PlanExecution &) = delete;
+
+  PlanExecution(const planner::AbstractPlan *plan,
+                const std::vector<Value> &params);
+
+  // Aborts the transaction of an execution that never finished
+  ~PlanExecution();
+
+  // Push output tiles into the sink until the plan is exhausted or the sink
+  // is full. Returns the number of processed tuples once the plan is done,
+  // 0 when suspended and -1 on failure.
+  int Run(ResultSink &sink);
+
+  bool IsSuspended() const { return suspended_; }
+
+ private:
+  // Clean up, then commit or abort the transaction if it is ours (or the
+  // plan failed to start). Returns false if the transaction did not commit.
+  bool Finish(bool init_failure);
+
+  // Stop early, e.g. when the sink gives up or the portal is closed
+  void Abort();
+
+  const planner::AbstractPlan *plan_;
+
+  std::vector<Value> params_;
+
+  concurrency::Transaction *txn_ = nullptr;
+
+  // whether the execution began (and so owns) its transaction
+  bool single_statement_txn_ = false;
+
+  std::unique_ptr<executor::ExecutorContext> executor_context_;
+
+  std::unique_ptr<executor::AbstractExecutor> executor_tree_;
+
+  // the rows a full sink left over
+  std::unique_ptr<executor::LogicalTile> pending_tile_;
+
+  bool suspended_ = false;
+
+  bool finished_ = false;
+};
+
+//===--------------------------------------------------------------------===//
+// Plan Executor
+//===--------------------------------------------------------------------===//
+
 class PlanExecutor {
  public:
   PlanExecutor(const PlanExecutor &) = delete;
@@ -80,6 +155,14 @@ class PlanExecutor {
   static int ExecutePlan(
       const planner::AbstractPlan *plan, const std::vector<Value> &params,
       std::vector<std::unique_ptr<executor::LogicalTile>> &logical_tile_list);
+
+  /*
+   * @brief Execute a plan and push its output into the sink as it is
+   * produced
+   * @return the number of tuples processed, -1 on failure
+   */
+  static int ExecutePlan(const planner::AbstractPlan *plan,
+                         const std::vector<Value> &params, ResultSink &sink);
 };
 
 }  // namespace bridge
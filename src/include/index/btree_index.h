@@ -47,6 +47,9 @@ class BTreeIndex : public Index {
 
   bool InsertEntry(const storage::Tuple *key, const ItemPointer &location);
 
+  bool InsertEntries(const std::vector<const storage::Tuple *> &keys,
+                     const std::vector<ItemPointer> &locations);
+
   bool DeleteEntry(const storage::Tuple *key, const ItemPointer &location);
 
   bool CondInsertEntry(const storage::Tuple *key, const ItemPointer &location,
@@ -120,6 +120,11 @@ class Index : public Printable {
   virtual bool InsertEntry(const storage::Tuple *key,
                            const ItemPointer &location) = 0;
 
+  // insert a batch of index entries, keys[i] linked to locations[i]. Indexes
+  // that can do better than one entry at a time override it.
+  virtual bool InsertEntries(const std::vector<const storage::Tuple *> &keys,
+                             const std::vector<ItemPointer> &locations);
+
   // delete the index entry linked to given tuple and location
   virtual bool DeleteEntry(const storage::Tuple *key,
                            const ItemPointer &location) = 0;
@@ -13,17 +13,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
-#include <mutex>
-#include <condition_variable>
 
 #include "common/types.h"
 #include "logging/logger.h"
 #include "logging/log_record.h"
 #include "logging/log_buffer.h"
+#include "logging/log_buffer_ring.h"
 #include "common/platform.h"
 #include "common/pool.h"
-#include "logging/circular_buffer_pool.h"
 
 namespace peloton {
 namespace logging {
@@ -57,21 +56,14 @@ class BackendLogger : public Logger {
                                     const void *data = nullptr) = 0;
 
   void SetLoggingCidLowerBound(cid_t cid) {
-    // XXX bad synchronization practice
-    log_buffer_lock.Lock();
+    logging_cid_lower_bound.store(cid);
 
-    logging_cid_lower_bound = cid;
-
-    highest_logged_commit_message = INVALID_CID;
-
-    log_buffer_lock.Unlock();
+    highest_logged_commit_message.store(INVALID_CID);
   }
 
   // FIXME The following methods should be exposed to FrontendLogger only
   // Collect all log buffers to be persisted
-  std::vector<std::unique_ptr<LogBuffer>> &GetLogBuffers() {
-    return local_queue;
-  }
+  std::vector<LogBufferSlice> &GetLogBuffers() { return local_queue; }
 
   // used by the frontend logger to collect data on the current state of the
   // backend
@@ -80,8 +72,10 @@ class BackendLogger : public Logger {
   // commit, The second is the maximum id this worker has committed
   std::pair<cid_t, cid_t> PrepareLogBuffers();
 
-  // Grant an empty buffer to use
-  void GrantEmptyBuffer(std::unique_ptr<LogBuffer>);
+  // Give back a sealed buffer once it has been persisted
+  void ReleaseLogBuffer(LogBuffer *log_buffer) {
+    log_buffer_ring_.ReleaseLogBuffer(log_buffer);
+  }
 
   // Set FrontendLoggerID
   void SetFrontendLoggerID(int id) { frontend_logger_id = id; }
@@ -96,35 +90,26 @@ class BackendLogger : public Logger {
   VarlenPool *GetVarlenPool() { return backend_pool.get(); }
 
  protected:
-  // the lock for the buffer being used currently
-  Spinlock log_buffer_lock;
-
-  // temporary local_queue used by backend
-  std::vector<std::unique_ptr<LogBuffer>> local_queue;
+  // log buffer slices collected by the frontend logger
+  std::vector<LogBufferSlice> local_queue;
 
   // commit id of the highest value committed so far
-  cid_t highest_logged_commit_message = INVALID_CID;
+  std::atomic<cid_t> highest_logged_commit_message;
+
+  // highest committed value already reported to the frontend logger
+  cid_t reported_commit_message = INVALID_CID;
 
   // id of the corresponding frontend logger
   int frontend_logger_id = -1;  // default
 
   // lower bound for values this backend may commit
-  cid_t logging_cid_lower_bound = INVALID_CID;
-
-  // max cid for the current log buffer
-  cid_t max_log_id_buffer = 0;
+  std::atomic<cid_t> logging_cid_lower_bound;
 
   // temporary serialization buffer
   CopySerializeOutput output_buffer;
 
-  // the current buffer
-  std::unique_ptr<LogBuffer> log_buffer_;
-
-  // the pool of available buffers
-  std::unique_ptr<BufferPool> available_buffer_pool_;
-
-  // the pool of buffers to persist
-  std::unique_ptr<BufferPool> persist_buffer_pool_;
+  // the log buffers of this backend
+  LogBufferRing log_buffer_ring_;
 
   // varlen pool for serialization
   std::unique_ptr<VarlenPool> backend_pool;
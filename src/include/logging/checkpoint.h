@@ -65,6 +65,9 @@ class Checkpoint {
 
   void InitDirectory();
 
+  // find the latest checkpoint version in the checkpoint directory
+  void InitVersionNumber();
+
   // whether file access is disabled. mainly used for testing
   bool disable_file_access = false;
 
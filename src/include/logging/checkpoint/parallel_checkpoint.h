@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parallel_checkpoint.h
+//
+// Identification: src/include/logging/checkpoint/parallel_checkpoint.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/serializer.h"
+#include "logging/checkpoint.h"
+#include "logging/logging_util.h"
+
+namespace peloton {
+
+namespace storage {
+class TileGroup;
+}
+
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Parallel Checkpoint
+//===--------------------------------------------------------------------===//
+
+/**
+ * Fuzzy checkpoint that serializes tile groups with a pool of worker threads.
+ *
+ * Every checkpoint file is a sequence of frames:
+ *   [int32 frame length][byte frame type][frame body]
+ * starting with a HEADER frame (checkpoint cid, delta flag) and ending with a
+ * FOOTER frame. A file without a footer is torn and ignored during recovery.
+ *
+ * Every N-th checkpoint is a full one. The others are deltas that only
+ * contain the tile groups modified since the previous checkpoint, as tracked
+ * by the dirty commit id in the tile group header.
+ */
+class ParallelCheckpoint : public Checkpoint {
+ public:
+  ParallelCheckpoint(const ParallelCheckpoint &) = delete;
+  ParallelCheckpoint &operator=(const ParallelCheckpoint &) = delete;
+  ParallelCheckpoint(ParallelCheckpoint &&) = delete;
+  ParallelCheckpoint &operator=(ParallelCheckpoint &&) = delete;
+  ParallelCheckpoint(bool disable_file_access);
+  ~ParallelCheckpoint();
+
+  // Inherited functions
+  void DoCheckpoint();
+
+  cid_t DoRecovery();
+
+  // Getters and Setters
+  inline void SetThreadCount(size_t thread_count) {
+    PL_ASSERT(thread_count > 0);
+    thread_count_ = thread_count;
+  }
+
+  inline void SetFullCheckpointInterval(size_t interval) {
+    PL_ASSERT(interval > 0);
+    full_checkpoint_interval_ = interval;
+  }
+
+  inline void SetStartCommitId(cid_t start_commit_id) {
+    start_commit_id_ = start_commit_id;
+  }
+
+  // number of tile groups written by the last checkpoint
+  inline size_t GetCheckpointedTileGroupCount() const {
+    return checkpointed_tile_group_count_;
+  }
+
+  inline bool IsLastCheckpointDelta() const { return last_checkpoint_delta_; }
+
+ private:
+  // Serialize one tile group frame into the output buffer
+  bool SerializeTileGroup(storage::TileGroup *tile_group,
+                          CopySerializeOutput &output, bool is_delta);
+
+  // Write a frame to the current checkpoint file
+  void WriteFrame(CheckpointFrameType frame_type,
+                  const CopySerializeOutput &body);
+
+  // Read a whole checkpoint file, returns false if it is missing or torn
+  bool LoadFile(int version, std::vector<char> &buffer, cid_t &commit_id,
+                bool &is_delta);
+
+  // Apply one checkpoint file that has been loaded into memory
+  void ApplyFile(const std::vector<char> &buffer, cid_t commit_id);
+
+  // Rebuild a tile group from its frame body
+  void RecoverTileGroup(const char *data, size_t length, cid_t commit_id);
+
+  void RemoveVersionsBefore(int version);
+
+  FileHandle file_handle_ = INVALID_FILE_HANDLE;
+
+  // serializes frame writes from the worker threads
+  std::mutex file_mutex_;
+
+  // worker threads used for both checkpointing and recovery
+  size_t thread_count_ = 1;
+
+  // every n-th checkpoint is a full checkpoint
+  size_t full_checkpoint_interval_ = 10;
+
+  // number of checkpoints since the last full one
+  size_t checkpoints_since_full_ = 0;
+
+  // commit id of current checkpoint
+  cid_t start_commit_id_ = 0;
+
+  size_t checkpointed_tile_group_count_ = 0;
+
+  bool last_checkpoint_delta_ = false;
+
+  // recovery bookkeeping, updated by the recovery threads
+  std::mutex recovery_mutex_;
+
+  std::map<oid_t, std::pair<storage::DataTable *, size_t>>
+      recovered_tile_groups_;
+};
+
+}  // namespace logging
+}  // namespace peloton
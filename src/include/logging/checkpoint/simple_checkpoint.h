@@ -23,6 +23,7 @@ namespace logging {
 
 class LogRecord;
 class BackendLogger;
+struct LogRecordView;
 
 //===--------------------------------------------------------------------===//
 // Simple Checkpoint
@@ -43,7 +44,7 @@ class SimpleCheckpoint : public Checkpoint {
   cid_t DoRecovery();
 
   // Internal functions
-  void InsertTuple(cid_t commit_id);
+  void InsertTuple(const LogRecordView &record, cid_t commit_id);
 
   void Scan(storage::DataTable *target_table, oid_t database_oid);
 
@@ -63,8 +64,6 @@ class SimpleCheckpoint : public Checkpoint {
 
   void Cleanup();
 
-  void InitVersionNumber();
-
   std::vector<std::shared_ptr<LogRecord>> records_;
 
   FileHandle file_handle_ = INVALID_FILE_HANDLE;
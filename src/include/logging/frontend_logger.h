@@ -24,7 +24,6 @@
 #include "common/types.h"
 #include "logging/logger.h"
 #include "logging/log_buffer.h"
-#include "logging/buffer_pool.h"
 #include "logging/backend_logger.h"
 #include "logging/checkpoint.h"
 
@@ -85,6 +84,9 @@ class FrontendLogger : public Logger {
   void Reset() {
     backend_loggers_lock.Lock();
 
+    // the queued slices point into the buffers of the backend loggers
+    global_queue.clear();
+
     for (auto backend_logger : backend_loggers) {
       backend_logger->SetShutdown(true);
       delete backend_logger;
@@ -94,7 +96,6 @@ class FrontendLogger : public Logger {
     max_flushed_commit_id = 0;
     max_collected_commit_id = 0;
     max_seen_commit_id = 0;
-    global_queue.clear();
 
     backend_loggers.clear();
     backend_loggers_lock.Unlock();
@@ -114,7 +115,7 @@ class FrontendLogger : public Logger {
   std::vector<BackendLogger *> backend_loggers;
 
   // Global queue
-  std::vector<std::unique_ptr<LogBuffer>> global_queue;
+  std::vector<LogBufferSlice> global_queue;
 
   // To synch the status
   Spinlock backend_loggers_lock;
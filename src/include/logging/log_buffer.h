@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 
@@ -39,6 +40,14 @@ class BackendLogger;
 //===--------------------------------------------------------------------===//
 // Log Buffer
 //===--------------------------------------------------------------------===//
+
+/**
+ * A segment of a backend logger's log region. The owning worker reserves
+ * space with a fetch-add on the reserved size, copies the record in and then
+ * publishes it by advancing the size. The frontend logger only reads the
+ * published prefix, so it never has to lock the buffer. Once the worker
+ * moves on to the next buffer, this one is sealed and its size is final.
+ */
 class LogBuffer {
  public:
   LogBuffer(BackendLogger *);
@@ -54,36 +63,70 @@ class LogBuffer {
   // clean up and reset content
   void ResetData();
 
-  inline size_t GetSize() { return size_; }
+  // size of the published prefix
+  inline size_t GetSize() { return size_.load(std::memory_order_acquire); }
 
-  inline void SetSize(size_t size) {
-    PL_ASSERT(size < capacity_);
-    size_ = size;
+  inline cid_t GetMaxLogId() {
+    return max_log_id.load(std::memory_order_relaxed);
   }
 
-  inline void SetMaxLogId(cid_t new_max) { max_log_id = new_max; }
+  inline BackendLogger *GetBackendLogger() { return backend_logger_; }
 
-  inline cid_t GetMaxLogId() { return max_log_id; }
+  // no more records will be written to a sealed buffer
+  inline void Seal() { sealed_.store(true, std::memory_order_release); }
 
-  inline BackendLogger *GetBackendLogger() { return backend_logger_; }
+  inline bool IsSealed() { return sealed_.load(std::memory_order_acquire); }
+
+  // a free buffer is waiting to be reused by the backend logger
+  inline void SetFree(bool free) {
+    free_.store(free, std::memory_order_release);
+  }
+
+  inline bool IsFree() { return free_.load(std::memory_order_acquire); }
+
+  // bytes already handed to the frontend logger (frontend only)
+  inline size_t GetCollectedSize() { return collected_size_; }
+
+  inline void SetCollectedSize(size_t size) { collected_size_ = size; }
 
  private:
-  // write data to the log buffer, return false if not enough space
-  bool WriteData(char *data, size_t len);
+  // the size of buffer reserved by writers
+  std::atomic<size_t> reserved_size_;
 
-  // the size of buffer used already
-  size_t size_ = 0;
+  // the size of buffer published to readers
+  std::atomic<size_t> size_;
 
   // the total capacity of the buffer
   size_t capacity_;
 
-  // Dynamically adjusted data array
+  // Dynamically adjusted data array, allocated on first write
   std::unique_ptr<char[]> elastic_data_;
 
   BackendLogger *backend_logger_;
 
   // maximum log id seen so far
-  cid_t max_log_id = 0;
+  std::atomic<cid_t> max_log_id;
+
+  std::atomic<bool> sealed_;
+
+  std::atomic<bool> free_;
+
+  size_t collected_size_ = 0;
+};
+
+// A published range of a log buffer collected by the frontend logger
+struct LogBufferSlice {
+  LogBuffer *buffer;
+
+  size_t begin;
+
+  size_t end;
+
+  // max log id of the buffer when the slice was collected
+  cid_t max_log_id;
+
+  // the buffer is sealed, give it back once the slice is persisted
+  bool release;
 };
 
 }  // namespace logging
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_buffer_ring.h
+//
+// Identification: src/include/logging/log_buffer_ring.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "logging/log_buffer.h"
+
+// Log Buffer Ring Size has to be 2^n
+#define LOG_BUFFER_RING_SIZE 16
+#define LOG_BUFFER_RING_MASK (LOG_BUFFER_RING_SIZE - 1)
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Buffer Ring
+//===--------------------------------------------------------------------===//
+
+/**
+ * The log region of one backend logger: a fixed ring of log buffers that is
+ * registered up front. The worker fills the buffer at the head and seals it
+ * when it is full. The frontend logger walks from the tail, collecting the
+ * published bytes of each buffer, and releases sealed buffers once they are
+ * persisted. Neither side takes a lock on the fast path; the worker only
+ * blocks when the frontend has fallen a full lap behind.
+ */
+class LogBufferRing {
+ public:
+  LogBufferRing(const LogBufferRing &) = delete;
+  LogBufferRing &operator=(const LogBufferRing &) = delete;
+  LogBufferRing(LogBufferRing &&) = delete;
+  LogBufferRing &operator=(LogBufferRing &&) = delete;
+
+  LogBufferRing(BackendLogger *backend_logger);
+
+  // Append a serialized record (backend only)
+  bool WriteRecord(LogRecord *record);
+
+  // Collect the published ranges that have not been collected yet, returns
+  // true if there is anything new to persist (frontend only)
+  bool CollectLogBuffers(std::vector<LogBufferSlice> &slices);
+
+  // Give a sealed buffer back to the backend logger (frontend only)
+  void ReleaseLogBuffer(LogBuffer *log_buffer);
+
+ private:
+  // Seal the current buffer and move to the next free one
+  void AdvanceBuffer();
+
+  inline LogBuffer *GetBuffer(size_t sequence) {
+    return buffers_[sequence & LOG_BUFFER_RING_MASK].get();
+  }
+
+  std::unique_ptr<LogBuffer> buffers_[LOG_BUFFER_RING_SIZE];
+
+  // sequence of the buffer being filled (backend only)
+  size_t head_ = 0;
+
+  // sequence of the next buffer to collect (frontend only)
+  size_t tail_ = 0;
+
+  // used only when the backend runs out of free buffers
+  std::mutex free_mutex_;
+
+  std::condition_variable free_cv_;
+};
+
+}  // namespace logging
+}  // namespace peloton
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_reader.h
+//
+// Identification: src/include/logging/log_reader.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <string>
+
+#include "common/types.h"
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Record View
+//===--------------------------------------------------------------------===//
+
+/**
+ * A record that lives in the memory of a log reader. The header and body
+ * ranges start with their own length prefix so that they can be handed to
+ * the record deserializers as they are. The view is only valid while the
+ * reader that produced it is open.
+ */
+struct LogRecordView {
+  LogRecordType type = LOGRECORD_TYPE_INVALID;
+
+  const char *header = nullptr;
+  size_t header_length = 0;
+
+  // only set for records that carry a tuple
+  const char *body = nullptr;
+  size_t body_length = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// Log Reader
+//===--------------------------------------------------------------------===//
+
+/**
+ * Zero-copy reader over a log segment. The segment is memory mapped and every
+ * record is checked for bounds and checksum before a view of it is returned.
+ * The first record that fails either check ends the segment: everything from
+ * there on is considered a torn write.
+ */
+class LogReader {
+ public:
+  LogReader(const LogReader &) = delete;
+  LogReader &operator=(const LogReader &) = delete;
+  LogReader(LogReader &&) = delete;
+  LogReader &operator=(LogReader &&) = delete;
+
+  LogReader() {}
+
+  ~LogReader();
+
+  // Map the file and start reading at the given offset
+  bool Open(const std::string &file_name, size_t offset);
+
+  bool Open(int fd, size_t offset);
+
+  // Read from a buffer that is owned by the caller
+  void Open(const char *data, size_t length);
+
+  void Close();
+
+  // Get the next valid record, returns false at the end of the segment
+  bool Next(LogRecordView &record);
+
+  // Whether reading stopped before the end of the segment
+  bool IsTornTail() const { return torn_tail_; }
+
+  // Offset of the first byte that has not been returned as a record
+  size_t GetPosition() const { return position_; }
+
+  size_t GetLength() const { return length_; }
+
+ private:
+  bool ReadLength(size_t offset, size_t &length) const;
+
+  const char *data_ = nullptr;
+
+  size_t length_ = 0;
+
+  size_t position_ = 0;
+
+  // set when the segment is mapped by the reader itself
+  void *mapping_ = nullptr;
+
+  size_t mapping_length_ = 0;
+
+  bool torn_tail_ = false;
+};
+
+}  // namespace logging
+}  // namespace peloton
@@ -33,11 +33,15 @@
  *     -BODY
  *       - Body length           : int
  *       - Data                  : void*
+ *
+ *   Every record ends with a CRC32C of all the preceding bytes :
+ *       - Checksum              : int
 */
 
 #pragma once
 
 #include "common/types.h"
+#include "common/crc32c.h"
 #include "common/serializer.h"
 
 namespace peloton {
@@ -66,7 +70,16 @@ class LogRecord {
 
   size_t GetMessageLength(void) const { return message_length; }
 
+  // Size of the checksum trailer at the end of every record
+  static size_t GetChecksumSize(void) { return sizeof(int32_t); }
+
  protected:
+  // Append the checksum of everything serialized so far
+  static void SerializeChecksum(CopySerializeOutput &output) {
+    output.WriteInt(
+        static_cast<int32_t>(Crc32c::Compute(output.Data(), output.Size())));
+  }
+
   LogRecordType log_record_type = LOGRECORD_TYPE_INVALID;
 
   cid_t cid;
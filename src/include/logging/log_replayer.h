@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_replayer.h
+//
+// Identification: src/include/logging/log_replayer.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/types.h"
+
+namespace peloton {
+namespace logging {
+
+class WriteAheadFrontendLogger;
+
+//===--------------------------------------------------------------------===//
+// Log Replayer
+//===--------------------------------------------------------------------===//
+
+/**
+ * Applies the WAL stream shipped by a primary on a read replica. Segments go
+ * through the same record replay as crash recovery, so a transaction only
+ * becomes visible once its commit record arrives. Segments stay pinned while
+ * a transaction that points into them is still open. Segments are applied
+ * strictly in sequence, one that comes after a missing segment is rejected.
+ */
+class LogReplayer {
+ public:
+  LogReplayer(const LogReplayer &) = delete;
+  LogReplayer &operator=(const LogReplayer &) = delete;
+  LogReplayer(LogReplayer &&) = delete;
+  LogReplayer &operator=(LogReplayer &&) = delete;
+
+  // global singleton
+  static LogReplayer &GetInstance(void);
+
+  // Replay a shipped segment, returns false if it was dropped
+  bool ReplayLogSegment(const std::string &segment, int64_t sequence_number,
+                        int logger_id);
+
+  // Last sequence number applied for the given logger, every segment up to
+  // it was applied
+  int64_t GetReplayedSequenceNumber(int logger_id);
+
+  // Drop open transactions and forget all streams
+  void Reset(void);
+
+ private:
+  LogReplayer();
+
+  ~LogReplayer();
+
+  void UpdateCatalogAndTxnManagers(void);
+
+  std::mutex replay_mutex_;
+
+  std::unique_ptr<WriteAheadFrontendLogger> replay_logger_;
+
+  std::map<int, int64_t> replayed_sequence_numbers_;
+
+  // segments referenced by the tuple records of open transactions
+  std::map<txn_id_t, std::vector<std::shared_ptr<std::string>>>
+      pinned_segments_;
+};
+
+}  // namespace logging
+}  // namespace peloton
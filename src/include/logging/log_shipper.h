@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_shipper.h
+//
+// Identification: src/include/logging/log_shipper.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace peloton {
+
+namespace networking {
+class RpcClient;
+}
+
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Shipper
+//===--------------------------------------------------------------------===//
+
+/**
+ * Streams durable WAL segments from the primary to its read replicas. A
+ * frontend logger hands over the records it has flushed and fsync'ed, and
+ * the shipper sends them to every subscriber as a LogRecordReplay request.
+ * Segments of each frontend logger are numbered so that a replica can drop
+ * duplicates and detect gaps. A replica acknowledges the last segment it
+ * applied in sequence, and the shipper keeps the segments until they are
+ * acknowledged so it can send them again when a replica reports a gap.
+ */
+class LogShipper {
+ public:
+  LogShipper(const LogShipper &) = delete;
+  LogShipper &operator=(const LogShipper &) = delete;
+  LogShipper(LogShipper &&) = delete;
+  LogShipper &operator=(LogShipper &&) = delete;
+
+  // global singleton
+  static LogShipper &GetInstance(void);
+
+  // Stream the log to the replica listening on "ip:port"
+  void AddSubscriber(const std::string &address);
+
+  bool HasSubscribers(void) const { return has_subscribers_.load(); }
+
+  // Send a segment made of whole, durable log records
+  void ShipLogSegment(const std::string &segment, int logger_id);
+
+  // Called when a replica acknowledges a segment, sends the segments after
+  // it again if the replica made no progress
+  void AcknowledgeLogSegment(int logger_id, int64_t sequence_number);
+
+  // Last sequence number sent / acknowledged for the given logger
+  int64_t GetShippedSequenceNumber(int logger_id);
+
+  int64_t GetAcknowledgedSequenceNumber(int logger_id);
+
+ private:
+  LogShipper();
+
+  ~LogShipper();
+
+  // Send a numbered segment to every subscriber, the mutex must be held
+  void SendLogSegment(const std::string &segment, int64_t sequence_number,
+                      int logger_id);
+
+  std::mutex shipper_mutex_;
+
+  std::vector<std::unique_ptr<networking::RpcClient>> subscribers_;
+
+  // checked on every flush without taking the mutex
+  std::atomic<bool> has_subscribers_{false};
+
+  std::map<int, int64_t> shipped_sequence_numbers_;
+
+  std::map<int, int64_t> acknowledged_sequence_numbers_;
+
+  // segments sent but not acknowledged yet, by sequence number
+  std::map<int, std::map<int64_t, std::string>> unacknowledged_segments_;
+
+  // last sequence number shipped when the segments were last sent again
+  std::map<int, int64_t> resent_sequence_numbers_;
+};
+
+}  // namespace logging
+}  // namespace peloton
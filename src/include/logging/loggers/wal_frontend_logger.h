@@ -16,9 +16,11 @@
 #include "logging/frontend_logger.h"
 #include "logging/records/tuple_record.h"
 #include "logging/log_file.h"
+#include "logging/log_reader.h"
 #include "executor/executors.h"
 
 #include <dirent.h>
+#include <memory>
 #include <vector>
 #include <set>
 #include <chrono>
@@ -62,6 +64,9 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   void DoRecovery(void);
 
+  bool ReplayLogRecord(const LogRecordView &record, cid_t start_commit_id,
+                       cid_t max_commit_id);
+
   void RecoverIndex();
 
   void StartTransactionRecovery(cid_t commit_id);
@@ -82,9 +87,9 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   bool FileSwitchCondIsTrue();
 
-  void OpenNextLogFile();
+  bool OpenNextLogFile();
 
-  LogRecordType GetNextLogRecordTypeForRecovery();
+  bool GetNextLogRecordForRecovery(LogRecordView &record);
 
   void TruncateLog(cid_t);
 
@@ -104,6 +109,11 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   void InitSelf();
 
+  // Largest oid and next commit id seen while replaying
+  oid_t GetMaxOid() const { return max_oid; }
+
+  cid_t GetMaxCid() const { return max_cid; }
+
   static constexpr auto wal_directory_path = "wal_log";
 
  private:
@@ -141,6 +151,10 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   int log_file_cursor_;
 
+  // log files mapped during recovery, kept open until their records are
+  // replayed since tuple records point into them
+  std::vector<std::unique_ptr<LogReader>> recovery_readers_;
+
   // for recovery from in memory buffer instead of file.
   char *input_log_buffer;
 
@@ -154,7 +168,10 @@ class WriteAheadFrontendLogger : public FrontendLogger {
 
   CopySerializeOutput output_buffer;
 
-  int logger_id;
+  int logger_id = 0;
+
+  // flushed records that have not been shipped to the replicas yet
+  std::string shipping_buffer_;
 
   cid_t max_delimiter_file = 0;
 
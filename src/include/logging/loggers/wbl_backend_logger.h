@@ -17,7 +17,7 @@
 #include "logging/backend_logger.h"
 #include "concurrency/transaction_manager_factory.h"
 
-#include "unordered_set"
+#include <unordered_map>
 
 namespace peloton {
 namespace logging {
@@ -28,6 +28,9 @@ namespace logging {
 
 class WriteBehindBackendLogger : public BackendLogger {
  public:
+  // Dirty tuple slots [begin, end) of each tile group
+  typedef std::unordered_map<oid_t, std::pair<oid_t, oid_t>> DirtyRangeMap;
+
   WriteBehindBackendLogger(const WriteBehindBackendLogger &) = delete;
   WriteBehindBackendLogger &operator=(const WriteBehindBackendLogger &) =
       delete;
@@ -36,6 +39,8 @@ class WriteBehindBackendLogger : public BackendLogger {
 
   WriteBehindBackendLogger() { logging_type = LOGGING_TYPE_NVM_WBL; }
 
+  ~WriteBehindBackendLogger();
+
   void Log(LogRecord *record);
 
   LogRecord *GetTupleRecord(LogRecordType log_record_type, txn_id_t txn_id,
@@ -44,13 +49,26 @@ class WriteBehindBackendLogger : public BackendLogger {
                             ItemPointer delete_location,
                             const void *data = nullptr);
 
-  void CollectRecordsAndClear(
-      std::vector<std::unique_ptr<LogRecord>> &frontend_queue);
+  // Move the dirty ranges of finished transactions into the given map
+  void CollectDirtyRanges(DirtyRangeMap &dirty_ranges);
+
+  static void MergeDirtyRange(DirtyRangeMap &dirty_ranges, oid_t tile_group_id,
+                              oid_t begin_slot, oid_t end_slot);
+
+  // Persist the tile data of the given ranges in one batch per backend
+  static void PersistDirtyRanges(const DirtyRangeMap &dirty_ranges);
 
  private:
-  void SyncDataForCommit();
+  void AddDirtySlot(const ItemPointer &location);
+
+  // slots modified by the running transaction
+  DirtyRangeMap txn_dirty_ranges_;
+
+  // slots of finished transactions, persisted by the frontend logger before
+  // it writes the record that covers their commit ids
+  DirtyRangeMap finished_dirty_ranges_;
 
-  std::unordered_set<oid_t> tile_groups_to_sync_;
+  Spinlock dirty_ranges_lock_;
 };
 
 }  // namespace logging
@@ -73,6 +73,9 @@ class WriteBehindFrontendLogger : public FrontendLogger {
 
   // Keep tracking latest cid for setting next commit in txn manager
   cid_t max_commit_id_seen = INVALID_CID;
+
+  // Commit ids up to this one may be handed out without another record
+  cid_t max_granted_commit_id = INVALID_CID;
 };
 
 }  // namespace logging
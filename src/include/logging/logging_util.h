@@ -35,26 +35,8 @@ class LoggingUtil {
 
   static size_t GetLogFileSize(FileHandle &file_handle);
 
-  static bool IsFileTruncated(FileHandle &file_handle, size_t size_to_read);
-
-  static size_t GetNextFrameSize(FileHandle &file_handle);
-
-  static LogRecordType GetNextLogRecordType(FileHandle &file_handle);
-
   static int ExtractNumberFromFileName(const char *name);
 
-  static bool ReadTransactionRecordHeader(TransactionRecord &txn_record,
-                                          FileHandle &file_handle);
-
-  static bool ReadTupleRecordHeader(TupleRecord &tuple_record,
-                                    FileHandle &file_handle);
-
-  static storage::Tuple *ReadTupleRecordBody(catalog::Schema *schema,
-                                             VarlenPool *pool,
-                                             FileHandle &file_handle);
-
-  static void SkipTupleRecordBody(FileHandle &file_handle);
-
   static int GetFileSizeFromFileName(const char *);
 
   static bool CreateDirectory(const char *dir_name, int mode);
@@ -41,7 +41,7 @@ class TransactionRecord : public LogRecord, Printable {
 
   bool Serialize(CopySerializeOutput &output);
 
-  void Deserialize(CopySerializeInputBE &input);
+  void Deserialize(SerializeInputBE &input);
 
   static size_t GetTransactionRecordSize(void);
 
@@ -62,7 +62,7 @@ class TupleRecord : public LogRecord, Printable {
 
   void SerializeHeader(CopySerializeOutput &output);
 
-  void DeserializeHeader(CopySerializeInputBE &input);
+  void DeserializeHeader(SerializeInputBE &input);
 
   //===--------------------------------------------------------------------===//
   // Accessor
@@ -80,6 +80,14 @@ class TupleRecord : public LogRecord, Printable {
 
   storage::Tuple *GetTuple();
 
+  // Point the record at a serialized tuple body owned by a log reader, so
+  // that replay can deserialize it straight into the tile group
+  void SetTupleBody(const char *body, size_t length);
+
+  const char *GetTupleBody() const { return tuple_body; }
+
+  size_t GetTupleBodyLength() const { return tuple_body_length; }
+
   static size_t GetTupleRecordSize(void);
 
   // Get a string representation for debugging
@@ -105,6 +113,11 @@ class TupleRecord : public LogRecord, Printable {
   // tuple (for deserialize
   storage::Tuple *tuple = nullptr;
 
+  // serialized tuple body (for zero-copy recovery)
+  const char *tuple_body = nullptr;
+
+  size_t tuple_body_length = 0;
+
   // database id
   oid_t db_oid = DEFAULT_DB_ID;
 };
@@ -97,6 +97,10 @@ class PelotonService : public AbstractPelotonService {
                          const QueryPlanExecRequest* request,
                          QueryPlanExecResponse* response,
                          ::google::protobuf::Closure* done);
+  virtual void LogRecordReplay(::google::protobuf::RpcController* controller,
+                               const LogRecordReplayRequest* request,
+                               LogRecordReplayResponse* response,
+                               ::google::protobuf::Closure* done);
 };
 
 }  // namespace networking
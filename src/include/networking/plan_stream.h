@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_stream.h
+//
+// Identification: src/include/networking/plan_stream.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/serializer.h"
+#include "common/types.h"
+#include "common/value.h"
+#include "executor/plan_executor.h"
+
+// Bound on the size of the tiles in one QueryPlan response
+#define PLAN_STREAM_CHUNK_SIZE (1 << 20)
+
+DECLARE_uint64(plan_stream_idle_timeout);
+
+namespace peloton {
+
+class VarlenPool;
+
+namespace planner {
+class AbstractPlan;
+}
+
+namespace networking {
+
+class QueryPlanExecResponse;
+
+//===--------------------------------------------------------------------===//
+// Plan Stream
+//===--------------------------------------------------------------------===//
+
+/*
+ * PlanStream - A plan shipped by another site, executed piecewise so that
+ * 	its results go back in chunks as the tiles are produced. Every output
+ * 	tile is serialized in the tile format (see Tile::SerializeTo) straight
+ * 	from the logical tile into a buffer that is reused for the whole query.
+ */
+class PlanStream : public bridge::ResultSink {
+ public:
+  PlanStream(const PlanStream &) = delete;
+  PlanStream &operator=(const PlanStream &) = delete;
+
+  // The parameters keep their varlen data in the pool
+  PlanStream(std::unique_ptr<planner::AbstractPlan> plan,
+             const std::vector<Value> &params,
+             std::unique_ptr<VarlenPool> pool);
+
+  // Fill the response with the next tiles of the result, holding at most
+  // max_tuples tuples (0 for no limit) and about PLAN_STREAM_CHUNK_SIZE
+  // bytes. Returns false if the execution failed.
+  bool NextChunk(size_t max_tuples, QueryPlanExecResponse *response);
+
+  // No results left
+  bool IsDone() const { return done_; }
+
+  bool Consume(std::unique_ptr<executor::LogicalTile> &tile) override;
+
+ private:
+  // Build the tile header out of the column info of the first tile
+  void SerializeHeader(executor::LogicalTile *tile);
+
+  std::unique_ptr<VarlenPool> pool_;
+
+  std::unique_ptr<planner::AbstractPlan> plan_;
+
+  bridge::PlanExecution execution_;
+
+  // the serialized tile, reused for every tile
+  CopySerializeOutput output_;
+
+  // the same for all the tiles of the query
+  std::string column_header_;
+
+  // the response being filled
+  QueryPlanExecResponse *response_ = nullptr;
+
+  size_t max_tuples_ = 0;
+
+  size_t chunk_tuple_count_ = 0;
+
+  size_t chunk_size_ = 0;
+
+  bool done_ = false;
+};
+
+//===--------------------------------------------------------------------===//
+// Plan Stream Manager
+//===--------------------------------------------------------------------===//
+
+/*
+ * PlanStreamManager - Keeps the plan streams that have more results to
+ * 	fetch, by query id. A stream is taken out while a request works on it.
+ * 	A stream that is not fetched for plan_stream_idle_timeout seconds is
+ * 	dropped, which aborts its transaction, so a site that went away does not
+ * 	keep it open.
+ */
+class PlanStreamManager {
+ public:
+  PlanStreamManager(const PlanStreamManager &) = delete;
+  PlanStreamManager &operator=(const PlanStreamManager &) = delete;
+
+  PlanStreamManager() {}
+
+  ~PlanStreamManager();
+
+  static PlanStreamManager &GetInstance();
+
+  int64_t GetNextQueryId() { return ++next_query_id_; }
+
+  void Park(int64_t query_id, std::unique_ptr<PlanStream> stream);
+
+  // Returns nullptr if there is no such stream
+  std::unique_ptr<PlanStream> Take(int64_t query_id);
+
+  // Drop the streams parked for longer than the idle time, returns their
+  // number
+  size_t DropIdleStreams(std::chrono::milliseconds idle_time);
+
+  size_t GetStreamCount();
+
+ private:
+  struct ParkedStream {
+    std::unique_ptr<PlanStream> stream;
+    std::chrono::steady_clock::time_point park_time;
+  };
+
+  // Runs DropIdleStreams until the manager goes away
+  void Sweeping(size_t idle_timeout);
+
+  std::mutex mutex_;
+
+  std::map<int64_t, ParkedStream> streams_;
+
+  std::atomic<int64_t> next_query_id_{0};
+
+  // started by the first Park
+  std::unique_ptr<std::thread> sweeper_thread_;
+
+  std::condition_variable stop_cv_;
+
+  bool is_running_ = false;
+};
+
+}  // End networking namespace
+}  // End peloton namespace
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 
+#pragma once
+
 #include <iostream>
 
 #include "networking/rpc_type.h"
@@ -85,6 +87,9 @@ class RpcClient {
   void QueryPlan(const QueryPlanExecRequest* request,
                  QueryPlanExecResponse* response);
 
+  void LogRecordReplay(const LogRecordReplayRequest* request,
+                       LogRecordReplayResponse* response);
+
  private:
   RpcChannel* channel_;
 
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy_parse.h
+//
+// Identification: src/include/parser/peloton/copy_parse.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "parser/peloton/abstract_parse.h"
+
+#include "common/types.h"
+
+#include "common/logger.h"
+
+namespace peloton {
+namespace parser {
+
+/*
+ * CopyParse - COPY table [(columns)] FROM STDIN / TO STDOUT [WITH options].
+ * Only the options that change the data format are kept, in the spelling of
+ * the statement; what is not given is left empty.
+ */
+class CopyParse : public AbstractParse {
+ public:
+  CopyParse() = delete;
+  CopyParse(const CopyParse &) = delete;
+  CopyParse &operator=(const CopyParse &) = delete;
+  CopyParse(CopyParse &&) = delete;
+  CopyParse &operator=(CopyParse &&) = delete;
+
+  explicit CopyParse(CopyStmt *copy_node) {
+    // COPY (SELECT ...) TO has no relation
+    if (copy_node->relation != nullptr) {
+      table_name = std::string(copy_node->relation->relname);
+    }
+    is_from = copy_node->is_from;
+    is_stdio = (copy_node->filename == nullptr && !copy_node->is_program);
+
+    ListCell *item;
+
+    // Columns
+    foreach(item, copy_node->attlist) {
+      ::Value *value = (::Value *)lfirst(item);
+      column_names.push_back(std::string(strVal(value)));
+    }
+
+    // Options, an option without argument means true
+    foreach(item, copy_node->options) {
+      DefElem *def_elem = (DefElem *)lfirst(item);
+      std::string name(def_elem->defname);
+      std::string arg = "true";
+      if (def_elem->arg != nullptr) {
+        if (IsA(def_elem->arg, Integer)) {
+          arg = intVal(def_elem->arg) ? "true" : "false";
+        } else if (IsA(def_elem->arg, String)) {
+          arg = std::string(strVal(def_elem->arg));
+        }
+      }
+
+      if (name == "format") {
+        format = arg;
+      } else if (name == "delimiter") {
+        delimiter = arg;
+      } else if (name == "null") {
+        null_string = arg;
+        has_null_string = true;
+      } else if (name == "header") {
+        header = (arg == "true" || arg == "on" || arg == "1");
+      } else if (name == "quote") {
+        quote = arg;
+      } else if (name == "escape") {
+        escape = arg;
+      } else {
+        LOG_INFO("Ignoring COPY option : %s ", name.c_str());
+      }
+    }
+  }
+
+  inline ParseNodeType GetParseNodeType() const { return PARSE_NODE_TYPE_COPY; }
+
+  const std::string GetInfo() const { return "CopyParse"; }
+
+  std::string GetTableName() const { return table_name; }
+
+  // Columns in the order of the data, empty for all of them
+  const std::vector<std::string> &GetColumnNames() const {
+    return column_names;
+  }
+
+  // FROM (load) or TO (dump)
+  bool IsFrom() const { return is_from; }
+
+  // STDIN or STDOUT, instead of a file or program on the server
+  bool IsStdio() const { return is_stdio; }
+
+  // "text", "csv", "binary" or empty for the default
+  std::string GetFormat() const { return format; }
+
+  std::string GetDelimiter() const { return delimiter; }
+
+  bool HasNullString() const { return has_null_string; }
+
+  std::string GetNullString() const { return null_string; }
+
+  bool HasHeader() const { return header; }
+
+  std::string GetQuote() const { return quote; }
+
+  std::string GetEscape() const { return escape; }
+
+ private:
+  std::string table_name;
+
+  std::vector<std::string> column_names;
+
+  bool is_from = true;
+
+  bool is_stdio = true;
+
+  std::string format;
+
+  std::string delimiter;
+
+  bool has_null_string = false;
+
+  std::string null_string;
+
+  bool header = false;
+
+  std::string quote;
+
+  std::string escape;
+};
+
+}  // namespace parser
+}  // namespace peloton
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <string>
+#include <vector>
+
 #include "parser/abstract_parser.h"
 
 namespace peloton {
@@ -33,8 +36,24 @@ class PostgresParser : AbstractParser {
 
   static PostgresParser &GetInstance();
 
+  // Parse the query and transform the postgres nodes into our parse tree
   std::unique_ptr<parser::AbstractParse> BuildParseTree(const std::string& query_string);
 
+  // Same result, but serializes the postgres nodes to JSON on the way like
+  // the libpg_query interface does. Only kept to compare against in the
+  // parser benchmark.
+  std::unique_ptr<parser::AbstractParse> BuildParseTreeViaJson(
+      const std::string& query_string);
+
+  // Split a query string into its statements on the semicolons the postgres
+  // scanner finds between tokens. Empty statements are dropped.
+  std::vector<std::string> SplitStatements(const std::string& query_string);
+
+  // The tokens of a statement separated by single spaces, without comments
+  // and trailing semicolons. Keywords and plain identifiers are lowercased,
+  // literals and quoted identifiers are kept as they are.
+  std::string NormalizeStatement(const std::string& query_string);
+
 };
 
 }  // End parser namespace
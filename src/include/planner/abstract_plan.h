@@ -56,7 +56,7 @@ class AbstractPlan : public Printable {
 
   const std::vector<std::unique_ptr<AbstractPlan>> &GetChildren() const;
 
-  const AbstractPlan *GetParent();
+  const AbstractPlan *GetParent() const;
 
   //===--------------------------------------------------------------------===//
   // Accessors
@@ -94,6 +94,13 @@ class AbstractPlan : public Printable {
   }
   virtual int SerializeSize() { return 0; }
 
+  // Serialize the plan with all its children. Only SeqScan (without a
+  // predicate) and Limit nodes are supported, returns false for any other.
+  bool SerializeTree(SerializeOutput &output) const;
+
+  // Rebuild a tree written by SerializeTree, or return nullptr if it can't
+  static std::unique_ptr<AbstractPlan> DeserializeTree(SerializeInputBE &input);
+
  protected:
   // only used by its derived classes (when deserialization)
   AbstractPlan *Parent() { return parent_; }
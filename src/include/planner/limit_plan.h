@@ -50,9 +50,28 @@ class LimitPlan : public AbstractPlan {
     return std::unique_ptr<AbstractPlan>(new LimitPlan(limit_, offset_));
   }
 
+  /**
+   * A LimitPlan is serialized as:
+   * [(int64_t) limit]
+   * [(int64_t) offset]
+   */
+  bool SerializeTo(SerializeOutput &output) const {
+    output.WriteLong(static_cast<int64_t>(limit_));
+    output.WriteLong(static_cast<int64_t>(offset_));
+    return true;
+  }
+
+  bool DeserializeFrom(SerializeInputBE &input) {
+    limit_ = static_cast<size_t>(input.ReadLong());
+    offset_ = static_cast<size_t>(input.ReadLong());
+    return true;
+  }
+
+  int SerializeSize() { return sizeof(int64_t) * 2; }
+
  private:
-  const size_t limit_;   // as LIMIT in SQL standard
-  const size_t offset_;  // as OFFSET in SQL standard
+  size_t limit_;   // as LIMIT in SQL standard
+  size_t offset_;  // as OFFSET in SQL standard
 };
 
 } /* namespace planner */
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column.h
+//
+// Identification: src/include/storage/compressed_column.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/types.h"
+#include "common/value.h"
+
+namespace peloton {
+
+class VarlenPool;
+
+namespace storage {
+
+class Tile;
+
+//===--------------------------------------------------------------------===//
+// Compressed Column
+//===--------------------------------------------------------------------===//
+
+/*
+ * CompressedColumn - One column of a tile that no longer changes, in the
+ * 	smallest of a few encodings. Every value becomes an integer code:
+ * 	integer columns use the offset from their smallest value (frame of
+ * 	reference), other columns the index into a dictionary of their
+ * 	distinct values. Codes are bit-packed at the width of the largest one,
+ * 	or kept as runs when the column has long runs of equal values. Single
+ * 	values are decoded in place, without unpacking the column.
+ */
+class CompressedColumn {
+ public:
+  CompressedColumn(const CompressedColumn &) = delete;
+  CompressedColumn &operator=(const CompressedColumn &) = delete;
+
+  ~CompressedColumn();
+
+  // Encode the first tuple_count slots of a tile column. Returns null when
+  // no encoding is smaller than the column as it is.
+  static CompressedColumn *Compress(Tile *tile, oid_t column_id,
+                                    oid_t tuple_count);
+
+  Value GetValue(oid_t tuple_offset) const;
+
+  CompressionType GetCompressionType() const { return compression_type; }
+
+  // Bytes taken by the encoded column
+  size_t GetSize() const;
+
+ private:
+  CompressedColumn(ValueType value_type, bool is_inlined,
+                   size_t column_length);
+
+  // Code of a slot, or of a run
+  uint64_t GetCode(size_t code_offset) const;
+
+  void PackCodes(const std::vector<uint64_t> &codes);
+
+  ValueType value_type;
+
+  bool is_inlined;
+
+  // bytes a value takes in the tile
+  size_t column_length;
+
+  CompressionType compression_type = COMPRESSION_TYPE_NONE;
+
+  // frame of reference, for integer columns
+  int64_t base_value = 0;
+
+  // distinct values, in tile storage format
+  std::unique_ptr<char[]> dictionary;
+
+  size_t dictionary_size = 0;
+
+  // strings of the dictionary
+  std::unique_ptr<VarlenPool> dictionary_pool;
+
+  // bits per code
+  uint32_t code_width = 0;
+
+  std::vector<uint64_t> packed_codes;
+
+  // exclusive end slot of every run
+  std::vector<oid_t> run_ends;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// data_file_allocator.h
+//
+// Identification: src/include/storage/data_file_allocator.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Every extent starts with a header of one cache line
+#define DATA_FILE_EXTENT_HEADER_SIZE 64
+
+// Extents are page aligned, and a page at least
+#define DATA_FILE_MIN_EXTENT_SIZE 4096
+
+#define DATA_FILE_EXTENT_MAGIC 0x504c5458
+
+namespace peloton {
+namespace storage {
+
+//===--------------------------------------------------------------------===//
+// Data File Allocator
+//===--------------------------------------------------------------------===//
+
+struct DataFileStats {
+  size_t segment_count = 0;
+
+  size_t file_size = 0;
+
+  // bytes in extents that are in use, and in the free lists
+  size_t live_bytes = 0;
+  size_t free_bytes = 0;
+
+  // segments whose extents are being moved out
+  size_t evacuating_segment_count = 0;
+
+  // segments that became empty and were given back to the file system
+  size_t reclaimed_segment_count = 0;
+
+  size_t relocated_count = 0;
+};
+
+/*
+ * DataFileAllocator - Manages the space of the data file of the SSD and HDD
+ * 	backends. The file grows by segments that are fallocate'd and mapped
+ * 	one at a time, so that the addresses handed out never move. Extents
+ * 	come in size classes, four per power of two, and released extents go
+ * 	to a free list per class. Every extent has a header in the file that
+ * 	tells its size and whether it is in use, so the free lists can be
+ * 	rebuilt from the file. A segment without any extent in use is punched
+ * 	out of the file and reused from its start. Sparse segments can be
+ * 	evacuated: their free extents are no longer reused, and their live ones
+ * 	are moved out with Relocate (see DataFileCompactor).
+ */
+class DataFileAllocator {
+ public:
+  DataFileAllocator(const DataFileAllocator &) = delete;
+  DataFileAllocator &operator=(const DataFileAllocator &) = delete;
+
+  // Takes over the open data file. Extents already in the file are found
+  // again. The file grows by segment_size bytes at a time.
+  DataFileAllocator(int data_fd, size_t segment_size);
+
+  // Syncs and unmaps the file
+  ~DataFileAllocator();
+
+  void *Allocate(size_t size);
+
+  void Release(void *address);
+
+  // Evacuate the segments whose extents in use fill less than live_ratio of
+  // their used space. Returns the number of segments being evacuated.
+  size_t SelectSegmentsToEvacuate(double live_ratio);
+
+  // Whether the extent is in a segment being evacuated
+  bool IsEvacuating(const void *address);
+
+  // Copy the extent into a new, synced one outside the evacuated segments.
+  // The old one is left to the caller to release once nobody reads it.
+  void *Relocate(const void *address);
+
+  // Sync the whole file
+  void Sync();
+
+  DataFileStats GetStats();
+
+ private:
+  struct Segment {
+    char *address;
+
+    size_t file_offset;
+
+    size_t length;
+
+    // extents are carved out of the segment up to here
+    size_t used;
+
+    size_t live_bytes;
+
+    bool evacuating;
+  };
+
+  static size_t GetSizeClass(size_t size);
+
+  // Back a range of the file with blocks
+  bool ReserveSpace(size_t file_offset, size_t length);
+
+  // Append a segment of at least length bytes to the file
+  size_t AddSegment(size_t length);
+
+  Segment *FindSegment(const void *address);
+
+  // Find the extents of a segment that is already in the file
+  void LoadExtents(Segment &segment);
+
+  // Drop the free extents of a segment from the free lists
+  void PurgeFreeExtents(const Segment &segment);
+
+  // Give the space of a segment without live extents back
+  void ReclaimSegment(Segment &segment);
+
+  int data_fd_;
+
+  size_t segment_size_;
+
+  size_t file_size_ = 0;
+
+  std::mutex mutex_;
+
+  std::vector<Segment> segments_;
+
+  // the segment new extents are carved out of
+  size_t current_segment_ = 0;
+
+  // size class -> free extents
+  std::map<size_t, std::vector<char *>> free_lists_;
+
+  // stats
+  size_t live_bytes_ = 0;
+
+  size_t free_bytes_ = 0;
+
+  size_t reclaimed_segment_count_ = 0;
+
+  size_t relocated_count_ = 0;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// data_file_compactor.h
+//
+// Identification: src/include/storage/data_file_compactor.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/types.h"
+
+DECLARE_uint64(data_file_compaction_interval);
+
+// Segments with less of their used space live than this are evacuated
+#define DATA_FILE_SPARSE_RATIO 0.5
+
+namespace peloton {
+namespace storage {
+
+class DataFileAllocator;
+class TileGroup;
+
+//===--------------------------------------------------------------------===//
+// Data File Compactor
+//===--------------------------------------------------------------------===//
+
+/*
+ * DataFileCompactor - Moves the live tiles out of the sparse segments of the
+ * 	data file, so that the segments end up empty and are given back. A
+ * 	tile group is only touched while none of its slots is being written:
+ * 	all of them are taken, and every version in it is committed and not
+ * 	deleted. The old tile data is released once every transaction that
+ * 	might still read it is gone.
+ */
+class DataFileCompactor {
+ public:
+  DataFileCompactor(const DataFileCompactor &) = delete;
+  DataFileCompactor &operator=(const DataFileCompactor &) = delete;
+
+  DataFileCompactor(DataFileAllocator &allocator);
+
+  ~DataFileCompactor();
+
+  // Compact every interval seconds in the background
+  void Start(size_t interval);
+
+  void Stop();
+
+  // One round over all the tables. Returns the number of tiles moved.
+  size_t CompactOnce();
+
+  // Release the old tile data nobody reads anymore
+  void ReleaseRetiredExtents();
+
+  size_t GetRetiredExtentCount() const { return retired_extents_.size(); }
+
+ private:
+  void Running(size_t interval);
+
+  size_t CompactTileGroup(TileGroup *tile_group);
+
+  DataFileAllocator &allocator_;
+
+  // old tile data and the commit id after which nobody reads it
+  std::vector<std::pair<void *, cid_t>> retired_extents_;
+
+  std::unique_ptr<std::thread> compactor_thread_;
+
+  std::mutex mutex_;
+
+  std::condition_variable stop_cv_;
+
+  bool is_running_ = false;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
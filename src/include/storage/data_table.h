@@ -17,9 +17,19 @@
 #include <queue>
 #include <map>
 #include <mutex>
+#include <vector>
 
+#include <gflags/gflags.h>
+
+#include "common/platform.h"
+#include "container/append_only_array.h"
 #include "storage/abstract_table.h"
 
+DECLARE_uint64(active_tile_group_count);
+
+// Tile groups a table inserts into at once, at most
+#define MAX_ACTIVE_TILE_GROUP_COUNT 64
+
 //===--------------------------------------------------------------------===//
 // GUC Variables
 //===--------------------------------------------------------------------===//
@@ -52,7 +62,10 @@ namespace peloton {
 
 typedef std::map<oid_t, std::pair<oid_t, oid_t>> column_map_type;
 
+class ThreadPool;
+
 namespace brain {
+class Clusterer;
 class Sample;
 }
 
@@ -113,6 +126,14 @@ class DataTable : public AbstractTable {
   // insert tuple in table
   ItemPointer InsertTuple(const Tuple *tuple);
 
+  // Bulk insert: claims runs of slots per tile group, fills the tile groups
+  // in parallel on the pool (if any) and inserts the index entries in
+  // batches, one index per task. The locations of the tuples are appended to
+  // locations. Returns false if an index rejected a key.
+  bool InsertTuples(const std::vector<std::unique_ptr<Tuple>> &tuples,
+                    std::vector<ItemPointer> &locations,
+                    ThreadPool *pool = nullptr);
+
   // delete the tuple at given location
   // bool DeleteTuple(const concurrency::Transaction *transaction,
   //                  ItemPointer location);
@@ -124,6 +145,11 @@ class DataTable : public AbstractTable {
   // coerce into adding a new tile group with a tile group id
   void AddTileGroupWithOidForRecovery(const oid_t &tile_group_id);
 
+  // install an empty tile group with the given id and layout, replacing any
+  // tile group already registered under that id
+  void ResetTileGroupWithOidForRecovery(const oid_t &tile_group_id,
+                                        const column_map_type &column_map);
+
   // add a tile group to table
   void AddTileGroup(const std::shared_ptr<TileGroup> &tile_group);
 
@@ -135,10 +161,15 @@ class DataTable : public AbstractTable {
   std::shared_ptr<storage::TileGroup> GetTileGroupById(
       const oid_t &tile_group_id) const;
 
+  // Same as GetTileGroup, but an evicted tile group stays evicted
+  std::shared_ptr<storage::TileGroup> PeekTileGroup(
+      const oid_t &tile_group_offset) const;
+
   size_t GetTileGroupCount() const;
 
   // Get a tile group with given layout
-  TileGroup *GetTileGroupWithLayout(const column_map_type &partitioning);
+  TileGroup *GetTileGroupWithLayout(const column_map_type &partitioning,
+                                    oid_t tile_group_id = INVALID_OID);
 
   //===--------------------------------------------------------------------===//
   // INDEX
@@ -170,8 +201,11 @@ class DataTable : public AbstractTable {
   // TRANSFORMERS
   //===--------------------------------------------------------------------===//
 
+  // With frozen_only, the tile group is left alone unless it is frozen, and
+  // the copy is dropped if anybody wrote to the original meanwhile
   storage::TileGroup *TransformTileGroup(const oid_t &tile_group_offset,
-                                         const double &theta);
+                                         const double &theta,
+                                         bool frozen_only = false);
 
   //===--------------------------------------------------------------------===//
   // STATS
@@ -197,7 +231,11 @@ class DataTable : public AbstractTable {
 
   void RecordSample(const brain::Sample &sample);
 
-  void UpdateDefaultPartition();
+  size_t GetSampleCount();
+
+  // Fold the recorded samples into the clusters, and derive the default
+  // partition from them. Returns true if the partition changed.
+  bool UpdateDefaultPartition();
 
   //===--------------------------------------------------------------------===//
   // UTILITIES
@@ -235,8 +273,19 @@ class DataTable : public AbstractTable {
   ItemPointer GetEmptyTupleSlot(const storage::Tuple *tuple,
                                 bool check_constraint = true);
 
-  // add a default unpartitioned tile group to table
-  oid_t AddDefaultTileGroup();
+  // add a default unpartitioned tile group to table, and insert into it
+  // through the given active slot
+  oid_t AddDefaultTileGroup(const size_t &active_tile_group_offset = 0);
+
+  // build a tile group ahead of the next AddDefaultTileGroup
+  void PrepareSpareTileGroup();
+
+  // active tile group the calling thread inserts into, adding one if needed
+  std::shared_ptr<TileGroup> GetActiveTileGroup(
+      size_t &active_tile_group_offset);
+
+  // record a tile group in the catalog and at the end of the table
+  void AppendTileGroup(const std::shared_ptr<TileGroup> &tile_group);
 
   // get a partitioning with given layout type
   column_map_type GetTileGroupLayout(LayoutType layout_type);
@@ -251,6 +300,12 @@ class DataTable : public AbstractTable {
   bool InsertInSecondaryIndexes(const storage::Tuple *tuple,
                                 ItemPointer location);
 
+  // insert the keys of a batch of tuples into one index, the tuples being at
+  // locations[offset] onwards
+  bool InsertInIndex(index::Index *index,
+                     const std::vector<std::unique_ptr<Tuple>> &tuples,
+                     const std::vector<ItemPointer> &locations, size_t offset);
+
   // check the foreign key constraints
   bool CheckForeignKeyConstraints(const storage::Tuple *tuple);
 
@@ -267,9 +322,20 @@ class DataTable : public AbstractTable {
   // set of tile groups
   RWLock tile_group_lock_;
 
-  std::vector<oid_t> tile_groups_;
+  // appended without locks, the lock only serializes recovery
+  AppendOnlyArray<oid_t> tile_groups_;
+
+  // tile groups inserts go to, a thread sticks to one of them
+  size_t active_tile_group_count_;
 
-  std::atomic<size_t> tile_group_count_ = ATOMIC_VAR_INIT(0);
+  std::vector<std::shared_ptr<TileGroup>> active_tile_groups_;
+
+  Spinlock active_tile_group_lock_;
+
+  // tile groups built before they are needed, not in the catalog yet
+  std::vector<std::shared_ptr<TileGroup>> spare_tile_groups_;
+
+  Spinlock spare_tile_group_lock_;
 
   // tile group mutex
   // TODO: don't know why need this mutex --Yingjun
@@ -304,6 +370,9 @@ class DataTable : public AbstractTable {
 
   // samples for clustering
   std::vector<brain::Sample> samples_;
+
+  // clusters of the samples seen so far
+  std::unique_ptr<brain::Clusterer> clusterer_;
 };
 
 }  // End storage namespace
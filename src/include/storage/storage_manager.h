@@ -13,14 +13,34 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "common/types.h"
 #include "common/platform.h"
+#include "storage/data_file_allocator.h"
+#include "storage/tile_group_arena.h"
 
 namespace peloton {
 namespace storage {
 
+class DataFileCompactor;
+
+//===--------------------------------------------------------------------===//
+// Sync Range
+//===--------------------------------------------------------------------===//
+
+/// A range of tile data that must reach persistent storage
+struct SyncRange {
+  SyncRange(const void *address, size_t length)
+      : address(address), length(length) {}
+
+  const void *address;
+
+  size_t length;
+};
+
 //===--------------------------------------------------------------------===//
 // Storage Manager
 //===--------------------------------------------------------------------===//
@@ -40,24 +60,45 @@ class StorageManager {
 
   void Sync(BackendType type, void *address, size_t length);
 
+  // Persist a batch of ranges. On NVM the cache lines of all the ranges are
+  // flushed before a single drain, on SSD/HDD the ranges are coalesced into
+  // as few page aligned msyncs as possible.
+  void SyncBatch(BackendType type, std::vector<SyncRange> &ranges);
+
   size_t GetMsyncCount() const { return msync_count; }
 
   size_t GetClflushCount() const { return clflush_count; }
 
   size_t GetAllocationCount() const { return allocation_count; }
 
- private:
-  // data file address
-  void *data_file_address;
+  size_t GetReleaseCount() const { return release_count; }
+
+  // memory of the MM and NVM backends
+  TileGroupArenaStats GetArenaStats() const {
+    return TileGroupArena::GetInstance().GetStats();
+  }
+
+  // space of the SSD and HDD backends
+  DataFileStats GetDataFileStats() const;
 
-  // data file lock
-  Spinlock data_file_spinlock;
+  // null unless the data file is in use
+  DataFileAllocator *GetDataFileAllocator() const {
+    return data_file_allocator.get();
+  }
 
-  // data file len
+  DataFileCompactor *GetDataFileCompactor() const {
+    return data_file_compactor.get();
+  }
+
+ private:
+  // data file len, the file grows by this much at a time
   size_t data_file_len;
 
-  // data offset
-  size_t data_file_offset;
+  // data file space
+  std::unique_ptr<DataFileAllocator> data_file_allocator;
+
+  // moves tiles out of sparse parts of the data file
+  std::unique_ptr<DataFileCompactor> data_file_compactor;
 
   // stats
   size_t msync_count = 0;
@@ -65,6 +106,8 @@ class StorageManager {
   size_t clflush_count = 0;
 
   size_t allocation_count = 0;
+
+  size_t release_count = 0;
 };
 
 }  // End storage namespace
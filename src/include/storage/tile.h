@@ -18,7 +18,9 @@
 #include "common/serializer.h"
 #include "common/pool.h"
 #include "common/printable.h"
+#include "common/platform.h"
 
+#include <memory>
 #include <mutex>
 
 namespace peloton {
@@ -29,9 +31,11 @@ namespace storage {
 //===--------------------------------------------------------------------===//
 
 class Tuple;
+class CompressedColumn;
 class TileGroup;
 class TileGroupHeader;
 class TupleIterator;
+struct SyncRange;
 
 /**
  * Represents a Tile.
@@ -135,6 +139,8 @@ class Tile : public Printable {
 
   inline TileGroupHeader *GetHeader() const { return tile_group_header; }
 
+  inline void SetHeader(TileGroupHeader *header) { tile_group_header = header; }
+
   inline TileGroup *GetTileGroup() const { return tile_group; }
 
   oid_t GetTileId() const { return tile_id; }
@@ -156,20 +162,75 @@ class Tile : public Printable {
   bool SerializeHeaderTo(SerializeOutput &output);
   bool SerializeTuplesTo(SerializeOutput &output, Tuple *tuples,
                          int num_tuples);
+  bool SerializeTuplesTo(SerializeOutput &output,
+                         const std::vector<oid_t> &tuple_slots);
 
   void DeserializeTuplesFrom(SerializeInputBE &serialize_in,
                              VarlenPool *pool = nullptr);
   void DeserializeTuplesFromWithoutHeader(SerializeInputBE &input,
                                           VarlenPool *pool = nullptr);
+  void DeserializeTuplesFrom(SerializeInputBE &input,
+                             const std::vector<oid_t> &tuple_slots,
+                             VarlenPool *pool = nullptr);
 
   VarlenPool *GetPool() { return (pool); }
 
   char *GetTupleLocation(const oid_t tuple_offset) const;
 
+  char *GetData() const { return data; }
+
+  // Give the uninlined values of the tuple back to the pool, once no
+  // transaction can read the tuple anymore
+  void FreeUninlinedData(const oid_t tuple_offset);
+
+  // Point the tile at a copy of its data. Returns the old data, which the
+  // caller releases once no reader is left on it.
+  char *RelocateData(char *new_data);
+
+  //===--------------------------------------------------------------------===//
+  // Compression
+  //===--------------------------------------------------------------------===//
+
+  // Encode every column, if every one of them shrinks. The tile is read only
+  // from then on, and keeps its plain data until ReleaseUncompressedData.
+  bool Compress();
+
+  // Drop the plain data of a compressed tile, once no reader is left on it
+  void ReleaseUncompressedData();
+
+  bool IsCompressed() const { return compressed; }
+
+  // Bytes taken by the encoded columns
+  size_t GetCompressedSize() const;
+
+  //===--------------------------------------------------------------------===//
+  // Eviction
+  //===--------------------------------------------------------------------===//
+
+  // Drop the contents of a tile whose tuples were written out with
+  // SerializeTuplesTo, once no reader is left on them
+  void ReleaseEvictedData();
+
+  // Allocate the tile again and load the tuples SerializeTuplesTo wrote. The
+  // tile is plain afterwards, even if it was compressed before.
+  void RestoreEvictedData(SerializeInputBE &input,
+                          const std::vector<oid_t> &tuple_slots);
+
+  // Bytes the contents of the tile take in memory
+  size_t GetResidentSize();
+
   // Sync the contents
   void Sync();
 
+  // Add the range that holds the tuple slots [begin_slot, end_slot)
+  void GetSyncRanges(oid_t begin_slot, oid_t end_slot,
+                     std::vector<SyncRange> &ranges) const;
+
  protected:
+  // Give the data and the pool back, the data lock must be held unless the
+  // tile goes away
+  void ReleaseData();
+
   //===--------------------------------------------------------------------===//
   // Data members
   //===--------------------------------------------------------------------===//
@@ -215,6 +276,14 @@ class Tile : public Printable {
 
   oid_t column_header_size;
 
+  // encoded columns, once the tile is compressed
+  std::vector<std::unique_ptr<CompressedColumn>> compressed_columns;
+
+  volatile bool compressed;
+
+  // guards data against relocation and release
+  Spinlock data_lock;
+
   /**
    * NOTE : Tiles don't keep track of number of occupied slots.
    * This is maintained by shared Tile Header.
@@ -225,6 +294,7 @@ class Tile : public Printable {
 // Returns a pointer to the tuple requested. No checks are done that the index
 // is valid.
 inline char *Tile::GetTupleLocation(const oid_t tuple_offset) const {
+  PL_ASSERT(data != NULL);
   char *tuple_location = data + (tuple_offset * tuple_length);
 
   return tuple_location;
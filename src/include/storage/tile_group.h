@@ -22,6 +22,7 @@
 
 #include "common/types.h"
 #include "common/printable.h"
+#include "common/serializer.h"
 
 namespace peloton {
 
@@ -44,10 +45,12 @@ namespace storage {
 
 class Tuple;
 class Tile;
+struct SyncRange;
 class TileGroupHeader;
 class AbstractTable;
 class TileGroupIterator;
 class RollbackSegment;
+class ZoneMap;
 
 typedef std::map<oid_t, std::pair<oid_t, oid_t>> column_map_type;
 
@@ -81,11 +84,17 @@ class TileGroup : public Printable {
 
   void ApplyRollbackSegment(char *rb_seg, const oid_t &tuple_slot_id);
 
-  // copy tuple in place.
+  // copy tuple in place, the strings it replaces are freed.
   void CopyTuple(const Tuple *tuple, const oid_t &tuple_slot_id);
 
   void CopyTuple(const oid_t &tuple_slot_id, Tuple *tuple);
 
+  // copy tuple_count tuples of the table schema into consecutive slots from
+  // first_slot on, a run of columns at a time. Fixed-width columns are
+  // copied as bytes, strings are cloned into the pools of the tiles.
+  void CopyTuples(const Tuple *const *tuples, const oid_t &tuple_count,
+                  const oid_t &first_slot);
+
   // insert tuple at next available slot in tile if a slot exists
   oid_t InsertTuple(const Tuple *tuple);
 
@@ -94,6 +103,11 @@ class TileGroup : public Printable {
   oid_t InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
                                 const Tuple *tuple);
 
+  // insert a serialized tuple of the table schema at specific tuple slot
+  // used by recovery mode to replay straight from the log
+  oid_t InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
+                                SerializeInputBE &tuple_body);
+
   // insert tuple at specific tuple slot
   // used by recovery mode
   oid_t DeleteTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id);
@@ -106,6 +120,13 @@ class TileGroup : public Printable {
   oid_t InsertTupleFromCheckpoint(oid_t tuple_slot_id, const Tuple *tuple,
                                   cid_t commit_id);
 
+  // widen the zone map with tuple_count tuples written in place, read
+  // straight from the tiles
+  void UpdateZoneMap(const oid_t &first_slot, const oid_t &tuple_count);
+
+  // build the zone map again from the tuple slots in use
+  void RebuildZoneMap();
+
   //===--------------------------------------------------------------------===//
   // Utilities
   //===--------------------------------------------------------------------===//
@@ -126,6 +147,11 @@ class TileGroup : public Printable {
 
   void SetHeader(TileGroupHeader *header) { tile_group_header = header; }
 
+  // Take over the header of the tile group with the same tuple slots that
+  // this one replaces, so that the MVCC state changes made through either
+  // of them, before or after the swap, are never lost
+  void ShareHeader(const TileGroup &tile_group);
+
   unsigned int NumTiles() const { return tiles.size(); }
 
   // Get the tile at given offset in the tile group
@@ -167,9 +193,61 @@ class TileGroup : public Printable {
 
   double GetSchemaDifference(const storage::column_map_type &new_column_map);
 
+  // Compress the tiles of a tile group nobody writes to anymore. Returns
+  // the number of tiles that were compressed.
+  size_t Compress();
+
+  // Whether any tile is compressed, in which case the tile group is read only
+  bool IsCompressed() const;
+
   // Sync the contents
   void Sync();
 
+  // Add the tile and header ranges that hold the tuple slots
+  // [begin_slot, end_slot), so that many of them can be synced in one batch
+  void GetSyncRanges(oid_t begin_slot, oid_t end_slot,
+                     std::vector<SyncRange> &ranges) const;
+
+  BackendType GetBackendType() const { return backend_type; }
+
+  // Get the min/max synopsis of the columns, used to skip the tile group
+  ZoneMap *GetZoneMap() const { return zone_map.get(); }
+
+  //===--------------------------------------------------------------------===//
+  // Anti-caching
+  //===--------------------------------------------------------------------===//
+
+  // Whether the tiles went to the eviction file, leaving only the header,
+  // the zone map and the layout in memory
+  bool IsEvicted() const { return evicted.load(std::memory_order_acquire); }
+
+  void SetEvicted(bool evicted_) {
+    evicted.store(evicted_, std::memory_order_release);
+  }
+
+  // Note a use in the given round of the evictor. Only the first use in a
+  // round writes, so that hot tile groups don't bounce the cache line.
+  void RecordAccess(uint64_t round) {
+    if (last_access_round.load(std::memory_order_relaxed) != round) {
+      last_access_round.store(round, std::memory_order_relaxed);
+      access_round_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t GetLastAccessRound() const {
+    return last_access_round.load(std::memory_order_relaxed);
+  }
+
+  // Rounds the tile group was used in, halved by the evictor every round
+  uint32_t GetAccessRoundCount() const {
+    return access_round_count.load(std::memory_order_relaxed);
+  }
+
+  void AgeAccessRoundCount() {
+    access_round_count.store(GetAccessRoundCount() / 2,
+                             std::memory_order_relaxed);
+  }
+
  protected:
   //===--------------------------------------------------------------------===//
   // Data members
@@ -192,6 +270,9 @@ class TileGroup : public Printable {
   // associated tile group
   TileGroupHeader *tile_group_header;
 
+  // owns the header, together with the tile groups it is shared with
+  std::shared_ptr<TileGroupHeader> shared_header;
+
   // associated table
   AbstractTable *table;  // this design is fantastic!!!
 
@@ -206,6 +287,28 @@ class TileGroup : public Printable {
   // column to tile mapping :
   // <column offset> to <tile offset, tile column offset>
   column_map_type column_map;
+
+  // Consecutive columns that are consecutive in a tile too, and so are
+  // copied in one go. An uninlined column is a run of its own.
+  struct ColumnRun {
+    oid_t column_id;
+    oid_t tile_column_id;
+    oid_t column_count;
+    bool is_inlined;
+  };
+
+  // runs of every tile, in tile column order
+  std::vector<std::vector<ColumnRun>> column_runs;
+
+  // min/max of every column, maintained by the writes
+  std::unique_ptr<ZoneMap> zone_map;
+
+  // tiles are in the eviction file
+  std::atomic<bool> evicted;
+
+  // access tracking of the evictor
+  std::atomic<uint64_t> last_access_round;
+  std::atomic<uint32_t> access_round_count;
 };
 
 }  // End storage namespace
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_arena.h
+//
+// Identification: src/include/storage/tile_group_arena.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/platform.h"
+
+DECLARE_bool(huge_pages);
+DECLARE_bool(numa_aware_allocation);
+
+// Every block starts with a header of one cache line
+#define ARENA_BLOCK_HEADER_SIZE 64
+
+// Smaller allocations are left to the heap
+#define ARENA_MIN_BLOCK_SIZE (64 * 1024)
+
+// Blocks are carved out of regions of this size, larger ones get their own
+// mapping
+#define ARENA_REGION_SIZE (64 << 20)
+#define ARENA_MAX_BLOCK_SIZE (ARENA_REGION_SIZE / 4)
+
+#define ARENA_PAGE_SIZE 4096
+#define ARENA_HUGE_PAGE_SIZE (2 << 20)
+
+namespace peloton {
+namespace storage {
+
+//===--------------------------------------------------------------------===//
+// Tile Group Arena
+//===--------------------------------------------------------------------===//
+
+struct TileGroupArenaStats {
+  size_t region_count = 0;
+
+  // regions and large blocks that got reserved huge pages
+  size_t hugetlb_mapping_count = 0;
+
+  // blocks too large for a region
+  size_t mapping_count = 0;
+
+  // allocations served from a free list
+  size_t reuse_count = 0;
+
+  // bytes mapped for regions and large blocks
+  size_t mapped_bytes = 0;
+
+  // bytes sitting in the free lists
+  size_t free_bytes = 0;
+
+  size_t node_count = 0;
+};
+
+/*
+ * TileGroupArena - Allocates the memory of tiles and tile group headers.
+ * 	Blocks are carved out of large regions backed by 2 MB huge pages,
+ * 	either reserved hugetlbfs pages or transparent huge pages, so that scans
+ * 	take few TLB misses. Every NUMA node has its own regions, and a block
+ * 	comes from the node of the allocating thread. Released blocks go to a
+ * 	free list per node and block size, which is how tile groups of the same
+ * 	table reuse each other's memory. Regions are never unmapped before the
+ * 	arena goes away.
+ */
+class TileGroupArena {
+ public:
+  TileGroupArena(const TileGroupArena &) = delete;
+  TileGroupArena &operator=(const TileGroupArena &) = delete;
+
+  TileGroupArena(bool huge_pages, bool numa_aware);
+
+  ~TileGroupArena();
+
+  // global arena, set up by the huge_pages and numa_aware_allocation flags.
+  // It lives until the process exits.
+  static TileGroupArena &GetInstance();
+
+  void *Allocate(size_t size);
+
+  void Release(void *address);
+
+  TileGroupArenaStats GetStats();
+
+  // Node of the calling thread
+  size_t GetCurrentNode() const;
+
+ private:
+  struct NodeArena {
+    Spinlock lock;
+
+    // the region blocks are carved out of
+    char *region = nullptr;
+
+    size_t region_offset = 0;
+
+    std::vector<char *> regions;
+
+    // block size -> released blocks
+    std::map<size_t, std::vector<char *>> free_lists;
+
+    size_t free_bytes = 0;
+  };
+
+  // Map memory on a huge page boundary, preferably on the given node
+  char *MapMemory(size_t length, size_t node);
+
+  bool huge_pages_;
+
+  size_t node_count_ = 1;
+
+  std::unique_ptr<NodeArena[]> nodes_;
+
+  // stats
+  std::atomic<size_t> region_count_{0};
+
+  std::atomic<size_t> hugetlb_mapping_count_{0};
+
+  std::atomic<size_t> mapping_count_{0};
+
+  std::atomic<size_t> reuse_count_{0};
+
+  std::atomic<size_t> mapped_bytes_{0};
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_compressor.h
+//
+// Identification: src/include/storage/tile_group_compressor.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/types.h"
+
+DECLARE_uint64(tile_group_compression_interval);
+
+// Rounds a tile group stays untouched before it counts as cold
+#define TILE_GROUP_COLD_ROUNDS 3
+
+namespace peloton {
+namespace storage {
+
+class Tile;
+class TileGroup;
+
+//===--------------------------------------------------------------------===//
+// Tile Group Compressor
+//===--------------------------------------------------------------------===//
+
+/*
+ * TileGroupCompressor - Compresses the in-memory tile groups that went cold:
+ * 	every slot is taken, every version in it is committed and not deleted,
+ * 	and none of them was written in the last few rounds. The plain tile
+ * 	data is released once every transaction that might still read it is
+ * 	gone.
+ */
+class TileGroupCompressor {
+ public:
+  TileGroupCompressor(const TileGroupCompressor &) = delete;
+  TileGroupCompressor &operator=(const TileGroupCompressor &) = delete;
+
+  static TileGroupCompressor &GetInstance();
+
+  // Compress every interval seconds in the background
+  void Start(size_t interval);
+
+  void Stop();
+
+  // One round over all the tables. Returns the number of tiles compressed.
+  size_t CompressOnce();
+
+  // Release the plain tile data nobody reads anymore
+  void ReleaseRetiredTiles();
+
+  size_t GetRetiredTileCount() const { return retired_tiles_.size(); }
+
+ private:
+  TileGroupCompressor() {}
+
+  ~TileGroupCompressor();
+
+  void Running(size_t interval);
+
+  size_t CompressTileGroup(TileGroup *tile_group, cid_t cold_cid);
+
+  // commit ids at the start of the last rounds
+  std::deque<cid_t> round_cids_;
+
+  // compressed tiles and the commit id after which nobody reads their data
+  std::vector<std::pair<std::shared_ptr<Tile>, cid_t>> retired_tiles_;
+
+  std::unique_ptr<std::thread> compressor_thread_;
+
+  std::mutex mutex_;
+
+  std::condition_variable stop_cv_;
+
+  bool is_running_ = false;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
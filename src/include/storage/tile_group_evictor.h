@@ -0,0 +1,195 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_evictor.h
+//
+// Identification: src/include/storage/tile_group_evictor.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/types.h"
+
+namespace peloton {
+class SerializeOutput;
+}
+
+DECLARE_uint64(anti_caching_interval);
+DECLARE_uint64(anti_caching_memory_limit);
+
+// Rounds a tile group stays unused before it may be evicted
+#define TILE_GROUP_EVICTION_COLD_ROUNDS 3
+
+#define EVICTION_FILE_NAME "peloton_evicted.data"
+
+namespace peloton {
+namespace storage {
+
+class TileGroup;
+
+struct TileGroupEvictorStats {
+  // tile groups in the eviction file
+  size_t evicted_tile_group_count = 0;
+
+  // bytes of the eviction file in use
+  size_t evicted_bytes = 0;
+
+  // tile groups written out, and read back since the start
+  size_t eviction_count = 0;
+  size_t fault_in_count = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// Tile Group Evictor
+//===--------------------------------------------------------------------===//
+
+/*
+ * TileGroupEvictor - Anti-caching for in-memory tile groups. Every round,
+ * 	the tile groups nobody looked up in the last few rounds are candidates,
+ * 	the least recently and least often used first. Their tuples are written
+ * 	to the eviction file and the tile group object stays in the catalog as
+ * 	a stub: the header, the zone map and the layout remain in memory, so
+ * 	visibility checks and scan pruning don't need the tuples. The tiles
+ * 	drop their data once every transaction that might still read it is
+ * 	gone. Looking an evicted tile group up in the catalog faults it back
+ * 	in, and scans ask for the next tile groups ahead of time so that they
+ * 	are read in the background.
+ */
+class TileGroupEvictor {
+ public:
+  TileGroupEvictor(const TileGroupEvictor &) = delete;
+  TileGroupEvictor &operator=(const TileGroupEvictor &) = delete;
+
+  static TileGroupEvictor &GetInstance();
+
+  // Evict every interval seconds in the background, until less than
+  // memory_limit MB of tile groups are in memory. Without a limit, every
+  // cold tile group is evicted.
+  void Start(size_t interval, size_t memory_limit);
+
+  void Stop();
+
+  // One round over all the tables. Returns the number of tile groups evicted.
+  size_t EvictOnce();
+
+  // Bring the tiles of an evicted tile group back, waits for the file
+  void FaultIn(TileGroup *tile_group);
+
+  // Write the given tuples of an evicted tile group from its copy in the
+  // file, a tile at a time in the layout of Tile::SerializeTuplesTo,
+  // without bringing it back. The slots are in ascending order. Returns
+  // false, and writes nothing, if the tile group is not evicted.
+  bool SerializeEvictedTuples(TileGroup *tile_group,
+                              const std::vector<oid_t> &tuple_slots,
+                              SerializeOutput &output);
+
+  // Have the tile group brought back in the background
+  void RequestFaultIn(const oid_t &tile_group_id);
+
+  // Forget the copy of a tile group that is dropped
+  void DropTileGroup(const oid_t &tile_group_id);
+
+  // Drop the data of evicted tiles nobody reads anymore
+  void ReleaseRetiredTileGroups();
+
+  size_t GetRetiredTileGroupCount();
+
+  // Round of the access tracking
+  uint64_t GetRound() const { return round_.load(std::memory_order_relaxed); }
+
+  TileGroupEvictorStats GetStats();
+
+ private:
+  TileGroupEvictor() {}
+
+  ~TileGroupEvictor();
+
+  void Running(size_t interval);
+
+  void FaultInRunning();
+
+  bool EvictTileGroup(const std::shared_ptr<TileGroup> &tile_group);
+
+  //===--------------------------------------------------------------------===//
+  // Eviction file
+  //===--------------------------------------------------------------------===//
+
+  struct EvictedBlock {
+    size_t offset;
+
+    size_t length;
+
+    // the tiles gave their data back
+    bool released;
+  };
+
+  // Append a block to the file, returns false if it could not be written
+  bool WriteBlock(const char *buffer, size_t length, size_t &offset);
+
+  void ReadBlock(const EvictedBlock &block, char *buffer);
+
+  // Give the space of a block back to the file system
+  void FreeBlock(const EvictedBlock &block);
+
+  int eviction_fd_ = -1;
+
+  std::string eviction_file_name_;
+
+  // end of the file
+  size_t file_size_ = 0;
+
+  // tile group id to its copy in the file
+  std::map<oid_t, EvictedBlock> evicted_blocks_;
+
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  std::atomic<uint64_t> round_ = ATOMIC_VAR_INIT(1);
+
+  size_t memory_limit_ = 0;
+
+  // evicted tile groups and the commit id after which nobody reads their data
+  std::vector<std::pair<std::shared_ptr<TileGroup>, cid_t>> retired_;
+
+  // tile groups to bring back in the background
+  std::deque<oid_t> fault_in_queue_;
+
+  TileGroupEvictorStats stats_;
+
+  // guards the file, the evicted blocks and the retired tile groups
+  std::mutex eviction_mutex_;
+
+  std::unique_ptr<std::thread> evictor_thread_;
+
+  std::unique_ptr<std::thread> fault_in_thread_;
+
+  std::mutex mutex_;
+
+  std::condition_variable stop_cv_;
+
+  std::condition_variable fault_in_cv_;
+
+  bool is_running_ = false;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
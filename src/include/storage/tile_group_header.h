@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <queue>
@@ -27,6 +28,7 @@ namespace peloton {
 namespace storage {
 
 class TileGroup;
+struct SyncRange;
 
 //===--------------------------------------------------------------------===//
 // Tile Group Header
@@ -37,17 +39,40 @@ class TileGroup;
  * This contains information related to MVCC.
  * It is shared by all tiles in a tile group.
  *
- * Layout :
+ * Layout : one array per field, each starting on a cache line of its own.
+ * Visibility checks scan the txn ids and commit ids of neighbouring slots,
+ * and the ts order protocol writes the reserved field on every read, so
+ * those writes don't invalidate the lines other slots' txn ids live on.
+ * Entries of 8 bytes or less never straddle a cache line.
  *
  *  -----------------------------------------------------------------------------
- *  | TxnID (8 bytes)  | BeginTimeStamp (8 bytes) | EndTimeStamp (8 bytes) |
- *  | NextItemPointer (8 bytes) | PrevItemPointer (8 bytes) | IndexCount(4
- *bytes) |
- *  | ReservedField (24 bytes) | InsertCommit (1 byte) | DeleteCommit (1 byte)
+ *  | TxnID (8 bytes) | ...                                     (one per slot)
+ *  | BeginTimeStamp (8 bytes) | ...
+ *  | EndTimeStamp (8 bytes) | ...
+ *  | NextItemPointer (8 bytes) | ...
+ *  | PrevItemPointer (8 bytes) | ...
+ *  | InsertCommit (1 byte) | DeleteCommit (1 byte) | ...
+ *  | ReservedField (24 bytes) | ...
  *  -----------------------------------------------------------------------------
  */
 
-#define TUPLE_HEADER_LOCATION data + (tuple_slot_id * header_entry_size)
+#define TXN_ID_LOCATION (txn_id_data + (tuple_slot_id * sizeof(txn_id_t)))
+
+#define BEGIN_CID_LOCATION (begin_cid_data + (tuple_slot_id * sizeof(cid_t)))
+
+#define END_CID_LOCATION (end_cid_data + (tuple_slot_id * sizeof(cid_t)))
+
+#define NEXT_POINTER_LOCATION \
+  (next_pointer_data + (tuple_slot_id * sizeof(ItemPointer)))
+
+#define PREV_POINTER_LOCATION \
+  (prev_pointer_data + (tuple_slot_id * sizeof(ItemPointer)))
+
+#define COMMIT_FLAGS_LOCATION \
+  (commit_flags_data + (tuple_slot_id * commit_flags_size))
+
+#define RESERVED_FIELD_LOCATION \
+  (reserved_field_data + (tuple_slot_id * reserverd_size))
 
 class TileGroupHeader : public Printable {
   TileGroupHeader() = delete;
@@ -59,15 +84,19 @@ class TileGroupHeader : public Printable {
     // check for self-assignment
     if (&other == this) return *this;
 
-    header_size = other.header_size;
+    PL_ASSERT(num_tuple_slots == other.num_tuple_slots);
 
-    // copy over all the data
-    PL_MEMCPY(data, other.data, header_size);
+    // copy over all the data, the arrays may start at another offset of
+    // the allocation
+    PL_MEMCPY(txn_id_data, other.txn_id_data,
+              GetArraysSize(num_tuple_slots));
 
-    num_tuple_slots = other.num_tuple_slots;
     oid_t val = other.next_tuple_slot;
     next_tuple_slot = val;
 
+    cid_t dirty_val = other.dirty_cid;
+    dirty_cid = dirty_val;
+
     return *this;
   }
 
@@ -85,6 +114,19 @@ class TileGroupHeader : public Printable {
     }
   }
 
+  // Claim up to count consecutive slots for a bulk insert, starting at
+  // first_slot. Returns the number of slots claimed, 0 once the tile group
+  // is full.
+  oid_t GetNextEmptyTupleSlots(const oid_t count, oid_t &first_slot) {
+    first_slot = next_tuple_slot.fetch_add(count, std::memory_order_relaxed);
+
+    if (first_slot >= num_tuple_slots) {
+      return 0;
+    } else {
+      return std::min(count, num_tuple_slots - first_slot);
+    }
+  }
+
   /**
    * Used by logging
    */
@@ -115,6 +157,11 @@ class TileGroupHeader : public Printable {
 
   oid_t GetActiveTupleCount();
 
+  // Whether every slot holds a committed version that is not deleted, so
+  // that nothing writes to the tile group. Also finds the newest begin
+  // commit id among the slots.
+  bool IsFrozen(cid_t &newest_begin_cid) const;
+
   //===--------------------------------------------------------------------===//
   // MVCC utilities
   //===--------------------------------------------------------------------===//
@@ -126,43 +173,43 @@ class TileGroupHeader : public Printable {
   // but the current transaction reads the txn_id.
   // the returned value seems to be uncertain.
   inline txn_id_t GetTransactionId(const oid_t &tuple_slot_id) const {
-    // txn_id_t *txn_id_ptr = (txn_id_t *)(TUPLE_HEADER_LOCATION);
+    // txn_id_t *txn_id_ptr = (txn_id_t *)(TXN_ID_LOCATION);
     // return __atomic_load_n(txn_id_ptr, __ATOMIC_RELAXED);
-    return *((txn_id_t *)(TUPLE_HEADER_LOCATION));
+    return *((txn_id_t *)(TXN_ID_LOCATION));
   }
 
   inline cid_t GetBeginCommitId(const oid_t &tuple_slot_id) const {
-    return *((cid_t *)(TUPLE_HEADER_LOCATION + begin_cid_offset));
+    return *((cid_t *)(BEGIN_CID_LOCATION));
   }
 
   inline cid_t GetEndCommitId(const oid_t &tuple_slot_id) const {
-    return *((cid_t *)(TUPLE_HEADER_LOCATION + end_cid_offset));
+    return *((cid_t *)(END_CID_LOCATION));
   }
 
   inline ItemPointer GetNextItemPointer(const oid_t &tuple_slot_id) const {
-    return *((ItemPointer *)(TUPLE_HEADER_LOCATION + next_pointer_offset));
+    return *((ItemPointer *)(NEXT_POINTER_LOCATION));
   }
 
   inline ItemPointer GetPrevItemPointer(const oid_t &tuple_slot_id) const {
-    return *((ItemPointer *)(TUPLE_HEADER_LOCATION + prev_pointer_offset));
+    return *((ItemPointer *)(PREV_POINTER_LOCATION));
   }
 
   // constraint: at most 24 bytes.
   inline char *GetReservedFieldRef(const oid_t &tuple_slot_id) const {
-    return (char *)(TUPLE_HEADER_LOCATION + reserved_field_offset);
+    return (char *)(RESERVED_FIELD_LOCATION);
   }
 
   inline bool GetInsertCommit(const oid_t &tuple_slot_id) const {
-    return *((bool *)(TUPLE_HEADER_LOCATION + insert_commit_offset));
+    return *((bool *)(COMMIT_FLAGS_LOCATION + insert_commit_offset));
   }
 
   inline bool GetDeleteCommit(const oid_t &tuple_slot_id) const {
-    return *((bool *)(TUPLE_HEADER_LOCATION + delete_commit_offset));
+    return *((bool *)(COMMIT_FLAGS_LOCATION + delete_commit_offset));
   }
 
   // used only by occ_rb_txn_manager
   inline char *GetPrevItempointerField(const oid_t &tuple_slot_id) const {
-    return (char *)(TUPLE_HEADER_LOCATION + prev_pointer_offset);
+    return (char *)(PREV_POINTER_LOCATION);
   }
 
   // Setters
@@ -172,60 +219,72 @@ class TileGroupHeader : public Printable {
   }
   inline void SetTransactionId(const oid_t &tuple_slot_id,
                                const txn_id_t &transaction_id) {
-    *((txn_id_t *)(TUPLE_HEADER_LOCATION)) = transaction_id;
+    *((txn_id_t *)(TXN_ID_LOCATION)) = transaction_id;
   }
 
   inline void SetBeginCommitId(const oid_t &tuple_slot_id,
                                const cid_t &begin_cid) {
-    *((cid_t *)(TUPLE_HEADER_LOCATION + begin_cid_offset)) = begin_cid;
+    *((cid_t *)(BEGIN_CID_LOCATION)) = begin_cid;
   }
 
   inline void SetEndCommitId(const oid_t &tuple_slot_id,
                              const cid_t &end_cid) const {
-    *((cid_t *)(TUPLE_HEADER_LOCATION + end_cid_offset)) = end_cid;
+    *((cid_t *)(END_CID_LOCATION)) = end_cid;
   }
 
   inline void SetNextItemPointer(const oid_t &tuple_slot_id,
                                  const ItemPointer &item) const {
-    *((ItemPointer *)(TUPLE_HEADER_LOCATION + next_pointer_offset)) = item;
+    *((ItemPointer *)(NEXT_POINTER_LOCATION)) = item;
   }
 
   inline void SetPrevItemPointer(const oid_t &tuple_slot_id,
                                  const ItemPointer &item) const {
-    *((ItemPointer *)(TUPLE_HEADER_LOCATION + prev_pointer_offset)) = item;
+    *((ItemPointer *)(PREV_POINTER_LOCATION)) = item;
   }
 
   inline void SetInsertCommit(const oid_t &tuple_slot_id,
                               const bool commit) const {
-    *((bool *)(TUPLE_HEADER_LOCATION + insert_commit_offset)) = commit;
+    *((bool *)(COMMIT_FLAGS_LOCATION + insert_commit_offset)) = commit;
   }
 
   inline void SetDeleteCommit(const oid_t &tuple_slot_id,
                               const bool commit) const {
-    *((bool *)(TUPLE_HEADER_LOCATION + delete_commit_offset)) = commit;
+    *((bool *)(COMMIT_FLAGS_LOCATION + delete_commit_offset)) = commit;
   }
 
   // Getters for addresses
   inline txn_id_t *GetTransactionIdLocation(const oid_t &tuple_slot_id) const {
-    return ((txn_id_t *)(TUPLE_HEADER_LOCATION));
+    return ((txn_id_t *)(TXN_ID_LOCATION));
   }
 
   inline txn_id_t SetAtomicTransactionId(const oid_t &tuple_slot_id,
                                          const txn_id_t &old_txn_id,
                                          const txn_id_t &new_txn_id) const {
-    txn_id_t *txn_id_ptr = (txn_id_t *)(TUPLE_HEADER_LOCATION);
+    txn_id_t *txn_id_ptr = (txn_id_t *)(TXN_ID_LOCATION);
     return __sync_val_compare_and_swap(txn_id_ptr, old_txn_id, new_txn_id);
   }
 
   inline bool SetAtomicTransactionId(const oid_t &tuple_slot_id,
                                      const txn_id_t &transaction_id) const {
-    txn_id_t *txn_id_ptr = (txn_id_t *)(TUPLE_HEADER_LOCATION);
+    txn_id_t *txn_id_ptr = (txn_id_t *)(TXN_ID_LOCATION);
     return __sync_bool_compare_and_swap(txn_id_ptr, INITIAL_TXN_ID,
                                         transaction_id);
   }
 
   void PrintVisibility(txn_id_t txn_id, cid_t at_cid);
 
+  // Record that a transaction committing at the given cid modified this
+  // tile group. Used by incremental checkpoints to skip clean tile groups.
+  inline void SetDirtyCommitId(const cid_t &commit_id) {
+    cid_t current_cid = dirty_cid.load(std::memory_order_relaxed);
+    while (current_cid < commit_id &&
+           !dirty_cid.compare_exchange_weak(current_cid, commit_id)) {
+    }
+  }
+
+  // Latest commit id that modified this tile group
+  inline cid_t GetDirtyCommitId() const { return dirty_cid.load(); }
+
   // Getter for spin lock
 
   Spinlock &GetHeaderLock() { return tile_header_lock; }
@@ -233,6 +292,11 @@ class TileGroupHeader : public Printable {
   // Sync the contents
   void Sync();
 
+  // Add the ranges that hold the headers of slots [begin_slot, end_slot),
+  // one per array
+  void GetSyncRanges(oid_t begin_slot, oid_t end_slot,
+                     std::vector<SyncRange> &ranges) const;
+
   //===--------------------------------------------------------------------===//
   // Utilities
   //===--------------------------------------------------------------------===//
@@ -241,35 +305,24 @@ class TileGroupHeader : public Printable {
   const std::string GetInfo() const;
 
   static inline size_t GetReservedSize() { return reserverd_size; }
-  // *
-  // -----------------------------------------------------------------------------
-  // *  | TxnID (8 bytes)  | BeginTimeStamp (8 bytes) | EndTimeStamp (8 bytes) |
-  // *  | NextItemPointer (8 bytes) | PrevItemPointer (8 bytes) |
-  // ReservedField (24 bytes)
-  // *  | InsertCommit (1 byte) | DeleteCommit (1 byte)
-  // *
-  // -----------------------------------------------------------------------------
-
-  // header entry size is the size of the layout described above
+
+  // Bytes taken by the arrays of a header with this many slots
+  static size_t GetArraysSize(const oid_t &tuple_count);
+
   static const size_t reserverd_size = 24;
-  // FIXME: there is no space reserved for index count?
-  static const size_t header_entry_size = sizeof(txn_id_t) + 2 * sizeof(cid_t) +
-                                          2 * sizeof(ItemPointer) +
-                                          reserverd_size + 2 * sizeof(bool);
-  static const size_t txn_id_offset = 0;
-  static const size_t begin_cid_offset = sizeof(txn_id_t);
-  static const size_t end_cid_offset = begin_cid_offset + sizeof(cid_t);
-  static const size_t next_pointer_offset = end_cid_offset + sizeof(cid_t);
-  static const size_t prev_pointer_offset =
-      next_pointer_offset + sizeof(ItemPointer);
-  static const size_t reserved_field_offset =
-      prev_pointer_offset + sizeof(ItemPointer);
-  static const size_t insert_commit_offset =
-      reserved_field_offset + reserverd_size;
-  static const size_t delete_commit_offset =
-      insert_commit_offset + sizeof(bool);
+  static const size_t commit_flags_size = 2 * sizeof(bool);
+  static const size_t insert_commit_offset = 0;
+  static const size_t delete_commit_offset = sizeof(bool);
+
+  // header entry size is the size of a slot across all the arrays
+  static const size_t header_entry_size =
+      sizeof(txn_id_t) + 2 * sizeof(cid_t) + 2 * sizeof(ItemPointer) +
+      commit_flags_size + reserverd_size;
 
  private:
+  // Point the arrays into the allocation
+  void SetArrayLocations();
+
   //===--------------------------------------------------------------------===//
   // Data members
   //===--------------------------------------------------------------------===//
@@ -282,9 +335,24 @@ class TileGroupHeader : public Printable {
 
   size_t header_size;
 
-  // set of fixed-length tuple slots
+  // allocation that holds the arrays, with room to align them
   char *data;
 
+  // start of each array, on a cache line
+  char *txn_id_data;
+
+  char *begin_cid_data;
+
+  char *end_cid_data;
+
+  char *next_pointer_data;
+
+  char *prev_pointer_data;
+
+  char *commit_flags_data;
+
+  char *reserved_field_data;
+
   // number of tuple slots allocated
   oid_t num_tuple_slots;
 
@@ -293,6 +361,9 @@ class TileGroupHeader : public Printable {
   // IT MAY OUT OF BOUNDARY! ALWAYS CHECK IF IT EXCEEDS num_tuple_slots
   std::atomic<oid_t> next_tuple_slot;
 
+  // latest commit id that modified any tuple in this tile group
+  std::atomic<cid_t> dirty_cid;
+
   Spinlock tile_header_lock;
 };
 
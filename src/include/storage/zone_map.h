@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// zone_map.h
+//
+// Identification: src/include/storage/zone_map.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <vector>
+
+#include "common/platform.h"
+#include "common/types.h"
+#include "common/value.h"
+
+namespace peloton {
+
+namespace executor {
+class ExecutorContext;
+}
+
+namespace expression {
+class AbstractExpression;
+}
+
+namespace storage {
+
+//===--------------------------------------------------------------------===//
+// Zone Map
+//===--------------------------------------------------------------------===//
+
+/*
+ * ZoneMap - Smallest and largest value of every column of a tile group,
+ * 	along with how many of the values written were null. The ranges only
+ * 	ever widen: deleted and overwritten values stay covered, so a zone map
+ * 	may admit tuples that are gone but never rules out one that is there.
+ * 	Only numeric and timestamp columns are tracked, the others always
+ * 	match and count no nulls. Writes are folded into a batch straight
+ * 	from the tile storage, and the batch is merged under the lock at once.
+ */
+class ZoneMap {
+ public:
+  ZoneMap(const ZoneMap &) = delete;
+  ZoneMap &operator=(const ZoneMap &) = delete;
+
+  // Columns are in table order
+  ZoneMap(const std::vector<ValueType> &column_types);
+
+  class Batch;
+
+  // Widen the ranges with a batch of tuple_count tuples
+  void Merge(const Batch &batch, const oid_t &tuple_count);
+
+  // Forget every value, before the zone map is built again
+  void Reset();
+
+  // Whether a tuple in the tile group could satisfy the predicate. Only
+  // conjunctions of comparisons between a column and a constant or a
+  // parameter are checked, anything else could match.
+  bool CouldMatch(const expression::AbstractExpression *predicate,
+                  executor::ExecutorContext *executor_context) const;
+
+  //===--------------------------------------------------------------------===//
+  // Accessors
+  //===--------------------------------------------------------------------===//
+
+  bool IsTracked(const oid_t &column_id) const;
+
+  // Whether a non-null value was written to the column
+  bool HasRange(const oid_t &column_id) const;
+
+  Value GetMin(const oid_t &column_id) const;
+
+  Value GetMax(const oid_t &column_id) const;
+
+  oid_t GetNullCount(const oid_t &column_id) const;
+
+  oid_t GetTupleCount() const;
+
+ private:
+  struct ColumnRange {
+    ValueType column_type;
+    bool is_tracked;
+    bool has_range;
+    Value min;
+    Value max;
+    oid_t null_count;
+  };
+
+  bool CouldMatchComparison(
+      const expression::AbstractExpression *comparison,
+      executor::ExecutorContext *executor_context) const;
+
+  // per column ranges
+  std::vector<ColumnRange> columns_;
+
+  // values written per column
+  oid_t tuple_count_;
+
+  // protects the ranges
+  mutable Spinlock zone_map_lock_;
+};
+
+/*
+ * Ranges of the tracked columns over a batch of writes, built without the
+ * 	lock of the zone map.
+ */
+class ZoneMap::Batch {
+ public:
+  Batch(const ZoneMap &zone_map);
+
+  // Fold value_count inlined values of a tracked column, the first one is
+  // at location and the next ones are stride bytes apart
+  void Fold(const oid_t &column_id, const char *location, const size_t &stride,
+            const oid_t &value_count);
+
+ private:
+  friend class ZoneMap;
+
+  std::vector<ColumnRange> columns_;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// admission_control.h
+//
+// Identification: src/include/tcop/admission_control.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include <gflags/gflags.h>
+
+DECLARE_uint64(max_active_queries);
+DECLARE_uint64(max_analytic_queries);
+DECLARE_uint64(admission_timeout_ms);
+
+// Sequential scans of tables up to this size still count as short queries
+#define ADMISSION_SHORT_SCAN_TUPLES (1 << 16)
+
+namespace peloton {
+
+namespace planner {
+class AbstractPlan;
+}
+
+namespace tcop {
+
+//===--------------------------------------------------------------------===//
+// Admission Control
+//===--------------------------------------------------------------------===//
+
+enum QueryClass {
+  QUERY_CLASS_OLTP = 0,      // short queries and updates, admitted first
+  QUERY_CLASS_ANALYTIC = 1,  // scans of large tables, joins, aggregates
+  QUERY_CLASS_COUNT = 2
+};
+
+struct AdmissionStats {
+  // per query class
+  uint64_t admitted_count[QUERY_CLASS_COUNT] = {0, 0};
+
+  // admitted only after waiting in the queue
+  uint64_t queued_count[QUERY_CLASS_COUNT] = {0, 0};
+
+  // gave up waiting
+  uint64_t timeout_count[QUERY_CLASS_COUNT] = {0, 0};
+
+  // time spent in the queue by the queued queries
+  uint64_t wait_usec[QUERY_CLASS_COUNT] = {0, 0};
+
+  size_t active_count = 0;
+  size_t waiting_count = 0;
+};
+
+/*
+ * AdmissionControl - Bounds the number of plans that execute at the same
+ * time, so that past saturation the executing queries keep their throughput
+ * instead of thrashing each other into aborts. Queries beyond the bound wait
+ * in a FIFO queue per class, and a finishing query hands its slot over to
+ * the first waiting OLTP query, or else to the first waiting analytic one as
+ * long as the analytic queries stay below their own bound. A query that
+ * waits longer than the timeout is turned away.
+ */
+class AdmissionControl {
+ public:
+  AdmissionControl(const AdmissionControl &) = delete;
+  AdmissionControl &operator=(const AdmissionControl &) = delete;
+
+  // A capacity of 0 admits everything
+  AdmissionControl(size_t capacity, size_t analytic_capacity,
+                   uint64_t timeout_ms);
+
+  // global singleton, sized by the max_active_queries and
+  // max_analytic_queries flags
+  static AdmissionControl &GetInstance();
+
+  // Class of a plan, by the work its tree implies
+  static QueryClass Classify(const planner::AbstractPlan *plan);
+
+  // Wait for a slot. Returns false if none was free within the timeout.
+  bool Admit(QueryClass query_class);
+
+  // Give the slot of an admitted query back
+  void Release(QueryClass query_class);
+
+  AdmissionStats GetStats() const;
+
+ private:
+  struct Waiter {
+    std::condition_variable cv;
+    bool admitted = false;
+  };
+
+  // Whether a query of the class may take a free slot now
+  bool HasSlot(QueryClass query_class) const;
+
+  // Hand the free slots to the waiting queries, by priority
+  void Dispatch();
+
+  void Activate(QueryClass query_class);
+
+  size_t capacity_;
+
+  size_t analytic_capacity_;
+
+  uint64_t timeout_ms_;
+
+  mutable std::mutex mutex_;
+
+  size_t active_count_[QUERY_CLASS_COUNT] = {0, 0};
+
+  std::list<Waiter *> queues_[QUERY_CLASS_COUNT];
+
+  AdmissionStats stats_;
+};
+
+/*
+ * AdmissionGuard - Holds the slot of a query for its scope, so that it is
+ * 	given back on every way out. A query that blocks on something outside
+ * 	the engine, like a client that does not read its result, suspends the
+ * 	guard of the query running on its thread to let others execute.
+ */
+class AdmissionGuard {
+ public:
+  AdmissionGuard(const AdmissionGuard &) = delete;
+  AdmissionGuard &operator=(const AdmissionGuard &) = delete;
+
+  // Waits for a slot, see IsAdmitted
+  AdmissionGuard(AdmissionControl &admission_control, QueryClass query_class);
+
+  ~AdmissionGuard();
+
+  bool IsAdmitted() const { return admitted_; }
+
+  // Give the slot back for a while
+  void Suspend();
+
+  // Take a slot again, returns false if none was free within the timeout
+  bool Resume();
+
+  // Guard of the query executing on this thread, if any
+  static AdmissionGuard *GetCurrent();
+
+ private:
+  AdmissionControl &admission_control_;
+
+  QueryClass query_class_;
+
+  bool admitted_;
+
+  // guard this one hides on the thread
+  AdmissionGuard *previous_;
+};
+
+}  // End tcop namespace
+}  // End peloton namespace
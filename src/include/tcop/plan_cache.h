@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache.h
+//
+// Identification: src/include/tcop/plan_cache.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <gflags/gflags.h>
+
+#include "common/types.h"
+
+DECLARE_uint64(plan_cache_size);
+
+// number of independently locked parts of the plan cache
+#define PLAN_CACHE_SHARD_COUNT 16
+
+namespace peloton {
+
+namespace planner {
+class AbstractPlan;
+}
+
+namespace tcop {
+
+//===--------------------------------------------------------------------===//
+// Plan Cache
+//===--------------------------------------------------------------------===//
+
+struct PlanCacheStats {
+  uint64_t hit_count = 0;
+  uint64_t miss_count = 0;
+
+  // plans dropped because the catalog changed since they were built
+  uint64_t invalidation_count = 0;
+
+  // plans dropped to stay within the capacity
+  uint64_t eviction_count = 0;
+
+  size_t entry_count = 0;
+};
+
+/*
+ * PlanCache - Process wide cache of query plans, shared by all sessions and
+ * keyed by the fingerprint of the query text. It is split into shards, each
+ * an LRU list under a lock of its own. Every plan remembers the catalog
+ * version it was built against, and is dropped on lookup once DDL moved the
+ * version on.
+ */
+class PlanCache {
+ public:
+  PlanCache(const PlanCache &) = delete;
+  PlanCache &operator=(const PlanCache &) = delete;
+
+  // A capacity of 0 disables the cache
+  explicit PlanCache(size_t capacity);
+
+  // global singleton, sized by the plan_cache_size flag
+  static PlanCache &GetInstance();
+
+  // Normalize the query text: comments are dropped, runs of whitespace
+  // become one space, and everything but literals and quoted identifiers
+  // is lower cased
+  static std::string GetFingerprint(const std::string &query_string);
+
+  // Cached plan of the fingerprint, nullptr on a miss
+  std::shared_ptr<planner::AbstractPlan> Find(const std::string &fingerprint);
+
+  // Cache a plan built against the given catalog version. Plans of DDL
+  // statements are not kept.
+  void Insert(const std::string &fingerprint,
+              std::shared_ptr<planner::AbstractPlan> plan,
+              uint64_t catalog_version);
+
+  void Clear();
+
+  PlanCacheStats GetStats() const;
+
+ private:
+  typedef std::list<std::string> KeyList;
+
+  struct Entry {
+    std::shared_ptr<planner::AbstractPlan> plan;
+    uint64_t catalog_version;
+
+    // position in the LRU list of the shard
+    KeyList::iterator lru_itr;
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+
+    // most recently used first
+    KeyList lru_list;
+
+    std::unordered_map<std::string, Entry> entries;
+  };
+
+  Shard &GetShard(const std::string &fingerprint);
+
+  size_t shard_capacity_;
+
+  Shard shards_[PLAN_CACHE_SHARD_COUNT];
+
+  std::atomic<uint64_t> hit_count_;
+  std::atomic<uint64_t> miss_count_;
+  std::atomic<uint64_t> invalidation_count_;
+  std::atomic<uint64_t> eviction_count_;
+};
+
+}  // End tcop namespace
+}  // End peloton namespace
@@ -23,6 +23,15 @@
 #include "common/types.h"
 
 namespace peloton {
+
+namespace executor {
+class LogicalTile;
+}
+
+namespace bridge {
+class ResultSink;
+}
+
 namespace tcop {
 
 //===--------------------------------------------------------------------===//
@@ -41,25 +50,34 @@ class TrafficCop {
   TrafficCop();
   ~TrafficCop();
 
-  // PortalExec - Execute query string
-  Result ExecuteStatement(const std::string& query,
-                          std::vector<ResultType> &result,
-                          std::vector<FieldInfoType> &tuple_descriptor,
-                          int &rows_changed,
-                          std::string &error_message);
-
-  // ExecPrepStmt - Execute a statement from a prepared and bound statement
-  Result ExecuteStatement(const std::shared_ptr<Statement>& statement,
-                          const bool unnamed,
-                          std::vector<ResultType> &result,
-                          int &rows_change,
-                          std::string &error_message);
+  // PortalExec - Execute query string, the output is pushed into the sink
+  // as it is produced
+  Result ExecuteStatement(
+      const std::string& query,
+      bridge::ResultSink &sink,
+      int &rows_changed,
+      std::string &error_message);
+
+  // ExecPrepStmt - Execute a bound portal, or resume it if it was suspended.
+  // The output is pushed into the sink as it is produced. Once the sink is
+  // full the portal is suspended, the next call continues where this one
+  // stopped.
+  Result ExecuteStatement(
+      const std::shared_ptr<Portal>& portal,
+      bridge::ResultSink &sink,
+      bool &suspended,
+      int &rows_change,
+      std::string &error_message);
 
   // InitBindPrepStmt - Prepare and bind a query from a query string
   std::shared_ptr<Statement> PrepareStatement(const std::string& statement_name,
                                               const std::string& query_string,
                                               std::string &error_message);
 
+  // Describe the columns of a result tile
+  static std::vector<FieldInfoType> GenerateTupleDescriptor(
+      executor::LogicalTile *tile);
+
   int BindParameters(std::vector<std::pair<int, std::string>> &parameters,
                      Statement **stmt,
                      std::string &error_message);
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy.h
+//
+// Identification: src/include/wire/copy.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/types.h"
+#include "executor/plan_executor.h"
+#include "wire/wire.h"
+
+DECLARE_uint64(copy_threads);
+
+// Amount of COPY data parsed and loaded at once
+#define COPY_BATCH_SIZE (4 << 20)
+
+namespace peloton {
+
+namespace concurrency {
+class Transaction;
+}
+
+namespace parser {
+class CopyParse;
+}
+
+namespace storage {
+class DataTable;
+class Tuple;
+}
+
+class VarlenPool;
+
+namespace wire {
+
+//===--------------------------------------------------------------------===//
+// Copy Options
+//===--------------------------------------------------------------------===//
+
+enum CopyFormat {
+  COPY_FORMAT_TEXT = 0,
+  COPY_FORMAT_CSV = 1,
+  COPY_FORMAT_BINARY = 2
+};
+
+struct CopyOptions {
+  CopyFormat format = COPY_FORMAT_TEXT;
+
+  char delimiter = '\t';
+
+  std::string null_string = "\\N";
+
+  // the first row only names the columns
+  bool header = false;
+
+  // CSV only
+  char quote = '"';
+  char escape = '"';
+
+  // Options of the statement, with the defaults of its format. Returns
+  // false if they do not make sense.
+  static bool FromParse(const parser::CopyParse &copy_parse,
+                        CopyOptions &options, std::string &error_message);
+};
+
+//===--------------------------------------------------------------------===//
+// Copy Loader
+//===--------------------------------------------------------------------===//
+
+/*
+ * CopyLoader - Loads the data of COPY FROM STDIN into a table. The CopyData
+ * 	messages are buffered until a batch is full. The batch is cut at the
+ * 	last complete row and split into chunks of rows that are turned into
+ * 	tuples in parallel, then the whole batch goes into the table at once
+ * 	(see DataTable::InsertTuples). The load runs in one transaction, which
+ * 	is parked between messages as they may arrive on different threads.
+ */
+class CopyLoader {
+ public:
+  CopyLoader(const CopyLoader &) = delete;
+  CopyLoader &operator=(const CopyLoader &) = delete;
+
+  // column_ids are the table columns in the order of the data, the other
+  // columns are set to NULL
+  CopyLoader(storage::DataTable *table, const std::vector<oid_t> &column_ids,
+             const CopyOptions &options);
+
+  // Aborts a load that never finished
+  ~CopyLoader();
+
+  // Take the payload of a CopyData message. Returns false on malformed data
+  // or a failed insert, the load is then aborted.
+  bool Append(const uchar *data, size_t len);
+
+  // End of the data: load the rest and commit
+  bool Finish();
+
+  // CopyFail, or the client went away
+  void Abort();
+
+  size_t GetRowCount() const { return row_count_; }
+
+  const std::string &GetErrorMessage() const { return error_message_; }
+
+ private:
+  // Load the complete rows in the buffer, all of it at the end of the data
+  bool LoadBatch(bool last);
+
+  // Find the end of the last complete row in the buffer, and the ends of
+  // chunks of about chunk_size bytes on the way
+  size_t SplitRows(size_t chunk_size, bool last,
+                   std::vector<size_t> &chunk_ends);
+
+  // Turn the rows between begin and end into tuples
+  bool ParseChunk(size_t begin, size_t end,
+                  std::vector<std::unique_ptr<storage::Tuple>> &tuples,
+                  VarlenPool *pool, std::string &error_message);
+
+  bool ParseTextRow(const char *row, size_t len, storage::Tuple *tuple,
+                    VarlenPool *pool, std::string &error_message);
+
+  bool ParseBinaryRow(const uchar *row, size_t len, storage::Tuple *tuple,
+                      VarlenPool *pool, std::string &error_message);
+
+  // Make the transaction of the load the current one, or park it again
+  void EnterTransaction();
+  void LeaveTransaction();
+
+  // Commit or abort our own transaction
+  bool EndTransaction(bool commit);
+
+  storage::DataTable *table_;
+
+  std::vector<oid_t> column_ids_;
+
+  // postgres type of each data column
+  std::vector<int32_t> column_types_;
+
+  CopyOptions options_;
+
+  // data not loaded yet
+  std::string buffer_;
+
+  concurrency::Transaction *txn_ = nullptr;
+
+  // whether the load began (and so owns) its transaction
+  bool single_statement_txn_ = false;
+
+  concurrency::Transaction *previous_txn_ = nullptr;
+
+  bool header_done_ = false;
+
+  // "\." or the binary trailer was seen
+  bool end_of_data_ = false;
+
+  bool finished_ = false;
+
+  size_t row_count_ = 0;
+
+  std::string error_message_;
+};
+
+//===--------------------------------------------------------------------===//
+// Copy Out Sink
+//===--------------------------------------------------------------------===//
+
+/*
+ * CopyOutSink - Encodes the output tiles of a scan into CopyData messages
+ * 	for COPY TO STDOUT, one per row in the chosen format, and flushes them
+ * 	to the client per tile.
+ */
+class CopyOutSink : public bridge::ResultSink {
+ public:
+  CopyOutSink(PacketManager &packet_manager, ResponseBuffer &responses,
+              const CopyOptions &options);
+
+  bool Consume(std::unique_ptr<executor::LogicalTile> &tile) override;
+
+  // the binary format has a header and a trailer around the rows
+  void PutHeader();
+  void PutTrailer();
+
+  size_t GetRowCount() const { return row_count_; }
+
+ private:
+  // Append the text of a value to the row, escaped or quoted as needed
+  void PutText(PktBuf &buf, const Value &value);
+
+  PacketManager &packet_manager_;
+
+  ResponseBuffer &responses_;
+
+  CopyOptions options_;
+
+  // text of the current value
+  PktBuf scratch_;
+
+  size_t row_count_ = 0;
+};
+
+}  // End wire namespace
+}  // End peloton namespace
@@ -19,6 +19,7 @@
 #include "wire/socket_base.h"
 #include "wire/wire.h"
 #include "common/logger.h"
+#include "common/value.h"
 
 namespace peloton {
 namespace wire {
@@ -47,6 +48,68 @@ extern void PacketPutCbytes(std::unique_ptr<Packet> &pkt, const uchar *b,
 extern void PacketPutBytes(std::unique_ptr<Packet> &pkt,
                            const std::vector<uchar> &data);
 
+/*
+ * DataRowEncoder - Writes complete DataRow ('D') messages back to back into
+ * 	one buffer. The row length is patched in when the row ends and fixed
+ * 	width attributes are formatted straight into the buffer, so encoding a
+ * 	result does no allocation per row or per attribute beyond the growth of
+ * 	the buffer itself. The buffer can be sent as a framed packet.
+ */
+class DataRowEncoder {
+ public:
+  /* row_type is the message type of the rows, e.g. 'd' for the binary
+   * rows of COPY which have the same layout */
+  DataRowEncoder(PktBuf &buf, uchar row_type = 'D')
+      : buf(buf), row_type(row_type), row_begin(0) {}
+
+  void BeginRow(int colcount);
+
+  void EndRow();
+
+  void PutNull();
+
+  /* put_text - attribute given as raw bytes, e.g. a varchar */
+  void PutText(const char *data, size_t len);
+
+  void PutInteger(int64_t value);
+
+  void PutDouble(double value, int precision);
+
+  void PutBoolean(bool value);
+
+  /* put_value - formats the value in the text format of its type */
+  void PutValue(const Value &value);
+
+  /* put_binary_value - formats the value in the binary format of the
+   * postgres type it is described as */
+  void PutBinaryValue(const Value &value);
+
+  /* put_value - text (0) or binary (1) format code */
+  inline void PutValue(const Value &value, int16_t format) {
+    if (format == 0)
+      PutValue(value);
+    else
+      PutBinaryValue(value);
+  }
+
+ private:
+  // writes a 32-bit int in network byte order at the given offset
+  void SetInt(size_t offset, int32_t value);
+
+  // writes a "width" byte attribute holding bits in network byte order
+  void PutBinaryInt(uint64_t bits, size_t width);
+
+  // writes a decimal in the base 10000 binary format of numeric
+  void PutBinaryNumeric(const std::string &text);
+
+  PktBuf &buf;
+
+  uchar row_type;
+
+  // offset of the length field of the current row
+  size_t row_begin;
+};
+
 /*
  * Unmarshallers
  */
@@ -67,6 +130,22 @@ extern void PacketGetString(Packet *pkt, size_t len, std::string &result);
 /* packet_get_bytes - Parse out "len" bytes of pkt as raw bytes */
 extern void PacketGetBytes(Packet *pkt, size_t len, PktBuf &result);
 
+/*
+ * packet_get_value - parse a bind parameter of "len" bytes in the given
+ * 	format code into a value of the given postgres type. Unknown types (0)
+ * 	are taken as text. Strings are allocated in pool. Returns false for
+ * 	malformed input.
+ */
+extern bool PacketGetValue(Packet *pkt, size_t len, int16_t format,
+                           int32_t type, VarlenPool *pool, Value &value);
+
+/*
+ * get_value - same as packet_get_value, for "len" bytes at data, e.g. a
+ * 	field of a COPY row
+ */
+extern bool GetValue(const uchar *data, size_t len, int16_t format,
+                     int32_t type, VarlenPool *pool, Value &value);
+
 /*
  * get_string_token - used to extract a string token
  * 		from an unsigned char vector
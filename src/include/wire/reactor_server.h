@@ -0,0 +1,209 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// reactor_server.h
+//
+// Identification: src/include/wire/reactor_server.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "wire/socket_base.h"
+#include "wire/wire.h"
+
+DECLARE_uint64(reactor_threads);
+DECLARE_uint64(worker_threads);
+DECLARE_uint64(client_write_timeout_ms);
+
+namespace peloton {
+namespace wire {
+
+class Reactor;
+class ReactorServer;
+
+//===--------------------------------------------------------------------===//
+// Connection
+//===--------------------------------------------------------------------===//
+
+/*
+ * Connection - A non-blocking client socket and its protocol session.
+ * 	A connection is armed in the epoll set of exactly one reactor with
+ * 	EPOLLONESHOT, so at any time it is touched by at most one thread: either
+ * 	its reactor (reading or draining writes) or a worker (running queries).
+ */
+class Connection {
+ public:
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  Connection(int sock_fd, Reactor *reactor);
+
+  int GetSocketFd() const { return sock_fd_; }
+
+  Reactor *GetReactor() const { return reactor_; }
+
+  // Read everything the socket has, returns false on EOF or error
+  bool FillReadBuffer();
+
+  // Whether a complete packet is waiting in the read buffer
+  bool HasPacket() const;
+
+  // Run every buffered packet through the protocol, returns false when the
+  // session is over
+  bool ProcessPackets();
+
+  // Write as much of the write buffer as the socket takes, returns false on
+  // error
+  bool FlushWriteBuffer();
+
+  bool HasPendingWrites() const { return wbufs_.empty() == false; }
+
+  size_t GetPendingWriteBytes() const;
+
+  // Whether the responses are kept back because the client is still
+  // pipelining extended query messages and has not sent Sync yet
+  bool HoldsWrites() const;
+
+  // Whether the connection waits for the socket to take its responses
+  bool IsDraining() const {
+    return HasPendingWrites() && HoldsWrites() == false;
+  }
+
+  bool IsClosing() const { return closing_; }
+
+  void CloseSocket() { sock_.CloseSocket(); }
+
+ private:
+  // Cut the next complete packet out of the read buffer
+  bool ReadPacket(Packet *pkt);
+
+  // Frame the responses into the write buffer
+  void BufferPackets(ResponseBuffer &responses);
+
+  // Send responses while a query is running, waiting for the client when
+  // too much is unsent. Returns false to abort the query, e.g. once the
+  // client is gone.
+  bool StreamPackets(ResponseBuffer &responses);
+
+  // Wait until the client took enough of the write buffer. Returns false
+  // once the client is gone or did not read for client_write_timeout_ms.
+  bool WaitForClient();
+
+  int sock_fd_;
+
+  Reactor *reactor_;
+
+  SocketManager<PktBuf> sock_;
+
+  PacketManager packet_manager_;
+
+  // bytes received but not yet consumed, starting at rbuf_ptr_
+  PktBuf rbuf_;
+  size_t rbuf_ptr_ = 0;
+
+  // Segments framed but not yet sent, the first one starting at wbuf_ptr_.
+  // Framed packets (e.g. batches of data rows) become segments of their own
+  // instead of being copied, and all segments go out with one writev.
+  std::deque<PktBuf> wbufs_;
+  size_t wbuf_ptr_ = 0;
+
+  // the first packet of a session has no type byte
+  bool startup_done_ = false;
+
+  // set once the client terminated or the protocol failed
+  bool closing_ = false;
+};
+
+//===--------------------------------------------------------------------===//
+// Reactor
+//===--------------------------------------------------------------------===//
+
+/*
+ * Reactor - An epoll event loop that owns a share of the connections. It only
+ * 	does socket I/O and hands connections with complete packets over to the
+ * 	server's worker pool.
+ */
+class Reactor {
+ public:
+  Reactor(const Reactor &) = delete;
+  Reactor &operator=(const Reactor &) = delete;
+
+  Reactor(ReactorServer *server);
+
+  ~Reactor();
+
+  void Start();
+
+  // Start watching a freshly accepted connection
+  bool AddConnection(Connection *connection);
+
+  // Re-arm the connection for reads, or writes if some are still pending
+  void ArmConnection(Connection *connection);
+
+  // Hand a connection back from a worker once its packets are processed
+  void ResumeConnection(Connection *connection);
+
+  void CloseConnection(Connection *connection);
+
+ private:
+  void EventLoop();
+
+  void HandleEvent(Connection *connection, uint32_t events);
+
+  ReactorServer *server_;
+
+  int epoll_fd_;
+
+  std::thread thread_;
+};
+
+//===--------------------------------------------------------------------===//
+// Reactor Server
+//===--------------------------------------------------------------------===//
+
+/*
+ * ReactorServer - Accepts clients and spreads them round robin over the
+ * 	reactors. Queries run on a bounded pool of workers, so the thread count
+ * 	does not grow with the number of (mostly idle) connections.
+ */
+class ReactorServer {
+ public:
+  ReactorServer(const ReactorServer &) = delete;
+  ReactorServer &operator=(const ReactorServer &) = delete;
+
+  ReactorServer(Server *server);
+
+  // Server's accept loop, never returns
+  void HandleConnections();
+
+  // Run the packets of a connection on a worker
+  void ProcessConnection(Connection *connection);
+
+  void ConnectionClosed() { connection_count_--; }
+
+  size_t GetConnectionCount() const { return connection_count_; }
+
+ private:
+  Server *server_;
+
+  std::vector<std::unique_ptr<Reactor>> reactors_;
+
+  ThreadPool workers_;
+
+  std::atomic<size_t> connection_count_;
+};
+
+}  // End wire namespace
+}  // End peloton namespace
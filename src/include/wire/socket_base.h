@@ -23,6 +23,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <iostream>
@@ -31,7 +32,7 @@
 #include <gflags/gflags.h>
 
 #define SOCKET_BUFFER_SIZE 8192
-#define MAX_CONNECTIONS 64
+#define MAX_CONNECTIONS 8192
 #define DEFAULT_PORT 5432
 
 DECLARE_uint64(port);
@@ -101,64 +102,13 @@ class SocketManager {
   // Used to invoke a write into the Socket, once the write buffer is ready
   bool FlushWriteBuffer();
 
+  // Writes the buffered bytes and a batch of complete messages with one
+  // writev, without copying the batch into the write buffer
+  bool WriteFramedBytes(B &pkt_buf, size_t len);
+
   void CloseSocket();
 };
 
 extern void StartServer(Server *server);
-
-// Thread function created per client
-template <typename P, typename B>
-void ClientHandler(std::unique_ptr<int> clientfd);
-
-// Server's "accept loop"
-template <typename P, typename B>
-void HandleConnections(Server *server);
-
-/*
- * Functions defined here for template visibility
- *
- */
-
-/*
- * handle_connections - Server's accept loop. Takes the protocol's PacketManager
- * (P) and STL container type for the protocol's buffer (B)
- */
-
-template <typename P, typename B>
-void HandleConnections(Server *server) {
-  int connfd, clilen;
-  struct sockaddr_in cli_addr;
-  clilen = sizeof(cli_addr);
-
-  for (;;) {
-    // block and wait for incoming connection
-    connfd = accept(server->server_fd, (struct sockaddr *)&cli_addr,
-                    (socklen_t *)&clilen);
-    if (connfd < 0) {
-      LOG_ERROR("Server error: Connection not established");
-      exit(EXIT_FAILURE);
-    }
-
-    std::unique_ptr<int> clientfd(new int(connfd));
-
-    LOG_INFO("LAUNCHING NEW THREAD");
-    std::thread client_thread(ClientHandler<P, B>, std::move(clientfd));
-    client_thread.detach();
-  }
-}
-
-/*
- * client_handler - Thread function to handle a client.
- * 		Takes the protocol's PacketManager (P) and STL container
- * 		type for the protocol's buffer (B)
- */
-template <typename P, typename B>
-void ClientHandler(std::unique_ptr<int> clientfd) {
-  int fd = *clientfd;
-  LOG_INFO("Client fd: %d", fd);
-  SocketManager<B> sm(fd);
-  P p(&sm);
-  p.ManagePackets();
-}
 }
 }
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -20,7 +22,6 @@
 
 #include <boost/assign/list_of.hpp>
 
-#include "common/cache.h"
 #include "common/statement.h"
 #include "common/portal.h"
 #include "wire/socket_base.h"
@@ -56,6 +57,7 @@ struct Packet {
   size_t len;      // size of packet
   size_t ptr;      // PktBuf cursor
   uchar msg_type;  // header
+  bool framed;     // buf holds whole messages, headers included
 
   // reserve buf's size as maximum packet size
   inline Packet() { Reset(); }
@@ -65,15 +67,29 @@ struct Packet {
     buf.shrink_to_fit();
     buf.clear();
     len = ptr = msg_type = 0;
+    framed = false;
   }
 };
 
+// Hands responses over to the client, returns false once the client is gone
+typedef std::function<bool(ResponseBuffer&)> ResponseFlusher;
+
+class CopyLoader;
+
 class PacketManager {
   Client client;
 
   // Manage standalone queries
   std::shared_ptr<Statement> unnamed_statement;
 
+  // Named statements of this session. Their plans come from the plan cache
+  // that all sessions share, so this only maps names to statements.
+  std::unordered_map<std::string, std::shared_ptr<Statement>>
+      statement_cache_;
+
+  // Query portals of this session
+  std::unordered_map<std::string, std::shared_ptr<Portal>> portals_;
+
   // gloabl txn state
   uchar txn_state;
 
@@ -82,9 +98,31 @@ class PacketManager {
   std::string skipped_query_string_;
   std::string skipped_query_type_;
 
+  // set by an error in the extended protocol, the messages up to the next
+  // Sync are then ignored
+  bool skip_to_sync_ = false;
+
+  // whether the last message was part of an extended query batch that is
+  // not yet closed by Sync or Flush
+  bool batch_open_ = false;
+
   static const std::unordered_map<std::string, std::string>
       parameter_status_map;
 
+  // Sends responses while a query still runs, see SetResponseFlusher
+  ResponseFlusher flusher_;
+
+  // Statements of the current simple query that did not run yet, they wait
+  // while a COPY FROM STDIN takes its data
+  std::vector<std::string> pending_queries_;
+  size_t next_query_ = 0;
+
+  // Load of a COPY FROM STDIN in progress
+  std::unique_ptr<CopyLoader> copy_loader_;
+
+  // Encodes result tiles for this session
+  friend class DataRowSink;
+
   /* Note: The responses argument in every subsequent function
    * is used to batch all the generated packets ofr that unit */
 
@@ -93,16 +131,18 @@ class PacketManager {
       std::vector<std::pair<uchar, std::string>> error_status,
       ResponseBuffer& responses);
 
+  // Error of an extended query message, skips the rest of the batch
+  void SendExtendedErrorResponse(const std::string& error_message,
+                                 ResponseBuffer& responses);
+
   // Sends ready for query packet to the frontend
   void SendReadyForQuery(uchar txn_status, ResponseBuffer& responses);
 
-  // Sends the attribute headers required by SELECT queries
+  // Sends the attribute headers required by SELECT queries, the columns are
+  // described with the given result formats (all text by default)
   void PutTupleDescriptor(const std::vector<FieldInfoType>& tuple_descriptor,
-                          ResponseBuffer& responses);
-
-  // Send each row, one packet at a time, used by SELECT queries
-  void SendDataRows(std::vector<ResultType>& results, int colcount,
-                    int& rows_affected, ResponseBuffer& responses);
+                          ResponseBuffer& responses,
+                          const std::vector<int16_t>& formats = {});
 
   // Used to send a packet that indicates the completion of a query. Also has
   // txn state mgmt
@@ -128,6 +168,16 @@ class PacketManager {
   /* Execute a Simple query protocol message */
   void ExecQueryMessage(Packet* pkt, ResponseBuffer& responses);
 
+  /* Run the pending statements of a simple query, then ReadyForQuery */
+  void RunPendingQueries(ResponseBuffer& responses);
+
+  /* Start a COPY FROM STDIN or run a COPY TO STDOUT. Returns false if an
+   * error was sent. */
+  bool ExecCopyStatement(const std::string& query, ResponseBuffer& responses);
+
+  /* Process the CopyData, CopyDone and CopyFail messages of COPY FROM */
+  void ExecCopyMessage(Packet* pkt, ResponseBuffer& responses);
+
   /* Process the PARSE message of the extended query protocol */
   void ExecParseMessage(Packet* pkt, ResponseBuffer& responses);
 
@@ -144,16 +194,31 @@ class PacketManager {
   void CloseClient();
 
  public:
-  inline PacketManager(SocketManager<PktBuf>* sock)
-      : client(sock), txn_state(TXN_IDLE) {}
+  PacketManager(SocketManager<PktBuf>* sock);
+
+  // Aborts a COPY that never finished
+  ~PacketManager();
 
   /* Startup packet processing logic */
   bool ProcessStartupPacket(Packet* pkt, ResponseBuffer& responses);
 
+  /* Result rows are streamed to the client through the flusher while the
+   * query runs. Without one they are kept until the packet is processed. */
+  inline void SetResponseFlusher(ResponseFlusher flusher) {
+    flusher_ = std::move(flusher);
+  }
+
+  /* Send the responses gathered so far, if there is a flusher */
+  bool FlushResponses(ResponseBuffer& responses);
+
   /* Main switch case wrapper to process every packet apart from the startup
    * packet */
   bool ProcessPacket(Packet* pkt, ResponseBuffer& responses);
 
+  /* Whether the client is still sending a pipeline of extended query
+   * messages, so the responses can wait for the Sync */
+  inline bool IsBatchOpen() const { return batch_open_; }
+
   /* Protocol manager */
   void ManagePackets();
 
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <algorithm>
+
 #include "index/btree_index.h"
 #include "index/index_key.h"
 #include "common/logger.h"
@@ -66,6 +68,44 @@ bool BTreeIndex<KeyType, ValueType, KeyComparator,
   return true;
 }
 
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+bool BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    InsertEntries(const std::vector<const storage::Tuple *> &keys,
+                  const std::vector<ItemPointer> &locations) {
+  PL_ASSERT(keys.size() == locations.size());
+
+  std::vector<std::pair<KeyType, ValueType>> entries(keys.size());
+  for (size_t entry_itr = 0; entry_itr < keys.size(); entry_itr++) {
+    entries[entry_itr].first.SetFromKey(keys[entry_itr]);
+    entries[entry_itr].second = new ItemPointer(locations[entry_itr]);
+  }
+
+  // Sorted input keeps the leaves hot, and lets an empty tree be built
+  // bottom up. Equal keys stay in insertion order.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [this](const std::pair<KeyType, ValueType> &lhs,
+                          const std::pair<KeyType, ValueType> &rhs) {
+                     return comparator(lhs.first, rhs.first);
+                   });
+
+  {
+    index_lock.WriteLock();
+
+    if (container.empty()) {
+      container.bulk_load(entries.begin(), entries.end());
+    } else {
+      for (auto &entry : entries) {
+        container.insert(entry);
+      }
+    }
+
+    index_lock.Unlock();
+  }
+
+  return true;
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker>
 bool BTreeIndex<KeyType, ValueType, KeyComparator,
@@ -11,10 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <dirent.h>
+
 #include "common/pool.h"
 #include "logging/checkpoint.h"
 #include "logging/logging_util.h"
 #include "logging/checkpoint/simple_checkpoint.h"
+#include "logging/checkpoint/parallel_checkpoint.h"
 #include "logging/log_manager.h"
 #include "logging/checkpoint_manager.h"
 #include "logging/backend_logger.h"
@@ -97,12 +100,40 @@ void Checkpoint::InitDirectory() {
   }
 }
 
+void Checkpoint::InitVersionNumber() {
+  // Get checkpoint version
+  LOG_TRACE("Trying to read checkpoint directory");
+  struct dirent *file;
+  auto dirp = opendir(checkpoint_dir.c_str());
+  if (dirp == nullptr) {
+    LOG_TRACE("Opendir failed: Errno: %d, error: %s", errno, strerror(errno));
+    return;
+  }
+
+  while ((file = readdir(dirp)) != NULL) {
+    if (strncmp(file->d_name, FILE_PREFIX.c_str(), FILE_PREFIX.length()) == 0) {
+      // found a checkpoint file!
+      LOG_TRACE("Found a checkpoint file with name %s", file->d_name);
+      int version = LoggingUtil::ExtractNumberFromFileName(file->d_name);
+      if (version > checkpoint_version) {
+        checkpoint_version = version;
+      }
+    }
+  }
+  closedir(dirp);
+  LOG_TRACE("set checkpoint version to: %d", checkpoint_version);
+}
+
 std::unique_ptr<Checkpoint> Checkpoint::GetCheckpoint(
     CheckpointType checkpoint_type, bool disable_file_access) {
   if (checkpoint_type == CHECKPOINT_TYPE_NORMAL) {
     std::unique_ptr<Checkpoint> checkpoint(
         new SimpleCheckpoint(disable_file_access));
-    return std::move(checkpoint);
+    return checkpoint;
+  } else if (checkpoint_type == CHECKPOINT_TYPE_PARALLEL) {
+    std::unique_ptr<Checkpoint> checkpoint(
+        new ParallelCheckpoint(disable_file_access));
+    return checkpoint;
   }
   return std::move(std::unique_ptr<Checkpoint>(nullptr));
 }
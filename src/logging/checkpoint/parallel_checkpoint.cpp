@@ -0,0 +1,463 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parallel_checkpoint.cpp
+//
+// Identification: src/logging/checkpoint/parallel_checkpoint.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+
+#include "logging/checkpoint/parallel_checkpoint.h"
+#include "logging/checkpoint_tile_scanner.h"
+#include "logging/checkpoint_manager.h"
+#include "logging/log_manager.h"
+
+#include "catalog/manager.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "common/logger.h"
+#include "common/types.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_evictor.h"
+#include "storage/tile_group_header.h"
+#include "storage/tuple.h"
+
+namespace peloton {
+namespace logging {
+
+// [int32 frame length][byte frame type]
+static const size_t frame_header_size = sizeof(int32_t) + sizeof(int8_t);
+
+//===--------------------------------------------------------------------===//
+// Parallel Checkpoint
+//===--------------------------------------------------------------------===//
+
+ParallelCheckpoint::ParallelCheckpoint(bool disable_file_access)
+    : Checkpoint(disable_file_access) {
+  thread_count_ = std::max(std::thread::hardware_concurrency(), 1u);
+  InitDirectory();
+  InitVersionNumber();
+}
+
+ParallelCheckpoint::~ParallelCheckpoint() {}
+
+void ParallelCheckpoint::DoCheckpoint() {
+  auto &log_manager = LogManager::GetInstance();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  start_commit_id_ = log_manager.GetGlobalMaxFlushedCommitId();
+  if (start_commit_id_ == INVALID_CID) {
+    start_commit_id_ = txn_manager.GetMaxCommittedCid();
+  }
+
+  // A transaction that drew its commit id but is still installing its writes
+  // may not have marked its tile groups dirty yet. The checkpoint stays below
+  // it, so the log it keeps replays that transaction.
+  auto oldest_commit_id = txn_manager.GetOldestInFlightCommitId();
+  if (oldest_commit_id <= start_commit_id_) {
+    start_commit_id_ = oldest_commit_id - 1;
+  }
+
+  // A delta only makes sense on top of a checkpoint taken by this process,
+  // since the dirty commit ids are not persisted, and only if the protocol
+  // keeps them up to date
+  bool is_delta = most_recent_checkpoint_cid != INVALID_CID &&
+                  checkpoints_since_full_ + 1 < full_checkpoint_interval_ &&
+                  txn_manager.TracksDirtyTileGroups() == true;
+  cid_t base_commit_id = most_recent_checkpoint_cid;
+
+  LOG_TRACE("DoCheckpoint cid = %lu delta = %d", start_commit_id_, is_delta);
+
+  // Collect the tile groups to checkpoint
+  std::vector<std::shared_ptr<storage::TileGroup>> tile_groups;
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto database_count = catalog_manager.GetDatabaseCount();
+  for (oid_t database_idx = 0; database_idx < database_count; database_idx++) {
+    auto database = catalog_manager.GetDatabase(database_idx);
+    auto table_count = database->GetTableCount();
+
+    for (oid_t table_idx = 0; table_idx < table_count; table_idx++) {
+      storage::DataTable *target_table = database->GetTable(table_idx);
+      PL_ASSERT(target_table);
+      auto tile_group_count = target_table->GetTileGroupCount();
+
+      for (oid_t offset = 0; offset < tile_group_count; offset++) {
+        // Evicted tile groups are written from their copy in the eviction
+        // file, they are neither brought back nor counted as used
+        auto tile_group = target_table->PeekTileGroup(offset);
+        if (tile_group == nullptr) continue;
+        if (is_delta &&
+            tile_group->GetHeader()->GetDirtyCommitId() <= base_commit_id) {
+          continue;
+        }
+        tile_groups.push_back(tile_group);
+      }
+    }
+  }
+
+  // Create a new file for checkpoint
+  if (!disable_file_access) {
+    std::string file_name =
+        ConcatFileName(checkpoint_dir, ++checkpoint_version);
+    bool success =
+        LoggingUtil::InitFileHandle(file_name.c_str(), file_handle_, "wb");
+    if (!success) {
+      LOG_ERROR("Failed to create checkpoint file %s", file_name.c_str());
+      --checkpoint_version;
+      return;
+    }
+    LOG_TRACE("Created a new checkpoint file: %s", file_name.c_str());
+  }
+
+  CopySerializeOutput header;
+  header.WriteLong(start_commit_id_);
+  header.WriteByte(is_delta);
+  WriteFrame(CHECKPOINT_FRAME_TYPE_HEADER, header);
+
+  // Serialize the tile groups in parallel
+  std::atomic<size_t> next_tile_group(0);
+  std::atomic<size_t> written_count(0);
+  std::vector<std::thread> workers;
+  for (size_t thread_itr = 0; thread_itr < thread_count_; thread_itr++) {
+    workers.push_back(std::thread([&]() {
+      CopySerializeOutput output;
+      size_t tile_group_itr;
+      while ((tile_group_itr = next_tile_group.fetch_add(1)) <
+             tile_groups.size()) {
+        output.Reset();
+        if (SerializeTileGroup(tile_groups[tile_group_itr].get(), output,
+                               is_delta)) {
+          WriteFrame(CHECKPOINT_FRAME_TYPE_TILE_GROUP, output);
+          written_count++;
+        }
+      }
+    }));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  CopySerializeOutput footer;
+  footer.WriteLong(start_commit_id_);
+  WriteFrame(CHECKPOINT_FRAME_TYPE_FOOTER, footer);
+
+  if (!disable_file_access) {
+    LoggingUtil::FFlushFsync(file_handle_);
+    fclose(file_handle_.file);
+    file_handle_ = INVALID_FILE_HANDLE;
+
+    // A full checkpoint supersedes every older file
+    if (!is_delta) {
+      RemoveVersionsBefore(checkpoint_version);
+    }
+  }
+
+  checkpoints_since_full_ = is_delta ? checkpoints_since_full_ + 1 : 0;
+  checkpointed_tile_group_count_ = written_count;
+  last_checkpoint_delta_ = is_delta;
+
+  // Truncate logs
+  LogManager::GetInstance().TruncateLogs(start_commit_id_);
+  most_recent_checkpoint_cid = start_commit_id_;
+}
+
+bool ParallelCheckpoint::SerializeTileGroup(storage::TileGroup *tile_group,
+                                            CopySerializeOutput &output,
+                                            bool is_delta) {
+  auto tile_group_header = tile_group->GetHeader();
+  CheckpointTileScanner scanner;
+
+  // Find the tuples visible to this checkpoint
+  std::vector<oid_t> tuple_slots;
+  oid_t active_tuple_count = tile_group->GetNextTupleSlot();
+  for (oid_t tuple_id = 0; tuple_id < active_tuple_count; tuple_id++) {
+    if (scanner.IsVisible(tile_group_header, tuple_id, start_commit_id_)) {
+      tuple_slots.push_back(tuple_id);
+    }
+  }
+
+  // An empty tile group still has to be written in a delta so that
+  // recovery drops the older image
+  if (tuple_slots.empty() && !is_delta) {
+    return false;
+  }
+
+  output.WriteInt(tile_group->GetDatabaseId());
+  output.WriteInt(tile_group->GetTableId());
+  output.WriteInt(tile_group->GetTileGroupId());
+
+  // Layout
+  auto &column_map = tile_group->GetColumnMap();
+  output.WriteInt(column_map.size());
+  for (auto &entry : column_map) {
+    output.WriteInt(entry.first);
+    output.WriteInt(entry.second.first);
+    output.WriteInt(entry.second.second);
+  }
+
+  output.WriteInt(tuple_slots.size());
+  for (auto tuple_slot : tuple_slots) {
+    output.WriteInt(tuple_slot);
+  }
+
+  if (tuple_slots.empty()) {
+    return true;
+  }
+
+  // The header stays in memory, the tuples may only be in the file
+  if (tile_group->IsEvicted() == true &&
+      storage::TileGroupEvictor::GetInstance().SerializeEvictedTuples(
+          tile_group, tuple_slots, output) == true) {
+    return true;
+  }
+
+  // Tile at a time, only the visible tuples
+  auto tile_count = tile_group->GetTileCount();
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    // Decodes compressed tiles as it goes
+    auto tile = tile_group->GetTile(tile_itr);
+    if (!tile->SerializeTuplesTo(output, tuple_slots)) {
+      LOG_ERROR("Failed to serialize tile %u of tile group %u", tile_itr,
+                tile_group->GetTileGroupId());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ParallelCheckpoint::WriteFrame(CheckpointFrameType frame_type,
+                                    const CopySerializeOutput &body) {
+  if (disable_file_access) return;
+  PL_ASSERT(file_handle_.file);
+
+  CopySerializeOutput frame_header;
+  frame_header.WriteInt(body.Size());
+  frame_header.WriteByte(static_cast<int8_t>(frame_type));
+
+  std::lock_guard<std::mutex> lock(file_mutex_);
+  fwrite(frame_header.Data(), sizeof(char), frame_header.Size(),
+         file_handle_.file);
+  fwrite(body.Data(), sizeof(char), body.Size(), file_handle_.file);
+}
+
+void ParallelCheckpoint::RemoveVersionsBefore(int version) {
+  for (int version_itr = 0; version_itr < version; version_itr++) {
+    auto file_name = ConcatFileName(checkpoint_dir, version_itr);
+    if (remove(file_name.c_str()) != 0) {
+      LOG_TRACE("Failed to remove file %s", file_name.c_str());
+    }
+  }
+}
+
+cid_t ParallelCheckpoint::DoRecovery() {
+  // No checkpoint to recover from
+  if (checkpoint_version < 0) {
+    return 0;
+  }
+
+  // Find the latest complete full checkpoint
+  std::vector<char> buffer;
+  cid_t commit_id = 0;
+  bool is_delta = false;
+  int base_version = checkpoint_version;
+  for (; base_version >= 0; base_version--) {
+    if (LoadFile(base_version, buffer, commit_id, is_delta) && !is_delta) {
+      break;
+    }
+  }
+  if (base_version < 0) {
+    LOG_ERROR("No complete full checkpoint found");
+    return 0;
+  }
+
+  ApplyFile(buffer, commit_id);
+  cid_t recovered_cid = commit_id;
+
+  // Then replay the deltas on top of it, stopping at the first torn one
+  for (int version = base_version + 1; version <= checkpoint_version;
+       version++) {
+    if (!LoadFile(version, buffer, commit_id, is_delta) || !is_delta) {
+      break;
+    }
+    ApplyFile(buffer, commit_id);
+    recovered_cid = commit_id;
+  }
+
+  // Tuple counts and next oid follow the final image of each tile group
+  std::map<storage::DataTable *, size_t> table_tuple_counts;
+  oid_t max_oid = 0;
+  for (auto &entry : recovered_tile_groups_) {
+    table_tuple_counts[entry.second.first] += entry.second.second;
+    max_oid = std::max(max_oid, entry.first);
+  }
+  for (auto &entry : table_tuple_counts) {
+    entry.first->SetNumberOfTuples(entry.second);
+  }
+  recovered_tile_groups_.clear();
+
+  auto &manager = catalog::Manager::GetInstance();
+  if (max_oid > manager.GetNextOid()) {
+    manager.SetNextOid(max_oid);
+  }
+
+  concurrency::TransactionManagerFactory::GetInstance().SetNextCid(
+      recovered_cid);
+  CheckpointManager::GetInstance().SetRecoveredCid(recovered_cid);
+  return recovered_cid;
+}
+
+bool ParallelCheckpoint::LoadFile(int version, std::vector<char> &buffer,
+                                  cid_t &commit_id, bool &is_delta) {
+  std::string file_name = ConcatFileName(checkpoint_dir, version);
+  FileHandle file_handle;
+  if (!LoggingUtil::InitFileHandle(file_name.c_str(), file_handle, "rb")) {
+    return false;
+  }
+
+  auto size = LoggingUtil::GetLogFileSize(file_handle);
+  buffer.resize(size);
+  bool read_ok =
+      size > 0 && fread(buffer.data(), 1, size, file_handle.file) == size;
+  fclose(file_handle.file);
+  if (!read_ok) {
+    return false;
+  }
+
+  // Walk the frames, the file is complete only if it ends with a footer
+  size_t offset = 0;
+  bool has_header = false;
+  while (offset + frame_header_size <= size) {
+    ReferenceSerializeInputBE frame_input(buffer.data() + offset,
+                                          frame_header_size);
+    size_t length = frame_input.ReadInt();
+    auto frame_type = static_cast<CheckpointFrameType>(frame_input.ReadByte());
+    offset += frame_header_size;
+    if (offset + length > size) break;
+
+    if (frame_type == CHECKPOINT_FRAME_TYPE_HEADER) {
+      ReferenceSerializeInputBE input(buffer.data() + offset, length);
+      commit_id = input.ReadLong();
+      is_delta = input.ReadByte();
+      has_header = true;
+    } else if (frame_type == CHECKPOINT_FRAME_TYPE_FOOTER) {
+      return has_header && offset + length == size;
+    } else if (frame_type != CHECKPOINT_FRAME_TYPE_TILE_GROUP) {
+      break;
+    }
+    offset += length;
+  }
+
+  LOG_ERROR("Torn checkpoint file %s", file_name.c_str());
+  return false;
+}
+
+void ParallelCheckpoint::ApplyFile(const std::vector<char> &buffer,
+                                   cid_t commit_id) {
+  // Locate the tile group frames, the file has already been validated
+  std::vector<std::pair<size_t, size_t>> frames;
+  size_t offset = 0;
+  while (offset < buffer.size()) {
+    ReferenceSerializeInputBE frame_input(buffer.data() + offset,
+                                          frame_header_size);
+    size_t length = frame_input.ReadInt();
+    auto frame_type = static_cast<CheckpointFrameType>(frame_input.ReadByte());
+    offset += frame_header_size;
+    if (frame_type == CHECKPOINT_FRAME_TYPE_TILE_GROUP) {
+      frames.emplace_back(offset, length);
+    }
+    offset += length;
+  }
+
+  std::atomic<size_t> next_frame(0);
+  std::vector<std::thread> workers;
+  for (size_t thread_itr = 0; thread_itr < thread_count_; thread_itr++) {
+    workers.push_back(std::thread([&]() {
+      size_t frame_itr;
+      while ((frame_itr = next_frame.fetch_add(1)) < frames.size()) {
+        RecoverTileGroup(buffer.data() + frames[frame_itr].first,
+                         frames[frame_itr].second, commit_id);
+      }
+    }));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ParallelCheckpoint::RecoverTileGroup(const char *data, size_t length,
+                                          cid_t commit_id) {
+  ReferenceSerializeInputBE input(data, length);
+  oid_t database_oid = input.ReadInt();
+  oid_t table_oid = input.ReadInt();
+  oid_t tile_group_id = input.ReadInt();
+
+  storage::column_map_type column_map;
+  oid_t column_count = input.ReadInt();
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    oid_t column_id = input.ReadInt();
+    oid_t tile_offset = input.ReadInt();
+    oid_t tile_column_offset = input.ReadInt();
+    column_map[column_id] = std::make_pair(tile_offset, tile_column_offset);
+  }
+
+  std::vector<oid_t> tuple_slots(input.ReadInt());
+  for (auto &tuple_slot : tuple_slots) {
+    tuple_slot = input.ReadInt();
+  }
+
+  auto table = catalog::Manager::GetInstance().GetTableWithOid(database_oid,
+                                                               table_oid);
+  if (table == nullptr) {
+    // the table was dropped
+    return;
+  }
+
+  // Start from an empty tile group with the checkpointed layout
+  table->ResetTileGroupWithOidForRecovery(tile_group_id, column_map);
+  auto tile_group = catalog::Manager::GetInstance().GetTileGroup(tile_group_id);
+  PL_ASSERT(tile_group);
+
+  if (!tuple_slots.empty()) {
+    auto tile_count = tile_group->GetTileCount();
+    for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+      auto tile = tile_group->GetTile(tile_itr);
+      input.ReadInt();  // tile length
+      tile->DeserializeTuplesFrom(input, tuple_slots, tile->GetPool());
+    }
+  }
+
+  // Set MVCC info
+  auto tile_group_header = tile_group->GetHeader();
+  for (auto tuple_slot : tuple_slots) {
+    tile_group_header->GetEmptyTupleSlot(tuple_slot);
+    tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    tile_group_header->SetBeginCommitId(tuple_slot, commit_id);
+    tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+    tile_group_header->SetInsertCommit(tuple_slot, false);
+    tile_group_header->SetDeleteCommit(tuple_slot, false);
+    tile_group_header->SetNextItemPointer(tuple_slot, INVALID_ITEMPOINTER);
+    tile_group->UpdateZoneMap(tuple_slot, 1);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(recovery_mutex_);
+    recovered_tile_groups_[tile_group_id] =
+        std::make_pair(table, tuple_slots.size());
+  }
+
+  LOG_TRACE("Recovered tile group %u with %lu tuples", tile_group_id,
+            tuple_slots.size());
+}
+
+}  // namespace logging
+}  // namespace peloton
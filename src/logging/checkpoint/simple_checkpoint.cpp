@@ -21,6 +21,7 @@
 #include "logging/records/tuple_record.h"
 #include "logging/records/transaction_record.h"
 #include "logging/log_record.h"
+#include "logging/log_reader.h"
 #include "logging/checkpoint_tile_scanner.h"
 #include "logging/logging_util.h"
 
@@ -124,26 +125,27 @@ cid_t SimpleCheckpoint::DoRecovery() {
   if (checkpoint_version < 0) {
     return 0;
   }
-  // we open checkpoint file in read + binary mode
+  // we map the checkpoint file and read the records in place
   std::string file_name = ConcatFileName(checkpoint_dir, checkpoint_version);
-  bool success =
-      LoggingUtil::InitFileHandle(file_name.c_str(), file_handle_, "rb");
+  LogReader reader;
+  bool success = reader.Open(file_name, 0);
   if (!success) {
     return 0;
   }
-
-  auto size = LoggingUtil::GetLogFileSize(file_handle_);
-  PL_ASSERT(size > 0);
-  file_handle_.size = size;
+  PL_ASSERT(reader.GetLength() > 0);
 
   bool should_stop = false;
   cid_t commit_id = 0;
+  LogRecordView record;
   while (!should_stop) {
-    auto record_type = LoggingUtil::GetNextLogRecordType(file_handle_);
-    switch (record_type) {
+    if (reader.Next(record) == false) {
+      LOG_ERROR("Torn checkpoint write.");
+      break;
+    }
+    switch (record.type) {
       case LOGRECORD_TYPE_WAL_TUPLE_INSERT: {
         LOG_TRACE("Read checkpoint insert entry");
-        InsertTuple(commit_id);
+        InsertTuple(record, commit_id);
         break;
       }
       case LOGRECORD_TYPE_TRANSACTION_COMMIT: {
@@ -152,12 +154,10 @@ cid_t SimpleCheckpoint::DoRecovery() {
       }
       case LOGRECORD_TYPE_TRANSACTION_BEGIN: {
         LOG_TRACE("Read checkpoint begin entry");
-        TransactionRecord txn_rec(record_type);
-        if (LoggingUtil::ReadTransactionRecordHeader(txn_rec, file_handle_) ==
-            false) {
-          LOG_ERROR("Failed to read checkpoint begin entry");
-          return false;
-        }
+        TransactionRecord txn_rec(record.type);
+        ReferenceSerializeInputBE txn_header(record.header,
+                                             record.header_length);
+        txn_rec.Deserialize(txn_header);
         commit_id = txn_rec.GetTransactionId();
         break;
       }
@@ -182,30 +182,24 @@ cid_t SimpleCheckpoint::DoRecovery() {
   return commit_id;
 }
 
-void SimpleCheckpoint::InsertTuple(cid_t commit_id) {
+void SimpleCheckpoint::InsertTuple(const LogRecordView &record,
+                                   cid_t commit_id) {
   TupleRecord tuple_record(LOGRECORD_TYPE_WAL_TUPLE_INSERT);
-
-  // Check for torn log write
-  if (LoggingUtil::ReadTupleRecordHeader(tuple_record, file_handle_) == false) {
-    LOG_ERROR("Could not read tuple record header.");
-    return;
-  }
+  ReferenceSerializeInputBE tuple_header(record.header, record.header_length);
+  tuple_record.DeserializeHeader(tuple_header);
 
   auto table = LoggingUtil::GetTable(tuple_record);
   if (!table) {
     // the table was deleted
-    LoggingUtil::SkipTupleRecordBody(file_handle_);
     return;
   }
 
   // Read off the tuple record body from the log
-  std::unique_ptr<storage::Tuple> tuple(LoggingUtil::ReadTupleRecordBody(
-      table->GetSchema(), pool.get(), file_handle_));
-  // Check for torn log write
-  if (tuple == nullptr) {
-    LOG_ERROR("Torn checkpoint write.");
-    return;
-  }
+  std::unique_ptr<storage::Tuple> tuple(
+      new storage::Tuple(table->GetSchema(), true));
+  ReferenceSerializeInputBE tuple_body(record.body, record.body_length);
+  tuple->DeserializeFrom(tuple_body, pool.get());
+
   auto target_location = tuple_record.GetInsertLocation();
   auto tile_group_id = target_location.block;
   RecoverTuple(tuple.get(), table, target_location, commit_id);
@@ -343,29 +337,5 @@ void SimpleCheckpoint::Cleanup() {
   LogManager::GetInstance().TruncateLogs(start_commit_id_);
 }
 
-void SimpleCheckpoint::InitVersionNumber() {
-  // Get checkpoint version
-  LOG_TRACE("Trying to read checkpoint directory");
-  struct dirent *file;
-  auto dirp = opendir(checkpoint_dir.c_str());
-  if (dirp == nullptr) {
-    LOG_TRACE("Opendir failed: Errno: %d, error: %s", errno, strerror(errno));
-    return;
-  }
-
-  while ((file = readdir(dirp)) != NULL) {
-    if (strncmp(file->d_name, FILE_PREFIX.c_str(), FILE_PREFIX.length()) == 0) {
-      // found a checkpoint file!
-      LOG_TRACE("Found a checkpoint file with name %s", file->d_name);
-      int version = LoggingUtil::ExtractNumberFromFileName(file->d_name);
-      if (version > checkpoint_version) {
-        checkpoint_version = version;
-      }
-    }
-  }
-  closedir(dirp);
-  LOG_TRACE("set checkpoint version to: %d", checkpoint_version);
-}
-
 }  // namespace logging
 }  // namespace peloton
@@ -213,7 +213,7 @@ void FrontendLogger::CollectLogRecordsFromBackendLoggers() {
       for (oid_t log_record_itr = 0; log_record_itr < log_buffer_size;
            log_record_itr++) {
         // copy to front end logger
-        global_queue.push_back(std::move(log_buffers[log_record_itr]));
+        global_queue.push_back(log_buffers[log_record_itr]);
       }
 
       // cleanup the local queue
@@ -278,11 +278,6 @@ void FrontendLogger::SetBackendLoggerLoggedCid(BackendLogger &bel) {
  * @param backend logger
  */
 void FrontendLogger::AddBackendLogger(BackendLogger *backend_logger) {
-  // Grant empty buffers
-  for (int i = 0; i < BUFFER_POOL_SIZE; i++) {
-    std::unique_ptr<LogBuffer> buffer(new LogBuffer(backend_logger));
-    backend_logger->GrantEmptyBuffer(std::move(buffer));
-  }
   // Add backend logger to the list of backend loggers
   backend_loggers_lock.Lock();
   backend_logger->SetLoggingCidLowerBound(max_collected_commit_id);
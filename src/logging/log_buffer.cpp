@@ -25,36 +25,60 @@ namespace logging {
 // Log Buffer
 //===--------------------------------------------------------------------===//
 LogBuffer::LogBuffer(BackendLogger *backend_logger)
-    : backend_logger_(backend_logger) {
+    : reserved_size_(0),
+      size_(0),
+      backend_logger_(backend_logger),
+      max_log_id(0),
+      sealed_(false),
+      free_(true) {
   capacity_ = LogManager::GetInstance().GetLogBufferCapacity();
-  elastic_data_.reset(new char[capacity_]);
 }
 
 bool LogBuffer::WriteRecord(LogRecord *record) {
-  bool success = WriteData(record->GetMessage(), record->GetMessageLength());
-  return success;
-}
+  char *data = record->GetMessage();
+  size_t len = record->GetMessageLength();
+  PL_ASSERT(data);
+  PL_ASSERT(len);
 
-void LogBuffer::ResetData() { size_ = 0; }
+  // Reserve space
+  size_t offset = reserved_size_.fetch_add(len, std::memory_order_relaxed);
 
-// Internal Methods
-bool LogBuffer::WriteData(char *data, size_t len) {
   // Not enough space
-  while (len + size_ > capacity_) {
-    if (size_ == 0) {
-      // double log buffer capacity for empty buffer
-      capacity_ *= 2;
-      elastic_data_.reset(new char[capacity_]);
-    } else {
+  if (offset + len > capacity_) {
+    if (offset != 0) {
+      reserved_size_.fetch_sub(len, std::memory_order_relaxed);
       return false;
     }
+    // grow an empty buffer, nothing has been published from it yet
+    while (len > capacity_) {
+      capacity_ *= 2;
+    }
+    elastic_data_.reset();
   }
-  PL_ASSERT(data);
-  PL_ASSERT(len);
-  PL_MEMCPY(elastic_data_.get() + size_, data, len);
-  size_ += len;
+  if (!elastic_data_) {
+    elastic_data_.reset(new char[capacity_]);
+  }
+
+  PL_MEMCPY(elastic_data_.get() + offset, data, len);
+
+  // the max log id must cover the record before it becomes visible
+  cid_t log_id = record->GetTransactionId();
+  if (log_id > max_log_id.load(std::memory_order_relaxed)) {
+    max_log_id.store(log_id, std::memory_order_relaxed);
+  }
+
+  // Publish
+  size_.store(offset + len, std::memory_order_release);
   return true;
 }
 
+void LogBuffer::ResetData() {
+  reserved_size_ = 0;
+  size_ = 0;
+  max_log_id = 0;
+  sealed_ = false;
+  collected_size_ = 0;
+}
+
 }  // namespace logging
 }  // namespace peloton
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_buffer_ring.cpp
+//
+// Identification: src/logging/log_buffer_ring.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "logging/log_buffer_ring.h"
+#include "common/logger.h"
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Buffer Ring
+//===--------------------------------------------------------------------===//
+LogBufferRing::LogBufferRing(BackendLogger *backend_logger) {
+  for (size_t buffer_itr = 0; buffer_itr < LOG_BUFFER_RING_SIZE;
+       buffer_itr++) {
+    buffers_[buffer_itr].reset(new LogBuffer(backend_logger));
+  }
+  // the first buffer is in use right away
+  GetBuffer(head_)->SetFree(false);
+}
+
+bool LogBufferRing::WriteRecord(LogRecord *record) {
+  if (GetBuffer(head_)->WriteRecord(record)) {
+    return true;
+  }
+
+  LOG_TRACE("Log buffer is full - Move to the next one");
+  AdvanceBuffer();
+
+  // an empty buffer grows to fit the record
+  auto success = GetBuffer(head_)->WriteRecord(record);
+  if (!success) {
+    LOG_ERROR("Write record to log buffer failed");
+  }
+  return success;
+}
+
+void LogBufferRing::AdvanceBuffer() {
+  GetBuffer(head_)->Seal();
+
+  auto next_buffer = GetBuffer(head_ + 1);
+  if (!next_buffer->IsFree()) {
+    // the frontend logger is a full lap behind
+    std::unique_lock<std::mutex> lock(free_mutex_);
+    free_cv_.wait(lock, [next_buffer] { return next_buffer->IsFree(); });
+  }
+
+  next_buffer->SetFree(false);
+  head_++;
+}
+
+bool LogBufferRing::CollectLogBuffers(std::vector<LogBufferSlice> &slices) {
+  bool collected = false;
+
+  while (true) {
+    auto log_buffer = GetBuffer(tail_);
+    if (log_buffer->IsFree()) {
+      break;
+    }
+
+    // read the seal before the size, the size of a sealed buffer is final
+    bool sealed = log_buffer->IsSealed();
+    size_t end = log_buffer->GetSize();
+    size_t begin = log_buffer->GetCollectedSize();
+
+    if (end > begin || sealed) {
+      slices.push_back(LogBufferSlice{log_buffer, begin, end,
+                                      log_buffer->GetMaxLogId(), sealed});
+      log_buffer->SetCollectedSize(end);
+      collected = collected || end > begin;
+    }
+
+    // the buffer at the head is still being filled
+    if (!sealed) {
+      break;
+    }
+    tail_++;
+  }
+
+  return collected;
+}
+
+void LogBufferRing::ReleaseLogBuffer(LogBuffer *log_buffer) {
+  log_buffer->ResetData();
+  {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    log_buffer->SetFree(true);
+  }
+  free_cv_.notify_one();
+}
+
+}  // namespace logging
+}  // namespace peloton
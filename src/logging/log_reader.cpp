@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_reader.cpp
+//
+// Identification: src/logging/log_reader.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "logging/log_reader.h"
+#include "logging/log_record.h"
+#include "common/crc32c.h"
+#include "common/logger.h"
+#include "common/serializer.h"
+
+namespace peloton {
+namespace logging {
+
+LogReader::~LogReader() { Close(); }
+
+bool LogReader::Open(const std::string &file_name, size_t offset) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    LOG_ERROR("Could not open log file %s : %s", file_name.c_str(),
+              strerror(errno));
+    return false;
+  }
+
+  // the mapping outlives the descriptor
+  bool status = Open(fd, offset);
+  close(fd);
+
+  return status;
+}
+
+bool LogReader::Open(int fd, size_t offset) {
+  Close();
+
+  struct stat file_stats;
+  if (fstat(fd, &file_stats) == -1) {
+    LOG_ERROR("Could not stat log file : %s", strerror(errno));
+    return false;
+  }
+
+  size_t file_size = file_stats.st_size;
+
+  // Nothing past the offset, so there is nothing to map
+  if (file_size <= offset) {
+    return true;
+  }
+
+  void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    LOG_ERROR("Could not map log file : %s", strerror(errno));
+    return false;
+  }
+
+  // Records are replayed front to back
+  madvise(mapping, file_size, MADV_SEQUENTIAL);
+
+  mapping_ = mapping;
+  mapping_length_ = file_size;
+
+  data_ = reinterpret_cast<const char *>(mapping) + offset;
+  length_ = file_size - offset;
+
+  return true;
+}
+
+void LogReader::Open(const char *data, size_t length) {
+  Close();
+
+  data_ = data;
+  length_ = length;
+}
+
+void LogReader::Close() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_length_);
+  }
+
+  mapping_ = nullptr;
+  mapping_length_ = 0;
+
+  data_ = nullptr;
+  length_ = 0;
+  position_ = 0;
+  torn_tail_ = false;
+}
+
+/**
+ * @brief Read a length prefix and make sure the range it covers is mapped
+ * @param offset of the length prefix
+ * @param length of the range including the prefix
+ * @return false if the prefix or the range runs past the end
+ */
+bool LogReader::ReadLength(size_t offset, size_t &length) const {
+  if (offset + sizeof(int32_t) > length_) {
+    return false;
+  }
+
+  ReferenceSerializeInputBE input(data_ + offset, sizeof(int32_t));
+  int32_t prefix = input.ReadInt();
+  if (prefix < 0 || static_cast<size_t>(prefix) > length_) {
+    return false;
+  }
+
+  length = sizeof(int32_t) + prefix;
+  return offset + length <= length_;
+}
+
+bool LogReader::Next(LogRecordView &record) {
+  if (torn_tail_ || position_ >= length_) {
+    return false;
+  }
+
+  size_t offset = position_;
+  record = LogRecordView();
+  record.type = static_cast<LogRecordType>(data_[offset]);
+
+  bool has_body = false;
+  switch (record.type) {
+    case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
+    case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+      has_body = true;
+      break;
+
+    case LOGRECORD_TYPE_TRANSACTION_BEGIN:
+    case LOGRECORD_TYPE_TRANSACTION_COMMIT:
+    case LOGRECORD_TYPE_TRANSACTION_END:
+    case LOGRECORD_TYPE_TRANSACTION_ABORT:
+    case LOGRECORD_TYPE_TRANSACTION_DONE:
+    case LOGRECORD_TYPE_TUPLE_INSERT:
+    case LOGRECORD_TYPE_TUPLE_DELETE:
+    case LOGRECORD_TYPE_TUPLE_UPDATE:
+    case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
+    case LOGRECORD_TYPE_WBL_TUPLE_INSERT:
+    case LOGRECORD_TYPE_WBL_TUPLE_DELETE:
+    case LOGRECORD_TYPE_WBL_TUPLE_UPDATE:
+    case LOGRECORD_TYPE_ITERATION_DELIMITER:
+      break;
+
+    default:
+      LOG_TRACE("Invalid log record type at offset %lu", position_);
+      torn_tail_ = true;
+      return false;
+  }
+  offset += sizeof(char);
+
+  size_t header_length;
+  if (ReadLength(offset, header_length) == false) {
+    LOG_TRACE("Torn log record header at offset %lu", position_);
+    torn_tail_ = true;
+    return false;
+  }
+  record.header = data_ + offset;
+  record.header_length = header_length;
+  offset += header_length;
+
+  if (has_body) {
+    size_t body_length;
+    if (ReadLength(offset, body_length) == false) {
+      LOG_TRACE("Torn log record body at offset %lu", position_);
+      torn_tail_ = true;
+      return false;
+    }
+    record.body = data_ + offset;
+    record.body_length = body_length;
+    offset += body_length;
+  }
+
+  // Verify the checksum trailer
+  if (offset + LogRecord::GetChecksumSize() > length_) {
+    LOG_TRACE("Torn log record checksum at offset %lu", position_);
+    torn_tail_ = true;
+    return false;
+  }
+
+  ReferenceSerializeInputBE input(data_ + offset,
+                                  LogRecord::GetChecksumSize());
+  uint32_t expected_checksum = static_cast<uint32_t>(input.ReadInt());
+  uint32_t checksum = Crc32c::Compute(data_ + position_, offset - position_);
+  if (checksum != expected_checksum) {
+    LOG_TRACE("Log record checksum mismatch at offset %lu", position_);
+    torn_tail_ = true;
+    return false;
+  }
+
+  position_ = offset + LogRecord::GetChecksumSize();
+  return true;
+}
+
+}  // namespace logging
+}  // namespace peloton
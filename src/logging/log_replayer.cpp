@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_replayer.cpp
+//
+// Identification: src/logging/log_replayer.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "logging/log_replayer.h"
+#include "logging/log_reader.h"
+#include "logging/loggers/wal_frontend_logger.h"
+#include "logging/records/transaction_record.h"
+#include "logging/records/tuple_record.h"
+#include "catalog/manager.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "common/logger.h"
+#include "common/serializer.h"
+
+namespace peloton {
+namespace logging {
+
+LogReplayer &LogReplayer::GetInstance() {
+  static LogReplayer log_replayer;
+  return log_replayer;
+}
+
+LogReplayer::LogReplayer() : replay_logger_(new WriteAheadFrontendLogger(true)) {}
+
+LogReplayer::~LogReplayer() {}
+
+/**
+ * @brief Replay the records of a shipped segment
+ * @param segment whole records in the WAL format
+ * @param sequence_number position of the segment in the stream of the logger
+ * @param logger_id frontend logger on the primary that wrote the segment
+ * @return false if the segment was a duplicate, came after a missing one or
+ * could not be read
+ */
+bool LogReplayer::ReplayLogSegment(const std::string &segment,
+                                   int64_t sequence_number, int logger_id) {
+  std::lock_guard<std::mutex> lock(replay_mutex_);
+
+  auto &replayed = replayed_sequence_numbers_[logger_id];
+  if (sequence_number <= replayed) {
+    LOG_TRACE("Skip duplicate log segment %ld of logger %d", sequence_number,
+              logger_id);
+    return false;
+  }
+
+  // The acknowledgement tells the primary where to resume from
+  if (sequence_number != replayed + 1) {
+    LOG_INFO("Reject log segment %ld of logger %d, missing %ld to %ld",
+             sequence_number, logger_id, replayed + 1, sequence_number - 1);
+    return false;
+  }
+  replayed = sequence_number;
+
+  // Tuple records keep pointing into the segment until they are applied
+  std::shared_ptr<std::string> pinned_segment(new std::string(segment));
+
+  LogReader reader;
+  reader.Open(pinned_segment->data(), pinned_segment->size());
+
+  LogRecordView record;
+  while (reader.Next(record)) {
+    ReferenceSerializeInputBE record_header(record.header,
+                                            record.header_length);
+
+    switch (record.type) {
+      case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
+      case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
+        TupleRecord tuple_record(record.type);
+        tuple_record.DeserializeHeader(record_header);
+        auto txn_id = tuple_record.GetTransactionId();
+
+        if (replay_logger_->ReplayLogRecord(record, 0, MAX_CID) == false) {
+          LOG_TRACE("Skip a tuple of unknown txn %d", (int)txn_id);
+          break;
+        }
+
+        auto &segments = pinned_segments_[txn_id];
+        if (segments.empty() || segments.back() != pinned_segment) {
+          segments.push_back(pinned_segment);
+        }
+        break;
+      }
+
+      case LOGRECORD_TYPE_TRANSACTION_COMMIT: {
+        TransactionRecord txn_record(record.type);
+        txn_record.Deserialize(record_header);
+
+        replay_logger_->ReplayLogRecord(record, 0, MAX_CID);
+        pinned_segments_.erase(txn_record.GetTransactionId());
+        break;
+      }
+
+      default:
+        if (replay_logger_->ReplayLogRecord(record, 0, MAX_CID) == false) {
+          LOG_TRACE("Skip a record of an unknown txn");
+        }
+        break;
+    }
+  }
+
+  if (reader.IsTornTail()) {
+    LOG_ERROR("Log segment %ld of logger %d is corrupted at offset %lu",
+              sequence_number, logger_id, reader.GetPosition());
+  }
+
+  UpdateCatalogAndTxnManagers();
+
+  return reader.IsTornTail() == false;
+}
+
+/**
+ * @brief Move the oid and commit id counters past the replayed transactions
+ * so that new snapshots see them. The counters only move forward.
+ */
+void LogReplayer::UpdateCatalogAndTxnManagers() {
+  auto &manager = catalog::Manager::GetInstance();
+  auto max_oid = replay_logger_->GetMaxOid();
+  if (manager.GetCurrentOid() < max_oid) {
+    manager.SetNextOid(max_oid);
+  }
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto next_cid = replay_logger_->GetMaxCid() + 1;
+  if (txn_manager.GetCurrentCommitId() < next_cid) {
+    txn_manager.SetNextCid(next_cid);
+  }
+}
+
+int64_t LogReplayer::GetReplayedSequenceNumber(int logger_id) {
+  std::lock_guard<std::mutex> lock(replay_mutex_);
+  return replayed_sequence_numbers_[logger_id];
+}
+
+void LogReplayer::Reset() {
+  std::lock_guard<std::mutex> lock(replay_mutex_);
+
+  replay_logger_->AbortActiveTransactions();
+  pinned_segments_.clear();
+  replayed_sequence_numbers_.clear();
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_shipper.cpp
+//
+// Identification: src/logging/log_shipper.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "logging/log_shipper.h"
+#include "networking/rpc_client.h"
+#include "common/logger.h"
+
+namespace peloton {
+namespace logging {
+
+// A replica that is further behind has to be rebuilt from a checkpoint
+static const size_t max_unacknowledged_segments = 4096;
+
+LogShipper &LogShipper::GetInstance() {
+  static LogShipper log_shipper;
+  return log_shipper;
+}
+
+LogShipper::LogShipper() {}
+
+LogShipper::~LogShipper() {}
+
+void LogShipper::AddSubscriber(const std::string &address) {
+  std::lock_guard<std::mutex> lock(shipper_mutex_);
+
+  LOG_INFO("Shipping the log to replica %s", address.c_str());
+  subscribers_.emplace_back(new networking::RpcClient(address.c_str()));
+  has_subscribers_ = true;
+}
+
+/**
+ * @brief Send a log segment to all the replicas
+ * @param segment whole records that are already durable on the primary
+ * @param logger_id frontend logger that wrote the segment
+ */
+void LogShipper::ShipLogSegment(const std::string &segment, int logger_id) {
+  if (segment.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(shipper_mutex_);
+
+  auto sequence_number = ++shipped_sequence_numbers_[logger_id];
+
+  auto &segments = unacknowledged_segments_[logger_id];
+  segments[sequence_number] = segment;
+  if (segments.size() > max_unacknowledged_segments) {
+    segments.erase(segments.begin());
+  }
+
+  SendLogSegment(segment, sequence_number, logger_id);
+
+  LOG_TRACE("Shipped log segment %ld of logger %d (%lu bytes)",
+            sequence_number, logger_id, segment.size());
+}
+
+void LogShipper::SendLogSegment(const std::string &segment,
+                                int64_t sequence_number, int logger_id) {
+  networking::LogRecordReplayRequest request;
+  request.set_log(segment);
+  request.set_sequence_number(sequence_number);
+  request.set_logger_id(logger_id);
+
+  // The rpc channel only queues the request, the replica answers with a
+  // separate response message
+  for (auto &subscriber : subscribers_) {
+    networking::LogRecordReplayResponse response;
+    subscriber->LogRecordReplay(&request, &response);
+  }
+}
+
+/**
+ * @brief Record the acknowledgement of a replica
+ * @param logger_id frontend logger the segments came from
+ * @param sequence_number last segment the replica applied in sequence
+ *
+ * A replica only moves forward by applying the next segment, so an
+ * acknowledgement that does not move forward means the replica rejected a
+ * segment that came after a missing one. Everything after the acknowledged
+ * segment is sent again, at most once for every newly shipped segment, so the
+ * rejections of the segments already in flight do not resend it again.
+ */
+void LogShipper::AcknowledgeLogSegment(int logger_id,
+                                       int64_t sequence_number) {
+  std::lock_guard<std::mutex> lock(shipper_mutex_);
+
+  auto &acknowledged = acknowledged_sequence_numbers_[logger_id];
+  auto &segments = unacknowledged_segments_[logger_id];
+  if (sequence_number > acknowledged) {
+    acknowledged = sequence_number;
+    segments.erase(segments.begin(), segments.upper_bound(sequence_number));
+    return;
+  }
+
+  auto shipped = shipped_sequence_numbers_[logger_id];
+  auto &resent = resent_sequence_numbers_[logger_id];
+  if (sequence_number >= shipped || resent >= shipped) {
+    return;
+  }
+  resent = shipped;
+
+  if (segments.empty() || segments.begin()->first > sequence_number + 1) {
+    LOG_ERROR("Log segments of logger %d after %ld are no longer kept, the "
+              "replica has to be rebuilt from a checkpoint",
+              logger_id, sequence_number);
+    return;
+  }
+
+  LOG_INFO("Resend log segments %ld to %ld of logger %d", sequence_number + 1,
+           shipped, logger_id);
+  for (auto itr = segments.upper_bound(sequence_number); itr != segments.end();
+       itr++) {
+    SendLogSegment(itr->second, itr->first, logger_id);
+  }
+}
+
+int64_t LogShipper::GetShippedSequenceNumber(int logger_id) {
+  std::lock_guard<std::mutex> lock(shipper_mutex_);
+  return shipped_sequence_numbers_[logger_id];
+}
+
+int64_t LogShipper::GetAcknowledgedSequenceNumber(int logger_id) {
+  std::lock_guard<std::mutex> lock(shipper_mutex_);
+  return acknowledged_sequence_numbers_[logger_id];
+}
+
+}  // namespace logging
+}  // namespace peloton
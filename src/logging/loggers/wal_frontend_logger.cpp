@@ -25,6 +25,8 @@
 #include "concurrency/transaction_manager.h"
 
 #include "logging/log_manager.h"
+#include "logging/log_shipper.h"
+#include "logging/log_reader.h"
 #include "logging/records/transaction_record.h"
 #include "logging/records/tuple_record.h"
 #include "logging/loggers/wal_frontend_logger.h"
@@ -134,28 +136,36 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
     }
   }
 
+  // Replicas get the records once they are durable
+  bool ship_log = LogShipper::GetInstance().HasSubscribers();
+
   // First, write all the record in the queue
   for (oid_t global_queue_itr = 0; global_queue_itr < global_queue_size;
        global_queue_itr++) {
-    auto &log_buffer = global_queue[global_queue_itr];
+    auto &slice = global_queue[global_queue_itr];
+    auto log_buffer = slice.buffer;
 
-    if (!test_mode_) {
-      fwrite(log_buffer->GetData(), sizeof(char), log_buffer->GetSize(),
-             cur_file_handle.file);
+    if (!test_mode_ && slice.end > slice.begin) {
+      fwrite(log_buffer->GetData() + slice.begin, sizeof(char),
+             slice.end - slice.begin, cur_file_handle.file);
+    }
+
+    if (ship_log && slice.end > slice.begin) {
+      shipping_buffer_.append(log_buffer->GetData() + slice.begin,
+                              slice.end - slice.begin);
     }
 
-    LOG_TRACE("Log buffer get max log id returned %d",
-              (int)log_buffer->GetMaxLogId());
+    LOG_TRACE("Log buffer get max log id returned %d", (int)slice.max_log_id);
 
-    if (log_buffer->GetMaxLogId() > this->max_log_id_file) {
-      this->max_log_id_file = log_buffer->GetMaxLogId();
+    if (slice.max_log_id > this->max_log_id_file) {
+      this->max_log_id_file = slice.max_log_id;
       LOG_TRACE("Max log id file so far is %d", (int)this->max_log_id_file);
     }
 
-    // return empty buffer
-    auto backend_logger = log_buffer->GetBackendLogger();
-    log_buffer->ResetData();
-    backend_logger->GrantEmptyBuffer(std::move(log_buffer));
+    // return sealed buffer
+    if (slice.release) {
+      log_buffer->GetBackendLogger()->ReleaseLogBuffer(log_buffer);
+    }
   }
 
   bool flushed = false;
@@ -213,6 +223,12 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
   if (flushed) {
     // signal that we have flushed
     LogManager::GetInstance().FrontendLoggerFlushed();
+
+    // everything buffered so far has been fsync'ed
+    if (ship_log) {
+      LogShipper::GetInstance().ShipLogSegment(shipping_buffer_, logger_id);
+      shipping_buffer_.clear();
+    }
   }
 }
 
@@ -227,7 +243,6 @@ void WriteAheadFrontendLogger::DoRecovery() {
   // FIXME GetNextCommitId() increments next_cid!!!
   cid_t start_commit_id = CheckpointManager::GetInstance().GetRecoveredCid();
   auto &log_manager = logging::LogManager::GetInstance();
-  int num_inserts = 0;
   cid_t global_max_flushed_id_for_recovery;
   log_file_cursor_ = 0;
 
@@ -236,148 +251,109 @@ void WriteAheadFrontendLogger::DoRecovery() {
   LOG_TRACE("Got start_commit_id as %d, global max flushed as %d",
             (int)start_commit_id, (int)global_max_flushed_id_for_recovery);
 
-  // open first file
-  OpenNextLogFile();
-
-  // Go over the log file if needed
-  bool reached_end_of_log = false;
-
-  // Go over each log record in the log file
-  while (reached_end_of_log == false) {
-    // Read the first byte to identify log record type
-    // If that is not possible, then wrap up recovery
-    auto record_type = GetNextLogRecordTypeForRecovery();
-    cid_t log_id = INVALID_CID;
-    TupleRecord *tuple_record;
+  // Drop any log files mapped by an earlier recovery
+  recovery_readers_.clear();
+
+  // Go over each log record in the log files
+  // If a record cannot be replayed, then wrap up recovery
+  LogRecordView record;
+  while (GetNextLogRecordForRecovery(record)) {
+    if (ReplayLogRecord(record, start_commit_id,
+                        global_max_flushed_id_for_recovery) == false) {
+      cur_file_handle = INVALID_FILE_HANDLE;
+      return;
+    }
+  }
 
-    switch (record_type) {
-      case LOGRECORD_TYPE_TRANSACTION_BEGIN:
-      case LOGRECORD_TYPE_TRANSACTION_COMMIT:
-      case LOGRECORD_TYPE_ITERATION_DELIMITER: {
-        // Check for torn log write
-        TransactionRecord txn_rec(record_type);
-        if (LoggingUtil::ReadTransactionRecordHeader(
-                txn_rec, cur_file_handle) == false) {
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
-        }
-        log_id = txn_rec.GetTransactionId();
-        if (log_id <= start_commit_id ||
-            log_id > global_max_flushed_id_for_recovery) {
-          LOG_TRACE("SKIP");
-          continue;
-        }
-        break;
-      }
-      case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
-      case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
-        tuple_record = new TupleRecord(record_type);
-        // Check for torn log write
-        if (LoggingUtil::ReadTupleRecordHeader(*tuple_record,
-                                               cur_file_handle) == false) {
-          LOG_ERROR("Could not read tuple record header.");
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
-        }
+  // Finally, abort ACTIVE transactions in recovery_txn_table
+  AbortActiveTransactions();
 
-        log_id = tuple_record->GetTransactionId();
-        auto table = LoggingUtil::GetTable(*tuple_record);
+  // All the records have been replayed, unmap the log files
+  recovery_readers_.clear();
 
-        if (!table || log_id <= start_commit_id ||
-            log_id > global_max_flushed_id_for_recovery) {
-          LoggingUtil::SkipTupleRecordBody(cur_file_handle);
-          LOG_TRACE("Skip a tuple, log id is %d", (int)log_id);
-          delete tuple_record;
-          continue;
-        }
+  // After finishing recovery, set the next oid with maximum oid
+  // observed during the recovery
+  log_manager.UpdateCatalogAndTxnManagers(max_oid, max_cid);
 
-        if (recovery_txn_table.find(log_id) == recovery_txn_table.end()) {
-          LOG_ERROR("Insert txd id %d not found in recovery txn table",
-                    (int)log_id);
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
-        }
+  cur_file_handle = INVALID_FILE_HANDLE;
+}
 
-        // Read off the tuple record body from the log
-        tuple_record->SetTuple(LoggingUtil::ReadTupleRecordBody(
-            table->GetSchema(), recovery_pool, cur_file_handle));
-        num_inserts++;
-        break;
+/**
+ * @brief Replay a single log record through the recovery txn table
+ * @param record view of the record, tuple bodies must stay valid until the
+ * transaction commits or is aborted
+ * @param start_commit_id records at or below it are already applied
+ * @param max_commit_id records above it are not durable yet
+ * @return false if a tuple record belongs to a transaction that never began
+ */
+bool WriteAheadFrontendLogger::ReplayLogRecord(const LogRecordView &record,
+                                               cid_t start_commit_id,
+                                               cid_t max_commit_id) {
+  auto record_type = record.type;
+  cid_t log_id = INVALID_CID;
+
+  // The header is deserialized in place
+  ReferenceSerializeInputBE record_header(record.header, record.header_length);
+
+  switch (record_type) {
+    case LOGRECORD_TYPE_TRANSACTION_BEGIN:
+    case LOGRECORD_TYPE_TRANSACTION_COMMIT: {
+      TransactionRecord txn_rec(record_type);
+      txn_rec.Deserialize(record_header);
+      log_id = txn_rec.GetTransactionId();
+      if (log_id <= start_commit_id || log_id > max_commit_id) {
+        LOG_TRACE("SKIP");
+        return true;
       }
-      case LOGRECORD_TYPE_WAL_TUPLE_DELETE: {
-        tuple_record = new TupleRecord(record_type);
-        // Check for torn log write
-        if (LoggingUtil::ReadTupleRecordHeader(*tuple_record,
-                                               cur_file_handle) == false) {
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
-        }
 
-        log_id = tuple_record->GetTransactionId();
-        if (log_id <= start_commit_id ||
-            log_id > global_max_flushed_id_for_recovery) {
-          delete tuple_record;
-          continue;
-        }
-        if (recovery_txn_table.find(log_id) == recovery_txn_table.end()) {
-          LOG_TRACE("Delete txd id %d not found in recovery txn table",
-                    (int)log_id);
-          cur_file_handle = INVALID_FILE_HANDLE;
-          return;
-        }
-        break;
+      if (record_type == LOGRECORD_TYPE_TRANSACTION_BEGIN) {
+        StartTransactionRecovery(log_id);
+      } else {
+        // Now directly commit this transaction. This is safe because we
+        // reject commit ids that appear after the persistent commit id
+        // above.
+        CommitTransactionRecovery(log_id);
       }
-      default:
-        reached_end_of_log = true;
-        break;
+      return true;
     }
-    if (!reached_end_of_log) {
-      switch (record_type) {
-        case LOGRECORD_TYPE_TRANSACTION_BEGIN:
-          PL_ASSERT(log_id != INVALID_CID);
-          StartTransactionRecovery(log_id);
-          break;
-
-        case LOGRECORD_TYPE_TRANSACTION_COMMIT:
-          PL_ASSERT(log_id != INVALID_CID);
-
-          // Now directly commit this transaction. This is safe because we
-          // reject commit ids that appear
-          // after the persistent commit id before coming here (in the switch
-          // case above).
-          CommitTransactionRecovery(log_id);
-          break;
-
-        case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
-        case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
-        case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
-          recovery_txn_table[tuple_record->GetTransactionId()].push_back(
-              tuple_record);
-          break;
-        case LOGRECORD_TYPE_ITERATION_DELIMITER: {
-          // Do nothing if we hit the delimiter, because the delimiters help
-          // us only to find
-          // the max persistent commit id, and should be ignored during actual
-          // recovery
-          break;
+    case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
+    case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+    case LOGRECORD_TYPE_WAL_TUPLE_DELETE: {
+      std::unique_ptr<TupleRecord> tuple_record(new TupleRecord(record_type));
+      tuple_record->DeserializeHeader(record_header);
+
+      log_id = tuple_record->GetTransactionId();
+      if (log_id <= start_commit_id || log_id > max_commit_id) {
+        LOG_TRACE("Skip a tuple, log id is %d", (int)log_id);
+        return true;
+      }
+
+      if (record_type != LOGRECORD_TYPE_WAL_TUPLE_DELETE) {
+        if (LoggingUtil::GetTable(*tuple_record) == nullptr) {
+          LOG_TRACE("Skip a tuple, table is missing");
+          return true;
         }
 
-        default:
-          reached_end_of_log = true;
-          break;
+        // The tuple body stays in the log segment until the transaction
+        // commits and it is deserialized straight into the tile group
+        tuple_record->SetTupleBody(record.body, record.body_length);
       }
-    }
-  }
 
-  // Finally, abort ACTIVE transactions in recovery_txn_table
-  AbortActiveTransactions();
-
-  // After finishing recovery, set the next oid with maximum oid
-  // observed during the recovery
-  log_manager.UpdateCatalogAndTxnManagers(max_oid, max_cid);
+      auto txn_itr = recovery_txn_table.find(log_id);
+      if (txn_itr == recovery_txn_table.end()) {
+        LOG_ERROR("Tuple txd id %d not found in recovery txn table",
+                  (int)log_id);
+        return false;
+      }
 
-  LOG_TRACE("This thread did %d inserts", (int)num_inserts);
-  cur_file_handle = INVALID_FILE_HANDLE;
+      txn_itr->second.push_back(tuple_record.release());
+      return true;
+    }
+    default:
+      // Delimiters only help us find the max persistent commit id, and
+      // should be ignored during actual recovery
+      return true;
+  }
 }
 
 void WriteAheadFrontendLogger::RecoverIndex() {
@@ -537,12 +513,14 @@ void WriteAheadFrontendLogger::CommitTransactionRecovery(cid_t commit_id) {
 
 void InsertTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
                        oid_t table_id, const ItemPointer &insert_loc,
-                       storage::Tuple *tuple,
+                       TupleRecord *record,
                        bool should_increase_tuple_count = true) {
   auto &manager = catalog::Manager::GetInstance();
   storage::Database *db = manager.GetDatabaseWithOid(db_id);
   PL_ASSERT(db);
 
+  storage::Tuple *tuple = record->GetTuple();
+
   auto table = db->GetTableWithOid(table_id);
   if (!table) {
     delete tuple;
@@ -564,7 +542,15 @@ void InsertTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
   // table->GetTileGroupLock().Unlock();
   // unlock table here
 
-  tile_group->InsertTupleFromRecovery(commit_id, insert_loc.offset, tuple);
+  if (record->GetTupleBody() != nullptr) {
+    // Replay straight from the log record
+    ReferenceSerializeInputBE tuple_body(record->GetTupleBody(),
+                                         record->GetTupleBodyLength());
+    tile_group->InsertTupleFromRecovery(commit_id, insert_loc.offset,
+                                        tuple_body);
+  } else {
+    tile_group->InsertTupleFromRecovery(commit_id, insert_loc.offset, tuple);
+  }
   if (should_increase_tuple_count) {
     table->GetTileGroupLock().WriteLock();
     table->IncreaseNumberOfTuplesBy(1);
@@ -605,14 +591,14 @@ void DeleteTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
 
 void UpdateTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
                        oid_t table_id, const ItemPointer &remove_loc,
-                       const ItemPointer &insert_loc, storage::Tuple *tuple) {
+                       const ItemPointer &insert_loc, TupleRecord *record) {
   auto &manager = catalog::Manager::GetInstance();
   storage::Database *db = manager.GetDatabaseWithOid(db_id);
   PL_ASSERT(db);
 
   auto table = db->GetTableWithOid(table_id);
   if (!table) {
-    delete tuple;
+    delete record->GetTuple();
     return;
   }
   PL_ASSERT(table);
@@ -628,7 +614,7 @@ void UpdateTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
     }
   }
   // table->GetTileGroupLock().Unlock();
-  InsertTupleHelper(max_tg, commit_id, db_id, table_id, insert_loc, tuple,
+  InsertTupleHelper(max_tg, commit_id, db_id, table_id, insert_loc, record,
                     false);
 
   tile_group->UpdateTupleFromRecovery(commit_id, remove_loc.offset, insert_loc);
@@ -641,7 +627,7 @@ void UpdateTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
 void WriteAheadFrontendLogger::InsertTuple(TupleRecord *record) {
   InsertTupleHelper(max_oid, record->GetTransactionId(),
                     record->GetDatabaseOid(), record->GetTableId(),
-                    record->GetInsertLocation(), record->GetTuple());
+                    record->GetInsertLocation(), record);
 }
 
 /**
@@ -663,65 +649,41 @@ void WriteAheadFrontendLogger::UpdateTuple(TupleRecord *record) {
   UpdateTupleHelper(max_oid, record->GetTransactionId(),
                     record->GetDatabaseOid(), record->GetTableId(),
                     record->GetDeleteLocation(), record->GetInsertLocation(),
-                    record->GetTuple());
+                    record);
 }
 
 //===--------------------------------------------------------------------===//
 // Utility functions
 //===--------------------------------------------------------------------===//
 
-LogRecordType WriteAheadFrontendLogger::GetNextLogRecordTypeForRecovery() {
-  char buffer;
-  bool is_truncated = false;
-  int ret;
-
-  if (cur_file_handle.file == nullptr || cur_file_handle.fd == -1)
-    return LOGRECORD_TYPE_INVALID;
-
-  LOG_TRACE("Inside GetNextLogRecordForRecovery");
-
-  LOG_TRACE("File is at position %d", (int)ftell(cur_file_handle.file));
-
-  // Check if the log record type is broken
-  if (LoggingUtil::IsFileTruncated(cur_file_handle, 1)) {
-    LOG_TRACE("Log file is truncated, should open next log file");
-    is_truncated = true;
-  }
-
-  // Otherwise, read the log record type
-  if (!is_truncated) {
-    ret = fread((void *)&buffer, 1, sizeof(char), cur_file_handle.file);
-    if (ret <= 0) {
-      LOG_TRACE("Failed an fread");
-    }
-  }
-  if (is_truncated || ret <= 0) {
-    LOG_TRACE("Call OpenNextLogFile");
-    OpenNextLogFile();
-    if (cur_file_handle.fd == -1) return LOGRECORD_TYPE_INVALID;
-
-    LOG_TRACE("Open succeeded. log_file_fd is %d", (int)cur_file_handle.fd);
+/**
+ * @brief Get the next valid log record, moving on to the next log file when
+ * the current one is exhausted
+ * @param record view of the log record
+ * @return false at the end of the log or at the first torn record
+ */
+bool WriteAheadFrontendLogger::GetNextLogRecordForRecovery(
+    LogRecordView &record) {
+  while (true) {
+    if (recovery_readers_.empty() == false) {
+      auto &reader = recovery_readers_.back();
+      if (reader->Next(record)) {
+        return true;
+      }
 
-    if (LoggingUtil::IsFileTruncated(cur_file_handle, 1)) {
-      LOG_ERROR("Log file is truncated");
-      return LOGRECORD_TYPE_INVALID;
+      // Nothing after a torn record can be trusted
+      if (reader->IsTornTail()) {
+        LOG_ERROR("Log file %d is torn at offset %lu, stopping recovery",
+                  (int)log_files_[log_file_cursor_ - 1]->GetLogNumber(),
+                  reader->GetPosition());
+        return false;
+      }
     }
 
-    LOG_TRACE("File is not truncated.");
-    ret = fread((void *)&buffer, 1, sizeof(char), cur_file_handle.file);
-    if (ret <= 0) {
-      LOG_ERROR("Could not read from log file");
-      return LOGRECORD_TYPE_INVALID;
+    if (OpenNextLogFile() == false) {
+      return false;
     }
-    LOG_TRACE("fread succeeded.");
-  } else {
-    LOG_TRACE("fread succeeded.");
   }
-
-  CopySerializeInputBE input(&buffer, sizeof(char));
-  LogRecordType log_record_type = (LogRecordType)(input.ReadEnumInSingleByte());
-
-  return log_record_type;
 }
 
 std::string WriteAheadFrontendLogger::GetLogFileName(void) {
@@ -965,79 +927,30 @@ bool WriteAheadFrontendLogger::FileSwitchCondIsTrue() {
          LogManager::GetInstance().GetLogFileSizeLimit() * 1024;
 }
 
-void WriteAheadFrontendLogger::OpenNextLogFile() {
-  cid_t temp_max_log_id_file, temp_max_delimiter_file;
-
-  if (log_files_.size() == 0) {  // no log files, fresh start
-    LOG_TRACE("Size of log files list is 0.");
-    cur_file_handle = INVALID_FILE_HANDLE;
-    return;
-  }
-
+bool WriteAheadFrontendLogger::OpenNextLogFile() {
   if (this->log_file_cursor_ >= (int)this->log_files_.size()) {
     LOG_TRACE("Cursor has reached the end. No more log files to read from.");
-    fclose(cur_file_handle.file);
-    cur_file_handle = INVALID_FILE_HANDLE;
-    return;
-  }
-
-  if (log_file_cursor_ != 0)  // close old file
-  {
-    LOG_TRACE("Closing last opened file");
-    fclose(cur_file_handle.file);
-  }
-
-  // open the next file
-  cur_file_handle.file =
-      fopen(GetFileNameFromVersion(log_files_[log_file_cursor_]->GetLogNumber())
-                .c_str(),
-            "rb");
-
-  if (cur_file_handle.file == NULL) {
-    LOG_ERROR("Couldn't open next log file");
-    cur_file_handle = INVALID_FILE_HANDLE;
-    return;
-  } else {
-    LOG_TRACE("Opened new log file for recovery");
+    return false;
   }
 
-  cur_file_handle.fd = fileno(cur_file_handle.file);
-
-  LOG_TRACE("FD of opened file is %d", (int)cur_file_handle.fd);
+  std::string file_name =
+      GetFileNameFromVersion(log_files_[log_file_cursor_]->GetLogNumber());
 
-  // Skip first 8 bytes of max commit id
-  size_t read_size =
-      fread((void *)&temp_max_log_id_file, sizeof(temp_max_log_id_file), 1,
-            cur_file_handle.file);
-  if (read_size != 1) {
-    LOG_ERROR("Read failed after opening file %s",
-              GetFileNameFromVersion(
-                  log_files_[log_file_cursor_]->GetLogNumber()).c_str());
+  // Skip the max commit id and the max delimiter at the start of the file
+  std::unique_ptr<LogReader> reader(new LogReader());
+  if (reader->Open(file_name, sizeof(cid_t) * 2) == false) {
+    LOG_ERROR("Couldn't open next log file %s", file_name.c_str());
+    return false;
   }
 
-  LOG_TRACE("On startup: MaxLogId of this file is %d",
-            (int)temp_max_log_id_file);
-
-  // Skip next 8 bytes of max delimiter
-  read_size = fread((void *)&temp_max_delimiter_file,
-                    sizeof(temp_max_delimiter_file), 1, cur_file_handle.file);
-
-  if (read_size != 1) {
-    LOG_ERROR("Read failed after opening file %s",
-              GetFileNameFromVersion(
-                  log_files_[log_file_cursor_]->GetLogNumber()).c_str());
-  }
+  LOG_TRACE("Mapped log file %s for recovery", file_name.c_str());
 
-  LOG_TRACE("On startup: MaxDelimiter of this file is %d",
-            (int)temp_max_delimiter_file);
-
-  struct stat stat_buf;
-
-  fstat(cur_file_handle.fd, &stat_buf);
-  cur_file_handle.size = stat_buf.st_size;
+  // The reader stays open until its records are replayed
+  recovery_readers_.push_back(std::move(reader));
 
   log_file_cursor_++;
   LOG_TRACE("Cursor is now %d", (int)log_file_cursor_);
+  return true;
 }
 
 void WriteAheadFrontendLogger::TruncateLog(cid_t truncate_log_id) {
@@ -1083,94 +996,54 @@ std::string WriteAheadFrontendLogger::GetFileNameFromVersion(int version) {
 std::pair<cid_t, cid_t>
 WriteAheadFrontendLogger::ExtractMaxLogIdAndMaxDelimFromLogFileRecords(
     FILE *log_file) {
-  bool reached_end_of_file = false;
-  struct stat log_stats;
   cid_t max_log_id_so_far = 0, max_delim_so_far = 0;
-  FileHandle file_handle;
-
-  file_handle.file = log_file;
-  file_handle.fd = fileno(log_file);
 
-  fstat(file_handle.fd, &log_stats);
-  file_handle.size = log_stats.st_size;
-
-  while (reached_end_of_file == false) {
-    // Read the first byte to identify log record type
-    // If that is not possible, then wrap up recovery
-    auto record_type = LoggingUtil::GetNextLogRecordType(file_handle);
+  // Records start right after the max log id and the max delimiter
+  LogReader reader;
+  if (reader.Open(fileno(log_file), sizeof(cid_t) * 2) == false) {
+    return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
+  }
 
+  LogRecordView record;
+  while (reader.Next(record)) {
+    ReferenceSerializeInputBE record_header(record.header,
+                                            record.header_length);
     cid_t commit_id = INVALID_CID;
 
-    TupleRecord *tuple_record;
-
-    switch (record_type) {
+    switch (record.type) {
       case LOGRECORD_TYPE_TRANSACTION_BEGIN:
       case LOGRECORD_TYPE_TRANSACTION_COMMIT:
       case LOGRECORD_TYPE_ITERATION_DELIMITER: {
-        // Check for torn log write
-        TransactionRecord txn_rec(record_type);
-        if (LoggingUtil::ReadTransactionRecordHeader(txn_rec, file_handle) ==
-            false) {
-          return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
-        }
+        TransactionRecord txn_rec(record.type);
+        txn_rec.Deserialize(record_header);
         commit_id = txn_rec.GetTransactionId();
-        if (commit_id > max_log_id_so_far) max_log_id_so_far = commit_id;
 
-        if (record_type == LOGRECORD_TYPE_ITERATION_DELIMITER) {
+        if (record.type == LOGRECORD_TYPE_ITERATION_DELIMITER) {
           if (commit_id > max_delim_so_far) max_delim_so_far = commit_id;
         }
         break;
       }
       case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
-      case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
-        tuple_record = new TupleRecord(record_type);
-
-        if (LoggingUtil::ReadTupleRecordHeader(*tuple_record, file_handle) ==
-            false) {
-          LOG_ERROR("Could not read tuple record header.");
-          delete tuple_record;
-          return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
-        }
-
-        auto cid = tuple_record->GetTransactionId();
-
-        if (cid > max_log_id_so_far) max_log_id_so_far = cid;
-
-        auto table = LoggingUtil::GetTable(*tuple_record);
-        if (!table) {
-          LoggingUtil::SkipTupleRecordBody(file_handle);
-          delete tuple_record;
-          continue;
-        }
-
-        // Read off the tuple record body from the log
-        auto record_body = LoggingUtil::ReadTupleRecordBody(
-            table->GetSchema(), recovery_pool, file_handle);
-        delete tuple_record;
-        delete record_body;
-
-        break;
-      }
+      case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
       case LOGRECORD_TYPE_WAL_TUPLE_DELETE: {
-        tuple_record = new TupleRecord(record_type);
-
-        if (LoggingUtil::ReadTupleRecordHeader(*tuple_record, file_handle) ==
-            false) {
-          delete tuple_record;
-          return std::pair<cid_t, cid_t>(UINT64_MAX, UINT64_MAX);
-        }
-
-        auto cid = tuple_record->GetTransactionId();
-
-        if (cid > max_log_id_so_far) max_log_id_so_far = cid;
-        delete tuple_record;
+        // The body is skipped without being deserialized
+        TupleRecord tuple_record(record.type);
+        tuple_record.DeserializeHeader(record_header);
+        commit_id = tuple_record.GetTransactionId();
         break;
       }
       default:
-        reached_end_of_file = true;
         break;
     }
+
+    if (commit_id > max_log_id_so_far) max_log_id_so_far = commit_id;
   }
+
+  // Only the records before a torn write are ever replayed
+  if (reader.IsTornTail()) {
+    LOG_ERROR("Log file is torn at offset %lu", reader.GetPosition());
+  }
+
   return std::pair<cid_t, cid_t>(max_log_id_so_far, max_delim_so_far);
 }
 
@@ -12,72 +12,133 @@
 
 
 #include <iostream>
+#include <map>
 
 #include "logging/records/tuple_record.h"
 #include "logging/records/transaction_record.h"
 #include "logging/log_manager.h"
 #include "logging/frontend_logger.h"
 #include "logging/loggers/wbl_backend_logger.h"
+#include "catalog/manager.h"
+#include "storage/storage_manager.h"
+#include "storage/tile_group.h"
 
 namespace peloton {
 namespace logging {
 
+WriteBehindBackendLogger::~WriteBehindBackendLogger() {
+  // The frontend logger cannot collect our ranges once we are gone
+  dirty_ranges_lock_.Lock();
+  PersistDirtyRanges(finished_dirty_ranges_);
+  finished_dirty_ranges_.clear();
+  dirty_ranges_lock_.Unlock();
+}
+
 void WriteBehindBackendLogger::Log(LogRecord *record) {
-  // if we are committing, sync all data before taking the lock
-  if (record->GetType() == LOGRECORD_TYPE_TRANSACTION_COMMIT) {
-    SyncDataForCommit();
-  }
-  log_buffer_lock.Lock();
   switch (record->GetType()) {
     case LOGRECORD_TYPE_TRANSACTION_COMMIT:
-      highest_logged_commit_message = record->GetTransactionId();
+    case LOGRECORD_TYPE_TRANSACTION_ABORT: {
+      // Hand the dirty slots over to the frontend logger before the commit
+      // becomes visible to it, it persists them along with the other
+      // transactions of the group
+      if (txn_dirty_ranges_.empty() == false) {
+        dirty_ranges_lock_.Lock();
+        for (auto &entry : txn_dirty_ranges_) {
+          MergeDirtyRange(finished_dirty_ranges_, entry.first,
+                          entry.second.first, entry.second.second);
+        }
+        dirty_ranges_lock_.Unlock();
+        txn_dirty_ranges_.clear();
+      }
+      if (record->GetType() == LOGRECORD_TYPE_TRANSACTION_COMMIT) {
+        highest_logged_commit_message.store(record->GetTransactionId());
+      }
+    }
     // fallthrough
-    case LOGRECORD_TYPE_TRANSACTION_ABORT:
     case LOGRECORD_TYPE_TRANSACTION_BEGIN:
     case LOGRECORD_TYPE_TRANSACTION_DONE:
     case LOGRECORD_TYPE_TRANSACTION_END: {
-      if (logging_cid_lower_bound < record->GetTransactionId() - 1) {
-        logging_cid_lower_bound = record->GetTransactionId() - 1;
+      if (logging_cid_lower_bound.load() < record->GetTransactionId() - 1) {
+        logging_cid_lower_bound.store(record->GetTransactionId() - 1);
       }
       break;
     }
     case LOGRECORD_TYPE_WBL_TUPLE_DELETE: {
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetDeleteLocation().block);
+      AddDirtySlot(((TupleRecord *)record)->GetDeleteLocation());
       break;
     }
     case LOGRECORD_TYPE_WBL_TUPLE_INSERT: {
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetInsertLocation().block);
+      AddDirtySlot(((TupleRecord *)record)->GetInsertLocation());
       break;
     }
     case LOGRECORD_TYPE_WBL_TUPLE_UPDATE: {
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetDeleteLocation().block);
-      tile_groups_to_sync_.insert(
-          ((TupleRecord *)record)->GetInsertLocation().block);
+      AddDirtySlot(((TupleRecord *)record)->GetDeleteLocation());
+      AddDirtySlot(((TupleRecord *)record)->GetInsertLocation());
       break;
     }
     default:
       LOG_INFO("Invalid log record type");
       break;
   }
+}
+
+void WriteBehindBackendLogger::AddDirtySlot(const ItemPointer &location) {
+  MergeDirtyRange(txn_dirty_ranges_, location.block, location.offset,
+                  location.offset + 1);
+}
+
+void WriteBehindBackendLogger::MergeDirtyRange(DirtyRangeMap &dirty_ranges,
+                                               oid_t tile_group_id,
+                                               oid_t begin_slot,
+                                               oid_t end_slot) {
+  auto itr = dirty_ranges.find(tile_group_id);
+  if (itr == dirty_ranges.end()) {
+    dirty_ranges[tile_group_id] = std::make_pair(begin_slot, end_slot);
+    return;
+  }
 
-  log_buffer_lock.Unlock();
+  // Slots are handed out in order, so one covering range per tile group is
+  // rarely much larger than the slots that were actually modified
+  auto &range = itr->second;
+  range.first = std::min(range.first, begin_slot);
+  range.second = std::max(range.second, end_slot);
 }
 
-void WriteBehindBackendLogger::SyncDataForCommit() {
+void WriteBehindBackendLogger::CollectDirtyRanges(DirtyRangeMap &dirty_ranges) {
+  dirty_ranges_lock_.Lock();
+  for (auto &entry : finished_dirty_ranges_) {
+    MergeDirtyRange(dirty_ranges, entry.first, entry.second.first,
+                    entry.second.second);
+  }
+  finished_dirty_ranges_.clear();
+  dirty_ranges_lock_.Unlock();
+}
+
+void WriteBehindBackendLogger::PersistDirtyRanges(
+    const DirtyRangeMap &dirty_ranges) {
+  if (dirty_ranges.empty()) {
+    return;
+  }
+
   auto &manager = catalog::Manager::GetInstance();
+  std::map<BackendType, std::vector<storage::SyncRange>> sync_ranges;
+
+  for (auto &entry : dirty_ranges) {
+    auto tile_group = manager.GetTileGroup(entry.first);
 
-  // Sync the tiles in the modified tile groups and their headers
-  for (oid_t tile_group_id : tile_groups_to_sync_) {
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    tile_group->Sync();
-    tile_group->GetHeader()->Sync();
+    // Nothing to persist if the tile group was dropped in the meantime
+    if (tile_group == nullptr) {
+      continue;
+    }
+
+    tile_group->GetSyncRanges(entry.second.first, entry.second.second,
+                              sync_ranges[tile_group->GetBackendType()]);
   }
 
-  // Clear the list of tile groups
-  tile_groups_to_sync_.clear();
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  for (auto &entry : sync_ranges) {
+    storage_manager.SyncBatch(entry.first, entry.second);
+  }
 }
 
 LogRecord *WriteBehindBackendLogger::GetTupleRecord(
@@ -27,7 +27,7 @@
 #include "logging/logging_util.h"
 #include "logging/log_manager.h"
 
-#define POSSIBLY_DIRTY_GRANT_SIZE 10000000;  // ten million seems reasonable
+#define POSSIBLY_DIRTY_GRANT_SIZE 10000000  // ten million seems reasonable
 
 namespace peloton {
 namespace logging {
@@ -79,24 +79,47 @@ WriteBehindFrontendLogger::~WriteBehindFrontendLogger() {
 //===--------------------------------------------------------------------===//
 
 /**
- * @brief flush all log records to the file
+ * @brief persist the data of the collected transactions and then the record
+ * that covers their commit ids
  */
 void WriteBehindFrontendLogger::FlushLogRecords(void) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  // Group commit: the tile data modified by every transaction collected in
+  // this round is persisted in one batch before the record is written
+  WriteBehindBackendLogger::DirtyRangeMap dirty_ranges;
+  backend_loggers_lock.Lock();
+  for (auto backend_logger : backend_loggers) {
+    static_cast<WriteBehindBackendLogger *>(backend_logger)
+        ->CollectDirtyRanges(dirty_ranges);
+  }
+  backend_loggers_lock.Unlock();
+
+  WriteBehindBackendLogger::PersistDirtyRanges(dirty_ranges);
+
+  // Nothing new to make durable and the grant is still far away, so the
+  // record and its fsync can wait for the next round
+  cid_t current_commit_id = txn_manager.GetCurrentCommitId();
+  cid_t grant_margin = POSSIBLY_DIRTY_GRANT_SIZE / 2;
+  if (max_collected_commit_id == max_flushed_commit_id &&
+      current_commit_id + grant_margin < max_granted_commit_id) {
+    return;
+  }
+
   struct WriteBehindLogRecord record;
   record.persistent_commit_id = max_collected_commit_id;
-  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
-  cid_t new_grant =
-      txn_manager.GetCurrentCommitId() + POSSIBLY_DIRTY_GRANT_SIZE;
+  cid_t new_grant = current_commit_id + POSSIBLY_DIRTY_GRANT_SIZE;
   // get current highest dispense commit id
   record.max_possible_dirty_commit_id = new_grant;
   if (!fwrite(&record, sizeof(WriteBehindLogRecord), 1, log_file)) {
     LOG_ERROR("Unable to write log record");
   }
 
-  // for now fsync every time because the cost is relatively low
-  if (fsync(log_file_fd)) {
+  // the record must reach the disk before anyone is told about it
+  if (fflush(log_file) || fsync(log_file_fd)) {
     LOG_ERROR("Unable to fsync log");
   }
+  fsync_count++;
 
   // inform backend loggers they can proceed if waiting for sync
   max_flushed_commit_id = max_collected_commit_id;
@@ -104,6 +127,7 @@ void WriteBehindFrontendLogger::FlushLogRecords(void) {
   manager.FrontendLoggerFlushed();
 
   // set new grant in txn_manager
+  max_granted_commit_id = new_grant;
   txn_manager.SetMaxGrantCid(new_grant);
 }
 
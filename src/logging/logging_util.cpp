@@ -68,77 +68,6 @@ size_t LoggingUtil::GetLogFileSize(FileHandle &file_handle) {
   return log_stats.st_size;
 }
 
-bool LoggingUtil::IsFileTruncated(FileHandle &file_handle,
-                                  size_t size_to_read) {
-  // Cache current position
-  size_t current_position = ftell(file_handle.file);
-
-  // Check if the actual file size is less than the expected file size
-  // Current position + frame length
-  if (current_position + size_to_read <= file_handle.size) {
-    return false;
-  } else {
-    fseek(file_handle.file, 0, SEEK_END);
-    return true;
-  }
-}
-
-size_t LoggingUtil::GetNextFrameSize(FileHandle &file_handle) {
-  size_t frame_size;
-  char buffer[sizeof(int32_t)];
-
-  // Check if the frame size is broken
-  if (LoggingUtil::IsFileTruncated(file_handle, sizeof(buffer))) {
-    return 0;
-  }
-
-  // Otherwise, read the frame size
-  size_t ret = fread(buffer, 1, sizeof(int32_t), file_handle.file);
-  if (ret <= 0) {
-    LOG_ERROR("Error occured in fread ");
-  }
-
-  // Read next 4 bytes as an integer
-  CopySerializeInputBE frameCheck(buffer, sizeof(buffer));
-  frame_size = (frameCheck.ReadInt()) + sizeof(buffer);
-
-  // Move back by 4 bytes
-  // So that tuple deserializer works later as expected
-  int res = fseek(file_handle.file, -sizeof(buffer), SEEK_CUR);
-  if (res == -1) {
-    LOG_ERROR("Error occured in fseek ");
-  }
-
-  // Check if the frame is broken
-  if (IsFileTruncated(file_handle, frame_size)) {
-    return 0;
-  }
-
-  return frame_size;
-}
-
-LogRecordType LoggingUtil::GetNextLogRecordType(FileHandle &file_handle) {
-  char buffer;
-
-  // Check if the log record type is broken
-  if (IsFileTruncated(file_handle, 1)) {
-    LOG_TRACE("Log file is truncated");
-    return LOGRECORD_TYPE_INVALID;
-  }
-
-  // Otherwise, read the log record type
-  int ret = fread((void *)&buffer, 1, sizeof(char), file_handle.file);
-  if (ret <= 0) {
-    LOG_ERROR("Could not read from log file");
-    return LOGRECORD_TYPE_INVALID;
-  }
-
-  CopySerializeInputBE input(&buffer, sizeof(char));
-  LogRecordType log_record_type = (LogRecordType)(input.ReadEnumInSingleByte());
-
-  return log_record_type;
-}
-
 int LoggingUtil::ExtractNumberFromFileName(const char *name) {
   std::string str(name);
   size_t start_index = str.find_first_of("0123456789");
@@ -150,93 +79,6 @@ int LoggingUtil::ExtractNumberFromFileName(const char *name) {
   return 0;
 }
 
-bool LoggingUtil::ReadTransactionRecordHeader(TransactionRecord &txn_record,
-                                              FileHandle &file_handle) {
-  // Check if frame is broken
-  auto header_size = GetNextFrameSize(file_handle);
-  if (header_size == 0) {
-    return false;
-  }
-
-  // Read header
-  char header[header_size];
-  size_t ret = fread(header, 1, header_size, file_handle.file);
-  if (ret <= 0) {
-    LOG_ERROR("Error occured in fread ");
-  }
-
-  CopySerializeInputBE txn_header(header, header_size);
-  txn_record.Deserialize(txn_header);
-
-  return true;
-}
-
-bool LoggingUtil::ReadTupleRecordHeader(TupleRecord &tuple_record,
-                                        FileHandle &file_handle) {
-  // Check if frame is broken
-  auto header_size = GetNextFrameSize(file_handle);
-  if (header_size == 0) {
-    LOG_ERROR("Header size is zero ");
-    return false;
-  }
-
-  // Read header
-  char header[header_size];
-  size_t ret = fread(header, 1, header_size, file_handle.file);
-  if (ret <= 0) {
-    LOG_ERROR("Error occured in fread");
-  }
-
-  CopySerializeInputBE tuple_header(header, header_size);
-  tuple_record.DeserializeHeader(tuple_header);
-
-  return true;
-}
-
-storage::Tuple *LoggingUtil::ReadTupleRecordBody(catalog::Schema *schema,
-                                                 VarlenPool *pool,
-                                                 FileHandle &file_handle) {
-  // Check if the frame is broken
-  size_t body_size = GetNextFrameSize(file_handle);
-  if (body_size == 0) {
-    LOG_ERROR("Body size is zero ");
-    return nullptr;
-  }
-
-  // Read Body
-  char body[body_size];
-  int ret = fread(body, 1, body_size, file_handle.file);
-  if (ret <= 0) {
-    LOG_ERROR("Error occured in fread ");
-  }
-
-  CopySerializeInputBE tuple_body(body, body_size);
-
-  // We create a tuple based on the message
-  storage::Tuple *tuple = new storage::Tuple(schema, true);
-  tuple->DeserializeFrom(tuple_body, pool);
-
-  return tuple;
-}
-
-void LoggingUtil::SkipTupleRecordBody(FileHandle &file_handle) {
-  // Check if the frame is broken
-  size_t body_size = GetNextFrameSize(file_handle);
-  if (body_size == 0) {
-    LOG_ERROR("Body size is zero ");
-  }
-
-  // Read Body
-  char body[body_size];
-  int ret = fread(body, 1, body_size, file_handle.file);
-  if (ret <= 0) {
-    LOG_ERROR("Error occured in fread ");
-  }
-
-  // TODO Is it necessary?
-  CopySerializeInputBE tuple_body(body, body_size);
-}
-
 // Wrappers
 storage::DataTable *LoggingUtil::GetTable(TupleRecord &tuple_record) {
   // Get db, table, schema to insert tuple
@@ -56,6 +56,8 @@ bool TupleRecord::Serialize(CopySerializeOutput &output) {
     }
   }
 
+  SerializeChecksum(output);
+
   message_length = output.Size();
   message = new char[message_length];
   PL_MEMCPY(message, output.Data(), message_length);
@@ -91,7 +93,7 @@ void TupleRecord::SerializeHeader(CopySerializeOutput &output) {
  * @brief Deserialize LogRecordHeader
  * @param input
  */
-void TupleRecord::DeserializeHeader(CopySerializeInputBE &input) {
+void TupleRecord::DeserializeHeader(SerializeInputBE &input) {
   input.ReadInt();
   db_oid = (oid_t)(input.ReadLong());
   PL_ASSERT(db_oid);
@@ -108,15 +110,20 @@ void TupleRecord::DeserializeHeader(CopySerializeInputBE &input) {
 // Used for write behind logging
 size_t TupleRecord::GetTupleRecordSize(void) {
   // log_record_type + header_legnth + db_oid + table_oid + txn_id +
-  // insert_location + delete_location
+  // insert_location + delete_location + checksum
   return sizeof(char) + sizeof(int) + sizeof(oid_t) + sizeof(oid_t) +
-         sizeof(txn_id_t) + sizeof(ItemPointer) * 2;
+         sizeof(txn_id_t) + sizeof(ItemPointer) * 2 + GetChecksumSize();
 }
 
 void TupleRecord::SetTuple(storage::Tuple *tuple) { this->tuple = tuple; }
 
 storage::Tuple *TupleRecord::GetTuple() { return tuple; }
 
+void TupleRecord::SetTupleBody(const char *body, size_t length) {
+  tuple_body = body;
+  tuple_body_length = length;
+}
+
 const std::string TupleRecord::GetInfo() const {
   std::ostringstream os;
 
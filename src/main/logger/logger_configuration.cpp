@@ -25,6 +25,9 @@ namespace peloton {
 namespace benchmark {
 namespace logger {
 
+// tmpfs mount used to emulate NVM when there is no NVM file system
+#define EMULATED_NVM_DIR "/dev/shm/"
+
 void Usage(FILE* out) {
   fprintf(out,
           "Command line options :  logger <options> \n"
@@ -93,6 +96,8 @@ std::string ExperimentTypeToString(ExperimentType type) {
       return "STORAGE";
     case EXPERIMENT_TYPE_LATENCY:
       return "LATENCY";
+    case EXPERIMENT_TYPE_COMPARISON:
+      return "COMPARISON";
 
     default:
       LOG_ERROR("Invalid experiment_type :: %d", type);
@@ -142,7 +147,7 @@ static void ValidateDataFileSize(const configuration& state) {
 }
 
 static void ValidateExperimentType(const configuration& state) {
-  if (state.experiment_type < 0 || state.experiment_type > 4) {
+  if (state.experiment_type < 0 || state.experiment_type > 5) {
     LOG_ERROR("Invalid experiment_type :: %d", state.experiment_type);
     exit(EXIT_FAILURE);
   }
@@ -210,6 +215,11 @@ static void ValidateLogFileDir(configuration& state) {
       if (status == 0 && S_ISDIR(data_stat.st_mode)) {
         state.log_file_dir = NVM_DIR;
       }
+      // Emulate NVM on tmpfs
+      else if (stat(EMULATED_NVM_DIR, &data_stat) == 0 &&
+               S_ISDIR(data_stat.st_mode)) {
+        state.log_file_dir = EMULATED_NVM_DIR;
+      }
     } break;
 
     // Log file on SSD
@@ -90,6 +90,29 @@ static void WriteOutput(double value) {
   out.flush();
 }
 
+// Throughput of the last build, reported along with the restart time
+static double build_throughput = 0;
+
+// Comparison mode reports both numbers of one logging type on one line
+static void WriteComparisonOutput(double throughput, double restart_time) {
+  LOG_INFO("----------------------------------------------------------");
+  LOG_INFO("%s %s :: throughput %lf restart time (ms) %lf",
+           LoggingTypeToString(state.logging_type).c_str(),
+           state.log_file_dir.c_str(), throughput, restart_time);
+
+  out << state.benchmark_type << " ";
+  out << state.logging_type << " ";
+  out << ycsb::state.update_ratio << " ";
+  out << ycsb::state.scale_factor << " ";
+  out << ycsb::state.backend_count << " ";
+  out << ycsb::state.duration << " ";
+  out << state.flush_mode << " ";
+  out << state.asynchronous_mode << " ";
+  out << throughput << " ";
+  out << restart_time << "\n";
+  out.flush();
+}
+
 std::string GetFilePath(std::string directory_path, std::string file_name) {
   std::string file_path = directory_path;
 
@@ -287,6 +310,8 @@ bool PrepareLogFile() {
     WriteOutput(latency);
   }
 
+  build_throughput = throughput;
+
   return true;
 }
 
@@ -339,6 +364,8 @@ void DoRecovery() {
   // Recovery time (in ms)
   if (state.experiment_type == EXPERIMENT_TYPE_RECOVERY) {
     WriteOutput(timer.GetDuration());
+  } else if (state.experiment_type == EXPERIMENT_TYPE_COMPARISON) {
+    WriteComparisonOutput(build_throughput, timer.GetDuration());
   }
 }
 
@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// parserbench.cpp
+//
+// Identification: src/main/parserbench/parserbench.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/timer.h"
+#include "parser/peloton/abstract_parse.h"
+#include "parser/postgres_parser.h"
+
+//===--------------------------------------------------------------------===//
+// Parser Benchmark
+//
+// Parses the statements of the TPC-C transactions over and over, once
+// transforming the postgres nodes directly into our parse tree and once
+// serializing them to JSON on the way, and reports the time per statement
+// of both.
+//===--------------------------------------------------------------------===//
+
+namespace peloton {
+namespace benchmark {
+namespace parserbench {
+
+class configuration {
+ public:
+  // passes over the statement list
+  int round_count;
+};
+
+configuration state;
+
+// Statements issued by the TPC-C transactions
+static const std::vector<std::string> tpcc_statements = {
+    // New-Order
+    "SELECT w_tax FROM warehouse WHERE w_id = 1",
+    "SELECT d_tax, d_next_o_id FROM district WHERE d_id = 3 AND d_w_id = 1",
+    "UPDATE district SET d_next_o_id = 3002 WHERE d_id = 3 AND d_w_id = 1",
+    "SELECT c_discount, c_last, c_credit FROM customer "
+    "WHERE c_w_id = 1 AND c_d_id = 3 AND c_id = 1234",
+    "INSERT INTO orders (o_id, o_d_id, o_w_id, o_c_id, o_entry_d, "
+    "o_carrier_id, o_ol_cnt, o_all_local) "
+    "VALUES (3001, 3, 1, 1234, '2016-01-01 00:00:00', NULL, 10, 1)",
+    "INSERT INTO new_order (no_o_id, no_d_id, no_w_id) VALUES (3001, 3, 1)",
+    "SELECT i_price, i_name, i_data FROM item WHERE i_id = 4711",
+    "SELECT s_quantity, s_data, s_dist_03 FROM stock "
+    "WHERE s_i_id = 4711 AND s_w_id = 1",
+    "UPDATE stock SET s_quantity = 42, s_ytd = s_ytd + 5, "
+    "s_order_cnt = s_order_cnt + 1 WHERE s_i_id = 4711 AND s_w_id = 1",
+    // Payment
+    "UPDATE warehouse SET w_ytd = w_ytd + 100.50 WHERE w_id = 1",
+    "SELECT c_id, c_first, c_middle, c_last, c_balance FROM customer "
+    "WHERE c_w_id = 1 AND c_d_id = 3 AND c_last = 'BARBARBAR' "
+    "ORDER BY c_first",
+    "INSERT INTO history (h_c_d_id, h_c_w_id, h_c_id, h_d_id, h_w_id, "
+    "h_date, h_amount, h_data) "
+    "VALUES (3, 1, 1234, 3, 1, '2016-01-01 00:00:00', 100.50, 'payment')",
+    // Order-Status
+    "SELECT o_id, o_carrier_id, o_entry_d FROM orders "
+    "WHERE o_w_id = 1 AND o_d_id = 3 AND o_c_id = 1234 "
+    "ORDER BY o_id DESC LIMIT 1",
+    // Delivery
+    "SELECT no_o_id FROM new_order WHERE no_d_id = 3 AND no_w_id = 1 "
+    "AND no_o_id > -1 LIMIT 1",
+    "DELETE FROM new_order WHERE no_d_id = 3 AND no_w_id = 1 "
+    "AND no_o_id = 2101",
+    "SELECT SUM(ol_amount) FROM order_line "
+    "WHERE ol_o_id = 2101 AND ol_d_id = 3 AND ol_w_id = 1",
+    // Stock-Level, with the join split up as the parse tree takes one table
+    "SELECT ol_i_id FROM order_line WHERE ol_w_id = 1 AND ol_d_id = 3 "
+    "AND ol_o_id < 3001 AND ol_o_id >= 2981",
+    "SELECT COUNT(*) FROM stock "
+    "WHERE s_w_id = 1 AND s_i_id = 4711 AND s_quantity < 15"};
+
+void Usage(FILE *out) {
+  fprintf(out,
+          "Command line options : parserbench <options> \n"
+          "   -h --help              :  Print help message \n"
+          "   -r --round-count       :  # of passes (default: 10000) \n");
+}
+
+static struct option opts[] = {
+    {"round-count", optional_argument, NULL, 'r'}, {NULL, 0, NULL, 0}};
+
+void ParseArguments(int argc, char *argv[], configuration &state) {
+  state.round_count = 10000;
+
+  while (1) {
+    int idx = 0;
+    int c = getopt_long(argc, argv, "hr:", opts, &idx);
+
+    if (c == -1) break;
+
+    switch (c) {
+      case 'r':
+        state.round_count = atoi(optarg);
+        break;
+      case 'h':
+        Usage(stderr);
+        exit(EXIT_FAILURE);
+        break;
+      default:
+        LOG_ERROR("Unknown option: -%c-", c);
+        Usage(stderr);
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (state.round_count <= 0) {
+    LOG_ERROR("Invalid round_count");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "round_count", state.round_count);
+}
+
+// Time one way of parsing, in microseconds per statement
+template <typename ParseFunction>
+static double TimeParser(const char *name, ParseFunction parse) {
+  size_t tree_count = 0;
+
+  Timer<> timer;
+  timer.Start();
+  for (int round_itr = 0; round_itr < state.round_count; round_itr++) {
+    for (auto &statement : tpcc_statements) {
+      auto parse_tree = parse(statement);
+      if (parse_tree.get() != nullptr) tree_count++;
+    }
+  }
+  timer.Stop();
+
+  double statement_count =
+      static_cast<double>(state.round_count) * tpcc_statements.size();
+  double usec_per_statement = timer.GetDuration() * 1e6 / statement_count;
+
+  LOG_INFO("%-6s : %.0lf statements in %.3lf s, %.3lf us per statement "
+           "(%lu parse trees)",
+           name, statement_count, timer.GetDuration(), usec_per_statement,
+           tree_count);
+  return usec_per_statement;
+}
+
+void RunBenchmark() {
+  auto &parser = parser::PostgresParser::GetInstance();
+
+  // Warm up the memory contexts of the parser
+  for (auto &statement : tpcc_statements) {
+    parser.BuildParseTree(statement);
+  }
+
+  double json_time = TimeParser("json", [&parser](const std::string &query) {
+    return parser.BuildParseTreeViaJson(query);
+  });
+
+  double direct_time =
+      TimeParser("direct", [&parser](const std::string &query) {
+        return parser.BuildParseTree(query);
+      });
+
+  LOG_INFO("Direct transformation speedup : %.2lfx",
+           json_time / direct_time);
+}
+
+}  // namespace parserbench
+}  // namespace benchmark
+}  // namespace peloton
+
+int main(int argc, char **argv) {
+  peloton::benchmark::parserbench::ParseArguments(
+      argc, argv, peloton::benchmark::parserbench::state);
+
+  peloton::benchmark::parserbench::RunBenchmark();
+
+  return 0;
+}
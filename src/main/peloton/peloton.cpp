@@ -13,14 +13,20 @@
 
 #include <unistd.h>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
-#include "wire/socket_base.h"
-#include "wire/wire.h"
+#include "wire/reactor_server.h"
 #include "common/stack_trace.h"
 #include "common/init.h"
+#include "logging/log_shipper.h"
+#include "networking/rpc_server.h"
+#include "networking/peloton_service.h"
 
 DECLARE_bool(help);
 DECLARE_bool(h);
+DECLARE_uint64(rpc_port);
+DECLARE_string(replicas);
 
 // Peloton process begins execution here.
 int main(int argc, char *argv[]) {
@@ -35,14 +41,33 @@ int main(int argc, char *argv[]) {
   // Setup
   peloton::PelotonInit::Initialize();
 
+  // Serve log shipping (and the other rpcs) when an rpc port is given
+  if (FLAGS_rpc_port != 0) {
+    std::thread rpc_thread([] {
+      peloton::networking::RpcServer rpc_server(FLAGS_rpc_port);
+      peloton::networking::PelotonService service;
+      rpc_server.RegisterService(&service);
+      rpc_server.Start();
+    });
+    rpc_thread.detach();
+
+    std::stringstream replicas(FLAGS_replicas);
+    std::string replica;
+    while (std::getline(replicas, replica, ',')) {
+      if (replica.empty() == false) {
+        peloton::logging::LogShipper::GetInstance().AddSubscriber(replica);
+      }
+    }
+  }
+
   // Setup signal handlers
   //peloton::RegisterSignalHandlers();
 
   // Launch server
   peloton::wire::Server server;
   peloton::wire::StartServer(&server);
-  peloton::wire::HandleConnections<peloton::wire::PacketManager,
-                                   peloton::wire::PktBuf>(&server);
+  peloton::wire::ReactorServer reactor_server(&server);
+  reactor_server.HandleConnections();
 
 
 
@@ -0,0 +1,282 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// wirebench.cpp
+//
+// Identification: src/main/wirebench/wirebench.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/timer.h"
+
+//===--------------------------------------------------------------------===//
+// Wire Benchmark
+//
+// Opens a large number of connections against a running server, performs the
+// startup handshake on all of them and then keeps them open while doing
+// rounds of Sync messages over every connection. Meant to show that the
+// server holds thousands of idle clients without a thread per client.
+//===--------------------------------------------------------------------===//
+
+namespace peloton {
+namespace benchmark {
+namespace wirebench {
+
+class configuration {
+ public:
+  // number of connections held open
+  int connection_count;
+
+  // server address
+  std::string host;
+  int port;
+
+  // rounds of Sync over every connection
+  int round_count;
+};
+
+configuration state;
+
+void Usage(FILE *out) {
+  fprintf(out,
+          "Command line options : wirebench <options> \n"
+          "   -h --help              :  Print help message \n"
+          "   -c --connection-count  :  # of connections (default: 5000) \n"
+          "   -a --host              :  Server address (default: 127.0.0.1) \n"
+          "   -p --port              :  Server port (default: 5432) \n"
+          "   -r --round-count       :  # of Sync rounds (default: 10) \n");
+}
+
+static struct option opts[] = {
+    {"connection-count", optional_argument, NULL, 'c'},
+    {"host", optional_argument, NULL, 'a'},
+    {"port", optional_argument, NULL, 'p'},
+    {"round-count", optional_argument, NULL, 'r'},
+    {NULL, 0, NULL, 0}};
+
+void ParseArguments(int argc, char *argv[], configuration &state) {
+  state.connection_count = 5000;
+  state.host = "127.0.0.1";
+  state.port = 5432;
+  state.round_count = 10;
+
+  while (1) {
+    int idx = 0;
+    int c = getopt_long(argc, argv, "hc:a:p:r:", opts, &idx);
+
+    if (c == -1) break;
+
+    switch (c) {
+      case 'c':
+        state.connection_count = atoi(optarg);
+        break;
+      case 'a':
+        state.host = optarg;
+        break;
+      case 'p':
+        state.port = atoi(optarg);
+        break;
+      case 'r':
+        state.round_count = atoi(optarg);
+        break;
+      case 'h':
+        Usage(stderr);
+        exit(EXIT_FAILURE);
+        break;
+      default:
+        LOG_ERROR("Unknown option: -%c-", c);
+        Usage(stderr);
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (state.connection_count <= 0 || state.round_count < 0) {
+    LOG_ERROR("Invalid connection_count or round_count");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "connection_count", state.connection_count);
+  LOG_INFO("%s : %s:%d", "server", state.host.c_str(), state.port);
+  LOG_INFO("%s : %d", "round_count", state.round_count);
+}
+
+static bool WriteAll(int fd, const std::vector<unsigned char> &buf) {
+  size_t written = 0;
+  while (written < buf.size()) {
+    ssize_t ret = write(fd, buf.data() + written, buf.size() - written);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) return false;
+    written += ret;
+  }
+  return true;
+}
+
+static bool ReadAll(int fd, unsigned char *buf, size_t len) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t ret = read(fd, buf + done, len - done);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) return false;
+    done += ret;
+  }
+  return true;
+}
+
+static void PutInt(std::vector<unsigned char> &buf, uint32_t value) {
+  value = htonl(value);
+  auto bytes = reinterpret_cast<unsigned char *>(&value);
+  buf.insert(buf.end(), bytes, bytes + sizeof(value));
+}
+
+// Skip messages until the server reports ReadyForQuery
+static bool WaitForReady(int fd) {
+  std::vector<unsigned char> body;
+  for (;;) {
+    unsigned char header[5];
+    if (ReadAll(fd, header, sizeof(header)) == false) return false;
+
+    uint32_t len;
+    memcpy(&len, header + 1, sizeof(len));
+    len = ntohl(len) - sizeof(len);
+
+    body.resize(len);
+    if (len > 0 && ReadAll(fd, body.data(), len) == false) return false;
+
+    if (header[0] == 'Z') return true;
+  }
+}
+
+static int Connect(const configuration &state) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(state.port);
+  inet_pton(AF_INET, state.host.c_str(), &addr.sin_addr);
+
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  int yes = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+  // startup packet: length, protocol 3.0 and the user
+  std::vector<unsigned char> body;
+  PutInt(body, 3 << 16);
+  for (auto token : {"user", "postgres", "database", "postgres", ""}) {
+    body.insert(body.end(), token, token + strlen(token) + 1);
+  }
+
+  std::vector<unsigned char> pkt;
+  PutInt(pkt, body.size() + sizeof(uint32_t));
+  pkt.insert(pkt.end(), body.begin(), body.end());
+
+  if (WriteAll(fd, pkt) == false) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+// Every connection is a descriptor on this side as well
+static void RaiseDescriptorLimit() {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+void RunBenchmark() {
+  RaiseDescriptorLimit();
+
+  std::vector<int> fds;
+  fds.reserve(state.connection_count);
+
+  // Open all connections first, then finish their handshakes
+  Timer<> timer;
+  timer.Start();
+  for (int conn_itr = 0; conn_itr < state.connection_count; conn_itr++) {
+    int fd = Connect(state);
+    if (fd < 0) {
+      LOG_ERROR("Could only open %lu connections : %s", fds.size(),
+                strerror(errno));
+      break;
+    }
+    fds.push_back(fd);
+  }
+
+  size_t ready_count = 0;
+  for (auto fd : fds) {
+    if (WaitForReady(fd)) ready_count++;
+  }
+  timer.Stop();
+
+  LOG_INFO("Connected %lu clients (%lu ready) in %.3lf s", fds.size(),
+           ready_count, timer.GetDuration());
+
+  // Pipeline one Sync per connection, then collect the replies
+  std::vector<unsigned char> sync_pkt = {'S'};
+  PutInt(sync_pkt, sizeof(uint32_t));
+
+  timer.Reset();
+  timer.Start();
+  size_t reply_count = 0;
+  for (int round_itr = 0; round_itr < state.round_count; round_itr++) {
+    for (auto fd : fds) {
+      WriteAll(fd, sync_pkt);
+    }
+    for (auto fd : fds) {
+      if (WaitForReady(fd)) reply_count++;
+    }
+  }
+  timer.Stop();
+
+  double duration = timer.GetDuration();
+  LOG_INFO("%lu Sync round trips in %.3lf s :: %.1lf per second", reply_count,
+           duration, duration > 0 ? reply_count / duration : 0);
+
+  // Terminate
+  std::vector<unsigned char> terminate_pkt = {'X'};
+  PutInt(terminate_pkt, sizeof(uint32_t));
+  for (auto fd : fds) {
+    WriteAll(fd, terminate_pkt);
+    close(fd);
+  }
+}
+
+}  // namespace wirebench
+}  // namespace benchmark
+}  // namespace peloton
+
+int main(int argc, char **argv) {
+  peloton::benchmark::wirebench::ParseArguments(
+      argc, argv, peloton::benchmark::wirebench::state);
+
+  peloton::benchmark::wirebench::RunBenchmark();
+
+  return 0;
+}
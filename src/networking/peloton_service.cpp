@@ -19,9 +19,13 @@
 #include "common/serializer.h"
 #include "common/macros.h"
 #include "storage/tile.h"
+#include "storage/tile_group_evictor.h"
 #include "storage/tuple.h"
-#include "planner/seq_scan_plan.h"
-#include "executor/plan_executor.h"
+#include "common/pool.h"
+#include "planner/abstract_plan.h"
+#include "networking/plan_stream.h"
+#include "logging/log_replayer.h"
+#include "logging/log_shipper.h"
 
 #include <unistd.h>
 #include <signal.h>
@@ -276,14 +280,31 @@ void PelotonService::Heartbeat(::google::protobuf::RpcController* controller,
 
 void PelotonService::UnevictData(
     ::google::protobuf::RpcController* controller,
-    UNUSED_ATTRIBUTE const UnevictDataRequest* request,
-    UNUSED_ATTRIBUTE UnevictDataResponse* response,
+    const UnevictDataRequest* request, UnevictDataResponse* response,
     ::google::protobuf::Closure* done) {
   if (controller->Failed()) {
     std::string error = controller->ErrorText();
     LOG_TRACE("PelotonService with controller failed:%s ", error.c_str());
   }
 
+  // The blocks are tile groups, they are read back in the background so
+  // that the transaction finds them in memory when it is restarted
+  if (request != NULL) {
+    LOG_TRACE("Unevict %d tile groups of table %d for txn %ld",
+              request->block_ids_size(), request->table_id(),
+              request->new_transaction_id());
+
+    auto &evictor = storage::TileGroupEvictor::GetInstance();
+    for (auto block_id : request->block_ids()) {
+      evictor.RequestFaultIn(static_cast<oid_t>(block_id));
+    }
+
+    response->set_sender_site(request->sender_site());
+    response->set_status(OK);
+    response->set_transaction_id(request->transaction_id());
+    response->set_partition_id(request->partition_id());
+  }
+
   // if callback exist, run it
   if (done) {
     done->Run();
@@ -306,8 +327,11 @@ void PelotonService::TimeSync(::google::protobuf::RpcController* controller,
 }
 
 /*
- * This a QueryPlan Processing function. It is a framework right now. Different
- * query type can be added.
+ * QueryPlan runs a plan tree shipped by another site and streams its results
+ * back: every response carries the next chunk of serialized tiles, and as
+ * long as has_more is set the client fetches the next one with the query id.
+ * Only trees of SeqScan (without a predicate) and Limit nodes can be shipped,
+ * see AbstractPlan::SerializeTree. Any other plan fails with tuple_count -1.
  */
 void PelotonService::QueryPlan(::google::protobuf::RpcController* controller,
                                const QueryPlanExecRequest* request,
@@ -322,87 +346,65 @@ void PelotonService::QueryPlan(::google::protobuf::RpcController* controller,
   // If request is not null, this is a rpc  call, server should handle the
   // reqeust
   if (request != NULL) {
-    LOG_TRACE("Received a queryplan");
-
-    if (!request->has_plan_type()) {
-      LOG_ERROR("Queryplan recived desen't have type");
-      return;
-    }
-
-    // construct parameter list
-    int param_num = request->param_num();
-    std::string param_list = request->param_list();
-    ReferenceSerializeInputBE param_input(param_list.c_str(),
-                                          param_list.size());
-    std::vector<Value> params;
-    for (int it = 0; it < param_num; it++) {
-      // TODO: Make sure why varlen_pool is used as parameter
-      std::shared_ptr<VarlenPool> pool(new VarlenPool(BACKEND_TYPE_MM));
-      Value value_item;
-      value_item.DeserializeFromAllocateForStorage(param_input, pool.get());
-      params.push_back(value_item);
-    }
-
-    // construct TupleDesc
-    // std::unique_ptr<tupleDesc> tuple_desc =
-    // ParseTupleDescMsg(request->tuple_dec());
-
-    PlanNodeType plan_type = static_cast<PlanNodeType>(request->plan_type());
-
-    // TODO: We can add more plan type in this switch to process
-    switch (plan_type) {
-      case PLAN_NODE_TYPE_INVALID: {
-        LOG_ERROR("Queryplan recived desen't have type");
-        break;
+    auto& plan_stream_manager = PlanStreamManager::GetInstance();
+    std::unique_ptr<PlanStream> plan_stream;
+    int64_t query_id;
+
+    if (request->has_query_id()) {
+      // A query that is already running
+      query_id = request->query_id();
+      plan_stream = plan_stream_manager.Take(query_id);
+      if (plan_stream == nullptr) {
+        LOG_ERROR("Queryplan received for unknown query %ld",
+                  static_cast<long>(query_id));
+      } else if (request->cancel()) {
+        LOG_TRACE("Query %ld canceled", static_cast<long>(query_id));
+        plan_stream.reset();
+      }
+    } else {
+      LOG_TRACE("Received a queryplan");
+      query_id = plan_stream_manager.GetNextQueryId();
+
+      // The varlen data of all the parameters goes into one pool that lives
+      // as long as the query
+      std::unique_ptr<VarlenPool> pool(new VarlenPool(BACKEND_TYPE_MM));
+      int param_num = request->param_num();
+      const std::string& param_list = request->param_list();
+      ReferenceSerializeInputBE param_input(param_list.c_str(),
+                                            param_list.size());
+      std::vector<Value> params;
+      params.reserve(param_num);
+      for (int it = 0; it < param_num; it++) {
+        Value value_item;
+        value_item.DeserializeFromAllocateForStorage(param_input, pool.get());
+        params.push_back(value_item);
       }
 
-      case PLAN_NODE_TYPE_SEQSCAN: {
-        LOG_TRACE("SEQSCAN revieved");
-        std::string plan = request->plan();
-        ReferenceSerializeInputBE input(plan.c_str(), plan.size());
-        std::shared_ptr<peloton::planner::SeqScanPlan> ss_plan =
-            std::make_shared<peloton::planner::SeqScanPlan>();
-        ss_plan->DeserializeFrom(input);
-
-        std::vector<std::unique_ptr<executor::LogicalTile>> logical_tile_list;
-        int tuple_count = peloton::bridge::PlanExecutor::ExecutePlan(
-            ss_plan.get(), params, logical_tile_list);
-        // Return result
-        if (tuple_count < 0) {
-          // ExecutePlan fails
-          LOG_ERROR("ExecutePlan fails");
-          return;
-        }
-
-        // Set the basic metadata
-        response->set_tuple_count(tuple_count);
-        response->set_tile_count(logical_tile_list.size());
-
-        // Loop the logical_tile_list to set the response
-        std::vector<std::unique_ptr<executor::LogicalTile>>::iterator it;
-        for (it = logical_tile_list.begin(); it != logical_tile_list.end();
-             it++) {
-          // First materialize logicalTile to physical tile
-          std::unique_ptr<storage::Tile> tile = (*it)->Materialize();
-
-          // Then serialize physical tile
-          CopySerializeOutput output_tiles;
-          tile->SerializeTo(output_tiles, tile->GetActiveTupleCount());
-
-          // Finally set the response, which be automatically sent back
-          response->add_result(output_tiles.Data(), output_tiles.Size());
-
-          // Debug
-          LOG_TRACE("Tile content is: %s", tile->GetInfo().c_str());
-        }
-
-        break;
+      const std::string& plan = request->plan();
+      ReferenceSerializeInputBE plan_input(plan.c_str(), plan.size());
+      auto plan_tree = planner::AbstractPlan::DeserializeTree(plan_input);
+      if (plan_tree == nullptr) {
+        LOG_ERROR("Queryplan received can't be deserialized");
+      } else {
+        plan_stream.reset(
+            new PlanStream(std::move(plan_tree), params, std::move(pool)));
       }
+    }
 
-      default: {
-        LOG_ERROR("Queryplan recived :: Unsupported TYPE: %u ", plan_type);
-        break;
+    response->set_tuple_count(0);
+    if (plan_stream != nullptr) {
+      if (plan_stream->NextChunk(request->chunk_tuples(), response) ==
+          false) {
+        LOG_ERROR("ExecutePlan fails");
+        response->set_tuple_count(-1);
+      } else if (plan_stream->IsDone() == false) {
+        // the rest waits for the next fetch
+        response->set_query_id(query_id);
+        response->set_has_more(true);
+        plan_stream_manager.Park(query_id, std::move(plan_stream));
       }
+    } else if (request->cancel() == false) {
+      response->set_tuple_count(-1);
     }
 
     // If callback exist, run it
@@ -449,5 +451,51 @@ void PelotonService::QueryPlan(::google::protobuf::RpcController* controller,
   }
 }
 
+/*
+ * Log shipping: the primary sends durable WAL segments to its replicas, the
+ * replica replays them and acknowledges the sequence number it applied.
+ */
+void PelotonService::LogRecordReplay(
+    ::google::protobuf::RpcController* controller,
+    const LogRecordReplayRequest* request, LogRecordReplayResponse* response,
+    ::google::protobuf::Closure* done) {
+  if (controller->Failed()) {
+    std::string error = controller->ErrorText();
+    LOG_TRACE("PelotonService with controller failed:%s ", error.c_str());
+  }
+
+  // If request is not null, this is a rpc call, the replica replays the log
+  if (request != NULL) {
+    int logger_id = request->has_logger_id() ? request->logger_id() : 0;
+    LOG_TRACE("Received log segment %ld of logger %d",
+              (int64_t)request->sequence_number(), logger_id);
+
+    auto& log_replayer = logging::LogReplayer::GetInstance();
+    log_replayer.ReplayLogSegment(request->log(), request->sequence_number(),
+                                  logger_id);
+
+    // Acknowledge the last segment applied in sequence, for a rejected
+    // segment this tells the primary where to resend from
+    response->set_sequence_number(
+        log_replayer.GetReplayedSequenceNumber(logger_id));
+    response->set_logger_id(logger_id);
+
+    // If callback exist, run it
+    if (done) {
+      done->Run();
+    }
+  }
+  // Here is for the client callback for response
+  else {
+    PL_ASSERT(response);
+    int logger_id = response->has_logger_id() ? response->logger_id() : 0;
+    LOG_TRACE("Replica acknowledged log segment %ld of logger %d",
+              (int64_t)response->sequence_number(), logger_id);
+
+    logging::LogShipper::GetInstance().AcknowledgeLogSegment(
+        logger_id, response->sequence_number());
+  }
+}
+
 }  // namespace networking
 }  // namespace peloton
@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_stream.cpp
+//
+// Identification: src/networking/plan_stream.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "networking/plan_stream.h"
+
+#include "peloton/proto/abstract_service.pb.h"
+
+#include "catalog/schema.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "common/pool.h"
+#include "executor/logical_tile.h"
+#include "planner/abstract_plan.h"
+#include "storage/tile.h"
+
+namespace peloton {
+namespace networking {
+
+//===--------------------------------------------------------------------===//
+// Plan Stream
+//===--------------------------------------------------------------------===//
+
+PlanStream::PlanStream(std::unique_ptr<planner::AbstractPlan> plan,
+                       const std::vector<Value> &params,
+                       std::unique_ptr<VarlenPool> pool)
+    : pool_(std::move(pool)),
+      plan_(std::move(plan)),
+      execution_(plan_.get(), params) {}
+
+bool PlanStream::NextChunk(size_t max_tuples,
+                           QueryPlanExecResponse *response) {
+  response_ = response;
+  max_tuples_ = max_tuples;
+  chunk_tuple_count_ = 0;
+  chunk_size_ = 0;
+
+  int processed = execution_.Run(*this);
+  response_ = nullptr;
+
+  response->set_tuple_count(static_cast<int>(chunk_tuple_count_));
+  response->set_tile_count(response->result_size());
+
+  if (processed < 0) {
+    done_ = true;
+    return false;
+  }
+
+  done_ = (execution_.IsSuspended() == false);
+  return true;
+}
+
+/**
+ * Every tile goes out as in Tile::SerializeTo:
+ * [(int) total size]
+ * [(int) header size] [num columns] [column types] [column names]
+ * [(int) num tuples] [tuple data]
+ */
+bool PlanStream::Consume(std::unique_ptr<executor::LogicalTile> &tile) {
+  PL_ASSERT(response_ != nullptr);
+
+  if (column_header_.empty()) {
+    SerializeHeader(tile.get());
+  }
+
+  output_.Reset();
+  output_.WriteInt(-1);
+  output_.WriteBytes(column_header_.data(), column_header_.size());
+  size_t tuple_count_position = output_.ReserveBytes(sizeof(int32_t));
+
+  int column_count = tile->GetColumnCount();
+  int tuple_count = 0;
+  std::vector<oid_t> sent_tuples;
+  bool full = false;
+  for (oid_t tuple_id : *tile) {
+    // The first tuple of a chunk always goes, however large
+    bool chunk_full =
+        (max_tuples_ > 0 && chunk_tuple_count_ == max_tuples_) ||
+        (chunk_tuple_count_ > 0 &&
+         chunk_size_ + output_.Size() >= PLAN_STREAM_CHUNK_SIZE);
+    if (chunk_full) {
+      full = true;
+      break;
+    }
+
+    size_t tuple_position = output_.ReserveBytes(sizeof(int32_t));
+    for (int column_itr = 0; column_itr < column_count; column_itr++) {
+      tile->GetValue(tuple_id, column_itr).SerializeTo(output_);
+    }
+    output_.WriteIntAt(tuple_position,
+                       static_cast<int32_t>(output_.Size() - tuple_position -
+                                            sizeof(int32_t)));
+
+    tuple_count++;
+    chunk_tuple_count_++;
+    sent_tuples.push_back(tuple_id);
+  }
+
+  if (tuple_count > 0) {
+    output_.WriteIntAt(tuple_count_position, tuple_count);
+
+    // Length prefix is non-inclusive
+    output_.WriteIntAt(0, static_cast<int32_t>(output_.Size() -
+                                               sizeof(int32_t)));
+    response_->add_result(output_.Data(), output_.Size());
+    chunk_size_ += output_.Size();
+  }
+
+  if (full) {
+    // the rest of the tile goes with the next chunk
+    for (auto tuple_id : sent_tuples) {
+      tile->RemoveVisibility(tuple_id);
+    }
+  } else {
+    tile.reset();
+  }
+
+  return true;
+}
+
+// Same as Tile::SerializeHeaderTo, with the types and names of the base
+// tile columns
+void PlanStream::SerializeHeader(executor::LogicalTile *tile) {
+  CopySerializeOutput output;
+  output.WriteInt(-1);
+
+  // Status code
+  output.WriteByte(-128);
+
+  auto &columns = tile->GetSchema();
+  output.WriteShort(static_cast<int16_t>(columns.size()));
+
+  for (auto &column_info : columns) {
+    ValueType type = column_info.base_tile->GetSchema()->GetType(
+        column_info.origin_column_id);
+    output.WriteByte(static_cast<int8_t>(type));
+  }
+
+  for (auto &column_info : columns) {
+    auto name =
+        column_info.base_tile->GetColumnName(column_info.origin_column_id);
+    output.WriteInt(static_cast<int32_t>(name.size()));
+    output.WriteBytes(name.data(), name.size());
+  }
+
+  output.WriteIntAt(0, static_cast<int32_t>(output.Size() - sizeof(int32_t)));
+  column_header_.assign(output.Data(), output.Size());
+}
+
+//===--------------------------------------------------------------------===//
+// Plan Stream Manager
+//===--------------------------------------------------------------------===//
+
+PlanStreamManager &PlanStreamManager::GetInstance() {
+  static PlanStreamManager plan_stream_manager;
+  return plan_stream_manager;
+}
+
+PlanStreamManager::~PlanStreamManager() {
+  if (sweeper_thread_ == nullptr) return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+  }
+  stop_cv_.notify_all();
+
+  sweeper_thread_->join();
+  sweeper_thread_.reset();
+}
+
+void PlanStreamManager::Park(int64_t query_id,
+                             std::unique_ptr<PlanStream> stream) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  streams_[query_id] = {std::move(stream), std::chrono::steady_clock::now()};
+
+  if (sweeper_thread_ == nullptr && FLAGS_plan_stream_idle_timeout != 0) {
+    is_running_ = true;
+    sweeper_thread_.reset(new std::thread(&PlanStreamManager::Sweeping, this,
+                                          FLAGS_plan_stream_idle_timeout));
+  }
+}
+
+std::unique_ptr<PlanStream> PlanStreamManager::Take(int64_t query_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto stream_itr = streams_.find(query_id);
+  if (stream_itr == streams_.end()) {
+    return nullptr;
+  }
+
+  auto stream = std::move(stream_itr->second.stream);
+  streams_.erase(stream_itr);
+  return stream;
+}
+
+size_t PlanStreamManager::DropIdleStreams(
+    std::chrono::milliseconds idle_time) {
+  std::vector<std::unique_ptr<PlanStream>> idle_streams;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto idle_since = std::chrono::steady_clock::now() - idle_time;
+    auto stream_itr = streams_.begin();
+    while (stream_itr != streams_.end()) {
+      if (stream_itr->second.park_time <= idle_since) {
+        LOG_TRACE("Query %ld was not fetched in time, dropping it",
+                  static_cast<long>(stream_itr->first));
+        idle_streams.push_back(std::move(stream_itr->second.stream));
+        stream_itr = streams_.erase(stream_itr);
+      } else {
+        stream_itr++;
+      }
+    }
+  }
+
+  // Their transactions are aborted outside the lock
+  size_t stream_count = idle_streams.size();
+  idle_streams.clear();
+  return stream_count;
+}
+
+void PlanStreamManager::Sweeping(size_t idle_timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    // a stream is dropped at most half the timeout late
+    stop_cv_.wait_for(lock, std::chrono::milliseconds(idle_timeout * 500));
+    if (is_running_ == false) break;
+
+    lock.unlock();
+    auto stream_count = DropIdleStreams(std::chrono::seconds(idle_timeout));
+    lock.lock();
+
+    if (stream_count > 0) {
+      LOG_INFO("Dropped %lu plan streams that were not fetched",
+               stream_count);
+    }
+  }
+}
+
+size_t PlanStreamManager::GetStreamCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return streams_.size();
+}
+
+}  // End networking namespace
+}  // End peloton namespace
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <functional>
+#include <memory>
 #include "../include/common/thread_pool.h"
 
 namespace peloton {
@@ -74,8 +75,10 @@ void RpcChannel::CallMethod(
 
   /* total length of the message: header length (4bytes) + message length
    * (8bytes + ...) */
+  /* shipped log segments can be large, so the buf does not live on the stack */
   PL_ASSERT(HEADERLEN == sizeof(msg_len));
-  char buf[HEADERLEN + msg_len];
+  std::unique_ptr<char[]> send_buf(new char[HEADERLEN + msg_len]);
+  char* buf = send_buf.get();
 
   /* copy the header into the buf */
   PL_MEMCPY(buf, &msg_len, sizeof(msg_len));
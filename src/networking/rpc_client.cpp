@@ -120,5 +120,10 @@ void RpcClient::QueryPlan(const QueryPlanExecRequest* request,
   stub_->QueryPlan(controller_, request, response, NULL);
 }
 
+void RpcClient::LogRecordReplay(const LogRecordReplayRequest* request,
+                                LogRecordReplayResponse* response) {
+  stub_->LogRecordReplay(controller_, request, response, NULL);
+}
+
 }  // namespace networking
 }  // namespace peloton
@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <mutex>
+#include <memory>
 
 #include <pthread.h>
 
@@ -138,9 +139,10 @@ void *Connection::ProcessMessage(void *connection) {
     /*
      * Get a message.
      * Note: we only get one message each time. so the buf is msg_len +
-     * HEADERLEN
+     * HEADERLEN. Shipped log segments can be large, so it is on the heap
      */
-    char buf[msg_len + HEADERLEN];
+    std::unique_ptr<char[]> recv_buf(new char[msg_len + HEADERLEN]);
+    char *buf = recv_buf.get();
 
     // Get the data
     conn->GetReadData(buf, msg_len + HEADERLEN);
@@ -25,6 +25,7 @@
 #include "parser/peloton/drop_parse.h"
 #include "parser/peloton/create_parse.h"
 #include "parser/peloton/select_parse.h"
+#include "parser/peloton/copy_parse.h"
 
 namespace peloton {
 namespace parser {
@@ -38,14 +39,14 @@ void ParseTreeTransformer::PrintParseTree(
     const std::unique_ptr<parser::AbstractParse> &parse_tree,
     std::string prefix) {
   if (parse_tree.get() == nullptr) {
-    LOG_INFO("Done printing");
+    LOG_TRACE("Done printing");
     return;
   }
 
   prefix += "  ";
 
-  LOG_INFO("%s->Parse Type :: %d ", prefix.c_str(),
-           parse_tree->GetParseNodeType());
+  LOG_TRACE("%s->Parse Type :: %d ", prefix.c_str(),
+            parse_tree->GetParseNodeType());
 
   auto &children = parse_tree->GetChildren();
 
@@ -64,7 +65,7 @@ std::unique_ptr<parser::AbstractParse> TransformParseTree(
     std::unique_ptr<parser::AbstractParse> &root,
     const Node *postgres_parse_tree) {
 
-  LOG_INFO("Transform Parse Tree : %p ", postgres_parse_tree);
+  LOG_TRACE("Transform Parse Tree : %p ", postgres_parse_tree);
 
   // Base case
   if (postgres_parse_tree == nullptr) {
@@ -74,7 +75,7 @@ std::unique_ptr<parser::AbstractParse> TransformParseTree(
   std::unique_ptr<parser::AbstractParse> child_parse_tree;
 
   auto parse_node_type = postgres_parse_tree->type;
-  LOG_INFO("Parse node type : %d", parse_node_type);
+  LOG_TRACE("Parse node type : %d", parse_node_type);
 
   switch (parse_node_type) {
 
@@ -83,7 +84,6 @@ std::unique_ptr<parser::AbstractParse> TransformParseTree(
       break;
 
     case T_CreateStmt:
-	LOG_INFO("Move on Up");
     	child_parse_tree.reset(new parser::CreateParse((CreateStmt *) postgres_parse_tree));
       break;
 
@@ -118,6 +118,11 @@ std::unique_ptr<parser::AbstractParse> TransformParseTree(
     case T_ExecuteStmt:
       break;
 
+    case T_CopyStmt:
+      child_parse_tree.reset(
+          new parser::CopyParse((CopyStmt *)postgres_parse_tree));
+      break;
+
     default:
       LOG_ERROR("Unsupported parse node type : %d ", parse_node_type);
       break;
@@ -127,10 +132,10 @@ std::unique_ptr<parser::AbstractParse> TransformParseTree(
   if (child_parse_tree.get() != nullptr) {
 
     if (root.get() != nullptr) {
-      LOG_INFO("Attach child");
+      LOG_TRACE("Attach child");
       root->AddChild(std::move(child_parse_tree));
     } else {
-      LOG_INFO("Set root");
+      LOG_TRACE("Set root");
       root = std::move(child_parse_tree);
     }
   }
@@ -147,7 +152,9 @@ std::unique_ptr<parser::AbstractParse> ParseTreeTransformer::BuildParseTree(
   parse_tree = TransformParseTree(parse_tree, postgres_parse_tree);
 
   // Print parse tree
+#ifdef LOG_TRACE_ENABLED
   PrintParseTree(parse_tree);
+#endif
 
   return parse_tree;
 }
@@ -24,6 +24,9 @@
 #include "parser/parser/scanner.h"
 #include "parser/parser/scansup.h"
 
+// token numbers of the scanner, only after scanner.h
+#include "parser/gram.h"
+
 #include "parser/parse_tree_transformer.h"
 
 namespace peloton {
@@ -48,67 +51,256 @@ PostgresParser &PostgresParser::GetInstance(){
   return postgres_parser;
 }
 
+// Transform the first statement of the postgres parse tree list
+static std::unique_ptr<parser::AbstractParse> TransformStatementList(
+    List *parsetree_list) {
+  std::unique_ptr<parser::AbstractParse> parse_tree;
+  ListCell *parsetree_item;
+
+  foreach(parsetree_item, parsetree_list){
+    Node *parsetree = (Node *) lfirst(parsetree_item);
+
+    parse_tree = ParseTreeTransformer::BuildParseTree(parsetree);
+
+    // Ignore other statements in list
+    break;
+  }
+
+  return parse_tree;
+}
+
+// Release what the raw parser malloc-ed outside of the memory context
+static void FreeParseError(PgQueryInternalParsetreeAndError &internal_result) {
+  PgQueryParseResult result = {0};
+  result.stderr_buffer = internal_result.stderr_buffer;
+  result.error = internal_result.error;
+  pg_query_free_parse_result(result);
+}
+
 std::unique_ptr<parser::AbstractParse> PostgresParser::BuildParseTree(
     const std::string& query_string){
   std::unique_ptr<parser::AbstractParse> parse_tree;
 
+  // Enter the temporary query parsing memory context
+  MemoryContext ctx = pg_query_enter_memory_context("pg_query_parse");
+
+  LOG_TRACE("Query string : %s", query_string.c_str());
+
   // Get postgres parse tree
-  MemoryContext ctx = NULL;
-  PgQueryInternalParsetreeAndError internal_result;
-  PgQueryParseResult result = {0};
+  PgQueryInternalParsetreeAndError internal_result =
+      pg_query_raw_parse(query_string.c_str());
 
-  // Enter the temporary query parsing memory context
-  ctx = pg_query_enter_memory_context("pg_query_parse");
+  // Parsing error
+  if (internal_result.error != nullptr) {
+    LOG_INFO("input: %s", query_string.c_str());
+    LOG_ERROR("error: %s at %d", internal_result.error->message,
+              internal_result.error->cursorpos);
+  } else {
+#ifdef LOG_TRACE_ENABLED
+    if (internal_result.tree != NULL) {
+      char *tree_json = pg_query_nodes_to_json(internal_result.tree);
+      LOG_TRACE("Parse Tree : %s", tree_json);
+      pfree(tree_json);
+    }
+#endif
+
+    // Transform the postgres nodes straight into our representation
+    parse_tree = TransformStatementList(internal_result.tree);
+  }
 
-  LOG_INFO("Query string : %s", query_string.c_str());
+  // Exit and clean the temporary query parsing memory context
+  pg_query_exit_memory_context(ctx);
 
-  internal_result = pg_query_raw_parse(query_string.c_str());
+  FreeParseError(internal_result);
 
-  // Convert parse tree to string representation
+  return parse_tree;
+}
+
+std::unique_ptr<parser::AbstractParse> PostgresParser::BuildParseTreeViaJson(
+    const std::string& query_string){
+  std::unique_ptr<parser::AbstractParse> parse_tree;
+
+  MemoryContext ctx = pg_query_enter_memory_context("pg_query_parse");
+
+  PgQueryInternalParsetreeAndError internal_result =
+      pg_query_raw_parse(query_string.c_str());
+
+  // Serialize the tree, as the libpg_query interface does
+  PgQueryParseResult result = {0};
   if (internal_result.tree != NULL) {
-    char *tree_json;
-    tree_json = pg_query_nodes_to_json(internal_result.tree);
+    char *tree_json = pg_query_nodes_to_json(internal_result.tree);
     result.parse_tree = strdup(tree_json);
     pfree(tree_json);
   } else {
     result.parse_tree = strdup("[]");
   }
-
   result.stderr_buffer = internal_result.stderr_buffer;
   result.error = internal_result.error;
 
-  // Parsing error
-  if (result.error != nullptr) {
-    LOG_INFO("input: %s", query_string.c_str());
-    LOG_ERROR("error: %s at %d", result.error->message,
-              result.error->cursorpos);
-    return parse_tree;
+  if (result.error == nullptr) {
+    parse_tree = TransformStatementList(internal_result.tree);
   }
 
-  LOG_INFO("Parse Tree : %s %s", result.parse_tree, result.stderr_buffer);
+  pg_query_exit_memory_context(ctx);
 
-  // Transform parse tree to our representation
-  ListCell *parsetree_item;
-  List *parsetree_list = internal_result.tree;
+  pg_query_free_parse_result(result);
 
-  foreach(parsetree_item, parsetree_list){
-    Node *parsetree = (Node *) lfirst(parsetree_item);
+  return parse_tree;
+}
 
-    parse_tree = std::move(ParseTreeTransformer::BuildParseTree(parsetree));
+std::vector<std::string> PostgresParser::SplitStatements(
+    const std::string& query_string){
+  std::vector<std::string> statements;
+
+  MemoryContext ctx = pg_query_enter_memory_context("pg_query_split");
+
+  // Bounds of the current statement, from its first token to the end of its
+  // last one. Kept volatile as the scanner leaves with a longjmp on errors.
+  volatile int statement_begin = -1;
+  volatile int statement_end = -1;
+
+  // where the text after the last separator starts
+  volatile int rest_begin = 0;
+
+  PG_TRY();
+  {
+    core_yy_extra_type yyextra;
+    core_YYSTYPE yylval;
+    YYLTYPE yylloc;
+    core_yyscan_t yyscanner = scanner_init(
+        query_string.c_str(), &yyextra, ScanKeywords, NumScanKeywords);
+
+    // Semicolons in literals, quoted identifiers, comments and dollar quoted
+    // bodies are part of their token, so only real separators end up here
+    for (;;) {
+      int token = core_yylex(&yylval, &yylloc, yyscanner);
+      if (token == 0) break;
+
+      if (token != ';') {
+        if (statement_begin < 0) statement_begin = yylloc;
+
+        // the scanner ends the current token with a '\0' in its buffer
+        statement_end = yylloc + strlen(yyextra.scanbuf + yylloc);
+        continue;
+      }
+
+      // empty statements are dropped
+      if (statement_begin >= 0) {
+        statements.push_back(query_string.substr(
+            statement_begin, statement_end - statement_begin));
+        statement_begin = -1;
+      }
+      rest_begin = yylloc + 1;
+    }
+
+    scanner_finish(yyscanner);
+  }
+  PG_CATCH();
+  {
+    // Leave the rest to the parser, which reports the error
+    FlushErrorState();
+
+    if (statement_begin < 0) {
+      statement_begin = rest_begin;
+      while (statement_begin < static_cast<int>(query_string.size()) &&
+             scanner_isspace(query_string[statement_begin])) {
+        statement_begin++;
+      }
+    }
+    statement_end = query_string.size();
+  }
+  PG_END_TRY();
 
-    // Ignore other statements in list
-    break;
+  if (statement_begin >= 0) {
+    statements.push_back(query_string.substr(statement_begin,
+                                             statement_end - statement_begin));
   }
 
-  // Exit and clean the temporary query parsing memory context
   pg_query_exit_memory_context(ctx);
 
-  // Clean up the result
-  pg_query_free_parse_result(result);
+  return statements;
+}
 
-  return parse_tree;
+// Literals and quoted identifiers are case sensitive, the rest is not
+static bool IsCaseSensitiveToken(int token, const char *token_text) {
+  if (token == SCONST || token == BCONST || token == XCONST) return true;
+  if (token != IDENT) return false;
+  return token_text[0] == '"' ||
+         ((token_text[0] == 'u' || token_text[0] == 'U') &&
+          token_text[1] == '&');
 }
 
+std::string PostgresParser::NormalizeStatement(
+    const std::string& query_string){
+  std::string normalized;
+  normalized.reserve(query_string.size());
+
+  MemoryContext ctx = pg_query_enter_memory_context("pg_query_normalize");
+
+  // end of the last token, and of the last one that is not a semicolon.
+  // Kept volatile as the scanner leaves with a longjmp on errors.
+  volatile int token_end = 0;
+  volatile size_t statement_size = 0;
+
+  PG_TRY();
+  {
+    core_yy_extra_type yyextra;
+    core_YYSTYPE yylval;
+    YYLTYPE yylloc;
+    core_yyscan_t yyscanner = scanner_init(
+        query_string.c_str(), &yyextra, ScanKeywords, NumScanKeywords);
+
+    for (;;) {
+      int token = core_yylex(&yylval, &yylloc, yyscanner);
+      if (token == 0) break;
+
+      // blanks and comments between tokens become one space
+      if (yylloc > token_end && normalized.empty() == false) {
+        normalized.push_back(' ');
+      }
+
+      // the scanner ends the current token with a '\0' in its buffer
+      const char *token_text = yyextra.scanbuf + yylloc;
+      size_t token_size = strlen(token_text);
+      if (IsCaseSensitiveToken(token, token_text)) {
+        normalized.append(token_text, token_size);
+      } else {
+        for (size_t char_itr = 0; char_itr < token_size; char_itr++) {
+          normalized.push_back(
+              tolower(static_cast<unsigned char>(token_text[char_itr])));
+        }
+      }
+
+      token_end = yylloc + token_size;
+      if (token != ';') statement_size = normalized.size();
+    }
+
+    scanner_finish(yyscanner);
+  }
+  PG_CATCH();
+  {
+    // Keep the rest as it is, the parser reports the error
+    FlushErrorState();
+
+    size_t rest_begin = token_end;
+    while (rest_begin < query_string.size() &&
+           scanner_isspace(query_string[rest_begin])) {
+      rest_begin++;
+    }
+    if (rest_begin < query_string.size()) {
+      if (normalized.empty() == false) normalized.push_back(' ');
+      normalized.append(query_string, rest_begin, std::string::npos);
+      statement_size = normalized.size();
+    }
+  }
+  PG_END_TRY();
+
+  pg_query_exit_memory_context(ctx);
+
+  // trailing semicolons do not change the statement
+  normalized.resize(statement_size);
+  return normalized;
+}
 
 }  // End parser namespace
 }  // End peloton namespace
@@ -20,6 +20,8 @@
 
 #include "common/types.h"
 #include "common/logger.h"
+#include "planner/limit_plan.h"
+#include "planner/seq_scan_plan.h"
 
 namespace peloton {
 namespace planner {
@@ -37,7 +39,81 @@ const std::vector<std::unique_ptr<AbstractPlan>> &AbstractPlan::GetChildren()
   return children_;
 }
 
-const AbstractPlan *AbstractPlan::GetParent() { return parent_; }
+const AbstractPlan *AbstractPlan::GetParent() const { return parent_; }
+
+//===--------------------------------------------------------------------===//
+// Serialization/Deserialization
+//===--------------------------------------------------------------------===//
+
+/**
+ * A plan tree is serialized in pre-order, every node as:
+ * [(int8_t) plan type]
+ * [(bytes) plan]           : see SerializeTo of the plan
+ * [(int) num children]
+ * [(bytes) children...]
+ *
+ * Only SeqScan and Limit nodes can be shipped so far. Expressions can't be
+ * serialized yet, so a SeqScan must not have a predicate.
+ */
+bool AbstractPlan::SerializeTree(SerializeOutput &output) const {
+  PlanNodeType plan_type = GetPlanNodeType();
+  if (plan_type != PLAN_NODE_TYPE_SEQSCAN &&
+      plan_type != PLAN_NODE_TYPE_LIMIT) {
+    LOG_ERROR("Plan serialization :: Unsupported PlanNodeType: %u ",
+              plan_type);
+    return false;
+  }
+
+  output.WriteByte(static_cast<int8_t>(plan_type));
+  if (SerializeTo(output) == false) {
+    LOG_ERROR("Plan serialization :: Can't serialize PlanNodeType: %u ",
+              plan_type);
+    return false;
+  }
+
+  output.WriteInt(static_cast<int>(children_.size()));
+  for (auto &child : children_) {
+    if (child->SerializeTree(output) == false) return false;
+  }
+
+  return true;
+}
+
+std::unique_ptr<AbstractPlan> AbstractPlan::DeserializeTree(
+    SerializeInputBE &input) {
+  PlanNodeType plan_type = (PlanNodeType)input.ReadEnumInSingleByte();
+
+  // The plans that know how to deserialize themselves
+  std::unique_ptr<AbstractPlan> plan;
+  switch (plan_type) {
+    case PLAN_NODE_TYPE_SEQSCAN:
+      plan.reset(new SeqScanPlan());
+      break;
+
+    case PLAN_NODE_TYPE_LIMIT:
+      plan.reset(new LimitPlan(0, 0));
+      break;
+
+    default: {
+      LOG_ERROR("Plan deserialization :: Unsupported PlanNodeType: %u ",
+                plan_type);
+      return nullptr;
+    }
+  }
+
+  if (plan->DeserializeFrom(input) == false) {
+    return nullptr;
+  }
+
+  int child_count = input.ReadInt();
+  for (int child_itr = 0; child_itr < child_count; child_itr++) {
+    auto child = DeserializeTree(input);
+    if (child == nullptr) return nullptr;
+    plan->AddChild(std::move(child));
+  }
+
+  return plan;
+}
 
 // Get a string representation of this plan
 std::ostream &operator<<(std::ostream &os, const AbstractPlan &plan) {
@@ -45,7 +45,13 @@ namespace planner {
  * TODO: parent_ seems never be set or used
  */
 
-bool SeqScanPlan::SerializeTo(SerializeOutput &output) {
+bool SeqScanPlan::SerializeTo(SerializeOutput &output) const {
+  // Expressions can't be serialized yet
+  if (GetPredicate() != nullptr) {
+    LOG_ERROR("SeqScanPlan serialization :: Predicates are not supported");
+    return false;
+  }
+
   // A placeholder for the total size written at the end
   int start = output.Position();
   output.WriteInt(-1);
@@ -75,18 +81,8 @@ bool SeqScanPlan::SerializeTo(SerializeOutput &output) {
     output.WriteInt(static_cast<int>(col_id));
   }
 
-  // Write predicate
-  if (GetPredicate() == nullptr) {
-    // Write the type
-    output.WriteByte(static_cast<int8_t>(EXPRESSION_TYPE_INVALID));
-  } else {
-    // Write the expression type
-    ExpressionType expr_type = GetPredicate()->GetExpressionType();
-    output.WriteByte(static_cast<int8_t>(expr_type));
-
-    // Write predicate
-    GetPredicate()->SerializeTo(output);
-  }
+  // Write predicate, which is always null for now
+  output.WriteByte(static_cast<int8_t>(EXPRESSION_TYPE_INVALID));
 
   // Write parent, but parent seems never be set or used right now
   if (GetParent() == nullptr) {
@@ -140,6 +136,11 @@ bool SeqScanPlan::DeserializeFrom(SerializeInputBE &input) {
   // Get table and set it to the member
   storage::DataTable *target_table = static_cast<storage::DataTable *>(
       catalog::Manager::GetInstance().GetTableWithOid(database_oid, table_oid));
+  if (target_table == nullptr) {
+    LOG_ERROR("SeqScanPlan deserialization :: Unknown table %u of database %u",
+              table_oid, database_oid);
+    return false;
+  }
   SetTargetTable(target_table);
 
   // Read the number of column_id and set them to column_ids_
@@ -166,7 +167,7 @@ bool SeqScanPlan::DeserializeFrom(SerializeInputBE &input) {
         LOG_ERROR(
             "Expression deserialization :: Unsupported EXPRESSION_TYPE: %u ",
             expr_type);
-        break;
+        return false;
       }
     }
   }
@@ -187,7 +188,7 @@ bool SeqScanPlan::DeserializeFrom(SerializeInputBE &input) {
       default: {
         LOG_ERROR("Parent deserialization :: Unsupported PlanNodeType: %u ",
                   expr_type);
-        break;
+        return false;
       }
     }
   }
@@ -0,0 +1,319 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column.cpp
+//
+// Identification: src/storage/compressed_column.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#include "storage/compressed_column.h"
+
+#include "common/logger.h"
+#include "common/macros.h"
+#include "common/pool.h"
+#include "common/value_peeker.h"
+#include "common/varlen.h"
+#include "storage/tile.h"
+
+namespace peloton {
+namespace storage {
+
+// Bytes a string of the dictionary costs on top of its own
+#define COMPRESSED_VARLEN_OVERHEAD 32
+
+static bool IsIntegerColumn(ValueType value_type, size_t column_length) {
+  switch (value_type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+      break;
+    default:
+      return false;
+  }
+
+  return column_length == 1 || column_length == 2 || column_length == 4 ||
+         column_length == 8;
+}
+
+static int64_t ReadInteger(const char *location, size_t column_length) {
+  switch (column_length) {
+    case 1:
+      return *reinterpret_cast<const int8_t *>(location);
+    case 2:
+      return *reinterpret_cast<const int16_t *>(location);
+    case 4:
+      return *reinterpret_cast<const int32_t *>(location);
+    default:
+      return *reinterpret_cast<const int64_t *>(location);
+  }
+}
+
+static void WriteInteger(char *location, size_t column_length, int64_t value) {
+  switch (column_length) {
+    case 1:
+      *reinterpret_cast<int8_t *>(location) = static_cast<int8_t>(value);
+      break;
+    case 2:
+      *reinterpret_cast<int16_t *>(location) = static_cast<int16_t>(value);
+      break;
+    case 4:
+      *reinterpret_cast<int32_t *>(location) = static_cast<int32_t>(value);
+      break;
+    default:
+      *reinterpret_cast<int64_t *>(location) = value;
+      break;
+  }
+}
+
+// Bits needed for codes up to max_code
+static uint32_t GetCodeWidth(uint64_t max_code) {
+  uint32_t code_width = 0;
+  while (code_width < 64 && (max_code >> code_width) != 0) code_width++;
+  return code_width;
+}
+
+// Bytes taken by code_count packed codes
+static size_t GetPackedSize(size_t code_count, uint32_t code_width) {
+  return ((code_count * code_width + 63) / 64) * sizeof(uint64_t);
+}
+
+CompressedColumn::CompressedColumn(ValueType value_type, bool is_inlined,
+                                   size_t column_length)
+    : value_type(value_type),
+      is_inlined(is_inlined),
+      column_length(column_length) {}
+
+CompressedColumn::~CompressedColumn() {}
+
+CompressedColumn *CompressedColumn::Compress(Tile *tile, oid_t column_id,
+                                             oid_t tuple_count) {
+  if (tuple_count == 0) return nullptr;
+
+  auto schema = tile->GetSchema();
+  auto value_type = schema->GetType(column_id);
+  auto is_inlined = schema->IsInlined(column_id);
+  size_t column_offset = schema->GetOffset(column_id);
+  size_t column_end = (column_id + 1 < schema->GetColumnCount())
+                          ? schema->GetOffset(column_id + 1)
+                          : schema->GetLength();
+  size_t column_length = column_end - column_offset;
+
+  std::unique_ptr<CompressedColumn> column(
+      new CompressedColumn(value_type, is_inlined, column_length));
+  std::vector<uint64_t> codes(tuple_count);
+  size_t raw_size = tuple_count * column_length;
+  size_t dictionary_bytes = 0;
+  uint64_t max_code = 0;
+  bool use_dictionary = true;
+
+  // Frame of reference, if the offsets are narrower than the values
+  if (is_inlined && IsIntegerColumn(value_type, column_length)) {
+    int64_t min_value = ReadInteger(
+        tile->GetTupleLocation(0) + column_offset, column_length);
+    int64_t max_value = min_value;
+    for (oid_t tuple_itr = 1; tuple_itr < tuple_count; tuple_itr++) {
+      auto value = ReadInteger(
+          tile->GetTupleLocation(tuple_itr) + column_offset, column_length);
+      min_value = std::min(min_value, value);
+      max_value = std::max(max_value, value);
+    }
+
+    max_code = static_cast<uint64_t>(max_value) -
+               static_cast<uint64_t>(min_value);
+    if (GetCodeWidth(max_code) < column_length * 8) {
+      for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+        auto value = ReadInteger(
+            tile->GetTupleLocation(tuple_itr) + column_offset, column_length);
+        codes[tuple_itr] =
+            static_cast<uint64_t>(value) - static_cast<uint64_t>(min_value);
+      }
+      column->base_value = min_value;
+      use_dictionary = false;
+    }
+  }
+
+  // Dictionary of the distinct values, keyed by their bytes
+  std::vector<const char *> entries;
+  if (use_dictionary == true) {
+    std::unordered_map<std::string, uint64_t> distinct_values;
+
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      auto field = tile->GetTupleLocation(tuple_itr) + column_offset;
+      std::string key;
+      if (is_inlined) {
+        key.assign(field, column_length);
+      } else {
+        auto value = Value::InitFromTupleStorage(field, value_type, false);
+        raw_size += COMPRESSED_VARLEN_OVERHEAD;
+        if (value.IsNull() == false) {
+          auto value_length = ValuePeeker::PeekObjectLengthWithoutNull(value);
+          raw_size += value_length;
+          key.assign(1, '\1');
+          key.append(reinterpret_cast<const char *>(
+                         ValuePeeker::PeekObjectValueWithoutNull(value)),
+                     value_length);
+        }
+      }
+
+      auto entry =
+          distinct_values.emplace(std::move(key), distinct_values.size());
+      if (entry.second == true) {
+        // Not worth it, when most values are distinct
+        if (distinct_values.size() > tuple_count / 2) return nullptr;
+
+        entries.push_back(field);
+        dictionary_bytes += column_length;
+        if (is_inlined == false) {
+          dictionary_bytes +=
+              entry.first->first.size() + COMPRESSED_VARLEN_OVERHEAD;
+        }
+      }
+      codes[tuple_itr] = entry.first->second;
+    }
+
+    max_code = entries.size() - 1;
+  }
+
+  // Runs, if they save more than they add
+  auto code_width = GetCodeWidth(max_code);
+  size_t run_count = 1;
+  for (oid_t tuple_itr = 1; tuple_itr < tuple_count; tuple_itr++) {
+    if (codes[tuple_itr] != codes[tuple_itr - 1]) run_count++;
+  }
+
+  size_t packed_size = GetPackedSize(tuple_count, code_width);
+  size_t run_size =
+      run_count * sizeof(oid_t) + GetPackedSize(run_count, code_width);
+  bool use_runs = (run_size < packed_size);
+  size_t compressed_size =
+      dictionary_bytes + (use_runs ? run_size : packed_size);
+  if (compressed_size >= raw_size) return nullptr;
+
+  column->code_width = code_width;
+  if (use_runs == true) {
+    std::vector<uint64_t> run_codes;
+    run_codes.reserve(run_count);
+    column->run_ends.reserve(run_count);
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      if (tuple_itr + 1 == tuple_count ||
+          codes[tuple_itr + 1] != codes[tuple_itr]) {
+        run_codes.push_back(codes[tuple_itr]);
+        column->run_ends.push_back(tuple_itr + 1);
+      }
+    }
+    column->PackCodes(run_codes);
+    column->compression_type = COMPRESSION_TYPE_RLE;
+  } else {
+    column->PackCodes(codes);
+    column->compression_type = use_dictionary ? COMPRESSION_TYPE_DICTIONARY
+                                              : COMPRESSION_TYPE_BITPACKING;
+  }
+
+  if (use_dictionary == true) {
+    column->dictionary_size = entries.size();
+    column->dictionary.reset(new char[entries.size() * column_length]);
+    if (is_inlined == false) {
+      column->dictionary_pool.reset(new VarlenPool(BACKEND_TYPE_MM));
+    }
+
+    for (size_t entry_itr = 0; entry_itr < entries.size(); entry_itr++) {
+      auto entry_location =
+          column->dictionary.get() + entry_itr * column_length;
+      if (is_inlined) {
+        PL_MEMCPY(entry_location, entries[entry_itr], column_length);
+        continue;
+      }
+
+      // Strings move into the dictionary pool, the tile pool goes away
+      auto varlen = *reinterpret_cast<Varlen *const *>(entries[entry_itr]);
+      if (varlen != nullptr) {
+        varlen = Varlen::Clone(*varlen, column->dictionary_pool.get());
+      }
+      *reinterpret_cast<Varlen **>(entry_location) = varlen;
+    }
+  }
+
+  LOG_TRACE("Compressed column %u from %lu to %lu bytes (%s)", column_id,
+            raw_size, compressed_size,
+            CompressionTypeToString(column->compression_type).c_str());
+
+  return column.release();
+}
+
+Value CompressedColumn::GetValue(oid_t tuple_offset) const {
+  size_t code_offset = tuple_offset;
+  if (compression_type == COMPRESSION_TYPE_RLE) {
+    code_offset = std::upper_bound(run_ends.begin(), run_ends.end(),
+                                   tuple_offset) -
+                  run_ends.begin();
+  }
+
+  auto code = GetCode(code_offset);
+  if (dictionary != nullptr) {
+    PL_ASSERT(code < dictionary_size);
+    return Value::InitFromTupleStorage(
+        dictionary.get() + code * column_length, value_type, is_inlined);
+  }
+
+  char buffer[sizeof(int64_t)];
+  WriteInteger(buffer, column_length,
+               static_cast<int64_t>(static_cast<uint64_t>(base_value) + code));
+  return Value::InitFromTupleStorage(buffer, value_type, true);
+}
+
+size_t CompressedColumn::GetSize() const {
+  size_t size = packed_codes.size() * sizeof(uint64_t) +
+                run_ends.size() * sizeof(oid_t) +
+                dictionary_size * column_length;
+  if (dictionary_pool != nullptr) {
+    size += dictionary_pool->GetAllocatedMemory();
+  }
+  return size;
+}
+
+uint64_t CompressedColumn::GetCode(size_t code_offset) const {
+  if (code_width == 0) return 0;
+
+  size_t bit_offset = code_offset * code_width;
+  size_t word_offset = bit_offset / 64;
+  size_t shift = bit_offset % 64;
+  uint64_t mask = (code_width == 64) ? ~0UL : ((1UL << code_width) - 1);
+
+  uint64_t code = packed_codes[word_offset] >> shift;
+  if (shift + code_width > 64) {
+    code |= packed_codes[word_offset + 1] << (64 - shift);
+  }
+  return code & mask;
+}
+
+void CompressedColumn::PackCodes(const std::vector<uint64_t> &codes) {
+  packed_codes.assign(GetPackedSize(codes.size(), code_width) /
+                          sizeof(uint64_t),
+                      0);
+  if (code_width == 0) return;
+
+  for (size_t code_itr = 0; code_itr < codes.size(); code_itr++) {
+    size_t bit_offset = code_itr * code_width;
+    size_t word_offset = bit_offset / 64;
+    size_t shift = bit_offset % 64;
+
+    packed_codes[word_offset] |= codes[code_itr] << shift;
+    if (shift + code_width > 64) {
+      packed_codes[word_offset + 1] |= codes[code_itr] >> (64 - shift);
+    }
+  }
+}
+
+}  // End storage namespace
+}  // End peloton namespace
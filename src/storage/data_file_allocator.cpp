@@ -0,0 +1,388 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// data_file_allocator.cpp
+//
+// Identification: src/storage/data_file_allocator.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/falloc.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+#include "storage/data_file_allocator.h"
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace peloton {
+namespace storage {
+
+// Whether an extent is in use
+enum ExtentState {
+  EXTENT_STATE_FREE = 0,
+  EXTENT_STATE_LIVE = 1
+};
+
+struct ExtentHeader {
+  uint32_t magic;
+
+  uint32_t state;
+
+  // of the whole extent, header included
+  size_t size;
+};
+
+static_assert(sizeof(ExtentHeader) <= DATA_FILE_EXTENT_HEADER_SIZE,
+              "data file extent header does not fit");
+
+static inline size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static void WriteExtentHeader(char *extent, ExtentState state, size_t size) {
+  ExtentHeader header;
+  header.magic = DATA_FILE_EXTENT_MAGIC;
+  header.state = state;
+  header.size = size;
+  PL_MEMCPY(extent, &header, sizeof(header));
+}
+
+DataFileAllocator::DataFileAllocator(int data_fd, size_t segment_size)
+    : data_fd_(data_fd),
+      segment_size_(RoundUp(std::max(segment_size,
+                                     static_cast<size_t>(
+                                         DATA_FILE_MIN_EXTENT_SIZE)),
+                            DATA_FILE_MIN_EXTENT_SIZE)) {
+  // Whatever the file holds already becomes the first segment
+  struct stat data_stat;
+  if (fstat(data_fd_, &data_stat) == 0 && data_stat.st_size > 0) {
+    size_t file_size = static_cast<size_t>(data_stat.st_size) &
+                       ~static_cast<size_t>(DATA_FILE_MIN_EXTENT_SIZE - 1);
+    if (file_size > 0) {
+      void *address = mmap(nullptr, file_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, data_fd_, 0);
+      if (address == MAP_FAILED) {
+        throw Exception("could not map data file : length : " +
+                        std::to_string(file_size));
+      }
+
+      Segment segment = {reinterpret_cast<char *>(address), 0, file_size, 0,
+                         0, false};
+      LoadExtents(segment);
+      segments_.push_back(segment);
+      file_size_ = file_size;
+    }
+  }
+
+  LOG_TRACE("Data file with %lu bytes, %lu live", file_size_, live_bytes_);
+}
+
+DataFileAllocator::~DataFileAllocator() {
+  Sync();
+
+  for (auto &segment : segments_) {
+    munmap(segment.address, segment.length);
+  }
+  close(data_fd_);
+}
+
+size_t DataFileAllocator::GetSizeClass(size_t size) {
+  if (size <= DATA_FILE_MIN_EXTENT_SIZE) return DATA_FILE_MIN_EXTENT_SIZE;
+
+  // Four classes between two powers of two, no finer than a page
+  size_t power = DATA_FILE_MIN_EXTENT_SIZE;
+  while (power * 2 < size) power *= 2;
+  size_t step = std::max(power / 4, static_cast<size_t>(
+                                        DATA_FILE_MIN_EXTENT_SIZE));
+
+  return RoundUp(size, step);
+}
+
+bool DataFileAllocator::ReserveSpace(size_t file_offset, size_t length) {
+  // Reserve the blocks, so that stores to the mapping do not fail later
+  if (fallocate(data_fd_, 0, file_offset, length) == 0) return true;
+
+  return errno == EOPNOTSUPP &&
+         posix_fallocate(data_fd_, file_offset, length) == 0;
+}
+
+size_t DataFileAllocator::AddSegment(size_t length) {
+  length = std::max(RoundUp(length, segment_size_), segment_size_);
+
+  if (ReserveSpace(file_size_, length) == false) {
+    throw Exception("could not grow data file : size : " +
+                    std::to_string(file_size_) + " length : " +
+                    std::to_string(length));
+  }
+
+  void *address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       data_fd_, file_size_);
+  if (address == MAP_FAILED) {
+    throw Exception("could not map data file : offset : " +
+                    std::to_string(file_size_) + " length : " +
+                    std::to_string(length));
+  }
+
+  Segment segment = {reinterpret_cast<char *>(address), file_size_, length, 0,
+                     0, false};
+  segments_.push_back(segment);
+  file_size_ += length;
+
+  LOG_TRACE("Data file grew to %lu bytes", file_size_);
+  return segments_.size() - 1;
+}
+
+DataFileAllocator::Segment *DataFileAllocator::FindSegment(
+    const void *address) {
+  auto location = reinterpret_cast<const char *>(address);
+  for (auto &segment : segments_) {
+    if (location >= segment.address &&
+        location < segment.address + segment.length) {
+      return &segment;
+    }
+  }
+
+  return nullptr;
+}
+
+void DataFileAllocator::LoadExtents(Segment &segment) {
+  // Extents are laid out back to back, with holes of zeroed pages where
+  // segments were given back. Pages in the holes stay unused.
+  size_t offset = 0;
+  while (offset + DATA_FILE_MIN_EXTENT_SIZE <= segment.length) {
+    char *extent = segment.address + offset;
+    ExtentHeader header;
+    PL_MEMCPY(&header, extent, sizeof(header));
+
+    if (header.magic != DATA_FILE_EXTENT_MAGIC || header.size == 0 ||
+        header.size % DATA_FILE_MIN_EXTENT_SIZE != 0 ||
+        offset + header.size > segment.length) {
+      offset += DATA_FILE_MIN_EXTENT_SIZE;
+      continue;
+    }
+
+    if (header.state == EXTENT_STATE_LIVE) {
+      segment.live_bytes += header.size;
+      live_bytes_ += header.size;
+    } else {
+      free_lists_[header.size].push_back(extent);
+      free_bytes_ += header.size;
+    }
+    offset += header.size;
+    segment.used = offset;
+  }
+}
+
+void DataFileAllocator::PurgeFreeExtents(const Segment &segment) {
+  for (auto &free_list : free_lists_) {
+    auto &extents = free_list.second;
+    auto begin = std::remove_if(extents.begin(), extents.end(),
+                                [&segment](char *extent) {
+      return extent >= segment.address &&
+             extent < segment.address + segment.length;
+    });
+
+    free_bytes_ -= (extents.end() - begin) * free_list.first;
+    extents.erase(begin, extents.end());
+  }
+}
+
+void DataFileAllocator::ReclaimSegment(Segment &segment) {
+  if (segment.evacuating == false) {
+    PurgeFreeExtents(segment);
+  }
+
+  // Dropping the blocks zeroes the range, so no stale header is found later
+  if (fallocate(data_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                segment.file_offset, segment.length) != 0) {
+    LOG_TRACE("Could not punch data file at %lu", segment.file_offset);
+    PL_MEMSET(segment.address, 0, segment.used);
+  }
+
+  segment.used = 0;
+  segment.evacuating = false;
+  reclaimed_segment_count_++;
+}
+
+void *DataFileAllocator::Allocate(size_t size) {
+  size_t extent_size = GetSizeClass(size + DATA_FILE_EXTENT_HEADER_SIZE);
+  char *extent = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto free_list_itr = free_lists_.find(extent_size);
+  if (free_list_itr != free_lists_.end() &&
+      free_list_itr->second.empty() == false) {
+    extent = free_list_itr->second.back();
+    free_list_itr->second.pop_back();
+    free_bytes_ -= extent_size;
+  } else {
+    if (segments_.empty() ||
+        segments_[current_segment_].used + extent_size >
+            segments_[current_segment_].length) {
+      // Refill an empty segment before growing the file
+      size_t next_segment = segments_.size();
+      for (size_t segment_itr = 0; segment_itr < segments_.size();
+           segment_itr++) {
+        auto &segment = segments_[segment_itr];
+        if (segment.used == 0 && segment.length >= extent_size &&
+            ReserveSpace(segment.file_offset, segment.length) == true) {
+          next_segment = segment_itr;
+          break;
+        }
+      }
+
+      if (next_segment == segments_.size()) {
+        next_segment = AddSegment(extent_size);
+      }
+      current_segment_ = next_segment;
+    }
+
+    auto &segment = segments_[current_segment_];
+    extent = segment.address + segment.used;
+    segment.used += extent_size;
+  }
+
+  auto segment = FindSegment(extent);
+  PL_ASSERT(segment != nullptr);
+  segment->live_bytes += extent_size;
+  live_bytes_ += extent_size;
+
+  WriteExtentHeader(extent, EXTENT_STATE_LIVE, extent_size);
+  return extent + DATA_FILE_EXTENT_HEADER_SIZE;
+}
+
+void DataFileAllocator::Release(void *address) {
+  if (address == nullptr) return;
+
+  char *extent = reinterpret_cast<char *>(address) -
+                 DATA_FILE_EXTENT_HEADER_SIZE;
+  ExtentHeader header;
+  PL_MEMCPY(&header, extent, sizeof(header));
+  if (header.magic != DATA_FILE_EXTENT_MAGIC ||
+      header.state != EXTENT_STATE_LIVE) {
+    LOG_ERROR("Invalid data file extent at %p", address);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto segment = FindSegment(extent);
+  if (segment == nullptr) {
+    LOG_ERROR("Extent at %p is not in the data file", address);
+    return;
+  }
+
+  WriteExtentHeader(extent, EXTENT_STATE_FREE, header.size);
+  segment->live_bytes -= header.size;
+  live_bytes_ -= header.size;
+
+  // The current segment keeps being filled, others are given back when
+  // they are empty
+  bool current = (segment == &segments_[current_segment_]);
+  if (segment->live_bytes == 0 && current == false) {
+    ReclaimSegment(*segment);
+  } else if (segment->evacuating == false) {
+    free_lists_[header.size].push_back(extent);
+    free_bytes_ += header.size;
+  }
+}
+
+size_t DataFileAllocator::SelectSegmentsToEvacuate(double live_ratio) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  size_t evacuating_segment_count = 0;
+  for (size_t segment_itr = 0; segment_itr < segments_.size();
+       segment_itr++) {
+    auto &segment = segments_[segment_itr];
+    if (segment.evacuating == false && segment_itr != current_segment_ &&
+        segment.used > 0 &&
+        segment.live_bytes < segment.used * live_ratio) {
+      // Nothing new lands here anymore
+      PurgeFreeExtents(segment);
+      segment.evacuating = true;
+      LOG_TRACE("Evacuating data file segment at %lu : %lu of %lu live",
+                segment.file_offset, segment.live_bytes, segment.used);
+    }
+
+    if (segment.evacuating == true) evacuating_segment_count++;
+  }
+
+  return evacuating_segment_count;
+}
+
+bool DataFileAllocator::IsEvacuating(const void *address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto segment = FindSegment(address);
+  return segment != nullptr && segment->evacuating;
+}
+
+void *DataFileAllocator::Relocate(const void *address) {
+  auto extent = reinterpret_cast<const char *>(address) -
+                DATA_FILE_EXTENT_HEADER_SIZE;
+  ExtentHeader header;
+  PL_MEMCPY(&header, extent, sizeof(header));
+  PL_ASSERT(header.magic == DATA_FILE_EXTENT_MAGIC);
+
+  size_t size = header.size - DATA_FILE_EXTENT_HEADER_SIZE;
+  auto new_address = Allocate(size);
+  PL_MEMCPY(new_address, address, size);
+
+  // The copy must be durable before anybody is pointed at it
+  uintptr_t begin = reinterpret_cast<uintptr_t>(new_address) -
+                    DATA_FILE_EXTENT_HEADER_SIZE;
+  if (msync(reinterpret_cast<void *>(begin), header.size, MS_SYNC) != 0) {
+    LOG_ERROR("Could not sync relocated extent at %p", new_address);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  relocated_count_++;
+
+  return new_address;
+}
+
+void DataFileAllocator::Sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (auto &segment : segments_) {
+    if (segment.used == 0) continue;
+    if (msync(segment.address, segment.used, MS_SYNC) != 0) {
+      LOG_ERROR("Could not sync data file at %lu", segment.file_offset);
+    }
+  }
+}
+
+DataFileStats DataFileAllocator::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  DataFileStats stats;
+  stats.segment_count = segments_.size();
+  stats.file_size = file_size_;
+  stats.live_bytes = live_bytes_;
+  stats.free_bytes = free_bytes_;
+  stats.reclaimed_segment_count = reclaimed_segment_count_;
+  stats.relocated_count = relocated_count_;
+
+  for (auto &segment : segments_) {
+    if (segment.evacuating == true) stats.evacuating_segment_count++;
+  }
+
+  return stats;
+}
+
+}  // End storage namespace
+}  // End peloton namespace
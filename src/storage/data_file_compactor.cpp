@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// data_file_compactor.cpp
+//
+// Identification: src/storage/data_file_compactor.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <chrono>
+
+#include "storage/data_file_compactor.h"
+
+#include "catalog/manager.h"
+#include "common/logger.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_file_allocator.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+
+namespace peloton {
+namespace storage {
+
+DataFileCompactor::DataFileCompactor(DataFileAllocator &allocator)
+    : allocator_(allocator) {}
+
+DataFileCompactor::~DataFileCompactor() { Stop(); }
+
+void DataFileCompactor::Start(size_t interval) {
+  if (interval == 0 || compactor_thread_ != nullptr) return;
+
+  LOG_TRACE("Starting data file compactor");
+  is_running_ = true;
+  compactor_thread_.reset(
+      new std::thread(&DataFileCompactor::Running, this, interval));
+}
+
+void DataFileCompactor::Stop() {
+  if (compactor_thread_ == nullptr) return;
+
+  LOG_TRACE("Stopping data file compactor");
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+  }
+  stop_cv_.notify_all();
+
+  compactor_thread_->join();
+  compactor_thread_.reset();
+}
+
+void DataFileCompactor::Running(size_t interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    stop_cv_.wait_for(lock, std::chrono::seconds(interval));
+    if (is_running_ == false) break;
+
+    lock.unlock();
+    auto tile_count = CompactOnce();
+    lock.lock();
+
+    if (tile_count > 0) {
+      LOG_TRACE("Moved %lu tiles out of sparse data file segments",
+                tile_count);
+    }
+  }
+}
+
+void DataFileCompactor::ReleaseRetiredExtents() {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto max_committed_cid = txn_manager.GetMaxCommittedCid();
+
+  size_t retired_itr = 0;
+  while (retired_itr < retired_extents_.size()) {
+    auto &retired_extent = retired_extents_[retired_itr];
+    if (retired_extent.second < max_committed_cid) {
+      allocator_.Release(retired_extent.first);
+      retired_extent = retired_extents_.back();
+      retired_extents_.pop_back();
+    } else {
+      retired_itr++;
+    }
+  }
+}
+
+size_t DataFileCompactor::CompactOnce() {
+  ReleaseRetiredExtents();
+
+  if (allocator_.SelectSegmentsToEvacuate(DATA_FILE_SPARSE_RATIO) == 0) {
+    return 0;
+  }
+
+  size_t tile_count = 0;
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto database_count = catalog_manager.GetDatabaseCount();
+  for (oid_t database_itr = 0; database_itr < database_count;
+       database_itr++) {
+    auto database = catalog_manager.GetDatabase(database_itr);
+    if (database == nullptr) continue;
+
+    auto table_count = database->GetTableCount();
+    for (oid_t table_itr = 0; table_itr < table_count; table_itr++) {
+      auto table = database->GetTable(table_itr);
+      if (table == nullptr) continue;
+
+      auto tile_group_count = table->GetTileGroupCount();
+      for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+           tile_group_itr++) {
+        // Hold on to the tile group, in case the table goes away meanwhile
+        auto tile_group = table->GetTileGroup(tile_group_itr);
+        if (tile_group == nullptr) continue;
+
+        auto backend_type = tile_group->GetBackendType();
+        if (backend_type != BACKEND_TYPE_SSD &&
+            backend_type != BACKEND_TYPE_HDD) {
+          continue;
+        }
+
+        tile_count += CompactTileGroup(tile_group.get());
+      }
+    }
+  }
+
+  return tile_count;
+}
+
+size_t DataFileCompactor::CompactTileGroup(TileGroup *tile_group) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  // While the transaction is alive, no slot of the tile group is recycled
+  txn_manager.BeginTransaction();
+
+  // Only move tile groups nobody writes to
+  cid_t newest_begin_cid;
+  bool frozen = tile_group->GetHeader()->IsFrozen(newest_begin_cid);
+
+  size_t tile_count = 0;
+  if (frozen == true) {
+    for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+         tile_itr++) {
+      auto tile = tile_group->GetTile(tile_itr);
+      if (allocator_.IsEvacuating(tile->GetData()) == false) continue;
+
+      auto new_data =
+          reinterpret_cast<char *>(allocator_.Relocate(tile->GetData()));
+      auto old_data = tile->RelocateData(new_data);
+
+      // Compressed meanwhile, its data goes away anyway
+      if (old_data == nullptr) {
+        allocator_.Release(new_data);
+        continue;
+      }
+
+      // Readers that started before now may still be on the old data
+      retired_extents_.emplace_back(old_data,
+                                    txn_manager.GetCurrentCommitId());
+      tile_count++;
+    }
+  }
+
+  txn_manager.CommitTransaction();
+
+  return tile_count;
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <algorithm>
+#include <future>
 #include <mutex>
 #include <utility>
 
@@ -19,7 +21,9 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/platform.h"
+#include "common/thread_pool.h"
 #include "catalog/foreign_key.h"
+#include "catalog/manager.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "gc/gc_manager_factory.h"
 #include "index/index.h"
@@ -54,6 +58,10 @@ DataTable::DataTable(catalog::Schema *schema, const std::string &table_name,
                      const bool adapt_table)
     : AbstractTable(database_oid, table_oid, table_name, schema, own_schema),
       tuples_per_tilegroup_(tuples_per_tilegroup),
+      active_tile_group_count_(std::max<size_t>(
+          1, std::min<size_t>(FLAGS_active_tile_group_count,
+                              MAX_ACTIVE_TILE_GROUP_COUNT))),
+      active_tile_groups_(active_tile_group_count_),
       adapt_table_(adapt_table) {
   // Init default partition
   auto col_count = schema->GetColumnCount();
@@ -61,8 +69,11 @@ DataTable::DataTable(catalog::Schema *schema, const std::string &table_name,
     default_partition_[col_itr] = std::make_pair(0, col_itr);
   }
 
-  // Create a tile group.
-  AddDefaultTileGroup();
+  // Create a tile group for every active slot.
+  for (size_t active_itr = 0; active_itr < active_tile_group_count_;
+       active_itr++) {
+    AddDefaultTileGroup(active_itr);
+  }
 }
 
 DataTable::~DataTable() {
@@ -71,9 +82,7 @@ DataTable::~DataTable() {
   oid_t tile_group_count = GetTileGroupCount();
   for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
        tile_group_itr++) {
-    tile_group_lock_.ReadLock();
-    auto tile_group_id = tile_groups_.at(tile_group_itr);
-    tile_group_lock_.Unlock();
+    auto tile_group_id = tile_groups_.Get(tile_group_itr);
 
     LOG_TRACE("Dropping tile group : %u", tile_group_id);
 
@@ -156,11 +165,12 @@ ItemPointer DataTable::GetEmptyTupleSlot(const storage::Tuple *tuple,
   std::shared_ptr<storage::TileGroup> tile_group;
   oid_t tuple_slot = INVALID_OID;
   oid_t tile_group_id = INVALID_OID;
+  size_t active_itr = 0;
 
   // get valid tuple.
   while (true) {
-    // get the last tile group.
-    tile_group = GetTileGroup(tile_group_count_ - 1);
+    // get the tile group this thread inserts into.
+    tile_group = GetActiveTileGroup(active_itr);
 
     tuple_slot = tile_group->InsertTuple(tuple);
 
@@ -169,16 +179,25 @@ ItemPointer DataTable::GetEmptyTupleSlot(const storage::Tuple *tuple,
       tile_group_id = tile_group->GetTileGroupId();
       break;
     }
+
+    // some other thread is replacing the full tile group
+    _mm_pause();
+  }
+
+  // half way through, build the next tile group while the others insert
+  auto allocated_tuple_count = tile_group->GetAllocatedTupleCount();
+  if (tuple_slot == allocated_tuple_count / 2) {
+    PrepareSpareTileGroup();
   }
 
   // if this is the last tuple slot we can get
   // then create a new tile group
-  if (tuple_slot == tile_group->GetAllocatedTupleCount() - 1) {
-    AddDefaultTileGroup();
+  if (tuple_slot == allocated_tuple_count - 1) {
+    AddDefaultTileGroup(active_itr);
   }
 
   LOG_TRACE("tile group count: %lu, tile group id: %u, address: %p",
-            tile_group_count_.load(), tile_group->GetTileGroupId(),
+            GetTileGroupCount(), tile_group->GetTileGroupId(),
             tile_group.get());
 
   // Set tuple location
@@ -253,6 +272,124 @@ ItemPointer DataTable::InsertTuple(const storage::Tuple *tuple) {
   return location;
 }
 
+bool DataTable::InsertTuples(
+    const std::vector<std::unique_ptr<Tuple>> &tuples,
+    std::vector<ItemPointer> &locations, ThreadPool *pool) {
+  size_t offset = locations.size();
+  size_t tuple_count = tuples.size();
+
+  // A run of consecutive slots within one tile group
+  struct SlotRun {
+    std::shared_ptr<storage::TileGroup> tile_group;
+    oid_t first_slot;
+    oid_t slot_count;
+    size_t tuple_offset;
+  };
+  std::vector<SlotRun> runs;
+
+  // Claim the slots, a whole run per tile group at once
+  size_t claimed_count = 0;
+  while (claimed_count < tuple_count) {
+    size_t active_itr = 0;
+    auto tile_group = GetActiveTileGroup(active_itr);
+    oid_t first_slot = INVALID_OID;
+    oid_t slot_count = tile_group->GetHeader()->GetNextEmptyTupleSlots(
+        tuple_count - claimed_count, first_slot);
+
+    // some other thread is allocating a new tile group
+    if (slot_count == 0) {
+      _mm_pause();
+      continue;
+    }
+
+    // we got the last slots, so create a new tile group, or passed the
+    // middle, so build the next one ahead
+    auto allocated_tuple_count = tile_group->GetAllocatedTupleCount();
+    if (first_slot + slot_count == allocated_tuple_count) {
+      AddDefaultTileGroup(active_itr);
+    } else if (first_slot <= allocated_tuple_count / 2 &&
+               first_slot + slot_count > allocated_tuple_count / 2) {
+      PrepareSpareTileGroup();
+    }
+
+    auto tile_group_id = tile_group->GetTileGroupId();
+    for (oid_t slot_itr = 0; slot_itr < slot_count; slot_itr++) {
+      locations.push_back(ItemPointer(tile_group_id, first_slot + slot_itr));
+    }
+
+    runs.push_back({tile_group, first_slot, slot_count, claimed_count});
+    claimed_count += slot_count;
+  }
+
+  // Fill the slots, a run of columns at a time. A run is copied by a single
+  // task, so that the varlen pools of a tile group are only used by one
+  // thread at a time.
+  std::vector<const Tuple *> tuple_ptrs;
+  tuple_ptrs.reserve(tuple_count);
+  for (auto &tuple : tuples) tuple_ptrs.push_back(tuple.get());
+
+  auto fill_run = [&tuple_ptrs](const SlotRun &run) {
+    run.tile_group->CopyTuples(tuple_ptrs.data() + run.tuple_offset,
+                               run.slot_count, run.first_slot);
+  };
+
+  if (pool == nullptr || runs.size() == 1) {
+    for (auto &run : runs) fill_run(run);
+  } else {
+    std::vector<std::future<void>> fills;
+    for (auto &run : runs) {
+      fills.push_back(pool->Enqueue(fill_run, std::cref(run)));
+    }
+    for (auto &fill : fills) fill.get();
+  }
+
+  // Index updates, one task per index
+  bool status = true;
+  auto index_count = GetIndexCount();
+  if (pool == nullptr || index_count <= 1) {
+    for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+      status &= InsertInIndex(GetIndex(index_itr), tuples, locations, offset);
+    }
+  } else {
+    std::vector<std::future<bool>> index_inserts;
+    for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+      index_inserts.push_back(pool->Enqueue([this, index_itr, &tuples,
+                                             &locations, offset]() {
+        return InsertInIndex(GetIndex(index_itr), tuples, locations, offset);
+      }));
+    }
+    for (auto &index_insert : index_inserts) status &= index_insert.get();
+  }
+
+  IncreaseNumberOfTuplesBy(tuple_count);
+  for (auto index : indexes_) index->IncreaseNumberOfTuplesBy(tuple_count);
+
+  LOG_TRACE("Inserted %lu tuples in %lu runs", tuple_count, runs.size());
+  return status;
+}
+
+bool DataTable::InsertInIndex(
+    index::Index *index, const std::vector<std::unique_ptr<Tuple>> &tuples,
+    const std::vector<ItemPointer> &locations, size_t offset) {
+  auto index_schema = index->GetKeySchema();
+  auto indexed_columns = index_schema->GetIndexedColumns();
+
+  std::vector<std::unique_ptr<storage::Tuple>> keys;
+  std::vector<const storage::Tuple *> key_ptrs;
+  keys.reserve(tuples.size());
+  key_ptrs.reserve(tuples.size());
+  for (auto &tuple : tuples) {
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+    key->SetFromTuple(tuple.get(), indexed_columns, index->GetPool());
+    key_ptrs.push_back(key.get());
+    keys.push_back(std::move(key));
+  }
+
+  std::vector<ItemPointer> key_locations(locations.begin() + offset,
+                                         locations.end());
+  return index->InsertEntries(key_ptrs, key_locations);
+}
+
 /**
  * @brief Insert a tuple into all indexes. If index is primary/unique,
  * check visibility of existing
@@ -437,11 +574,12 @@ void DataTable::ResetDirty() { dirty_ = false; }
 //===--------------------------------------------------------------------===//
 
 TileGroup *DataTable::GetTileGroupWithLayout(
-    const column_map_type &partitioning) {
+    const column_map_type &partitioning, oid_t tile_group_id) {
   std::vector<catalog::Schema> schemas;
-  oid_t tile_group_id = INVALID_OID;
 
-  tile_group_id = catalog::Manager::GetInstance().GetNextOid();
+  if (tile_group_id == INVALID_OID) {
+    tile_group_id = catalog::Manager::GetInstance().GetNextOid();
+  }
 
   // Figure out the columns in each tile in new layout
   std::map<std::pair<oid_t, oid_t>, oid_t> tile_column_map;
@@ -502,39 +640,91 @@ column_map_type DataTable::GetTileGroupLayout(LayoutType layout_type) {
   return column_map;
 }
 
-oid_t DataTable::AddDefaultTileGroup() {
-  column_map_type column_map;
-  oid_t tile_group_id = INVALID_OID;
+oid_t DataTable::AddDefaultTileGroup(const size_t &active_tile_group_offset) {
+  PL_ASSERT(active_tile_group_offset < active_tile_group_count_);
+  std::shared_ptr<TileGroup> tile_group;
 
-  // Figure out the partitioning for given tilegroup layout
-  column_map = GetTileGroupLayout((LayoutType)peloton_layout_mode);
+  // Take a tile group built ahead of time, if there is one
+  spare_tile_group_lock_.Lock();
+  if (spare_tile_groups_.empty() == false) {
+    tile_group = spare_tile_groups_.back();
+    spare_tile_groups_.pop_back();
+  }
+  spare_tile_group_lock_.Unlock();
 
-  // Create a tile group with that partitioning
-  std::shared_ptr<TileGroup> tile_group(GetTileGroupWithLayout(column_map));
+  if (tile_group == nullptr) {
+    // Figure out the partitioning for given tilegroup layout
+    auto column_map = GetTileGroupLayout((LayoutType)peloton_layout_mode);
+
+    // Create a tile group with that partitioning
+    tile_group.reset(GetTileGroupWithLayout(column_map));
+  }
   PL_ASSERT(tile_group.get());
-  tile_group_id = tile_group->GetTileGroupId();
+  oid_t tile_group_id = tile_group->GetTileGroupId();
 
-  LOG_TRACE("Trying to add a tile group ");
-  {
-    LOG_TRACE("Added a tile group ");
+  AppendTileGroup(tile_group);
 
-    tile_group_lock_.WriteLock();
-    tile_groups_.push_back(tile_group_id);
-    tile_group_lock_.Unlock();
+  // Inserts of this slot move on to the new tile group
+  std::atomic_store(&active_tile_groups_[active_tile_group_offset],
+                    tile_group);
 
-    // add tile group metadata in locator
-    catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
+  return tile_group_id;
+}
+
+void DataTable::PrepareSpareTileGroup() {
+  spare_tile_group_lock_.Lock();
+  auto spare_count = spare_tile_groups_.size();
+  spare_tile_group_lock_.Unlock();
 
-    // we must guarantee that the compiler always add tile group before adding
-    // tile_group_count_.
-    COMPILER_MEMORY_FENCE;
+  // One spare per active tile group is enough
+  if (spare_count >= active_tile_group_count_) return;
+
+  auto column_map = GetTileGroupLayout((LayoutType)peloton_layout_mode);
+  std::shared_ptr<TileGroup> tile_group(GetTileGroupWithLayout(column_map));
 
-    tile_group_count_++;
+  spare_tile_group_lock_.Lock();
+  spare_tile_groups_.push_back(tile_group);
+  spare_tile_group_lock_.Unlock();
 
-    LOG_TRACE("Recording tile group : %u ", tile_group_id);
+  LOG_TRACE("Prepared spare tile group : %u ", tile_group->GetTileGroupId());
+}
+
+std::shared_ptr<TileGroup> DataTable::GetActiveTileGroup(
+    size_t &active_tile_group_offset) {
+  // Threads are spread over the active slots round robin
+  static std::atomic<size_t> next_thread_offset(0);
+  static thread_local size_t thread_offset = next_thread_offset++;
+
+  active_tile_group_offset = thread_offset % active_tile_group_count_;
+  auto &active_tile_group = active_tile_groups_[active_tile_group_offset];
+  auto tile_group = std::atomic_load(&active_tile_group);
+  if (tile_group != nullptr) return tile_group;
+
+  // The slot lost its tile group to recovery
+  active_tile_group_lock_.Lock();
+  tile_group = std::atomic_load(&active_tile_group);
+  if (tile_group == nullptr) {
+    AddDefaultTileGroup(active_tile_group_offset);
+    tile_group = std::atomic_load(&active_tile_group);
   }
+  active_tile_group_lock_.Unlock();
 
-  return tile_group_id;
+  return tile_group;
+}
+
+void DataTable::AppendTileGroup(const std::shared_ptr<TileGroup> &tile_group) {
+  oid_t tile_group_id = tile_group->GetTileGroupId();
+
+  // add tile group metadata in locator
+  catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
+
+  // we must guarantee that readers that see the tile group in the table
+  // also find it in the locator.
+  COMPILER_MEMORY_FENCE;
+
+  tile_groups_.Append(tile_group_id);
+
+  LOG_TRACE("Recording tile group : %u ", tile_group_id);
 }
 
 void DataTable::AddTileGroupWithOidForRecovery(const oid_t &tile_group_id) {
@@ -555,54 +745,60 @@ void DataTable::AddTileGroupWithOidForRecovery(const oid_t &tile_group_id) {
       tuples_per_tilegroup_));
 
   tile_group_lock_.WriteLock();
-  if (std::find(tile_groups_.begin(), tile_groups_.end(),
-                tile_group->GetTileGroupId()) == tile_groups_.end()) {
-    tile_groups_.push_back(tile_group->GetTileGroupId());
-
+  if (tile_groups_.Contains(tile_group_id) == false) {
     LOG_TRACE("Added a tile group ");
 
-    // add tile group metadata in locator
-    catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
-
-    // we must guarantee that the compiler always add tile group before adding
-    // tile_group_count_.
-    COMPILER_MEMORY_FENCE;
-
-    tile_group_count_++;
+    AppendTileGroup(tile_group);
 
-    LOG_TRACE("Recording tile group : %u ", tile_group_id);
+    // inserts go to the newest tile group
+    std::atomic_store(&active_tile_groups_[0], tile_group);
   }
   tile_group_lock_.Unlock();
 }
 
-void DataTable::AddTileGroup(const std::shared_ptr<TileGroup> &tile_group) {
-  oid_t tile_group_id = tile_group->GetTileGroupId();
+void DataTable::ResetTileGroupWithOidForRecovery(
+    const oid_t &tile_group_id, const column_map_type &column_map) {
+  PL_ASSERT(tile_group_id);
+
+  std::shared_ptr<TileGroup> tile_group(
+      GetTileGroupWithLayout(column_map, tile_group_id));
 
   tile_group_lock_.WriteLock();
-  tile_groups_.push_back(tile_group_id);
-  tile_group_lock_.Unlock();
+  if (tile_groups_.Contains(tile_group_id) == false) {
+    AppendTileGroup(tile_group);
 
-  // add tile group in catalog
-  catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
+    std::atomic_store(&active_tile_groups_[0], tile_group);
+  } else {
+    // swap out the stale image in the locator
+    catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
 
-  // we must guarantee that the compiler always add tile group before adding
-  // tile_group_count_.
-  COMPILER_MEMORY_FENCE;
+    // and in the active slots
+    for (auto &active_tile_group : active_tile_groups_) {
+      auto active = std::atomic_load(&active_tile_group);
+      if (active != nullptr && active->GetTileGroupId() == tile_group_id) {
+        std::atomic_store(&active_tile_group, tile_group);
+      }
+    }
+  }
+  tile_group_lock_.Unlock();
+
+  LOG_TRACE("Reset tile group : %u ", tile_group_id);
+}
 
-  tile_group_count_++;
+void DataTable::AddTileGroup(const std::shared_ptr<TileGroup> &tile_group) {
+  AppendTileGroup(tile_group);
 
-  LOG_TRACE("Recording tile group : %u ", tile_group_id);
+  // inserts go to the newest tile group
+  std::atomic_store(&active_tile_groups_[0], tile_group);
 }
 
-size_t DataTable::GetTileGroupCount() const { return tile_group_count_; }
+size_t DataTable::GetTileGroupCount() const { return tile_groups_.GetSize(); }
 
 std::shared_ptr<storage::TileGroup> DataTable::GetTileGroup(
     const oid_t &tile_group_offset) const {
   PL_ASSERT(tile_group_offset < GetTileGroupCount());
 
-  tile_group_lock_.ReadLock();
-  auto tile_group_id = tile_groups_.at(tile_group_offset);
-  tile_group_lock_.Unlock();
+  auto tile_group_id = tile_groups_.Get(tile_group_offset);
 
   return GetTileGroupById(tile_group_id);
 }
@@ -613,15 +809,34 @@ std::shared_ptr<storage::TileGroup> DataTable::GetTileGroupById(
   return manager.GetTileGroup(tile_group_id);
 }
 
+std::shared_ptr<storage::TileGroup> DataTable::PeekTileGroup(
+    const oid_t &tile_group_offset) const {
+  PL_ASSERT(tile_group_offset < GetTileGroupCount());
+
+  auto tile_group_id = tile_groups_.Get(tile_group_offset);
+
+  auto &manager = catalog::Manager::GetInstance();
+  return manager.PeekTileGroup(tile_group_id);
+}
+
 void DataTable::DropTileGroups() {
-  tile_group_count_ = 0;
   auto &catalog_manager = catalog::Manager::GetInstance();
-  for (auto tile_group_id : tile_groups_) {
-    // add tile group in catalog
+  auto tile_group_count = GetTileGroupCount();
+  for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+       tile_group_itr++) {
+    auto tile_group_id = tile_groups_.Get(tile_group_itr);
     catalog_manager.DropTileGroup(tile_group_id);
     LOG_TRACE("Dropping tile group : %u ", tile_group_id);
   }
-  tile_groups_.clear();
+  tile_groups_.Clear();
+
+  for (auto &active_tile_group : active_tile_groups_) {
+    std::atomic_store(&active_tile_group, std::shared_ptr<TileGroup>());
+  }
+
+  spare_tile_group_lock_.Lock();
+  spare_tile_groups_.clear();
+  spare_tile_group_lock_.Unlock();
 }
 
 const std::string DataTable::GetInfo() const {
@@ -672,6 +887,8 @@ void DataTable::AddIndex(index::Index *index) {
   } else if (index_type == INDEX_CONSTRAINT_TYPE_UNIQUE) {
     unique_constraint_count_++;
   }
+
+  catalog::Manager::GetInstance().IncrementCatalogVersion();
 }
 
 index::Index *DataTable::GetIndexWithOid(const oid_t &index_oid) const {
@@ -695,6 +912,8 @@ void DataTable::DropIndexWithOid(const oid_t &index_id) {
     // Drop the index
     indexes_.erase(indexes_.begin() + index_offset);
   }
+
+  catalog::Manager::GetInstance().IncrementCatalogVersion();
 }
 
 index::Index *DataTable::GetIndex(const oid_t &index_offset) const {
@@ -810,25 +1029,39 @@ void SetTransformedTileGroup(storage::TileGroup *orig_tile_group,
     }
   }
 
-  // Finally, copy over the tile header
-  auto header = orig_tile_group->GetHeader();
-  auto new_header = new_tile_group->GetHeader();
-  *new_header = *header;
+  // Finally, take over the tile header. A copy would lose the deletes,
+  // updates and reads that go to the original header until the new tile
+  // group is in the catalog, or later through a reference to the original.
+  new_tile_group->ShareHeader(*orig_tile_group);
+
+  // The values are the same, but were not written through the tile group
+  new_tile_group->RebuildZoneMap();
 }
 
 storage::TileGroup *DataTable::TransformTileGroup(
-    const oid_t &tile_group_offset, const double &theta) {
+    const oid_t &tile_group_offset, const double &theta, bool frozen_only) {
   // First, check if the tile group is in this table
-  if (tile_group_offset >= tile_groups_.size()) {
+  if (tile_group_offset >= tile_groups_.GetSize()) {
     LOG_ERROR("Tile group offset not found in table : %u ", tile_group_offset);
     return nullptr;
   }
 
-  auto tile_group_id = tile_groups_[tile_group_offset];
+  auto tile_group_id = tile_groups_.Get(tile_group_offset);
 
   // Get orig tile group from catalog
   auto &catalog_manager = catalog::Manager::GetInstance();
   auto tile_group = catalog_manager.GetTileGroup(tile_group_id);
+  if (tile_group == nullptr) {
+    return nullptr;
+  }
+
+  // Only move tile groups nobody writes to
+  cid_t newest_begin_cid = 0;
+  if (frozen_only == true &&
+      tile_group->GetHeader()->IsFrozen(newest_begin_cid) == false) {
+    return nullptr;
+  }
+
   auto diff = tile_group->GetSchemaDifference(default_partition_);
 
   // Check threshold for transformation
@@ -848,7 +1081,9 @@ storage::TileGroup *DataTable::TransformTileGroup(
           new_schema, default_partition_,
           tile_group->GetAllocatedTupleCount()));
 
-  // Set the transformed tile group column-at-a-time
+  // Set the transformed tile group column-at-a-time. The tuples of a frozen
+  // tile group are not written any more, only its header is, and the header
+  // is shared.
   SetTransformedTileGroup(tile_group.get(), new_tile_group.get());
 
   // Set the location of the new tile group
@@ -886,31 +1121,50 @@ std::map<oid_t, oid_t> DataTable::GetColumnMapStats() {
   return std::move(column_map_stats);
 }
 
-void DataTable::UpdateDefaultPartition() {
+size_t DataTable::GetSampleCount() {
+  std::lock_guard<std::mutex> lock(clustering_mutex_);
+  return samples_.size();
+}
+
+bool DataTable::UpdateDefaultPartition() {
   oid_t column_count = GetSchema()->GetColumnCount();
 
   // TODO: Number of clusters and new sample weight
   oid_t cluster_count = 4;
   double new_sample_weight = 0.01;
 
-  brain::Clusterer clusterer(cluster_count, column_count, new_sample_weight);
+  // TODO: Max number of tiles
+  oid_t tile_count = 2;
+  if (column_count < tile_count) return false;
+
+  column_map_type partition;
 
   // Process all samples
   {
     std::lock_guard<std::mutex> lock(clustering_mutex_);
 
     // Check if we have any samples
-    if (samples_.empty()) return;
+    if (samples_.empty()) return false;
+
+    // The clusters carry over, so that the layout follows the workload
+    if (clusterer_ == nullptr) {
+      clusterer_.reset(new brain::Clusterer(cluster_count, column_count,
+                                            new_sample_weight));
+    }
 
-    for (auto sample : samples_) {
-      clusterer.ProcessSample(sample);
+    for (auto &sample : samples_) {
+      clusterer_->ProcessSample(sample);
     }
 
     samples_.clear();
+
+    partition = clusterer_->GetPartitioning(tile_count);
   }
 
-  // TODO: Max number of tiles
-  default_partition_ = clusterer.GetPartitioning(2);
+  if (partition == default_partition_) return false;
+
+  default_partition_ = partition;
+  return true;
 }
 
 //===--------------------------------------------------------------------===//
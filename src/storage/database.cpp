@@ -14,6 +14,7 @@
 #include <sstream>
 
 #include "catalog/foreign_key.h"
+#include "catalog/manager.h"
 #include "storage/database.h"
 #include "storage/table_factory.h"
 #include "common/logger.h"
@@ -38,6 +39,8 @@ void Database::AddTable(storage::DataTable *table) {
     std::lock_guard<std::mutex> lock(database_mutex);
     tables.push_back(table);
   }
+
+  catalog::Manager::GetInstance().IncrementCatalogVersion();
 }
 
 storage::DataTable *Database::GetTableWithOid(const oid_t table_oid) const {
@@ -71,6 +74,8 @@ void Database::DropTableWithOid(const oid_t table_oid) {
     // Drop the table
     tables.erase(tables.begin() + table_offset);
   }
+
+  catalog::Manager::GetInstance().IncrementCatalogVersion();
 }
 
 storage::DataTable *Database::GetTable(const oid_t table_offset) const {
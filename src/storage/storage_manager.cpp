@@ -22,6 +22,7 @@
 #include <sys/mman.h>
 #include <cpuid.h>
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 
@@ -30,6 +31,7 @@
 #include "common/macros.h"
 #include "common/exception.h"
 #include "storage/storage_manager.h"
+#include "storage/data_file_compactor.h"
 
 //===--------------------------------------------------------------------===//
 // GUC Variables
@@ -132,6 +134,21 @@ int is_cpu_clflush_present(void) {
   return ret;
 }
 
+/*
+ * is_cpu_clflushopt_present -- checks if CLFLUSHOPT instruction is supported
+ */
+int is_cpu_clflushopt_present(void) {
+  unsigned cpuinfo[4] = {0};
+
+  if (!is_cpu_genuine_intel()) return 0;
+
+  cpuid(0x7, 0x0, cpuinfo);
+
+  int ret = (cpuinfo[EBX_IDX] & bit_CLFLUSHOPT) != 0;
+
+  return ret;
+}
+
 /*
  * is_cpu_clwb_present -- checks if CLWB instruction is supported
  */
@@ -179,6 +196,18 @@ static inline void flush_clflush(const void *addr, size_t len) {
     _mm_clflush((char *)uptr);
 }
 
+// flush_clflushopt -- (internal) flush the CPU cache, using clflushopt
+static inline void flush_clflushopt(const void *addr, size_t len) {
+  uintptr_t uptr;
+
+  // Loop through cache-line-size (typically 64B) aligned chunks
+  // covering the given range.
+  for (uptr = (uintptr_t)addr & ~(FLUSH_ALIGN - 1);
+       uptr < (uintptr_t)addr + len; uptr += FLUSH_ALIGN) {
+    _mm_clflushopt((char *)uptr);
+  }
+}
+
 // flush_clwb -- (internal) flush the CPU cache, using clwb
 static inline void flush_clwb(const void *addr, size_t len) {
   uintptr_t uptr;
@@ -272,15 +301,21 @@ StorageManager &StorageManager::GetInstance(void) {
   return storage_manager;
 }
 
-StorageManager::StorageManager()
-    : data_file_address(nullptr), data_file_len(0), data_file_offset(0) {
+StorageManager::StorageManager() : data_file_len(0) {
   // Check if we need a data pool
   if (IsBasedOnWriteAheadLogging(peloton_logging_mode) == true ||
       peloton_logging_mode == LOGGING_TYPE_INVALID) {
     return;
   }
 
-  // Check for instruction availability
+  // Check for instruction availability, clwb is preferred over clflushopt
+  // since it keeps the lines in the cache
+  if (is_cpu_clflushopt_present()) {
+    LOG_TRACE("Found clflushopt \n");
+    Func_flush = flush_clflushopt;
+    Func_predrain_fence = predrain_fence_sfence;
+  }
+
   if (is_cpu_clwb_present()) {
     LOG_TRACE("Found clwb \n");
     Func_flush = flush_clwb;
@@ -362,43 +397,27 @@ StorageManager::StorageManager()
     exit(EXIT_FAILURE);
   }
 
-  // Allocate the data file
-  if ((errno = posix_fallocate(data_fd, 0, data_file_len)) != 0) {
-    perror("posix_fallocate");
-    exit(EXIT_FAILURE);
-  }
-
-  // map the data file in memory
-  if ((data_file_address = mmap(NULL, data_file_len, PROT_READ | PROT_WRITE,
-                                MAP_SHARED, data_fd, 0)) == MAP_FAILED) {
-    perror("mmap");
-    exit(EXIT_FAILURE);
-  }
+  // the allocator grows, maps and eventually closes the data file
+  data_file_allocator.reset(new DataFileAllocator(data_fd, data_file_len));
 
-  // close the pmem file -- it will remain mapped
-  close(data_fd);
+  data_file_compactor.reset(new DataFileCompactor(*data_file_allocator));
+  data_file_compactor->Start(FLAGS_data_file_compaction_interval);
 }
 
 StorageManager::~StorageManager() {
   LOG_TRACE("Allocation count : %ld \n", allocation_count);
 
-  // Check if we need a PMEM pool
-  if (peloton_logging_mode != LOGGING_TYPE_NVM_WBL) return;
-
   // sync and unmap the data file
-  if (data_file_address != nullptr) {
-    // sync the mmap'ed file to SSD or HDD
-    int status = msync(data_file_address, data_file_len, MS_SYNC);
-    if (status != 0) {
-      perror("msync");
-      exit(EXIT_FAILURE);
-    }
+  data_file_compactor.reset();
+  data_file_allocator.reset();
+}
 
-    if (munmap(data_file_address, data_file_len)) {
-      perror("munmap");
-      exit(EXIT_FAILURE);
-    }
+DataFileStats StorageManager::GetDataFileStats() const {
+  if (data_file_allocator == nullptr) {
+    return DataFileStats();
   }
+
+  return data_file_allocator->GetStats();
 }
 
 void *StorageManager::Allocate(BackendType type, size_t size) {
@@ -408,39 +427,17 @@ void *StorageManager::Allocate(BackendType type, size_t size) {
   switch (type) {
     case BACKEND_TYPE_MM:
     case BACKEND_TYPE_NVM: {
-      return ::operator new(size);
+      return TileGroupArena::GetInstance().Allocate(size);
     } break;
 
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      {
-        size_t cache_data_file_offset = 0;
-
-        // Lock the file
-        data_file_spinlock.Lock();
-
-        // Check if within bounds
-        if (data_file_offset < data_file_len) {
-          cache_data_file_offset = data_file_offset;
-
-          // Offset by the requested size
-          data_file_offset += size;
-
-          // Unlock the file
-          data_file_spinlock.Unlock();
-
-          void *address = reinterpret_cast<char *>(data_file_address) +
-                          cache_data_file_offset;
-          return address;
-        }
-
-        data_file_spinlock.Unlock();
-        throw Exception("no more memory available: offset : " +
-                        std::to_string(data_file_offset) + " length : " +
-                        std::to_string(data_file_len));
-
-        return nullptr;
+      if (data_file_allocator == nullptr) {
+        throw Exception("no data file for backend: " +
+                        std::to_string(type));
       }
+
+      return data_file_allocator->Allocate(size);
     } break;
 
     case BACKEND_TYPE_INVALID:
@@ -452,15 +449,20 @@ void *StorageManager::Allocate(BackendType type, size_t size) {
 }
 
 void StorageManager::Release(BackendType type, void *address) {
+  // Update release count
+  release_count++;
+
   switch (type) {
     case BACKEND_TYPE_MM:
     case BACKEND_TYPE_NVM: {
-      ::operator delete(address);
+      TileGroupArena::GetInstance().Release(address);
     } break;
 
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      // Nothing to do here
+      if (data_file_allocator != nullptr) {
+        data_file_allocator->Release(address);
+      }
     } break;
 
     case BACKEND_TYPE_INVALID:
@@ -472,28 +474,67 @@ void StorageManager::Release(BackendType type, void *address) {
 }
 
 void StorageManager::Sync(BackendType type, void *address, size_t length) {
+  std::vector<SyncRange> ranges;
+  ranges.emplace_back(address, length);
+
+  SyncBatch(type, ranges);
+}
+
+void StorageManager::SyncBatch(BackendType type,
+                               std::vector<SyncRange> &ranges) {
+  if (ranges.empty()) {
+    return;
+  }
+
   switch (type) {
     case BACKEND_TYPE_MM: {
       // Nothing to do here
     } break;
 
     case BACKEND_TYPE_NVM: {
-      // flush writes to NVM
-      Func_flush(address, length);
+      // flush writes to NVM, and wait for all of them at once
+      for (auto &range : ranges) {
+        Func_flush(range.address, range.length);
+      }
       Func_drain();
       clflush_count++;
     } break;
 
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      // sync the mmap'ed file to SSD or HDD
-      int status = msync(data_file_address, data_file_len, MS_SYNC);
-      if (status != 0) {
-        perror("msync");
-        exit(EXIT_FAILURE);
+      // msync works on whole pages
+      static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+
+      std::vector<std::pair<uintptr_t, uintptr_t>> pages;
+      for (auto &range : ranges) {
+        uintptr_t begin = (uintptr_t)range.address & ~(page_size - 1);
+        uintptr_t end = (uintptr_t)range.address + range.length;
+        pages.emplace_back(begin, end);
       }
+      std::sort(pages.begin(), pages.end());
+
+      // Coalesce overlapping and adjacent pages
+      auto sync_pages = [this](uintptr_t begin, uintptr_t end) {
+        // sync the mmap'ed file to SSD or HDD
+        int status = msync((void *)begin, end - begin, MS_SYNC);
+        if (status != 0) {
+          perror("msync");
+          exit(EXIT_FAILURE);
+        }
 
-      msync_count++;
+        msync_count++;
+      };
+
+      uintptr_t begin = pages.front().first;
+      uintptr_t end = pages.front().second;
+      for (auto &page : pages) {
+        if (page.first > end) {
+          sync_pages(begin, end);
+          begin = page.first;
+        }
+        end = std::max(end, page.second);
+      }
+      sync_pages(begin, end);
     } break;
 
     case BACKEND_TYPE_INVALID:
@@ -16,10 +16,13 @@
 
 #include "catalog/schema.h"
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/pool.h"
 #include "common/serializer.h"
 #include "common/types.h"
+#include "common/varlen.h"
 #include "common/macros.h"
+#include "storage/compressed_column.h"
 #include "storage/tuple_iterator.h"
 #include "storage/tuple.h"
 #include "storage/storage_manager.h"
@@ -49,6 +52,7 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
       uninlined_data_size(0),
       column_header(NULL),
       column_header_size(INVALID_OID),
+      compressed(false),
       tile_group_header(tile_header) {
   PL_ASSERT(tuple_count > 0);
 
@@ -70,20 +74,151 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
 }
 
 Tile::~Tile() {
-  // reclaim the tile memory (INLINED data)
-  auto &storage_manager = storage::StorageManager::GetInstance();
-  storage_manager.Release(backend_type, data);
-  data = NULL;
+  // reclaim the tile memory (INLINED and UNINLINED data)
+  ReleaseData();
+
+  // clear any cached column headers
+  if (column_header) delete column_header;
+  column_header = NULL;
+}
+
+void Tile::FreeUninlinedData(const oid_t tuple_offset) {
+  if (schema.IsInlined() == true || compressed == true) return;
+
+  PL_ASSERT(tuple_offset < num_tuple_slots);
+  char *tuple_location = GetTupleLocation(tuple_offset);
+
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    if (schema.IsInlined(column_itr) == true) continue;
+
+    auto field_location = reinterpret_cast<Varlen **>(
+        tuple_location + schema.GetOffset(column_itr));
+    Varlen::Destroy(*field_location, pool);
+    *field_location = nullptr;
+  }
+}
+
+char *Tile::RelocateData(char *new_data) {
+  data_lock.Lock();
+
+  // Compressed tiles don't need their data much longer
+  if (compressed == true) {
+    data_lock.Unlock();
+    return nullptr;
+  }
+
+  char *old_data = data;
+
+  // The copy is complete before anybody finds it
+  COMPILER_MEMORY_FENCE;
+  data = new_data;
+
+  data_lock.Unlock();
+  return old_data;
+}
+
+//===--------------------------------------------------------------------===//
+// Compression
+//===--------------------------------------------------------------------===//
+
+bool Tile::Compress() {
+  if (compressed == true) return true;
+
+  std::vector<std::unique_ptr<CompressedColumn>> columns;
+  size_t compressed_size = 0;
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    std::unique_ptr<CompressedColumn> column(
+        CompressedColumn::Compress(this, column_itr, num_tuple_slots));
+    if (column == nullptr) return false;
+
+    compressed_size += column->GetSize();
+    columns.push_back(std::move(column));
+  }
+
+  data_lock.Lock();
+  compressed_columns = std::move(columns);
+
+  // The columns are complete before any reader switches to them
+  COMPILER_MEMORY_FENCE;
+  compressed = true;
+  data_lock.Unlock();
+
+  LOG_TRACE("Compressed tile %u from %lu to %lu bytes", tile_id,
+            tile_size + (pool ? pool->GetAllocatedMemory() : 0),
+            compressed_size);
+  return true;
+}
+
+void Tile::ReleaseUncompressedData() {
+  data_lock.Lock();
+
+  // A tile that was evicted meanwhile has no plain data left to drop
+  if (compressed == true) ReleaseData();
+
+  data_lock.Unlock();
+}
+
+void Tile::ReleaseData() {
+  if (data != NULL) {
+    auto &storage_manager = storage::StorageManager::GetInstance();
+    storage_manager.Release(backend_type, data);
+    data = NULL;
+  }
 
-  // reclaim the tile memory (UNINLINED data)
   if (schema.IsInlined() == false) {
     delete pool;
   }
   pool = NULL;
+}
 
-  // clear any cached column headers
-  if (column_header) delete column_header;
-  column_header = NULL;
+size_t Tile::GetCompressedSize() const {
+  size_t compressed_size = 0;
+  for (auto &column : compressed_columns) {
+    compressed_size += column->GetSize();
+  }
+  return compressed_size;
+}
+
+//===--------------------------------------------------------------------===//
+// Eviction
+//===--------------------------------------------------------------------===//
+
+void Tile::ReleaseEvictedData() {
+  data_lock.Lock();
+  ReleaseData();
+  compressed = false;
+  compressed_columns.clear();
+  data_lock.Unlock();
+}
+
+void Tile::RestoreEvictedData(SerializeInputBE &input,
+                              const std::vector<oid_t> &tuple_slots) {
+  PL_ASSERT(data == NULL && compressed == false);
+
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  char *new_data = reinterpret_cast<char *>(
+      storage_manager.Allocate(backend_type, tile_size));
+  PL_ASSERT(new_data != NULL);
+  PL_MEMSET(new_data, 0, tile_size);
+
+  data_lock.Lock();
+  data = new_data;
+  if (schema.IsInlined() == false) {
+    pool = new VarlenPool(backend_type);
+  }
+  data_lock.Unlock();
+
+  input.ReadInt();  // tile length
+  DeserializeTuplesFrom(input, tuple_slots, pool);
+}
+
+size_t Tile::GetResidentSize() {
+  if (compressed == true) return GetCompressedSize();
+  if (data == NULL) return 0;
+
+  size_t resident_size = tile_size;
+  if (pool != NULL) resident_size += pool->GetAllocatedMemory();
+  return resident_size;
 }
 
 //===--------------------------------------------------------------------===//
@@ -112,6 +247,10 @@ Value Tile::GetValue(const oid_t tuple_offset, const oid_t column_id) {
   PL_ASSERT(tuple_offset < GetAllocatedTupleCount());
   PL_ASSERT(column_id < schema.GetColumnCount());
 
+  if (compressed == true) {
+    return compressed_columns[column_id]->GetValue(tuple_offset);
+  }
+
   const ValueType column_type = schema.GetType(column_id);
 
   const char *tuple_location = GetTupleLocation(tuple_offset);
@@ -131,6 +270,14 @@ Value Tile::GetValueFast(const oid_t tuple_offset, const size_t column_offset,
   PL_ASSERT(tuple_offset < GetAllocatedTupleCount());
   PL_ASSERT(column_offset < schema.GetLength());
 
+  if (compressed == true) {
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      if (schema.GetOffset(column_itr) == column_offset) {
+        return compressed_columns[column_itr]->GetValue(tuple_offset);
+      }
+    }
+  }
+
   const char *tuple_location = GetTupleLocation(tuple_offset);
   const char *field_location = tuple_location + column_offset;
 
@@ -372,6 +519,36 @@ bool Tile::SerializeTuplesTo(SerializeOutput &output, Tuple *tuples,
   return true;
 }
 
+// Serialized only the tuple slots specified, along with header. Works on
+// compressed tiles as well.
+bool Tile::SerializeTuplesTo(SerializeOutput &output,
+                             const std::vector<oid_t> &tuple_slots) {
+  std::size_t pos = output.Position();
+  output.WriteInt(-1);
+
+  // Serialize the header
+  if (!SerializeHeaderTo(output)) return false;
+
+  output.WriteInt(static_cast<int32_t>(tuple_slots.size()));
+  for (auto tuple_slot : tuple_slots) {
+    PL_ASSERT(tuple_slot < num_tuple_slots);
+
+    // Same layout as Tuple::SerializeTo
+    std::size_t start = output.ReserveBytes(4);
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      GetValue(tuple_slot, column_itr).SerializeTo(output);
+    }
+    output.WriteIntAt(start, static_cast<int32_t>(output.Position() - start -
+                                                  sizeof(int32_t)));
+  }
+
+  // Length prefix is non-inclusive
+  output.WriteIntAt(
+      pos, static_cast<int32_t>(output.Position() - pos - sizeof(int32_t)));
+
+  return true;
+}
+
 /**
  * Loads only tuple data, not schema, from the serialized tile.
  * Used for initial data loading.
@@ -459,6 +636,29 @@ void Tile::DeserializeTuplesFromWithoutHeader(SerializeInputBE &input,
   }
 }
 
+/**
+ * Loads tuple data into the given tuple slots. The column header is skipped,
+ * so it must match the schema of this tile.
+ * Used for checkpoint recovery where only the visible tuples were serialized.
+ */
+void Tile::DeserializeTuplesFrom(SerializeInputBE &input,
+                                 const std::vector<oid_t> &tuple_slots,
+                                 VarlenPool *pool) {
+  // Skip the column header
+  int32_t header_size = input.ReadInt();
+  input.GetRawPointer(header_size);
+
+  oid_t tuple_count = input.ReadInt();
+  PL_ASSERT(tuple_count == tuple_slots.size());
+
+  storage::Tuple temp_tuple(&schema, GetTupleLocation(0));
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; ++tuple_itr) {
+    PL_ASSERT(tuple_slots[tuple_itr] < num_tuple_slots);
+    temp_tuple.Move(GetTupleLocation(tuple_slots[tuple_itr]));
+    temp_tuple.DeserializeFrom(input, pool);
+  }
+}
+
 // active tuple slots
 oid_t Tile::GetActiveTupleCount() const {
   // For normal tiles
@@ -477,6 +677,17 @@ void Tile::Sync() {
   storage_manager.Sync(backend_type, data, tile_size);
 }
 
+void Tile::GetSyncRanges(oid_t begin_slot, oid_t end_slot,
+                         std::vector<SyncRange> &ranges) const {
+  end_slot = std::min(end_slot, num_tuple_slots);
+  if (begin_slot >= end_slot) {
+    return;
+  }
+
+  ranges.emplace_back(GetTupleLocation(begin_slot),
+                      (end_slot - begin_slot) * tuple_length);
+}
+
 //===--------------------------------------------------------------------===//
 // Utilities
 //===--------------------------------------------------------------------===//
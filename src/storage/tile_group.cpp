@@ -16,14 +16,19 @@
 #include <numeric>
 
 #include "common/platform.h"
+#include "common/pool.h"
 #include "catalog/manager.h"
 #include "common/logger.h"
 #include "common/types.h"
+#include "common/varlen.h"
 #include "storage/abstract_table.h"
 #include "storage/tile.h"
 #include "storage/tuple.h"
+#include "storage/tile_group_evictor.h"
 #include "storage/tile_group_header.h"
+#include "storage/storage_manager.h"
 #include "storage/rollback_segment.h"
+#include "storage/zone_map.h"
 
 namespace peloton {
 namespace storage {
@@ -38,6 +43,7 @@ TileGroup::TileGroup(BackendType backend_type,
       backend_type(backend_type),
       tile_schemas(schemas),
       tile_group_header(tile_group_header),
+      shared_header(tile_group_header),
       table(table),
       num_tuple_slots(tuple_count),
       column_map(column_map) {
@@ -54,13 +60,70 @@ TileGroup::TileGroup(BackendType backend_type,
     // Add a reference to the tile in the tile group
     tiles.push_back(tile);
   }
+
+  // Column of every tile column
+  std::map<std::pair<oid_t, oid_t>, oid_t> tile_column_map;
+  for (auto entry : column_map) {
+    tile_column_map[entry.second] = entry.first;
+  }
+
+  column_runs.resize(tile_count);
+  std::vector<ValueType> column_types;
+  oid_t column_itr = 0;
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    const catalog::Schema &schema = tile_schemas[tile_itr];
+    auto &runs = column_runs[tile_itr];
+
+    for (oid_t tile_column_itr = 0;
+         tile_column_itr < schema.GetColumnCount(); tile_column_itr++) {
+      // Without a map entry, columns follow the order of the tiles
+      oid_t column_id = column_itr++;
+      auto entry = tile_column_map.find(std::make_pair(tile_itr,
+                                                       tile_column_itr));
+      if (entry != tile_column_map.end()) column_id = entry->second;
+
+      if (column_id >= column_types.size()) {
+        column_types.resize(column_id + 1, VALUE_TYPE_INVALID);
+      }
+      column_types[column_id] = schema.GetType(tile_column_itr);
+
+      bool is_inlined = schema.IsInlined(tile_column_itr);
+      if (is_inlined && runs.empty() == false) {
+        auto &run = runs.back();
+        if (run.is_inlined &&
+            run.column_id + run.column_count == column_id &&
+            run.tile_column_id + run.column_count == tile_column_itr) {
+          run.column_count++;
+          continue;
+        }
+      }
+      runs.push_back({column_id, tile_column_itr, 1, is_inlined});
+    }
+  }
+
+  zone_map.reset(new ZoneMap(column_types));
+
+  // New tile groups start out hot
+  evicted.store(false);
+  last_access_round.store(TileGroupEvictor::GetInstance().GetRound());
+  access_round_count.store(1);
 }
 
 TileGroup::~TileGroup() {
   // Drop references on all tiles
 
-  // clean up tile group header
-  delete tile_group_header;
+  // the tile group header goes with the last tile group sharing it
+}
+
+void TileGroup::ShareHeader(const TileGroup &tile_group) {
+  PL_ASSERT(tile_group.num_tuple_slots == num_tuple_slots);
+
+  tile_group_header = tile_group.tile_group_header;
+  shared_header = tile_group.shared_header;
+  tile_group_header->SetTileGroup(this);
+  for (auto &tile : tiles) {
+    tile->SetHeader(tile_group_header);
+  }
 }
 
 oid_t TileGroup::GetTileId(const oid_t tile_id) const {
@@ -127,36 +190,89 @@ void TileGroup::ApplyRollbackSegment(char *rb_seg, const oid_t &tuple_slot_id) {
 }
 
 /**
- * Grab next slot (thread-safe) and fill in the tuple
+ * Overwrite the tuple at the slot in place
  *
- * Returns slot where inserted (INVALID_ID if not inserted)
+ * The strings of the old tuple go back to the pools of the tiles
  */
 void TileGroup::CopyTuple(const Tuple *tuple, const oid_t &tuple_slot_id) {
   LOG_TRACE("Tile Group Id :: %u status :: %u out of %u slots ", tile_group_id,
             tuple_slot_id, num_tuple_slots);
 
-  oid_t tile_column_count;
-  oid_t column_itr = 0;
-
+  std::vector<std::pair<Varlen *, VarlenPool *>> old_varlens;
   for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
     const catalog::Schema &schema = tile_schemas[tile_itr];
-    tile_column_count = schema.GetColumnCount();
+    if (schema.IsInlined() == true) continue;
 
     storage::Tile *tile = GetTile(tile_itr);
-    PL_ASSERT(tile);
-    char *tile_tuple_location = tile->GetTupleLocation(tuple_slot_id);
-    PL_ASSERT(tile_tuple_location);
+    char *location = tile->GetTupleLocation(tuple_slot_id);
+    for (oid_t column_itr = 0; column_itr < schema.GetColumnCount();
+         column_itr++) {
+      if (schema.IsInlined(column_itr) == true) continue;
+      old_varlens.emplace_back(*reinterpret_cast<Varlen **>(
+                                   location + schema.GetOffset(column_itr)),
+                               tile->GetPool());
+    }
+  }
+
+  CopyTuples(&tuple, 1, tuple_slot_id);
 
-    // NOTE:: Only a tuple wrapper
-    storage::Tuple tile_tuple(&schema, tile_tuple_location);
+  // Only now, the new tuple may have been made from the old strings
+  for (auto &old_varlen : old_varlens) {
+    Varlen::Destroy(old_varlen.first, old_varlen.second);
+  }
+}
+
+void TileGroup::CopyTuples(const Tuple *const *tuples,
+                           const oid_t &tuple_count, const oid_t &first_slot) {
+  PL_ASSERT(first_slot + tuple_count <= num_tuple_slots);
+  if (tuple_count == 0) return;
+
+  // The tuples share the schema of the table
+  auto source_schema = tuples[0]->GetSchema();
+
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    const catalog::Schema &schema = tile_schemas[tile_itr];
+    size_t tile_tuple_length = schema.GetLength();
 
-    for (oid_t tile_column_itr = 0; tile_column_itr < tile_column_count;
-         tile_column_itr++) {
-      tile_tuple.SetValue(tile_column_itr, tuple->GetValue(column_itr),
-                          tile->GetPool());
-      column_itr++;
+    storage::Tile *tile = GetTile(tile_itr);
+    PL_ASSERT(tile);
+    char *first_location = tile->GetTupleLocation(first_slot);
+    PL_ASSERT(first_location);
+
+    for (auto &run : column_runs[tile_itr]) {
+      PL_ASSERT(run.column_id + run.column_count <=
+                source_schema->GetColumnCount());
+      size_t source_offset = source_schema->GetOffset(run.column_id);
+      size_t tile_offset = schema.GetOffset(run.tile_column_id);
+      oid_t last_column = run.tile_column_id + run.column_count - 1;
+      size_t run_length = schema.GetOffset(last_column) +
+                          schema.GetLength(last_column) - tile_offset;
+      char *location = first_location + tile_offset;
+
+      if (run.is_inlined) {
+        for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+          PL_MEMCPY(location, tuples[tuple_itr]->GetData() + source_offset,
+                    run_length);
+          location += tile_tuple_length;
+        }
+        continue;
+      }
+
+      // Strings move into the pool of the tile
+      auto pool = tile->GetPool();
+      for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+        auto varlen = *reinterpret_cast<Varlen *const *>(
+            tuples[tuple_itr]->GetData() + source_offset);
+        if (varlen != nullptr) {
+          varlen = Varlen::Clone(*varlen, pool);
+        }
+        *reinterpret_cast<Varlen **>(location) = varlen;
+        location += tile_tuple_length;
+      }
     }
   }
+
+  UpdateZoneMap(first_slot, tuple_count);
 }
 
 // This is commented out before merge
@@ -189,28 +305,7 @@ oid_t TileGroup::InsertTuple(const Tuple *tuple) {
     return INVALID_OID;
   }
 
-  oid_t tile_column_count;
-  oid_t column_itr = 0;
-
-  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
-    const catalog::Schema &schema = tile_schemas[tile_itr];
-    tile_column_count = schema.GetColumnCount();
-
-    storage::Tile *tile = GetTile(tile_itr);
-    PL_ASSERT(tile);
-    char *tile_tuple_location = tile->GetTupleLocation(tuple_slot_id);
-    PL_ASSERT(tile_tuple_location);
-
-    // NOTE:: Only a tuple wrapper
-    storage::Tuple tile_tuple(&schema, tile_tuple_location);
-
-    for (oid_t tile_column_itr = 0; tile_column_itr < tile_column_count;
-         tile_column_itr++) {
-      tile_tuple.SetValue(tile_column_itr, tuple->GetValue(column_itr),
-                          tile->GetPool());
-      column_itr++;
-    }
-  }
+  CopyTuples(&tuple, 1, tuple_slot_id);
 
   // Set MVCC info
   PL_ASSERT(tile_group_header->GetTransactionId(tuple_slot_id) ==
@@ -244,30 +339,73 @@ oid_t TileGroup::InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
   LOG_TRACE("Tile Group Id :: %u status :: %u out of %u slots ", tile_group_id,
             tuple_slot_id, num_tuple_slots);
 
-  oid_t tile_column_count;
-  oid_t column_itr = 0;
+  CopyTuples(&tuple, 1, tuple_slot_id);
 
-  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
-    const catalog::Schema &schema = tile_schemas[tile_itr];
-    tile_column_count = schema.GetColumnCount();
+  // Set MVCC info
+  tile_group_header->SetDirtyCommitId(commit_id);
+  tile_group_header->SetTransactionId(tuple_slot_id, INITIAL_TXN_ID);
+  tile_group_header->SetBeginCommitId(tuple_slot_id, commit_id);
+  tile_group_header->SetEndCommitId(tuple_slot_id, MAX_CID);
+  tile_group_header->SetInsertCommit(tuple_slot_id, false);
+  tile_group_header->SetDeleteCommit(tuple_slot_id, false);
+  tile_group_header->SetNextItemPointer(tuple_slot_id, INVALID_ITEMPOINTER);
 
-    storage::Tile *tile = GetTile(tile_itr);
-    PL_ASSERT(tile);
-    char *tile_tuple_location = tile->GetTupleLocation(tuple_slot_id);
-    PL_ASSERT(tile_tuple_location);
+  tile_group_header->GetHeaderLock().Unlock();
+
+  return tuple_slot_id;
+}
+
+/**
+ * Grab specific slot and fill in the serialized tuple
+ * Used by recovery to replay a tuple straight from the log
+ * Returns slot where inserted (INVALID_ID if not inserted)
+ */
+oid_t TileGroup::InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
+                                         SerializeInputBE &tuple_body) {
+  auto status = tile_group_header->GetEmptyTupleSlot(tuple_slot_id);
+
+  // No more slots
+  if (status == false) return INVALID_OID;
 
-    // NOTE:: Only a tuple wrapper
-    storage::Tuple tile_tuple(&schema, tile_tuple_location);
+  tile_group_header->GetHeaderLock().Lock();
 
-    for (oid_t tile_column_itr = 0; tile_column_itr < tile_column_count;
-         tile_column_itr++) {
-      tile_tuple.SetValue(tile_column_itr, tuple->GetValue(column_itr),
-                          tile->GetPool());
-      column_itr++;
+  cid_t current_begin_cid = tile_group_header->GetBeginCommitId(tuple_slot_id);
+  if (current_begin_cid != MAX_CID && current_begin_cid > commit_id) {
+    tile_group_header->GetHeaderLock().Unlock();
+    return tuple_slot_id;
+  }
+
+  LOG_TRACE("Tile Group Id :: %u status :: %u out of %u slots ", tile_group_id,
+            tuple_slot_id, num_tuple_slots);
+
+  // The columns are logged in table order, which is the order of the column
+  // map. Each one is read straight into its tile, strings into the tile pool.
+  tuple_body.ReadInt();
+  for (auto &entry : column_map) {
+    storage::Tile *tile = GetTile(entry.second.first);
+    PL_ASSERT(tile);
+    const catalog::Schema &schema = tile_schemas[entry.second.first];
+    oid_t tile_column_id = entry.second.second;
+
+    const bool is_inlined = schema.IsInlined(tile_column_id);
+    int32_t column_length;
+    if (is_inlined) {
+      column_length = schema.GetLength(tile_column_id);
+    } else {
+      column_length = schema.GetVariableLength(tile_column_id);
     }
+    char *location = tile->GetTupleLocation(tuple_slot_id) +
+                     schema.GetOffset(tile_column_id);
+
+    Value::DeserializeFrom(tuple_body, tile->GetPool(), location,
+                           schema.GetType(tile_column_id), is_inlined,
+                           column_length, false);
   }
 
+  UpdateZoneMap(tuple_slot_id, 1);
+
   // Set MVCC info
+  tile_group_header->SetDirtyCommitId(commit_id);
   tile_group_header->SetTransactionId(tuple_slot_id, INITIAL_TXN_ID);
   tile_group_header->SetBeginCommitId(tuple_slot_id, commit_id);
   tile_group_header->SetEndCommitId(tuple_slot_id, MAX_CID);
@@ -296,6 +434,7 @@ oid_t TileGroup::DeleteTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id) {
     return INVALID_OID;
   }
   // Set MVCC info
+  tile_group_header->SetDirtyCommitId(commit_id);
   tile_group_header->SetTransactionId(tuple_slot_id, INVALID_TXN_ID);
   tile_group_header->SetBeginCommitId(tuple_slot_id, commit_id);
   tile_group_header->SetEndCommitId(tuple_slot_id, commit_id);
@@ -324,6 +463,7 @@ oid_t TileGroup::UpdateTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
     return INVALID_OID;
   }
   // Set MVCC info
+  tile_group_header->SetDirtyCommitId(commit_id);
   tile_group_header->SetTransactionId(tuple_slot_id, INVALID_TXN_ID);
   tile_group_header->SetBeginCommitId(tuple_slot_id, commit_id);
   tile_group_header->SetEndCommitId(tuple_slot_id, commit_id);
@@ -350,28 +490,7 @@ oid_t TileGroup::InsertTupleFromCheckpoint(oid_t tuple_slot_id,
   LOG_TRACE("Tile Group Id :: %u status :: %u out of %u slots ", tile_group_id,
             tuple_slot_id, num_tuple_slots);
 
-  oid_t tile_column_count;
-  oid_t column_itr = 0;
-
-  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
-    const catalog::Schema &schema = tile_schemas[tile_itr];
-    tile_column_count = schema.GetColumnCount();
-
-    storage::Tile *tile = GetTile(tile_itr);
-    PL_ASSERT(tile);
-    char *tile_tuple_location = tile->GetTupleLocation(tuple_slot_id);
-    PL_ASSERT(tile_tuple_location);
-
-    // NOTE:: Only a tuple wrapper
-    storage::Tuple tile_tuple(&schema, tile_tuple_location);
-
-    for (oid_t tile_column_itr = 0; tile_column_itr < tile_column_count;
-         tile_column_itr++) {
-      tile_tuple.SetValue(tile_column_itr, tuple->GetValue(column_itr),
-                          tile->GetPool());
-      column_itr++;
-    }
-  }
+  CopyTuples(&tuple, 1, tuple_slot_id);
 
   // Set MVCC info
   tile_group_header->SetTransactionId(tuple_slot_id, INITIAL_TXN_ID);
@@ -384,6 +503,36 @@ oid_t TileGroup::InsertTupleFromCheckpoint(oid_t tuple_slot_id,
   return tuple_slot_id;
 }
 
+void TileGroup::UpdateZoneMap(const oid_t &first_slot,
+                              const oid_t &tuple_count) {
+  // Only inlined columns are tracked, each one is folded over the slots
+  ZoneMap::Batch batch(*zone_map);
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    const catalog::Schema &schema = tile_schemas[tile_itr];
+    size_t tile_tuple_length = schema.GetLength();
+    const char *first_location =
+        GetTile(tile_itr)->GetTupleLocation(first_slot);
+
+    for (auto &run : column_runs[tile_itr]) {
+      if (run.is_inlined == false) continue;
+      for (oid_t column_itr = 0; column_itr < run.column_count; column_itr++) {
+        oid_t column_id = run.column_id + column_itr;
+        if (zone_map->IsTracked(column_id) == false) continue;
+        auto location =
+            first_location + schema.GetOffset(run.tile_column_id + column_itr);
+        batch.Fold(column_id, location, tile_tuple_length, tuple_count);
+      }
+    }
+  }
+
+  zone_map->Merge(batch, tuple_count);
+}
+
+void TileGroup::RebuildZoneMap() {
+  zone_map->Reset();
+  UpdateZoneMap(0, GetNextTupleSlot());
+}
+
 // Sets the tile id and column id w.r.t that tile corresponding to
 // the specified tile group column id.
 void TileGroup::LocateTileAndColumn(oid_t column_offset, oid_t &tile_offset,
@@ -447,6 +596,22 @@ double TileGroup::GetSchemaDifference(
   return theta;
 }
 
+size_t TileGroup::Compress() {
+  size_t compressed_tile_count = 0;
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    if (tiles[tile_itr]->IsCompressed() == true) continue;
+    if (tiles[tile_itr]->Compress() == true) compressed_tile_count++;
+  }
+  return compressed_tile_count;
+}
+
+bool TileGroup::IsCompressed() const {
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    if (tiles[tile_itr]->IsCompressed() == true) return true;
+  }
+  return false;
+}
+
 void TileGroup::Sync() {
   // Sync the tile group data by syncing all the underlying tiles
   for (auto tile : tiles) {
@@ -454,6 +619,15 @@ void TileGroup::Sync() {
   }
 }
 
+void TileGroup::GetSyncRanges(oid_t begin_slot, oid_t end_slot,
+                              std::vector<SyncRange> &ranges) const {
+  for (auto tile : tiles) {
+    tile->GetSyncRanges(begin_slot, end_slot, ranges);
+  }
+
+  tile_group_header->GetSyncRanges(begin_slot, end_slot, ranges);
+}
+
 //===--------------------------------------------------------------------===//
 // Utilities
 //===--------------------------------------------------------------------===//
@@ -0,0 +1,268 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_arena.cpp
+//
+// Identification: src/storage/tile_group_arena.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+#include <algorithm>
+#include <string>
+
+#include "storage/tile_group_arena.h"
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace peloton {
+namespace storage {
+
+// Where a block came from
+enum ArenaBlockKind {
+  ARENA_BLOCK_KIND_HEAP = 0,
+  ARENA_BLOCK_KIND_REGION = 1,
+  ARENA_BLOCK_KIND_MAPPING = 2
+};
+
+struct ArenaBlockHeader {
+  // of the whole block, header included
+  size_t size;
+
+  uint32_t node;
+
+  uint32_t kind;
+};
+
+static_assert(sizeof(ArenaBlockHeader) <= ARENA_BLOCK_HEADER_SIZE,
+              "arena block header does not fit");
+
+static inline size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Number of NUMA nodes, as the kernel reports them
+static size_t GetNodeCount() {
+  size_t node_count = 0;
+  struct stat node_stat;
+  while (true) {
+    std::string node_dir =
+        "/sys/devices/system/node/node" + std::to_string(node_count);
+    if (stat(node_dir.c_str(), &node_stat) != 0) break;
+    node_count++;
+  }
+
+  return std::max(node_count, static_cast<size_t>(1));
+}
+
+TileGroupArena::TileGroupArena(bool huge_pages, bool numa_aware)
+    : huge_pages_(huge_pages) {
+  if (numa_aware) {
+    node_count_ = GetNodeCount();
+  }
+  nodes_.reset(new NodeArena[node_count_]);
+
+  LOG_TRACE("Tile group arena over %lu nodes, huge pages : %d", node_count_,
+            huge_pages_);
+}
+
+TileGroupArena::~TileGroupArena() {
+  for (size_t node_itr = 0; node_itr < node_count_; node_itr++) {
+    for (auto region : nodes_[node_itr].regions) {
+      munmap(region, ARENA_REGION_SIZE);
+    }
+  }
+}
+
+TileGroupArena &TileGroupArena::GetInstance() {
+  // Blocks may still be released while the other singletons go away
+  static TileGroupArena *tile_group_arena =
+      new TileGroupArena(FLAGS_huge_pages, FLAGS_numa_aware_allocation);
+  return *tile_group_arena;
+}
+
+size_t TileGroupArena::GetCurrentNode() const {
+  if (node_count_ == 1) return 0;
+
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= node_count_) {
+    return 0;
+  }
+  return node;
+}
+
+char *TileGroupArena::MapMemory(size_t length, size_t node) {
+  void *address = MAP_FAILED;
+
+  // Reserved huge pages first
+  if (huge_pages_) {
+    address = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (address != MAP_FAILED) {
+      hugetlb_mapping_count_++;
+    }
+  }
+
+  // Else map a bit more, so that the memory can start on a huge page
+  // boundary, and ask for transparent huge pages
+  if (address == MAP_FAILED) {
+    size_t mapped_length = length + ARENA_HUGE_PAGE_SIZE;
+    void *mapped = mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+      throw Exception("could not map memory : length : " +
+                      std::to_string(length));
+    }
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(mapped);
+    uintptr_t aligned_begin = RoundUp(begin, ARENA_HUGE_PAGE_SIZE);
+    if (aligned_begin > begin) {
+      munmap(mapped, aligned_begin - begin);
+    }
+    uintptr_t end = begin + mapped_length;
+    if (end > aligned_begin + length) {
+      munmap(reinterpret_cast<void *>(aligned_begin + length),
+             end - aligned_begin - length);
+    }
+
+    address = reinterpret_cast<void *>(aligned_begin);
+    if (huge_pages_) {
+      madvise(address, length, MADV_HUGEPAGE);
+    }
+  }
+
+  // Prefer the node, the memory is not touched yet
+  if (node_count_ > 1) {
+    unsigned long node_mask = 1UL << node;
+    if (syscall(SYS_mbind, address, length, MPOL_PREFERRED, &node_mask,
+                sizeof(node_mask) * 8, 0) != 0) {
+      LOG_TRACE("Could not bind memory to node %lu", node);
+    }
+  }
+
+  mapped_bytes_ += length;
+  return reinterpret_cast<char *>(address);
+}
+
+void *TileGroupArena::Allocate(size_t size) {
+  size_t block_size = size + ARENA_BLOCK_HEADER_SIZE;
+  char *block = nullptr;
+  ArenaBlockHeader header;
+  header.node = 0;
+
+  if (size < ARENA_MIN_BLOCK_SIZE) {
+    block = reinterpret_cast<char *>(::operator new(block_size));
+    header.kind = ARENA_BLOCK_KIND_HEAP;
+  } else if (block_size > ARENA_MAX_BLOCK_SIZE) {
+    block_size = RoundUp(block_size, ARENA_HUGE_PAGE_SIZE);
+    header.node = GetCurrentNode();
+    block = MapMemory(block_size, header.node);
+    header.kind = ARENA_BLOCK_KIND_MAPPING;
+    mapping_count_++;
+  } else {
+    // Page sized steps keep the free lists few
+    block_size = RoundUp(block_size, ARENA_PAGE_SIZE);
+    header.node = GetCurrentNode();
+    header.kind = ARENA_BLOCK_KIND_REGION;
+
+    auto &node_arena = nodes_[header.node];
+    node_arena.lock.Lock();
+
+    auto free_list_itr = node_arena.free_lists.find(block_size);
+    if (free_list_itr != node_arena.free_lists.end() &&
+        free_list_itr->second.empty() == false) {
+      block = free_list_itr->second.back();
+      free_list_itr->second.pop_back();
+      node_arena.free_bytes -= block_size;
+      reuse_count_++;
+    } else {
+      // Start a new region once the current one is used up
+      if (node_arena.region == nullptr ||
+          node_arena.region_offset + block_size > ARENA_REGION_SIZE) {
+        try {
+          node_arena.region = MapMemory(ARENA_REGION_SIZE, header.node);
+        } catch (Exception &e) {
+          node_arena.lock.Unlock();
+          throw;
+        }
+        node_arena.regions.push_back(node_arena.region);
+        node_arena.region_offset = 0;
+        region_count_++;
+      }
+
+      block = node_arena.region + node_arena.region_offset;
+      node_arena.region_offset += block_size;
+    }
+
+    node_arena.lock.Unlock();
+  }
+
+  header.size = block_size;
+  PL_MEMCPY(block, &header, sizeof(header));
+  return block + ARENA_BLOCK_HEADER_SIZE;
+}
+
+void TileGroupArena::Release(void *address) {
+  if (address == nullptr) return;
+
+  char *block = reinterpret_cast<char *>(address) - ARENA_BLOCK_HEADER_SIZE;
+  ArenaBlockHeader header;
+  PL_MEMCPY(&header, block, sizeof(header));
+
+  switch (header.kind) {
+    case ARENA_BLOCK_KIND_HEAP: {
+      ::operator delete(block);
+    } break;
+
+    case ARENA_BLOCK_KIND_MAPPING: {
+      munmap(block, header.size);
+      mapped_bytes_ -= header.size;
+    } break;
+
+    case ARENA_BLOCK_KIND_REGION: {
+      PL_ASSERT(header.node < node_count_);
+      auto &node_arena = nodes_[header.node];
+      node_arena.lock.Lock();
+      node_arena.free_lists[header.size].push_back(block);
+      node_arena.free_bytes += header.size;
+      node_arena.lock.Unlock();
+    } break;
+
+    default: {
+      LOG_ERROR("Invalid arena block at %p", address);
+    } break;
+  }
+}
+
+TileGroupArenaStats TileGroupArena::GetStats() {
+  TileGroupArenaStats stats;
+  stats.region_count = region_count_;
+  stats.hugetlb_mapping_count = hugetlb_mapping_count_;
+  stats.mapping_count = mapping_count_;
+  stats.reuse_count = reuse_count_;
+  stats.mapped_bytes = mapped_bytes_;
+  stats.node_count = node_count_;
+
+  for (size_t node_itr = 0; node_itr < node_count_; node_itr++) {
+    auto &node_arena = nodes_[node_itr];
+    node_arena.lock.Lock();
+    stats.free_bytes += node_arena.free_bytes;
+    node_arena.lock.Unlock();
+  }
+
+  return stats;
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_compressor.cpp
+//
+// Identification: src/storage/tile_group_compressor.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <chrono>
+
+#include "storage/tile_group_compressor.h"
+
+#include "catalog/manager.h"
+#include "common/logger.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+
+namespace peloton {
+namespace storage {
+
+TileGroupCompressor &TileGroupCompressor::GetInstance() {
+  static TileGroupCompressor tile_group_compressor;
+  return tile_group_compressor;
+}
+
+TileGroupCompressor::~TileGroupCompressor() { Stop(); }
+
+void TileGroupCompressor::Start(size_t interval) {
+  if (interval == 0 || compressor_thread_ != nullptr) return;
+
+  LOG_TRACE("Starting tile group compressor");
+  is_running_ = true;
+  compressor_thread_.reset(
+      new std::thread(&TileGroupCompressor::Running, this, interval));
+}
+
+void TileGroupCompressor::Stop() {
+  if (compressor_thread_ == nullptr) return;
+
+  LOG_TRACE("Stopping tile group compressor");
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+  }
+  stop_cv_.notify_all();
+
+  compressor_thread_->join();
+  compressor_thread_.reset();
+}
+
+void TileGroupCompressor::Running(size_t interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    stop_cv_.wait_for(lock, std::chrono::seconds(interval));
+    if (is_running_ == false) break;
+
+    lock.unlock();
+    auto tile_count = CompressOnce();
+    lock.lock();
+
+    if (tile_count > 0) {
+      LOG_TRACE("Compressed %lu tiles of cold tile groups", tile_count);
+    }
+  }
+}
+
+void TileGroupCompressor::ReleaseRetiredTiles() {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto max_committed_cid = txn_manager.GetMaxCommittedCid();
+
+  size_t retired_itr = 0;
+  while (retired_itr < retired_tiles_.size()) {
+    auto &retired_tile = retired_tiles_[retired_itr];
+    if (retired_tile.second < max_committed_cid) {
+      retired_tile.first->ReleaseUncompressedData();
+      retired_tile = retired_tiles_.back();
+      retired_tiles_.pop_back();
+    } else {
+      retired_itr++;
+    }
+  }
+}
+
+size_t TileGroupCompressor::CompressOnce() {
+  ReleaseRetiredTiles();
+
+  // Versions older than the oldest round went cold
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  round_cids_.push_back(txn_manager.GetCurrentCommitId());
+  if (round_cids_.size() <= TILE_GROUP_COLD_ROUNDS) return 0;
+
+  auto cold_cid = round_cids_.front();
+  round_cids_.pop_front();
+
+  size_t tile_count = 0;
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto database_count = catalog_manager.GetDatabaseCount();
+  for (oid_t database_itr = 0; database_itr < database_count;
+       database_itr++) {
+    auto database = catalog_manager.GetDatabase(database_itr);
+    if (database == nullptr) continue;
+
+    auto table_count = database->GetTableCount();
+    for (oid_t table_itr = 0; table_itr < table_count; table_itr++) {
+      auto table = database->GetTable(table_itr);
+      if (table == nullptr) continue;
+
+      auto tile_group_count = table->GetTileGroupCount();
+      for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+           tile_group_itr++) {
+        // Hold on to the tile group, in case the table goes away meanwhile
+        auto tile_group = table->PeekTileGroup(tile_group_itr);
+        if (tile_group == nullptr || tile_group->IsEvicted() == true) continue;
+
+        // Tiles in files stay as they are, the file is their durable copy
+        if (tile_group->GetBackendType() != BACKEND_TYPE_MM) continue;
+
+        tile_count += CompressTileGroup(tile_group.get(), cold_cid);
+      }
+    }
+  }
+
+  return tile_count;
+}
+
+size_t TileGroupCompressor::CompressTileGroup(TileGroup *tile_group,
+                                              cid_t cold_cid) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  // While the transaction is alive, no slot of the tile group is recycled
+  txn_manager.BeginTransaction();
+
+  // Only compress tile groups nobody wrote to in a while
+  cid_t newest_begin_cid;
+  bool frozen = tile_group->GetHeader()->IsFrozen(newest_begin_cid);
+
+  size_t tile_count = 0;
+  if (frozen == true && newest_begin_cid < cold_cid) {
+    for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+         tile_itr++) {
+      auto tile = tile_group->GetTileReference(tile_itr);
+      if (tile->IsCompressed() == true) continue;
+      if (tile->Compress() == false) continue;
+
+      // Readers that started before now may still be on the plain data
+      retired_tiles_.emplace_back(tile, txn_manager.GetCurrentCommitId());
+      tile_count++;
+    }
+  }
+
+  txn_manager.CommitTransaction();
+
+  return tile_count;
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,495 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_evictor.cpp
+//
+// Identification: src/storage/tile_group_evictor.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/falloc.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+#include "storage/tile_group_evictor.h"
+
+#include "catalog/manager.h"
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "common/serializer.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
+
+namespace peloton {
+namespace storage {
+
+// Bytes the tiles of the tile group take in memory
+static size_t GetResidentSize(TileGroup *tile_group) {
+  size_t resident_size = 0;
+  for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount(); tile_itr++) {
+    resident_size += tile_group->GetTile(tile_itr)->GetResidentSize();
+  }
+  return resident_size;
+}
+
+TileGroupEvictor &TileGroupEvictor::GetInstance() {
+  static TileGroupEvictor tile_group_evictor;
+  return tile_group_evictor;
+}
+
+TileGroupEvictor::~TileGroupEvictor() {
+  Stop();
+
+  if (eviction_fd_ >= 0) {
+    close(eviction_fd_);
+    unlink(eviction_file_name_.c_str());
+  }
+}
+
+void TileGroupEvictor::Start(size_t interval, size_t memory_limit) {
+  if (interval == 0 || evictor_thread_ != nullptr) return;
+
+  LOG_TRACE("Starting tile group evictor");
+  memory_limit_ = memory_limit * 1024 * 1024;
+  is_running_ = true;
+  evictor_thread_.reset(
+      new std::thread(&TileGroupEvictor::Running, this, interval));
+  fault_in_thread_.reset(
+      new std::thread(&TileGroupEvictor::FaultInRunning, this));
+}
+
+void TileGroupEvictor::Stop() {
+  if (evictor_thread_ == nullptr) return;
+
+  LOG_TRACE("Stopping tile group evictor");
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_running_ = false;
+    fault_in_queue_.clear();
+  }
+  stop_cv_.notify_all();
+  fault_in_cv_.notify_all();
+
+  evictor_thread_->join();
+  evictor_thread_.reset();
+  fault_in_thread_->join();
+  fault_in_thread_.reset();
+}
+
+void TileGroupEvictor::Running(size_t interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    stop_cv_.wait_for(lock, std::chrono::seconds(interval));
+    if (is_running_ == false) break;
+
+    lock.unlock();
+    auto tile_group_count = EvictOnce();
+    lock.lock();
+
+    if (tile_group_count > 0) {
+      LOG_TRACE("Evicted %lu cold tile groups", tile_group_count);
+    }
+  }
+}
+
+void TileGroupEvictor::FaultInRunning() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    fault_in_cv_.wait(lock, [this] {
+      return is_running_ == false || fault_in_queue_.empty() == false;
+    });
+    if (is_running_ == false) break;
+
+    auto tile_group_id = fault_in_queue_.front();
+    fault_in_queue_.pop_front();
+
+    lock.unlock();
+    auto &catalog_manager = catalog::Manager::GetInstance();
+    auto tile_group = catalog_manager.PeekTileGroup(tile_group_id);
+    if (tile_group != nullptr) {
+      FaultIn(tile_group.get());
+    }
+    lock.lock();
+  }
+}
+
+void TileGroupEvictor::RequestFaultIn(const oid_t &tile_group_id) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_running_ == false) return;
+    fault_in_queue_.push_back(tile_group_id);
+  }
+  fault_in_cv_.notify_one();
+}
+
+void TileGroupEvictor::ReleaseRetiredTileGroups() {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto max_committed_cid = txn_manager.GetMaxCommittedCid();
+
+  std::lock_guard<std::mutex> lock(eviction_mutex_);
+  size_t retired_itr = 0;
+  while (retired_itr < retired_.size()) {
+    auto &retired = retired_[retired_itr];
+    if (retired.second >= max_committed_cid) {
+      retired_itr++;
+      continue;
+    }
+
+    // Tile groups that were faulted in meanwhile are no longer retired
+    auto tile_group = retired.first.get();
+    auto block_itr = evicted_blocks_.find(tile_group->GetTileGroupId());
+    if (tile_group->IsEvicted() == true && block_itr != evicted_blocks_.end()) {
+      for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+           tile_itr++) {
+        tile_group->GetTile(tile_itr)->ReleaseEvictedData();
+      }
+      block_itr->second.released = true;
+    }
+
+    retired = retired_.back();
+    retired_.pop_back();
+  }
+}
+
+size_t TileGroupEvictor::GetRetiredTileGroupCount() {
+  std::lock_guard<std::mutex> lock(eviction_mutex_);
+  return retired_.size();
+}
+
+size_t TileGroupEvictor::EvictOnce() {
+  ReleaseRetiredTileGroups();
+
+  // Uses from now on count towards the new round
+  auto round = round_.fetch_add(1) + 1;
+
+  struct Candidate {
+    std::shared_ptr<TileGroup> tile_group;
+    uint64_t last_access_round;
+    uint32_t access_round_count;
+    size_t resident_size;
+  };
+
+  std::vector<Candidate> candidates;
+  size_t resident_size = 0;
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto database_count = catalog_manager.GetDatabaseCount();
+  for (oid_t database_itr = 0; database_itr < database_count;
+       database_itr++) {
+    auto database = catalog_manager.GetDatabase(database_itr);
+    if (database == nullptr) continue;
+
+    auto table_count = database->GetTableCount();
+    for (oid_t table_itr = 0; table_itr < table_count; table_itr++) {
+      auto table = database->GetTable(table_itr);
+      if (table == nullptr) continue;
+
+      auto tile_group_count = table->GetTileGroupCount();
+      for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+           tile_group_itr++) {
+        // Leave the evicted tile groups where they are
+        auto tile_group = table->PeekTileGroup(tile_group_itr);
+        if (tile_group == nullptr || tile_group->IsEvicted() == true) continue;
+
+        // Tiles in files stay as they are, the file is their durable copy
+        if (tile_group->GetBackendType() != BACKEND_TYPE_MM) continue;
+
+        auto tile_group_size = GetResidentSize(tile_group.get());
+        resident_size += tile_group_size;
+
+        auto last_access_round = tile_group->GetLastAccessRound();
+        auto access_round_count = tile_group->GetAccessRoundCount();
+        tile_group->AgeAccessRoundCount();
+        if (last_access_round + TILE_GROUP_EVICTION_COLD_ROUNDS > round) {
+          continue;
+        }
+
+        candidates.push_back({tile_group, last_access_round,
+                              access_round_count, tile_group_size});
+      }
+    }
+  }
+
+  // Least recently used first, then least often used
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate &lhs, const Candidate &rhs) {
+              if (lhs.last_access_round != rhs.last_access_round) {
+                return lhs.last_access_round < rhs.last_access_round;
+              }
+              return lhs.access_round_count < rhs.access_round_count;
+            });
+
+  size_t tile_group_count = 0;
+  for (auto &candidate : candidates) {
+    if (memory_limit_ != 0 && resident_size <= memory_limit_) break;
+
+    if (EvictTileGroup(candidate.tile_group) == true) {
+      resident_size -= candidate.resident_size;
+      tile_group_count++;
+    }
+  }
+
+  return tile_group_count;
+}
+
+bool TileGroupEvictor::EvictTileGroup(
+    const std::shared_ptr<TileGroup> &tile_group) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  // While the transaction is alive, no slot of the tile group is recycled
+  txn_manager.BeginTransaction();
+
+  // Only tile groups nobody writes to are evicted, their tuples don't change
+  cid_t newest_begin_cid;
+  bool frozen = tile_group->GetHeader()->IsFrozen(newest_begin_cid);
+
+  bool evicted = false;
+  if (frozen == true) {
+    std::vector<oid_t> tuple_slots(tile_group->GetNextTupleSlot());
+    std::iota(tuple_slots.begin(), tuple_slots.end(), 0);
+
+    CopySerializeOutput output;
+    output.WriteInt(static_cast<int32_t>(tuple_slots.size()));
+    bool serialized = true;
+    for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+         tile_itr++) {
+      auto tile = tile_group->GetTile(tile_itr);
+      serialized = serialized && tile->SerializeTuplesTo(output, tuple_slots);
+    }
+
+    std::lock_guard<std::mutex> lock(eviction_mutex_);
+    size_t offset;
+    if (serialized == true &&
+        WriteBlock(output.Data(), output.Size(), offset) == true) {
+      // A tile group recovered under the same id leaves its old copy behind
+      auto tile_group_id = tile_group->GetTileGroupId();
+      auto block_itr = evicted_blocks_.find(tile_group_id);
+      if (block_itr != evicted_blocks_.end()) {
+        FreeBlock(block_itr->second);
+        stats_.evicted_bytes -= block_itr->second.length;
+        evicted_blocks_.erase(block_itr);
+      }
+
+      evicted_blocks_[tile_group_id] = {offset, output.Size(), false};
+      stats_.evicted_bytes += output.Size();
+      stats_.eviction_count++;
+
+      // Readers that started before now may still be on the tiles
+      tile_group->SetEvicted(true);
+      retired_.emplace_back(tile_group, txn_manager.GetCurrentCommitId());
+      evicted = true;
+    }
+  }
+
+  txn_manager.CommitTransaction();
+
+  return evicted;
+}
+
+void TileGroupEvictor::FaultIn(TileGroup *tile_group) {
+  std::lock_guard<std::mutex> lock(eviction_mutex_);
+
+  // Someone else brought it back already
+  if (tile_group->IsEvicted() == false) return;
+
+  auto block_itr = evicted_blocks_.find(tile_group->GetTileGroupId());
+  if (block_itr == evicted_blocks_.end()) {
+    throw Exception("Evicted tile group " +
+                    std::to_string(tile_group->GetTileGroupId()) +
+                    " has no copy in " + eviction_file_name_);
+  }
+  auto &block = block_itr->second;
+
+  // Until the tiles drop their data, there is nothing to read
+  if (block.released == true) {
+    std::unique_ptr<char[]> buffer(new char[block.length]);
+    ReadBlock(block, buffer.get());
+
+    ReferenceSerializeInputBE input(buffer.get(), block.length);
+    std::vector<oid_t> tuple_slots(input.ReadInt());
+    std::iota(tuple_slots.begin(), tuple_slots.end(), 0);
+    for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+         tile_itr++) {
+      tile_group->GetTile(tile_itr)->RestoreEvictedData(input, tuple_slots);
+    }
+  }
+
+  // The tiles are complete before anybody finds them
+  tile_group->SetEvicted(false);
+
+  FreeBlock(block);
+  stats_.evicted_bytes -= block.length;
+  stats_.fault_in_count++;
+  evicted_blocks_.erase(block_itr);
+
+  // An older retirement must not drop the data that is back
+  size_t retired_itr = 0;
+  while (retired_itr < retired_.size()) {
+    if (retired_[retired_itr].first.get() == tile_group) {
+      retired_[retired_itr] = retired_.back();
+      retired_.pop_back();
+    } else {
+      retired_itr++;
+    }
+  }
+}
+
+bool TileGroupEvictor::SerializeEvictedTuples(
+    TileGroup *tile_group, const std::vector<oid_t> &tuple_slots,
+    SerializeOutput &output) {
+  std::unique_ptr<char[]> buffer;
+  size_t length;
+  {
+    std::lock_guard<std::mutex> lock(eviction_mutex_);
+    if (tile_group->IsEvicted() == false) return false;
+
+    auto block_itr = evicted_blocks_.find(tile_group->GetTileGroupId());
+    if (block_itr == evicted_blocks_.end()) return false;
+
+    length = block_itr->second.length;
+    buffer.reset(new char[length]);
+    ReadBlock(block_itr->second, buffer.get());
+  }
+
+  ReferenceSerializeInputBE input(buffer.get(), length);
+  oid_t tuple_count = input.ReadInt();
+  if (tuple_slots.empty() == false && tuple_slots.back() >= tuple_count) {
+    return false;
+  }
+
+  // The tuples are copied as they are, only the slots asked for
+  for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+       tile_itr++) {
+    input.ReadInt();  // tile length
+    size_t tile_start = output.ReserveBytes(sizeof(int32_t));
+
+    int32_t header_size = input.ReadInt();
+    output.WriteInt(header_size);
+    output.WriteBytes(input.GetRawPointer(header_size), header_size);
+
+    input.ReadInt();  // tuple count
+    output.WriteInt(static_cast<int32_t>(tuple_slots.size()));
+    size_t slot_itr = 0;
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      int32_t tuple_length = input.ReadInt();
+      auto tuple_data = input.GetRawPointer(tuple_length);
+      if (slot_itr < tuple_slots.size() &&
+          tuple_slots[slot_itr] == tuple_itr) {
+        output.WriteInt(tuple_length);
+        output.WriteBytes(tuple_data, tuple_length);
+        slot_itr++;
+      }
+    }
+
+    // Length prefix is non-inclusive
+    output.WriteIntAt(tile_start,
+                      static_cast<int32_t>(output.Position() - tile_start -
+                                           sizeof(int32_t)));
+  }
+
+  return true;
+}
+
+void TileGroupEvictor::DropTileGroup(const oid_t &tile_group_id) {
+  std::lock_guard<std::mutex> lock(eviction_mutex_);
+
+  auto block_itr = evicted_blocks_.find(tile_group_id);
+  if (block_itr == evicted_blocks_.end()) return;
+
+  FreeBlock(block_itr->second);
+  stats_.evicted_bytes -= block_itr->second.length;
+  evicted_blocks_.erase(block_itr);
+}
+
+TileGroupEvictorStats TileGroupEvictor::GetStats() {
+  std::lock_guard<std::mutex> lock(eviction_mutex_);
+  auto stats = stats_;
+  stats.evicted_tile_group_count = evicted_blocks_.size();
+  return stats;
+}
+
+//===--------------------------------------------------------------------===//
+// Eviction file
+//===--------------------------------------------------------------------===//
+
+bool TileGroupEvictor::WriteBlock(const char *buffer, size_t length,
+                                  size_t &offset) {
+  // Prefer the SSD, like the data file does
+  if (eviction_fd_ < 0) {
+    struct stat dir_stat;
+    if (stat(SSD_DIR, &dir_stat) == 0 && S_ISDIR(dir_stat.st_mode)) {
+      eviction_file_name_ = std::string(SSD_DIR) + EVICTION_FILE_NAME;
+    } else {
+      eviction_file_name_ = std::string(TMP_DIR) + EVICTION_FILE_NAME;
+    }
+
+    eviction_fd_ = open(eviction_file_name_.c_str(),
+                        O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
+    if (eviction_fd_ < 0) {
+      LOG_ERROR("Could not open the eviction file %s : %s",
+                eviction_file_name_.c_str(), strerror(errno));
+      return false;
+    }
+  }
+
+  // A block that is cut short is overwritten by the next one
+  size_t written = 0;
+  while (written < length) {
+    auto status = pwrite(eviction_fd_, buffer + written, length - written,
+                         file_size_ + written);
+    if (status < 0) {
+      if (errno == EINTR) continue;
+      LOG_ERROR("Could not write to the eviction file %s : %s",
+                eviction_file_name_.c_str(), strerror(errno));
+      return false;
+    }
+    written += status;
+  }
+
+  offset = file_size_;
+  file_size_ += length;
+  return true;
+}
+
+void TileGroupEvictor::ReadBlock(const EvictedBlock &block, char *buffer) {
+  size_t read_length = 0;
+  while (read_length < block.length) {
+    auto status = pread(eviction_fd_, buffer + read_length,
+                        block.length - read_length, block.offset + read_length);
+    if (status < 0 && errno == EINTR) continue;
+    if (status <= 0) {
+      throw Exception("Could not read an evicted tile group from " +
+                      eviction_file_name_);
+    }
+    read_length += status;
+  }
+}
+
+void TileGroupEvictor::FreeBlock(const EvictedBlock &block) {
+  // Offsets are not reused, the file only gets sparser
+  if (fallocate(eviction_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                block.offset, block.length) != 0) {
+    LOG_TRACE("Could not punch an evicted block out of %s",
+              eviction_file_name_.c_str());
+  }
+}
+
+}  // End storage namespace
+}  // End peloton namespace
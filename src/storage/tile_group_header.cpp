@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -29,14 +30,22 @@
 namespace peloton {
 namespace storage {
 
+// Bytes of an array of the header, up to the next cache line
+static size_t GetArraySize(oid_t tuple_count, size_t entry_size) {
+  return (tuple_count * entry_size + CACHELINE_SIZE - 1) / CACHELINE_SIZE *
+         CACHELINE_SIZE;
+}
+
 TileGroupHeader::TileGroupHeader(const BackendType &backend_type,
                                  const int &tuple_count)
     : backend_type(backend_type),
       data(nullptr),
       num_tuple_slots(tuple_count),
       next_tuple_slot(0),
+      dirty_cid(INVALID_CID),
       tile_header_lock() {
-  header_size = num_tuple_slots * header_entry_size;
+  // small allocations are not cache line aligned
+  header_size = GetArraysSize(num_tuple_slots) + CACHELINE_SIZE;
 
   // allocate storage space for header
   auto &storage_manager = storage::StorageManager::GetInstance();
@@ -46,6 +55,7 @@ TileGroupHeader::TileGroupHeader(const BackendType &backend_type,
 
   // zero out the data
   PL_MEMSET(data, 0, header_size);
+  SetArrayLocations();
 
   // Set MVCC Initial Value
   for (oid_t tuple_slot_id = START_OID; tuple_slot_id < num_tuple_slots;
@@ -61,6 +71,30 @@ TileGroupHeader::TileGroupHeader(const BackendType &backend_type,
   }
 }
 
+size_t TileGroupHeader::GetArraysSize(const oid_t &tuple_count) {
+  return 5 * GetArraySize(tuple_count, sizeof(txn_id_t)) +
+         GetArraySize(tuple_count, commit_flags_size) +
+         GetArraySize(tuple_count, reserverd_size);
+}
+
+void TileGroupHeader::SetArrayLocations() {
+  static_assert(sizeof(txn_id_t) == sizeof(cid_t) &&
+                    sizeof(txn_id_t) == sizeof(ItemPointer),
+                "header arrays of 8 byte entries");
+  auto address = reinterpret_cast<uintptr_t>(data);
+  auto word_array_size = GetArraySize(num_tuple_slots, sizeof(txn_id_t));
+
+  txn_id_data = data + (CACHELINE_SIZE - address % CACHELINE_SIZE) %
+                           CACHELINE_SIZE;
+  begin_cid_data = txn_id_data + word_array_size;
+  end_cid_data = begin_cid_data + word_array_size;
+  next_pointer_data = end_cid_data + word_array_size;
+  prev_pointer_data = next_pointer_data + word_array_size;
+  commit_flags_data = prev_pointer_data + word_array_size;
+  reserved_field_data =
+      commit_flags_data + GetArraySize(num_tuple_slots, commit_flags_size);
+}
+
 TileGroupHeader::~TileGroupHeader() {
   // reclaim the space
   auto &storage_manager = storage::StorageManager::GetInstance();
@@ -139,6 +173,30 @@ void TileGroupHeader::Sync() {
   storage_manager.Sync(backend_type, data, header_size);
 }
 
+void TileGroupHeader::GetSyncRanges(oid_t begin_slot, oid_t end_slot,
+                                    std::vector<SyncRange> &ranges) const {
+  end_slot = std::min(end_slot, num_tuple_slots);
+  if (begin_slot >= end_slot) {
+    return;
+  }
+
+  auto slot_count = end_slot - begin_slot;
+  ranges.emplace_back(txn_id_data + begin_slot * sizeof(txn_id_t),
+                      slot_count * sizeof(txn_id_t));
+  ranges.emplace_back(begin_cid_data + begin_slot * sizeof(cid_t),
+                      slot_count * sizeof(cid_t));
+  ranges.emplace_back(end_cid_data + begin_slot * sizeof(cid_t),
+                      slot_count * sizeof(cid_t));
+  ranges.emplace_back(next_pointer_data + begin_slot * sizeof(ItemPointer),
+                      slot_count * sizeof(ItemPointer));
+  ranges.emplace_back(prev_pointer_data + begin_slot * sizeof(ItemPointer),
+                      slot_count * sizeof(ItemPointer));
+  ranges.emplace_back(commit_flags_data + begin_slot * commit_flags_size,
+                      slot_count * commit_flags_size);
+  ranges.emplace_back(reserved_field_data + begin_slot * reserverd_size,
+                      slot_count * reserverd_size);
+}
+
 void TileGroupHeader::PrintVisibility(txn_id_t txn_id, cid_t at_cid) {
   oid_t active_tuple_slots = GetCurrentNextTupleSlot();
   std::stringstream os;
@@ -228,5 +286,23 @@ oid_t TileGroupHeader::GetActiveTupleCount() {
   return active_tuple_slots;
 }
 
+bool TileGroupHeader::IsFrozen(cid_t &newest_begin_cid) const {
+  newest_begin_cid = 0;
+  if (GetCurrentNextTupleSlot() != num_tuple_slots) return false;
+
+  for (oid_t tuple_slot_id = START_OID; tuple_slot_id < num_tuple_slots;
+       tuple_slot_id++) {
+    if (GetTransactionId(tuple_slot_id) != INITIAL_TXN_ID ||
+        GetEndCommitId(tuple_slot_id) != MAX_CID) {
+      return false;
+    }
+
+    newest_begin_cid =
+        std::max(newest_begin_cid, GetBeginCommitId(tuple_slot_id));
+  }
+
+  return true;
+}
+
 }  // End storage namespace
 }  // End peloton namespace
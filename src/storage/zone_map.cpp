@@ -0,0 +1,390 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// zone_map.cpp
+//
+// Identification: src/storage/zone_map.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <utility>
+
+#include "storage/zone_map.h"
+
+#include "common/macros.h"
+#include "expression/abstract_expression.h"
+#include "expression/tuple_value_expression.h"
+
+namespace peloton {
+namespace storage {
+
+// Types whose values compare with each other and need no pool
+static bool IsTrackedType(const ValueType &type) {
+  switch (type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_DECIMAL:
+    case VALUE_TYPE_DOUBLE:
+    case VALUE_TYPE_TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Mirror the comparison, for a constant on the left of the column
+static ExpressionType ReverseComparison(const ExpressionType &type) {
+  switch (type) {
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      return EXPRESSION_TYPE_COMPARE_GREATERTHAN;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      return EXPRESSION_TYPE_COMPARE_LESSTHAN;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      return EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      return EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO;
+    default:
+      return type;
+  }
+}
+
+ZoneMap::ZoneMap(const std::vector<ValueType> &column_types)
+    : tuple_count_(0) {
+  for (auto column_type : column_types) {
+    ColumnRange range;
+    range.column_type = column_type;
+    range.is_tracked = IsTrackedType(column_type);
+    range.has_range = false;
+    range.null_count = 0;
+    columns_.push_back(range);
+  }
+}
+
+void ZoneMap::Merge(const Batch &batch, const oid_t &tuple_count) {
+  PL_ASSERT(batch.columns_.size() == columns_.size());
+
+  zone_map_lock_.Lock();
+
+  for (oid_t column_itr = 0; column_itr < columns_.size(); column_itr++) {
+    auto &range = columns_[column_itr];
+    auto &batch_range = batch.columns_[column_itr];
+    range.null_count += batch_range.null_count;
+    if (batch_range.has_range == false) continue;
+
+    if (range.has_range == false) {
+      range.min = batch_range.min;
+      range.max = batch_range.max;
+      range.has_range = true;
+      continue;
+    }
+
+    if (batch_range.min.Compare(range.min) == VALUE_COMPARE_LESSTHAN) {
+      range.min = batch_range.min;
+    }
+    if (batch_range.max.Compare(range.max) == VALUE_COMPARE_GREATERTHAN) {
+      range.max = batch_range.max;
+    }
+  }
+  tuple_count_ += tuple_count;
+
+  zone_map_lock_.Unlock();
+}
+
+void ZoneMap::Reset() {
+  zone_map_lock_.Lock();
+
+  for (auto &range : columns_) {
+    range.has_range = false;
+    range.min = Value();
+    range.max = Value();
+    range.null_count = 0;
+  }
+  tuple_count_ = 0;
+
+  zone_map_lock_.Unlock();
+}
+
+//===--------------------------------------------------------------------===//
+// Batch
+//===--------------------------------------------------------------------===//
+
+// How the inlined types store a null, as in Value::InitFromTupleStorage
+static bool IsRawNull(const int8_t &value) { return value == INT8_NULL; }
+
+static bool IsRawNull(const int16_t &value) { return value == INT16_NULL; }
+
+static bool IsRawNull(const int32_t &value) { return value == INT32_NULL; }
+
+static bool IsRawNull(const int64_t &value) { return value == INT64_NULL; }
+
+static bool IsRawNull(const double &value) { return value <= DOUBLE_NULL; }
+
+// Smallest and largest of the values that are not null, compared as they are
+// stored and boxed only once at the end
+template <typename T>
+static bool FoldRawValues(const ValueType &type, const char *location,
+                          const size_t &stride, const oid_t &value_count,
+                          Value &min, Value &max, oid_t &null_count) {
+  T raw_min = T(), raw_max = T();
+  bool has_range = false;
+  for (oid_t value_itr = 0; value_itr < value_count; value_itr++) {
+    T value = *reinterpret_cast<const T *>(location);
+    location += stride;
+
+    if (IsRawNull(value)) {
+      null_count++;
+    } else if (has_range == false) {
+      raw_min = value;
+      raw_max = value;
+      has_range = true;
+    } else if (value < raw_min) {
+      raw_min = value;
+    } else if (value > raw_max) {
+      raw_max = value;
+    }
+  }
+
+  if (has_range) {
+    min = Value::InitFromTupleStorage(&raw_min, type, true);
+    max = Value::InitFromTupleStorage(&raw_max, type, true);
+  }
+  return has_range;
+}
+
+// Decimals have no native comparison, they go through Value
+static bool FoldValues(const ValueType &type, const char *location,
+                       const size_t &stride, const oid_t &value_count,
+                       Value &min, Value &max, oid_t &null_count) {
+  bool has_range = false;
+  for (oid_t value_itr = 0; value_itr < value_count; value_itr++) {
+    auto value = Value::InitFromTupleStorage(location, type, true);
+    location += stride;
+
+    if (value.IsNull()) {
+      null_count++;
+    } else if (has_range == false) {
+      min = value;
+      max = value;
+      has_range = true;
+    } else if (value.Compare(min) == VALUE_COMPARE_LESSTHAN) {
+      min = value;
+    } else if (value.Compare(max) == VALUE_COMPARE_GREATERTHAN) {
+      max = value;
+    }
+  }
+  return has_range;
+}
+
+ZoneMap::Batch::Batch(const ZoneMap &zone_map) {
+  // The column types never change, they are read without the lock
+  for (auto &zone_map_range : zone_map.columns_) {
+    ColumnRange range;
+    range.column_type = zone_map_range.column_type;
+    range.is_tracked = zone_map_range.is_tracked;
+    range.has_range = false;
+    range.null_count = 0;
+    columns_.push_back(range);
+  }
+}
+
+void ZoneMap::Batch::Fold(const oid_t &column_id, const char *location,
+                          const size_t &stride, const oid_t &value_count) {
+  PL_ASSERT(column_id < columns_.size());
+  auto &range = columns_[column_id];
+  PL_ASSERT(range.is_tracked);
+
+  auto type = range.column_type;
+  bool has_range;
+  Value min, max;
+  switch (type) {
+    case VALUE_TYPE_TINYINT:
+      has_range = FoldRawValues<int8_t>(type, location, stride, value_count,
+                                        min, max, range.null_count);
+      break;
+    case VALUE_TYPE_SMALLINT:
+      has_range = FoldRawValues<int16_t>(type, location, stride, value_count,
+                                         min, max, range.null_count);
+      break;
+    case VALUE_TYPE_INTEGER:
+      has_range = FoldRawValues<int32_t>(type, location, stride, value_count,
+                                         min, max, range.null_count);
+      break;
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+      has_range = FoldRawValues<int64_t>(type, location, stride, value_count,
+                                         min, max, range.null_count);
+      break;
+    case VALUE_TYPE_DOUBLE:
+      has_range = FoldRawValues<double>(type, location, stride, value_count,
+                                        min, max, range.null_count);
+      break;
+    default:
+      has_range = FoldValues(type, location, stride, value_count, min, max,
+                             range.null_count);
+      break;
+  }
+  if (has_range == false) return;
+
+  if (range.has_range == false) {
+    range.min = min;
+    range.max = max;
+    range.has_range = true;
+    return;
+  }
+
+  if (min.Compare(range.min) == VALUE_COMPARE_LESSTHAN) range.min = min;
+  if (max.Compare(range.max) == VALUE_COMPARE_GREATERTHAN) range.max = max;
+}
+
+bool ZoneMap::CouldMatch(const expression::AbstractExpression *predicate,
+                         executor::ExecutorContext *executor_context) const {
+  if (predicate == nullptr) return true;
+
+  switch (predicate->GetExpressionType()) {
+    case EXPRESSION_TYPE_CONJUNCTION_AND:
+      return CouldMatch(predicate->GetLeft(), executor_context) &&
+             CouldMatch(predicate->GetRight(), executor_context);
+    case EXPRESSION_TYPE_CONJUNCTION_OR:
+      return CouldMatch(predicate->GetLeft(), executor_context) ||
+             CouldMatch(predicate->GetRight(), executor_context);
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      return CouldMatchComparison(predicate, executor_context);
+    default:
+      return true;
+  }
+}
+
+bool ZoneMap::CouldMatchComparison(
+    const expression::AbstractExpression *comparison,
+    executor::ExecutorContext *executor_context) const {
+  auto comparison_type = comparison->GetExpressionType();
+  auto column_expr = comparison->GetLeft();
+  auto value_expr = comparison->GetRight();
+  if (column_expr == nullptr || value_expr == nullptr) return true;
+
+  if (column_expr->GetExpressionType() != EXPRESSION_TYPE_VALUE_TUPLE) {
+    std::swap(column_expr, value_expr);
+    comparison_type = ReverseComparison(comparison_type);
+  }
+
+  if (column_expr->GetExpressionType() != EXPRESSION_TYPE_VALUE_TUPLE) {
+    return true;
+  }
+
+  // Parameters are only known once the plan runs
+  auto value_type = value_expr->GetExpressionType();
+  if (value_type == EXPRESSION_TYPE_VALUE_PARAMETER) {
+    if (executor_context == nullptr) return true;
+  } else if (value_type != EXPRESSION_TYPE_VALUE_CONSTANT) {
+    return true;
+  }
+
+  auto tuple_value_expr =
+      static_cast<const expression::TupleValueExpression *>(column_expr);
+  if (tuple_value_expr->GetTupleIdx() != 0) return true;
+  auto column_id = static_cast<oid_t>(tuple_value_expr->GetColumnId());
+  if (column_id >= columns_.size() || columns_[column_id].is_tracked == false) {
+    return true;
+  }
+
+  // Timestamps are only compared with timestamps
+  auto value = value_expr->Evaluate(nullptr, nullptr, executor_context);
+  if (value.IsNull() || IsTrackedType(value.GetValueType()) == false ||
+      (value.GetValueType() == VALUE_TYPE_TIMESTAMP) !=
+          (columns_[column_id].column_type == VALUE_TYPE_TIMESTAMP)) {
+    return true;
+  }
+
+  zone_map_lock_.Lock();
+
+  auto &range = columns_[column_id];
+  bool could_match;
+  if (range.has_range == false) {
+    // Every value is null, or there are none
+    could_match = false;
+  } else {
+    switch (comparison_type) {
+      case EXPRESSION_TYPE_COMPARE_EQUAL:
+        could_match =
+            range.min.Compare(value) != VALUE_COMPARE_GREATERTHAN &&
+            range.max.Compare(value) != VALUE_COMPARE_LESSTHAN;
+        break;
+      case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+        could_match = range.min.Compare(value) == VALUE_COMPARE_LESSTHAN;
+        break;
+      case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        could_match = range.min.Compare(value) != VALUE_COMPARE_GREATERTHAN;
+        break;
+      case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+        could_match = range.max.Compare(value) == VALUE_COMPARE_GREATERTHAN;
+        break;
+      case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+        could_match = range.max.Compare(value) != VALUE_COMPARE_LESSTHAN;
+        break;
+      default:
+        could_match = true;
+        break;
+    }
+  }
+
+  zone_map_lock_.Unlock();
+
+  return could_match;
+}
+
+bool ZoneMap::IsTracked(const oid_t &column_id) const {
+  PL_ASSERT(column_id < columns_.size());
+  return columns_[column_id].is_tracked;
+}
+
+bool ZoneMap::HasRange(const oid_t &column_id) const {
+  PL_ASSERT(column_id < columns_.size());
+  zone_map_lock_.Lock();
+  auto has_range = columns_[column_id].has_range;
+  zone_map_lock_.Unlock();
+  return has_range;
+}
+
+Value ZoneMap::GetMin(const oid_t &column_id) const {
+  PL_ASSERT(column_id < columns_.size());
+  zone_map_lock_.Lock();
+  auto min = columns_[column_id].min;
+  zone_map_lock_.Unlock();
+  return min;
+}
+
+Value ZoneMap::GetMax(const oid_t &column_id) const {
+  PL_ASSERT(column_id < columns_.size());
+  zone_map_lock_.Lock();
+  auto max = columns_[column_id].max;
+  zone_map_lock_.Unlock();
+  return max;
+}
+
+oid_t ZoneMap::GetNullCount(const oid_t &column_id) const {
+  PL_ASSERT(column_id < columns_.size());
+  zone_map_lock_.Lock();
+  auto null_count = columns_[column_id].null_count;
+  zone_map_lock_.Unlock();
+  return null_count;
+}
+
+oid_t ZoneMap::GetTupleCount() const {
+  zone_map_lock_.Lock();
+  auto tuple_count = tuple_count_;
+  zone_map_lock_.Unlock();
+  return tuple_count;
+}
+
+}  // End storage namespace
+}  // End peloton namespace
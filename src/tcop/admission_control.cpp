@@ -0,0 +1,218 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// admission_control.cpp
+//
+// Identification: src/tcop/admission_control.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "tcop/admission_control.h"
+
+#include "common/logger.h"
+#include "planner/abstract_plan.h"
+#include "planner/abstract_scan_plan.h"
+#include "storage/data_table.h"
+
+namespace peloton {
+namespace tcop {
+
+AdmissionControl::AdmissionControl(size_t capacity, size_t analytic_capacity,
+                                   uint64_t timeout_ms)
+    : capacity_(capacity),
+      analytic_capacity_(std::min(analytic_capacity, capacity)),
+      timeout_ms_(timeout_ms) {}
+
+// global singleton
+AdmissionControl &AdmissionControl::GetInstance() {
+  // one query per core by default, a quarter of them analytic
+  static size_t capacity =
+      FLAGS_max_active_queries != 0
+          ? FLAGS_max_active_queries
+          : std::max(std::thread::hardware_concurrency(), 1u);
+  static size_t analytic_capacity =
+      FLAGS_max_analytic_queries != 0
+          ? FLAGS_max_analytic_queries
+          : std::max(capacity / 4, static_cast<size_t>(1));
+
+  static AdmissionControl admission_control(capacity, analytic_capacity,
+                                            FLAGS_admission_timeout_ms);
+  return admission_control;
+}
+
+QueryClass AdmissionControl::Classify(const planner::AbstractPlan *plan) {
+  if (plan == nullptr) return QUERY_CLASS_OLTP;
+
+  switch (plan->GetPlanNodeType()) {
+    case PLAN_NODE_TYPE_NESTLOOP:
+    case PLAN_NODE_TYPE_NESTLOOPINDEX:
+    case PLAN_NODE_TYPE_MERGEJOIN:
+    case PLAN_NODE_TYPE_HASHJOIN:
+    case PLAN_NODE_TYPE_AGGREGATE:
+    case PLAN_NODE_TYPE_HASHAGGREGATE:
+    case PLAN_NODE_TYPE_ORDERBY:
+      return QUERY_CLASS_ANALYTIC;
+
+    // the size of the table tells a lookup from a report
+    case PLAN_NODE_TYPE_SEQSCAN: {
+      auto table =
+          static_cast<const planner::AbstractScan *>(plan)->GetTable();
+      if (table != nullptr &&
+          table->GetNumberOfTuples() > ADMISSION_SHORT_SCAN_TUPLES) {
+        return QUERY_CLASS_ANALYTIC;
+      }
+    } break;
+
+    default:
+      break;
+  }
+
+  for (auto &child : plan->GetChildren()) {
+    if (Classify(child.get()) == QUERY_CLASS_ANALYTIC) {
+      return QUERY_CLASS_ANALYTIC;
+    }
+  }
+  return QUERY_CLASS_OLTP;
+}
+
+bool AdmissionControl::HasSlot(QueryClass query_class) const {
+  size_t active_count =
+      active_count_[QUERY_CLASS_OLTP] + active_count_[QUERY_CLASS_ANALYTIC];
+  if (active_count >= capacity_) return false;
+
+  return query_class == QUERY_CLASS_OLTP ||
+         active_count_[QUERY_CLASS_ANALYTIC] < analytic_capacity_;
+}
+
+void AdmissionControl::Activate(QueryClass query_class) {
+  active_count_[query_class]++;
+  stats_.admitted_count[query_class]++;
+}
+
+bool AdmissionControl::Admit(QueryClass query_class) {
+  if (capacity_ == 0) return true;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // Nobody to overtake: OLTP queries only queue behind each other, analytic
+  // ones behind everybody
+  bool queue_empty = queues_[query_class].empty() &&
+                     (query_class == QUERY_CLASS_OLTP ||
+                      queues_[QUERY_CLASS_OLTP].empty());
+  if (queue_empty && HasSlot(query_class)) {
+    Activate(query_class);
+    return true;
+  }
+
+  Waiter waiter;
+  auto &queue = queues_[query_class];
+  auto waiter_itr = queue.insert(queue.end(), &waiter);
+
+  auto wait_begin = std::chrono::steady_clock::now();
+  bool admitted = waiter.cv.wait_until(
+      lock, wait_begin + std::chrono::milliseconds(timeout_ms_),
+      [&waiter]() { return waiter.admitted; });
+  auto wait_usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - wait_begin).count();
+
+  if (admitted == false) {
+    queue.erase(waiter_itr);
+    stats_.timeout_count[query_class]++;
+    LOG_TRACE("Query of class %d timed out after %ld us in the queue",
+              query_class, static_cast<long>(wait_usec));
+    return false;
+  }
+
+  stats_.queued_count[query_class]++;
+  stats_.wait_usec[query_class] += wait_usec;
+  return true;
+}
+
+void AdmissionControl::Release(QueryClass query_class) {
+  if (capacity_ == 0) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  PL_ASSERT(active_count_[query_class] > 0);
+  active_count_[query_class]--;
+  Dispatch();
+}
+
+void AdmissionControl::Dispatch() {
+  while (true) {
+    QueryClass query_class;
+    if (queues_[QUERY_CLASS_OLTP].empty() == false &&
+        HasSlot(QUERY_CLASS_OLTP)) {
+      query_class = QUERY_CLASS_OLTP;
+    } else if (queues_[QUERY_CLASS_ANALYTIC].empty() == false &&
+               HasSlot(QUERY_CLASS_ANALYTIC)) {
+      query_class = QUERY_CLASS_ANALYTIC;
+    } else {
+      break;
+    }
+
+    // the slot is taken on behalf of the waiter
+    auto waiter = queues_[query_class].front();
+    queues_[query_class].pop_front();
+    Activate(query_class);
+    waiter->admitted = true;
+    waiter->cv.notify_one();
+  }
+}
+
+AdmissionStats AdmissionControl::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AdmissionStats stats = stats_;
+  for (int class_itr = 0; class_itr < QUERY_CLASS_COUNT; class_itr++) {
+    stats.active_count += active_count_[class_itr];
+    stats.waiting_count += queues_[class_itr].size();
+  }
+  return stats;
+}
+
+//===--------------------------------------------------------------------===//
+// Admission Guard
+//===--------------------------------------------------------------------===//
+
+static thread_local AdmissionGuard *current_guard = nullptr;
+
+AdmissionGuard::AdmissionGuard(AdmissionControl &admission_control,
+                               QueryClass query_class)
+    : admission_control_(admission_control),
+      query_class_(query_class),
+      admitted_(admission_control.Admit(query_class)),
+      previous_(current_guard) {
+  current_guard = this;
+}
+
+AdmissionGuard::~AdmissionGuard() {
+  current_guard = previous_;
+  if (admitted_) {
+    admission_control_.Release(query_class_);
+  }
+}
+
+void AdmissionGuard::Suspend() {
+  if (admitted_ == false) return;
+  admission_control_.Release(query_class_);
+  admitted_ = false;
+}
+
+bool AdmissionGuard::Resume() {
+  if (admitted_ == false) {
+    admitted_ = admission_control_.Admit(query_class_);
+  }
+  return admitted_;
+}
+
+AdmissionGuard *AdmissionGuard::GetCurrent() { return current_guard; }
+
+}  // End tcop namespace
+}  // End peloton namespace
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache.cpp
+//
+// Identification: src/tcop/plan_cache.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "tcop/plan_cache.h"
+
+#include "catalog/manager.h"
+#include "common/logger.h"
+#include "parser/postgres_parser.h"
+#include "planner/abstract_plan.h"
+
+namespace peloton {
+namespace tcop {
+
+PlanCache::PlanCache(size_t capacity)
+    : hit_count_(0),
+      miss_count_(0),
+      invalidation_count_(0),
+      eviction_count_(0) {
+  // round up, so that a small cache still holds a plan per shard
+  shard_capacity_ =
+      (capacity + PLAN_CACHE_SHARD_COUNT - 1) / PLAN_CACHE_SHARD_COUNT;
+}
+
+// global singleton
+PlanCache &PlanCache::GetInstance() {
+  static PlanCache plan_cache(FLAGS_plan_cache_size);
+  return plan_cache;
+}
+
+std::string PlanCache::GetFingerprint(const std::string &query_string) {
+  // The scanner of the parser finds the literals, so quotes inside them,
+  // escaped ones or dollar quoted bodies do not end them early
+  return parser::PostgresParser::GetInstance().NormalizeStatement(
+      query_string);
+}
+
+PlanCache::Shard &PlanCache::GetShard(const std::string &fingerprint) {
+  return shards_[std::hash<std::string>()(fingerprint) %
+                 PLAN_CACHE_SHARD_COUNT];
+}
+
+std::shared_ptr<planner::AbstractPlan> PlanCache::Find(
+    const std::string &fingerprint) {
+  if (shard_capacity_ == 0) return nullptr;
+
+  auto catalog_version = catalog::Manager::GetInstance().GetCatalogVersion();
+  auto &shard = GetShard(fingerprint);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto entry_itr = shard.entries.find(fingerprint);
+  if (entry_itr == shard.entries.end()) {
+    miss_count_++;
+    return nullptr;
+  }
+
+  // The catalog changed since the plan was built
+  auto &entry = entry_itr->second;
+  if (entry.catalog_version != catalog_version) {
+    shard.lru_list.erase(entry.lru_itr);
+    shard.entries.erase(entry_itr);
+    invalidation_count_++;
+    miss_count_++;
+    return nullptr;
+  }
+
+  // move it to the front of the LRU list
+  shard.lru_list.splice(shard.lru_list.begin(), shard.lru_list,
+                        entry.lru_itr);
+  hit_count_++;
+  return entry.plan;
+}
+
+void PlanCache::Insert(const std::string &fingerprint,
+                       std::shared_ptr<planner::AbstractPlan> plan,
+                       uint64_t catalog_version) {
+  if (shard_capacity_ == 0 || plan == nullptr) return;
+
+  // DDL only runs once, and its plan outlives what it creates or drops
+  auto plan_type = plan->GetPlanNodeType();
+  if (plan_type == PLAN_NODE_TYPE_CREATE || plan_type == PLAN_NODE_TYPE_DROP) {
+    return;
+  }
+
+  auto &shard = GetShard(fingerprint);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // Another session may have planned the same query meanwhile
+  auto entry_itr = shard.entries.find(fingerprint);
+  if (entry_itr != shard.entries.end()) {
+    auto &entry = entry_itr->second;
+    entry.plan = plan;
+    entry.catalog_version = catalog_version;
+    shard.lru_list.splice(shard.lru_list.begin(), shard.lru_list,
+                          entry.lru_itr);
+    return;
+  }
+
+  shard.lru_list.push_front(fingerprint);
+  Entry entry;
+  entry.plan = plan;
+  entry.catalog_version = catalog_version;
+  entry.lru_itr = shard.lru_list.begin();
+  shard.entries.emplace(fingerprint, entry);
+
+  // Evict the least recently used plans
+  while (shard.entries.size() > shard_capacity_) {
+    shard.entries.erase(shard.lru_list.back());
+    shard.lru_list.pop_back();
+    eviction_count_++;
+  }
+}
+
+void PlanCache::Clear() {
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.clear();
+    shard.lru_list.clear();
+  }
+}
+
+PlanCacheStats PlanCache::GetStats() const {
+  PlanCacheStats stats;
+  stats.hit_count = hit_count_;
+  stats.miss_count = miss_count_;
+  stats.invalidation_count = invalidation_count_;
+  stats.eviction_count = eviction_count_;
+
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    stats.entry_count += shard.entries.size();
+  }
+  return stats;
+}
+
+}  // End tcop namespace
+}  // End peloton namespace
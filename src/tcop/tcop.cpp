@@ -12,15 +12,21 @@
 
 
 #include "tcop/tcop.h"
+#include "tcop/plan_cache.h"
+#include "tcop/admission_control.h"
 
 #include "common/macros.h"
 #include "common/portal.h"
 #include "common/logger.h"
 #include "common/types.h"
 
+#include "catalog/manager.h"
+#include "catalog/schema.h"
 #include "parser/postgres_parser.h"
 #include "optimizer/simple_optimizer.h"
+#include "executor/logical_tile.h"
 #include "executor/plan_executor.h"
+#include "storage/tile.h"
 
 namespace peloton {
 namespace tcop {
@@ -39,12 +45,13 @@ TrafficCop::~TrafficCop() {
   // Nothing to do here !
 }
 
-Result TrafficCop::ExecuteStatement(const std::string& query,
-                                    std::vector<ResultType> &result,
-                                    std::vector<FieldInfoType> &tuple_descriptor,
-                                    int &rows_changed,
-                                    std::string &error_message){
+Result TrafficCop::ExecuteStatement(
+    const std::string& query,
+    bridge::ResultSink &sink,
+    int &rows_changed,
+    std::string &error_message){
   LOG_INFO("Received %s", query.c_str());
+  rows_changed = 0;
 
   // Prepare the statement
   std::string unnamed_statement = "unnamed";
@@ -54,35 +61,112 @@ Result TrafficCop::ExecuteStatement(const std::string& query,
     return Result::RESULT_FAILURE;
   }
 
-  // Then, execute the statement
-  bool unnamed = true;
-  auto status = ExecuteStatement(statement, unnamed,
-                                 result, rows_changed, error_message);
+  // Nothing to run, e.g. for transaction control statements
+  auto plan = statement->GetPlanTree().get();
+  if (plan == nullptr) {
+    return Result::RESULT_SUCCESS;
+  }
 
-  if(status == Result::RESULT_SUCCESS) {
-	  LOG_INFO("Execution succeeded!");
-    tuple_descriptor = std::move(statement->GetTupleDescriptor());
+  // Wait for a slot to run in, it is given back when the statement is done
+  AdmissionGuard admission(AdmissionControl::GetInstance(),
+                           AdmissionControl::Classify(plan));
+  if (admission.IsAdmitted() == false) {
+    error_message = "canceling statement: too many active queries";
+    return Result::RESULT_FAILURE;
   }
-  else{
-	  LOG_INFO("Execution failed!");
+
+  // Then, execute the statement
+  std::vector<Value> params;
+  int processed = bridge::PlanExecutor::ExecutePlan(plan, params, sink);
+  LOG_INFO("Statement executed. Processed: %d", processed);
+
+  if (processed < 0) {
+    LOG_INFO("Execution failed!");
+    error_message = "Failed to execute " + query;
+    return Result::RESULT_FAILURE;
   }
 
-  return status;
+  LOG_INFO("Execution succeeded!");
+  rows_changed = processed;
+  return Result::RESULT_SUCCESS;
 }
 
-Result TrafficCop::ExecuteStatement(UNUSED_ATTRIBUTE const std::shared_ptr<Statement>& statement,
-                                    UNUSED_ATTRIBUTE const bool unnamed,
-                                    UNUSED_ATTRIBUTE std::vector<ResultType> &result,
-                                    UNUSED_ATTRIBUTE int &rows_changed,
-                                    UNUSED_ATTRIBUTE std::string &error_message){
+Result TrafficCop::ExecuteStatement(
+    const std::shared_ptr<Portal>& portal,
+    bridge::ResultSink &sink,
+    bool &suspended,
+    int &rows_changed,
+    std::string &error_message){
+  auto statement = portal->GetStatement();
 
   LOG_INFO("Execute Statement %s", statement->GetStatementName().c_str());
-  std::vector<Value> params;
-  bridge::PlanExecutor::PrintPlan(statement->GetPlanTree().get(), "Shit");
-  bridge::peloton_status status = bridge::PlanExecutor::ExecutePlan(statement->GetPlanTree().get(), params);
-  LOG_INFO("Statement executed. Result: %d", status.m_result);
-  return status.m_result;
+  rows_changed = 0;
+  suspended = false;
+
+  // Nothing to run, e.g. for transaction control statements
+  auto plan = statement->GetPlanTree().get();
+  if (plan == nullptr) {
+    return Result::RESULT_SUCCESS;
+  }
+
+  // A suspended portal picks up its execution again
+  auto execution = portal->GetExecution();
+  if (execution == nullptr) {
+    execution = new bridge::PlanExecution(plan, portal->GetParameters());
+    portal->SetExecution(execution);
+  }
+
+  // Every run of the portal waits for a slot of its own, so that a client
+  // that leaves its portal suspended holds none
+  int processed;
+  {
+    AdmissionGuard admission(AdmissionControl::GetInstance(),
+                             AdmissionControl::Classify(plan));
+    if (admission.IsAdmitted() == false) {
+      error_message = "canceling statement: too many active queries";
+      return Result::RESULT_FAILURE;
+    }
+
+    processed = execution->Run(sink);
+  }
+  LOG_INFO("Statement executed. Processed: %d", processed);
 
+  if (execution->IsSuspended()) {
+    suspended = true;
+    return Result::RESULT_SUCCESS;
+  }
+  portal->SetExecution(nullptr);
+
+  if (processed < 0) {
+    error_message = "Failed to execute " + statement->GetQueryString();
+    return Result::RESULT_FAILURE;
+  }
+  rows_changed = processed;
+
+  return Result::RESULT_SUCCESS;
+}
+
+std::vector<FieldInfoType> TrafficCop::GenerateTupleDescriptor(
+    executor::LogicalTile *tile) {
+  std::vector<FieldInfoType> tuple_descriptor;
+
+  for (auto &column_info : tile->GetSchema()) {
+    auto schema = column_info.base_tile->GetSchema();
+    auto column = schema->GetColumn(column_info.origin_column_id);
+    auto postgres_type = PelotonValueTypeToPostgresValueType(column.GetType());
+
+    // Variable length types are reported with size -1
+    size_t type_size = column.GetFixedLength();
+    if (column.GetType() == VALUE_TYPE_VARCHAR ||
+        column.GetType() == VALUE_TYPE_VARBINARY) {
+      type_size = -1;
+    }
+
+    tuple_descriptor.push_back(
+        std::make_tuple(column.GetName(), postgres_type, type_size));
+  }
+
+  return tuple_descriptor;
 }
 
 std::shared_ptr<Statement> TrafficCop::PrepareStatement(const std::string& statement_name,
@@ -94,10 +178,24 @@ std::shared_ptr<Statement> TrafficCop::PrepareStatement(const std::string& state
 
   statement.reset(new Statement(statement_name, query_string));
 
-  auto& postgres_parser = parser::PostgresParser::GetInstance();
-  auto parse_tree = postgres_parser.BuildParseTree(query_string);
+  // Sessions share the plans of the queries they have in common
+  auto& plan_cache = PlanCache::GetInstance();
+  auto fingerprint = PlanCache::GetFingerprint(query_string);
+  auto plan = plan_cache.Find(fingerprint);
+
+  if (plan == nullptr) {
+    // the version is read first, so DDL while planning makes the plan stale
+    auto catalog_version =
+        catalog::Manager::GetInstance().GetCatalogVersion();
+
+    auto& postgres_parser = parser::PostgresParser::GetInstance();
+    auto parse_tree = postgres_parser.BuildParseTree(query_string);
+    plan = optimizer::SimpleOptimizer::BuildPlanTree(parse_tree);
+
+    plan_cache.Insert(fingerprint, plan, catalog_version);
+  }
 
-  statement->SetPlanTree(optimizer::SimpleOptimizer::BuildPlanTree(parse_tree));
+  statement->SetPlanTree(plan);
 
   return statement;
 }
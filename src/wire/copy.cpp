@@ -0,0 +1,828 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy.cpp
+//
+// Identification: src/wire/copy.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "wire/copy.h"
+
+#include "catalog/schema.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "common/pool.h"
+#include "common/thread_pool.h"
+#include "common/value_factory.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "executor/logical_tile.h"
+#include "parser/peloton/copy_parse.h"
+#include "storage/data_table.h"
+#include "storage/tuple.h"
+#include "wire/marshal.h"
+
+#include <boost/algorithm/string.hpp>
+
+// Batches are not split into chunks smaller than this
+#define COPY_MIN_CHUNK_SIZE (64 << 10)
+
+namespace peloton {
+namespace wire {
+
+// Signature that starts the binary format
+static const char binary_signature[] = "PGCOPY\n\377\r\n";
+static const size_t binary_signature_size = 11;
+
+// Threads turning the rows of a batch into tuples, shared by all loads
+static ThreadPool &GetCopyPool() {
+  static ThreadPool copy_pool(
+      FLAGS_copy_threads != 0
+          ? FLAGS_copy_threads
+          : std::max(std::thread::hardware_concurrency(), 1u));
+  return copy_pool;
+}
+
+// Reads a 16 or 32-bit int in network byte order
+static int32_t GetNetworkInt(const uchar *data, size_t width) {
+  uint32_t bits = 0;
+  for (size_t byte_itr = 0; byte_itr < width; byte_itr++) {
+    bits = (bits << 8) | data[byte_itr];
+  }
+  if (width == sizeof(int16_t)) return static_cast<int16_t>(bits);
+  return static_cast<int32_t>(bits);
+}
+
+//===--------------------------------------------------------------------===//
+// Copy Options
+//===--------------------------------------------------------------------===//
+
+bool CopyOptions::FromParse(const parser::CopyParse &copy_parse,
+                            CopyOptions &options,
+                            std::string &error_message) {
+  auto format = boost::to_lower_copy(copy_parse.GetFormat());
+  if (format.empty() || format == "text") {
+    options.format = COPY_FORMAT_TEXT;
+  } else if (format == "csv") {
+    options.format = COPY_FORMAT_CSV;
+    options.delimiter = ',';
+    options.null_string = "";
+  } else if (format == "binary") {
+    options.format = COPY_FORMAT_BINARY;
+  } else {
+    error_message = "COPY format \"" + format + "\" not recognized";
+    return false;
+  }
+
+  bool binary = (options.format == COPY_FORMAT_BINARY);
+  bool csv = (options.format == COPY_FORMAT_CSV);
+
+  if (copy_parse.GetDelimiter().empty() == false) {
+    if (binary) {
+      error_message = "cannot specify DELIMITER in BINARY mode";
+      return false;
+    }
+    if (copy_parse.GetDelimiter().size() != 1) {
+      error_message = "COPY delimiter must be a single one-byte character";
+      return false;
+    }
+    options.delimiter = copy_parse.GetDelimiter()[0];
+  }
+
+  if (copy_parse.HasNullString()) {
+    if (binary) {
+      error_message = "cannot specify NULL in BINARY mode";
+      return false;
+    }
+    options.null_string = copy_parse.GetNullString();
+  }
+
+  if (copy_parse.HasHeader()) {
+    if (csv == false) {
+      error_message = "COPY HEADER available only in CSV mode";
+      return false;
+    }
+    options.header = true;
+  }
+
+  if (copy_parse.GetQuote().empty() == false) {
+    if (csv == false || copy_parse.GetQuote().size() != 1) {
+      error_message = "COPY quote must be a single one-byte character in CSV "
+                      "mode";
+      return false;
+    }
+    options.quote = copy_parse.GetQuote()[0];
+  }
+
+  // the escape defaults to the quote
+  options.escape = options.quote;
+  if (copy_parse.GetEscape().empty() == false) {
+    if (csv == false || copy_parse.GetEscape().size() != 1) {
+      error_message = "COPY escape must be a single one-byte character in CSV "
+                      "mode";
+      return false;
+    }
+    options.escape = copy_parse.GetEscape()[0];
+  }
+
+  if (options.delimiter == '\n' || options.delimiter == '\r' ||
+      (csv && options.delimiter == options.quote)) {
+    error_message = "COPY delimiter is not valid";
+    return false;
+  }
+
+  return true;
+}
+
+//===--------------------------------------------------------------------===//
+// Copy Loader
+//===--------------------------------------------------------------------===//
+
+CopyLoader::CopyLoader(storage::DataTable *table,
+                       const std::vector<oid_t> &column_ids,
+                       const CopyOptions &options)
+    : table_(table), column_ids_(column_ids), options_(options) {
+  auto schema = table_->GetSchema();
+  for (auto column_id : column_ids_) {
+    column_types_.push_back(
+        PelotonValueTypeToPostgresValueType(schema->GetType(column_id)));
+  }
+
+  // there is no header row to skip in the text format
+  header_done_ =
+      (options_.header == false && options_.format != COPY_FORMAT_BINARY);
+}
+
+CopyLoader::~CopyLoader() {
+  if (finished_ == false) {
+    Abort();
+  }
+}
+
+bool CopyLoader::Append(const uchar *data, size_t len) {
+  if (finished_) return false;
+
+  // anything after the end marker is ignored
+  if (end_of_data_) return true;
+
+  buffer_.append(reinterpret_cast<const char *>(data), len);
+  if (buffer_.size() < COPY_BATCH_SIZE) return true;
+
+  if (LoadBatch(false) == false) {
+    Abort();
+    return false;
+  }
+  return true;
+}
+
+bool CopyLoader::Finish() {
+  if (finished_) return false;
+
+  if (LoadBatch(true) == false) {
+    Abort();
+    return false;
+  }
+
+  finished_ = true;
+  if (EndTransaction(true) == false) {
+    error_message_ = "could not commit the COPY transaction";
+    return false;
+  }
+
+  LOG_TRACE("COPY loaded %lu rows", row_count_);
+  return true;
+}
+
+void CopyLoader::Abort() {
+  if (finished_) return;
+  finished_ = true;
+
+  // nothing was loaded if the transaction never started
+  if (txn_ != nullptr) {
+    EndTransaction(false);
+  }
+}
+
+void CopyLoader::EnterTransaction() {
+  previous_txn_ = concurrency::current_txn;
+
+  if (txn_ == nullptr) {
+    txn_ = concurrency::current_txn;
+
+    // COPY outside of a transaction block
+    if (txn_ == nullptr) {
+      auto &txn_manager =
+          concurrency::TransactionManagerFactory::GetInstance();
+      single_statement_txn_ = true;
+      txn_ = txn_manager.BeginTransaction();
+    }
+  } else if (single_statement_txn_) {
+    // the messages of a load may be processed on different threads
+    concurrency::current_txn = txn_;
+  }
+}
+
+void CopyLoader::LeaveTransaction() {
+  if (single_statement_txn_) {
+    concurrency::current_txn = previous_txn_;
+  }
+}
+
+bool CopyLoader::EndTransaction(bool commit) {
+  EnterTransaction();
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  bool committed = commit;
+  if (single_statement_txn_) {
+    if (commit && txn_->GetResult() == Result::RESULT_SUCCESS) {
+      committed = (txn_manager.CommitTransaction() == Result::RESULT_SUCCESS);
+    } else {
+      txn_manager.AbortTransaction();
+      committed = false;
+    }
+  } else if (commit == false) {
+    // the caller's transaction block fails with us
+    txn_manager.SetTransactionResult(Result::RESULT_FAILURE);
+  }
+
+  LeaveTransaction();
+  return committed;
+}
+
+// Position of the newline ending the text or CSV row that starts at pos, or
+// end if the row is not complete
+static size_t FindRowEnd(const CopyOptions &options, const char *data,
+                         size_t pos, size_t end) {
+  if (options.format == COPY_FORMAT_TEXT) {
+    while (pos < end) {
+      char c = data[pos];
+      if (c == '\n') return pos;
+      // an escaped character, even a newline, belongs to the field
+      pos += (c == '\\') ? 2 : 1;
+    }
+    return end;
+  }
+
+  bool in_quote = false;
+  while (pos < end) {
+    char c = data[pos];
+    if (in_quote && c == options.escape && options.escape != options.quote &&
+        pos + 1 < end) {
+      pos += 2;
+      continue;
+    }
+    if (c == options.quote) {
+      in_quote = !in_quote;
+    } else if (c == '\n' && in_quote == false) {
+      return pos;
+    }
+    pos++;
+  }
+  return end;
+}
+
+// Length of the binary row that starts at pos, 0 if it is not complete
+static size_t GetBinaryRowLength(const uchar *data, size_t pos, size_t end) {
+  size_t row_begin = pos;
+  if (pos + sizeof(int16_t) > end) return 0;
+  int16_t field_count = GetNetworkInt(data + pos, sizeof(int16_t));
+  pos += sizeof(int16_t);
+
+  // the trailer
+  if (field_count < 0) return sizeof(int16_t);
+
+  for (int16_t field_itr = 0; field_itr < field_count; field_itr++) {
+    if (pos + sizeof(int32_t) > end) return 0;
+    int32_t field_len = GetNetworkInt(data + pos, sizeof(int32_t));
+    pos += sizeof(int32_t);
+    if (field_len > 0) pos += field_len;
+    if (pos > end) return 0;
+  }
+  return pos - row_begin;
+}
+
+// Whether the row is the "\." end marker of the text formats
+static bool IsEndMarker(const char *row, size_t len) {
+  if (len > 0 && row[len - 1] == '\r') len--;
+  return len == 2 && row[0] == '\\' && row[1] == '.';
+}
+
+size_t CopyLoader::SplitRows(size_t chunk_size, bool last,
+                             std::vector<size_t> &chunk_ends) {
+  const char *data = buffer_.data();
+  size_t size = buffer_.size();
+  size_t chunk_begin = 0;
+  size_t pos = 0;
+
+  while (pos < size) {
+    size_t row_end;
+    if (options_.format == COPY_FORMAT_BINARY) {
+      size_t row_len = GetBinaryRowLength(
+          reinterpret_cast<const uchar *>(data), pos, size);
+      // an incomplete row at the end of the data is left to the parser
+      if (row_len == 0) {
+        if (last) pos = size;
+        break;
+      }
+      if (GetNetworkInt(reinterpret_cast<const uchar *>(data) + pos,
+                        sizeof(int16_t)) < 0) {
+        end_of_data_ = true;
+        break;
+      }
+      row_end = pos + row_len;
+    } else {
+      size_t newline = FindRowEnd(options_, data, pos, size);
+      if (newline == size && last == false) break;
+      if (IsEndMarker(data + pos, newline - pos)) {
+        end_of_data_ = true;
+        break;
+      }
+      row_end = std::min(newline + 1, size);
+    }
+
+    pos = row_end;
+    if (pos - chunk_begin >= chunk_size) {
+      chunk_ends.push_back(pos);
+      chunk_begin = pos;
+    }
+  }
+
+  if (pos > chunk_begin) {
+    chunk_ends.push_back(pos);
+  }
+  return pos;
+}
+
+bool CopyLoader::LoadBatch(bool last) {
+  // The binary format starts with a signature, flags and an extension area
+  if (header_done_ == false && options_.format == COPY_FORMAT_BINARY) {
+    const size_t fixed_size = binary_signature_size + 2 * sizeof(int32_t);
+    if (buffer_.size() < fixed_size) {
+      if (last == false) return true;
+      error_message_ = "COPY file signature not recognized";
+      return false;
+    }
+    if (memcmp(buffer_.data(), binary_signature, binary_signature_size) != 0) {
+      error_message_ = "COPY file signature not recognized";
+      return false;
+    }
+    auto extension_len = GetNetworkInt(
+        reinterpret_cast<const uchar *>(buffer_.data()) +
+            binary_signature_size + sizeof(int32_t),
+        sizeof(int32_t));
+    if (extension_len < 0 || buffer_.size() < fixed_size + extension_len) {
+      if (last == false && extension_len >= 0) return true;
+      error_message_ = "invalid COPY file header";
+      return false;
+    }
+    buffer_.erase(0, fixed_size + extension_len);
+    header_done_ = true;
+  }
+
+  // The CSV header row only names the columns
+  if (header_done_ == false) {
+    size_t newline = FindRowEnd(options_, buffer_.data(), 0, buffer_.size());
+    if (newline == buffer_.size() && last == false) return true;
+    buffer_.erase(0, std::min(newline + 1, buffer_.size()));
+    header_done_ = true;
+  }
+
+  // Cut the batch into chunks of whole rows, one or more per thread
+  auto &copy_pool = GetCopyPool();
+  size_t chunk_size = std::max(buffer_.size() / copy_pool.GetNumThreads(),
+                               static_cast<size_t>(COPY_MIN_CHUNK_SIZE));
+  std::vector<size_t> chunk_ends;
+  size_t batch_end = SplitRows(chunk_size, last, chunk_ends);
+  if (chunk_ends.empty()) {
+    if (last || end_of_data_) buffer_.clear();
+    return true;
+  }
+
+  // Parse the chunks in parallel, each with a pool of its own
+  size_t chunk_count = chunk_ends.size();
+  std::vector<std::unique_ptr<VarlenPool>> chunk_pools(chunk_count);
+  std::vector<std::vector<std::unique_ptr<storage::Tuple>>> chunk_tuples(
+      chunk_count);
+  std::vector<std::string> chunk_errors(chunk_count);
+  std::vector<std::future<bool>> parses;
+
+  for (size_t chunk_itr = 0; chunk_itr < chunk_count; chunk_itr++) {
+    size_t chunk_begin = (chunk_itr == 0) ? 0 : chunk_ends[chunk_itr - 1];
+    chunk_pools[chunk_itr].reset(new VarlenPool(BACKEND_TYPE_MM));
+    parses.push_back(copy_pool.Enqueue([this, chunk_itr, chunk_begin,
+                                        &chunk_ends, &chunk_tuples,
+                                        &chunk_pools, &chunk_errors]() {
+      return ParseChunk(chunk_begin, chunk_ends[chunk_itr],
+                        chunk_tuples[chunk_itr], chunk_pools[chunk_itr].get(),
+                        chunk_errors[chunk_itr]);
+    }));
+  }
+
+  bool status = true;
+  for (size_t chunk_itr = 0; chunk_itr < chunk_count; chunk_itr++) {
+    if (parses[chunk_itr].get() == false && status) {
+      error_message_ = chunk_errors[chunk_itr];
+      status = false;
+    }
+  }
+  if (status == false) return false;
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  for (auto &tuples_of_chunk : chunk_tuples) {
+    std::move(tuples_of_chunk.begin(), tuples_of_chunk.end(),
+              std::back_inserter(tuples));
+  }
+
+  // Fill the tile groups and the indexes, then make the rows ours
+  EnterTransaction();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  std::vector<ItemPointer> locations;
+  locations.reserve(tuples.size());
+  if (table_->InsertTuples(tuples, locations, &copy_pool) == false) {
+    error_message_ = "COPY violates an index constraint";
+    status = false;
+  }
+
+  for (size_t location_itr = 0; status && location_itr < locations.size();
+       location_itr++) {
+    if (txn_manager.PerformInsert(locations[location_itr]) == false) {
+      error_message_ = "COPY failed to insert a row";
+      status = false;
+    }
+  }
+  LeaveTransaction();
+
+  if (status == false) return false;
+
+  row_count_ += tuples.size();
+  buffer_.erase(0, batch_end);
+  if (end_of_data_) buffer_.clear();
+
+  LOG_TRACE("COPY batch of %lu rows in %lu chunks", tuples.size(),
+            chunk_count);
+  return true;
+}
+
+bool CopyLoader::ParseChunk(
+    size_t begin, size_t end,
+    std::vector<std::unique_ptr<storage::Tuple>> &tuples, VarlenPool *pool,
+    std::string &error_message) {
+  auto schema = table_->GetSchema();
+
+  // columns without data are NULL
+  std::vector<oid_t> null_column_ids;
+  for (oid_t column_id = 0; column_id < schema->GetColumnCount();
+       column_id++) {
+    if (std::find(column_ids_.begin(), column_ids_.end(), column_id) ==
+        column_ids_.end()) {
+      null_column_ids.push_back(column_id);
+    }
+  }
+
+  const char *data = buffer_.data();
+  size_t pos = begin;
+  while (pos < end) {
+    std::unique_ptr<storage::Tuple> tuple(new storage::Tuple(schema, true));
+    for (auto column_id : null_column_ids) {
+      tuple->SetValue(column_id,
+                      ValueFactory::GetNullValueByType(
+                          schema->GetType(column_id)),
+                      pool);
+    }
+
+    bool status;
+    if (options_.format == COPY_FORMAT_BINARY) {
+      const uchar *row = reinterpret_cast<const uchar *>(data) + pos;
+      size_t row_len = GetBinaryRowLength(reinterpret_cast<const uchar *>(data),
+                                          pos, end);
+      if (row_len == 0) {
+        error_message = "unexpected EOF in COPY data";
+        return false;
+      }
+      status = ParseBinaryRow(row, row_len, tuple.get(), pool, error_message);
+      pos += row_len;
+    } else {
+      size_t newline = FindRowEnd(options_, data, pos, end);
+      status = ParseTextRow(data + pos, newline - pos, tuple.get(), pool,
+                            error_message);
+      pos = newline + 1;
+    }
+
+    if (status == false) return false;
+    tuples.push_back(std::move(tuple));
+  }
+  return true;
+}
+
+bool CopyLoader::ParseTextRow(const char *row, size_t len,
+                              storage::Tuple *tuple, VarlenPool *pool,
+                              std::string &error_message) {
+  if (len > 0 && row[len - 1] == '\r') len--;
+
+  bool csv = (options_.format == COPY_FORMAT_CSV);
+  size_t pos = 0;
+  size_t field_itr = 0;
+  std::string field;
+
+  // an empty row is one empty field
+  do {
+    if (field_itr == column_ids_.size()) {
+      error_message = "extra data after last expected column";
+      return false;
+    }
+
+    field.clear();
+    size_t field_begin = pos;
+    bool quoted = false;
+
+    if (csv) {
+      bool in_quote = false;
+      while (pos < len && (in_quote || row[pos] != options_.delimiter)) {
+        char c = row[pos];
+        if (in_quote && c == options_.escape && pos + 1 < len &&
+            (row[pos + 1] == options_.quote ||
+             row[pos + 1] == options_.escape)) {
+          field.push_back(row[pos + 1]);
+          pos += 2;
+          continue;
+        }
+        if (c == options_.quote) {
+          in_quote = !in_quote;
+          quoted = true;
+        } else {
+          field.push_back(c);
+        }
+        pos++;
+      }
+      if (in_quote) {
+        error_message = "unterminated CSV quoted field";
+        return false;
+      }
+    } else {
+      while (pos < len && row[pos] != options_.delimiter) {
+        char c = row[pos++];
+        if (c != '\\' || pos == len) {
+          field.push_back(c);
+          continue;
+        }
+
+        c = row[pos++];
+        switch (c) {
+          case 'b': field.push_back('\b'); break;
+          case 'f': field.push_back('\f'); break;
+          case 'n': field.push_back('\n'); break;
+          case 'r': field.push_back('\r'); break;
+          case 't': field.push_back('\t'); break;
+          case 'v': field.push_back('\v'); break;
+          case 'x':
+            if (pos < len && isxdigit(static_cast<uchar>(row[pos]))) {
+              int digit_count = 0, value = 0;
+              while (digit_count < 2 && pos < len &&
+                     isxdigit(static_cast<uchar>(row[pos]))) {
+                char digit = tolower(row[pos++]);
+                value = value * 16 +
+                        (isdigit(static_cast<uchar>(digit)) ? digit - '0'
+                                                           : digit - 'a' + 10);
+                digit_count++;
+              }
+              field.push_back(static_cast<char>(value));
+            } else {
+              field.push_back(c);
+            }
+            break;
+          default:
+            if (c >= '0' && c <= '7') {
+              int digit_count = 1, value = c - '0';
+              while (digit_count < 3 && pos < len && row[pos] >= '0' &&
+                     row[pos] <= '7') {
+                value = value * 8 + (row[pos++] - '0');
+                digit_count++;
+              }
+              field.push_back(static_cast<char>(value));
+            } else {
+              field.push_back(c);
+            }
+            break;
+        }
+      }
+    }
+
+    // NULL is matched before any unescaping, and never quoted
+    auto column_id = column_ids_[field_itr];
+    Value value;
+    if (quoted == false &&
+        options_.null_string.compare(0, std::string::npos, row + field_begin,
+                                     pos - field_begin) == 0) {
+      value = ValueFactory::GetNullValueByType(
+          table_->GetSchema()->GetType(column_id));
+    } else if (GetValue(reinterpret_cast<const uchar *>(field.data()),
+                        field.size(), 0, column_types_[field_itr], pool,
+                        value) == false) {
+      error_message = "invalid input syntax for column " +
+                      std::to_string(field_itr + 1) + ": \"" + field + "\"";
+      return false;
+    }
+    tuple->SetValue(column_id, value, pool);
+    field_itr++;
+  } while (pos++ < len);
+
+  if (field_itr != column_ids_.size()) {
+    error_message = "missing data for column " + std::to_string(field_itr + 1);
+    return false;
+  }
+  return true;
+}
+
+bool CopyLoader::ParseBinaryRow(const uchar *row, size_t len,
+                                storage::Tuple *tuple, VarlenPool *pool,
+                                std::string &error_message) {
+  size_t field_count = GetNetworkInt(row, sizeof(int16_t));
+  if (field_count != column_ids_.size()) {
+    error_message = "row field count is " + std::to_string(field_count) +
+                    ", expected " + std::to_string(column_ids_.size());
+    return false;
+  }
+
+  size_t pos = sizeof(int16_t);
+  for (size_t field_itr = 0; field_itr < field_count; field_itr++) {
+    int32_t field_len = GetNetworkInt(row + pos, sizeof(int32_t));
+    pos += sizeof(int32_t);
+
+    auto column_id = column_ids_[field_itr];
+    Value value;
+    if (field_len < 0) {
+      value = ValueFactory::GetNullValueByType(
+          table_->GetSchema()->GetType(column_id));
+    } else {
+      PL_ASSERT(pos + field_len <= len);
+      if (GetValue(row + pos, field_len, 1, column_types_[field_itr], pool,
+                   value) == false) {
+        error_message = "incorrect binary data format in column " +
+                        std::to_string(field_itr + 1);
+        return false;
+      }
+      pos += field_len;
+    }
+    tuple->SetValue(column_id, value, pool);
+  }
+  return true;
+}
+
+//===--------------------------------------------------------------------===//
+// Copy Out Sink
+//===--------------------------------------------------------------------===//
+
+CopyOutSink::CopyOutSink(PacketManager &packet_manager,
+                         ResponseBuffer &responses, const CopyOptions &options)
+    : packet_manager_(packet_manager),
+      responses_(responses),
+      options_(options) {}
+
+void CopyOutSink::PutHeader() {
+  if (options_.format != COPY_FORMAT_BINARY) return;
+
+  std::unique_ptr<Packet> pkt(new Packet());
+  pkt->msg_type = 'd';
+  PacketPutCbytes(pkt, reinterpret_cast<const uchar *>(binary_signature),
+                  binary_signature_size);
+  // flags and the length of the header extension
+  PacketPutInt(pkt, 0, 4);
+  PacketPutInt(pkt, 0, 4);
+  responses_.push_back(std::move(pkt));
+}
+
+void CopyOutSink::PutTrailer() {
+  if (options_.format != COPY_FORMAT_BINARY) return;
+
+  std::unique_ptr<Packet> pkt(new Packet());
+  pkt->msg_type = 'd';
+  PacketPutInt(pkt, -1, 2);
+  responses_.push_back(std::move(pkt));
+}
+
+void CopyOutSink::PutText(PktBuf &buf, const Value &value) {
+  if (value.IsNull()) {
+    buf.insert(buf.end(), options_.null_string.begin(),
+               options_.null_string.end());
+    return;
+  }
+
+  // the text format of the value, behind its length
+  scratch_.clear();
+  DataRowEncoder encoder(scratch_);
+  encoder.PutValue(value);
+  auto text_begin = scratch_.begin() + sizeof(int32_t);
+  auto text_end = scratch_.end();
+
+  if (options_.format == COPY_FORMAT_TEXT) {
+    for (auto itr = text_begin; itr != text_end; itr++) {
+      char c = *itr;
+      char escaped = 0;
+      switch (c) {
+        case '\\': escaped = '\\'; break;
+        case '\b': escaped = 'b'; break;
+        case '\f': escaped = 'f'; break;
+        case '\n': escaped = 'n'; break;
+        case '\r': escaped = 'r'; break;
+        case '\t': escaped = 't'; break;
+        case '\v': escaped = 'v'; break;
+        default:
+          if (c == options_.delimiter) escaped = c;
+          break;
+      }
+      if (escaped != 0) {
+        buf.push_back('\\');
+        buf.push_back(escaped);
+      } else {
+        buf.push_back(c);
+      }
+    }
+    return;
+  }
+
+  // CSV quotes what could be taken for a delimiter, a row end or NULL
+  bool quote = std::equal(text_begin, text_end, options_.null_string.begin(),
+                          options_.null_string.end());
+  for (auto itr = text_begin; quote == false && itr != text_end; itr++) {
+    char c = *itr;
+    quote = (c == options_.delimiter || c == options_.quote ||
+             c == options_.escape || c == '\n' || c == '\r');
+  }
+
+  if (quote == false) {
+    buf.insert(buf.end(), text_begin, text_end);
+    return;
+  }
+
+  buf.push_back(options_.quote);
+  for (auto itr = text_begin; itr != text_end; itr++) {
+    char c = *itr;
+    if (c == options_.quote || c == options_.escape) {
+      buf.push_back(options_.escape);
+    }
+    buf.push_back(c);
+  }
+  buf.push_back(options_.quote);
+}
+
+bool CopyOutSink::Consume(std::unique_ptr<executor::LogicalTile> &tile) {
+  int colcount = tile->GetColumnCount();
+
+  // All rows of the tile go into one framed packet, a CopyData each
+  std::unique_ptr<Packet> pkt(new Packet());
+  pkt->framed = true;
+  auto &buf = pkt->buf;
+
+  if (options_.format == COPY_FORMAT_BINARY) {
+    // the binary rows look like DataRows
+    DataRowEncoder encoder(buf, 'd');
+    for (oid_t tuple_id : *tile) {
+      encoder.BeginRow(colcount);
+      for (int column_itr = 0; column_itr < colcount; column_itr++) {
+        encoder.PutBinaryValue(tile->GetValue(tuple_id, column_itr));
+      }
+      encoder.EndRow();
+      row_count_++;
+    }
+  } else {
+    for (oid_t tuple_id : *tile) {
+      buf.push_back('d');
+      size_t row_begin = buf.size();
+      buf.resize(row_begin + sizeof(int32_t));
+
+      for (int column_itr = 0; column_itr < colcount; column_itr++) {
+        if (column_itr > 0) buf.push_back(options_.delimiter);
+        PutText(buf, tile->GetValue(tuple_id, column_itr));
+      }
+      buf.push_back('\n');
+
+      // the length includes its own field but not the type byte
+      uint32_t row_len = htonl(buf.size() - row_begin);
+      std::copy(reinterpret_cast<uchar *>(&row_len),
+                reinterpret_cast<uchar *>(&row_len) + sizeof(row_len),
+                buf.begin() + row_begin);
+      row_count_++;
+    }
+  }
+
+  if (buf.empty() == false) {
+    pkt->len = buf.size();
+    responses_.push_back(std::move(pkt));
+  }
+  tile.reset();
+
+  return packet_manager_.FlushResponses(responses_);
+}
+
+}  // End wire namespace
+}  // End peloton namespace
@@ -16,9 +16,20 @@
 #include <iterator>
 
 #include "wire/marshal.h"
+#include "common/value_factory.h"
+#include "common/value_peeker.h"
 
 #include <netinet/in.h>
 
+// Postgres counts dates and timestamps from 2000-01-01, Peloton from the
+// unix epoch
+#define POSTGRES_EPOCH_DAYS 10957
+#define POSTGRES_EPOCH_USECS 946684800000000LL
+
+// signs of a binary numeric
+#define NUMERIC_POS 0x0000
+#define NUMERIC_NEG 0x4000
+
 namespace peloton {
 namespace wire {
 
@@ -156,6 +167,511 @@ void PacketPutCbytes(std::unique_ptr<Packet> &pkt, const uchar *b, int len) {
   pkt->len += len;
 }
 
+void DataRowEncoder::SetInt(size_t offset, int32_t value) {
+  value = htonl(value);
+  std::copy(reinterpret_cast<uchar *>(&value),
+            reinterpret_cast<uchar *>(&value) + sizeof(int32_t),
+            std::begin(buf) + offset);
+}
+
+void DataRowEncoder::BeginRow(int colcount) {
+  buf.push_back(row_type);
+
+  // length is known once the row is done
+  row_begin = buf.size();
+  buf.resize(row_begin + sizeof(int32_t) + sizeof(int16_t));
+
+  int16_t colcount_nb = htons(colcount);
+  std::copy(reinterpret_cast<uchar *>(&colcount_nb),
+            reinterpret_cast<uchar *>(&colcount_nb) + sizeof(int16_t),
+            std::begin(buf) + row_begin + sizeof(int32_t));
+}
+
+void DataRowEncoder::EndRow() {
+  // the length includes its own field but not the type byte
+  SetInt(row_begin, buf.size() - row_begin);
+}
+
+void DataRowEncoder::PutNull() {
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(int32_t));
+  SetInt(offset, -1);
+}
+
+void DataRowEncoder::PutText(const char *data, size_t len) {
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(int32_t));
+  SetInt(offset, len);
+  buf.insert(std::end(buf), data, data + len);
+}
+
+void DataRowEncoder::PutInteger(int64_t value) {
+  // sign and up to 20 digits
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(int32_t) + 21);
+  char *out = reinterpret_cast<char *>(&buf[offset + sizeof(int32_t)]);
+
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  if (value < 0) magnitude = 0 - magnitude;
+  char digits[20];
+  size_t digit_count = 0;
+  do {
+    digits[digit_count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  size_t len = 0;
+  if (value < 0) out[len++] = '-';
+  while (digit_count > 0) out[len++] = digits[--digit_count];
+
+  SetInt(offset, len);
+  buf.resize(offset + sizeof(int32_t) + len);
+}
+
+void DataRowEncoder::PutDouble(double value, int precision) {
+  const size_t max_len = 32;
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(int32_t) + max_len);
+  char *out = reinterpret_cast<char *>(&buf[offset + sizeof(int32_t)]);
+
+  size_t len = snprintf(out, max_len, "%.*g", precision, value);
+  if (len >= max_len) len = max_len - 1;
+
+  SetInt(offset, len);
+  buf.resize(offset + sizeof(int32_t) + len);
+}
+
+void DataRowEncoder::PutBoolean(bool value) {
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(int32_t) + 1);
+  SetInt(offset, 1);
+  buf[offset + sizeof(int32_t)] = value ? 't' : 'f';
+}
+
+void DataRowEncoder::PutValue(const Value &value) {
+  if (value.IsNull()) {
+    PutNull();
+    return;
+  }
+
+  switch (value.GetValueType()) {
+    case VALUE_TYPE_BOOLEAN:
+      PutBoolean(ValuePeeker::PeekBoolean(value));
+      break;
+
+    case VALUE_TYPE_TINYINT:
+      PutInteger(ValuePeeker::PeekTinyInt(value));
+      break;
+    case VALUE_TYPE_SMALLINT:
+      PutInteger(ValuePeeker::PeekSmallInt(value));
+      break;
+    case VALUE_TYPE_INTEGER:
+      PutInteger(ValuePeeker::PeekInteger(value));
+      break;
+    case VALUE_TYPE_BIGINT:
+      PutInteger(ValuePeeker::PeekBigInt(value));
+      break;
+
+    // same number of significant digits as postgres
+    case VALUE_TYPE_REAL:
+      PutDouble(ValuePeeker::PeekDouble(value), 6);
+      break;
+    case VALUE_TYPE_DOUBLE:
+      PutDouble(ValuePeeker::PeekDouble(value), 15);
+      break;
+
+    // strings are copied straight out of the tile
+    case VALUE_TYPE_VARCHAR:
+    case VALUE_TYPE_VARBINARY:
+      PutText(reinterpret_cast<const char *>(
+                  ValuePeeker::PeekObjectValueWithoutNull(value)),
+              ValuePeeker::PeekObjectLengthWithoutNull(value));
+      break;
+
+    // dates, timestamps and decimals go through their string cast
+    default: {
+      Value string_value = value.CastAs(VALUE_TYPE_VARCHAR);
+      PutText(reinterpret_cast<const char *>(
+                  ValuePeeker::PeekObjectValueWithoutNull(string_value)),
+              ValuePeeker::PeekObjectLengthWithoutNull(string_value));
+    } break;
+  }
+}
+
+void DataRowEncoder::PutBinaryInt(uint64_t bits, size_t width) {
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(int32_t) + width);
+  SetInt(offset, width);
+
+  uchar *out = &buf[offset + sizeof(int32_t)];
+  for (size_t byte_itr = 0; byte_itr < width; byte_itr++) {
+    out[byte_itr] = (bits >> (8 * (width - 1 - byte_itr))) & 0xFF;
+  }
+}
+
+void DataRowEncoder::PutBinaryNumeric(const std::string &text) {
+  // split "-123.456" into its sign, integer and fraction digits
+  size_t pos = 0;
+  int16_t sign = NUMERIC_POS;
+  if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+    if (text[pos] == '-') sign = NUMERIC_NEG;
+    pos++;
+  }
+  size_t point = text.find('.', pos);
+  std::string int_digits = text.substr(
+      pos, point == std::string::npos ? std::string::npos : point - pos);
+  std::string frac_digits =
+      point == std::string::npos ? "" : text.substr(point + 1);
+  int16_t dscale = frac_digits.size();
+
+  // base 10000 digits are aligned on the decimal point
+  int_digits.insert(0, (4 - int_digits.size() % 4) % 4, '0');
+  frac_digits.append((4 - frac_digits.size() % 4) % 4, '0');
+  std::string all_digits = int_digits + frac_digits;
+  int16_t weight = int_digits.size() / 4 - 1;
+
+  std::vector<int16_t> digits;
+  for (size_t digit_itr = 0; digit_itr < all_digits.size(); digit_itr += 4) {
+    int16_t digit = 0;
+    for (size_t char_itr = digit_itr; char_itr < digit_itr + 4; char_itr++) {
+      digit = digit * 10 + (all_digits[char_itr] - '0');
+    }
+    digits.push_back(digit);
+  }
+
+  // zero digits on either end are implied by the weight
+  size_t first = 0, last = digits.size();
+  while (first < last && digits[first] == 0) {
+    first++;
+    weight--;
+  }
+  while (last > first && digits[last - 1] == 0) last--;
+  if (first == last) {
+    weight = 0;
+    sign = NUMERIC_POS;
+  }
+
+  int16_t header[4] = {static_cast<int16_t>(last - first), weight, sign,
+                       dscale};
+
+  size_t offset = buf.size();
+  size_t len = (4 + last - first) * sizeof(int16_t);
+  buf.resize(offset + sizeof(int32_t));
+  SetInt(offset, len);
+
+  for (auto field : header) {
+    uint16_t field_nb = htons(field);
+    buf.insert(std::end(buf), reinterpret_cast<uchar *>(&field_nb),
+               reinterpret_cast<uchar *>(&field_nb) + sizeof(int16_t));
+  }
+  for (size_t digit_itr = first; digit_itr < last; digit_itr++) {
+    uint16_t digit_nb = htons(digits[digit_itr]);
+    buf.insert(std::end(buf), reinterpret_cast<uchar *>(&digit_nb),
+               reinterpret_cast<uchar *>(&digit_nb) + sizeof(int16_t));
+  }
+}
+
+void DataRowEncoder::PutBinaryValue(const Value &value) {
+  if (value.IsNull()) {
+    PutNull();
+    return;
+  }
+
+  switch (value.GetValueType()) {
+    case VALUE_TYPE_BOOLEAN:
+      PutBinaryInt(ValuePeeker::PeekBoolean(value) ? 1 : 0, 1);
+      break;
+
+    // tiny ints are described as smallint
+    case VALUE_TYPE_TINYINT:
+      PutBinaryInt(static_cast<uint16_t>(ValuePeeker::PeekTinyInt(value)), 2);
+      break;
+    case VALUE_TYPE_SMALLINT:
+      PutBinaryInt(static_cast<uint16_t>(ValuePeeker::PeekSmallInt(value)), 2);
+      break;
+    case VALUE_TYPE_INTEGER:
+      PutBinaryInt(static_cast<uint32_t>(ValuePeeker::PeekInteger(value)), 4);
+      break;
+    case VALUE_TYPE_BIGINT:
+      PutBinaryInt(static_cast<uint64_t>(ValuePeeker::PeekBigInt(value)), 8);
+      break;
+
+    case VALUE_TYPE_REAL: {
+      float real_value = ValuePeeker::PeekDouble(value);
+      uint32_t bits;
+      memcpy(&bits, &real_value, sizeof(bits));
+      PutBinaryInt(bits, sizeof(bits));
+    } break;
+    case VALUE_TYPE_DOUBLE: {
+      double double_value = ValuePeeker::PeekDouble(value);
+      uint64_t bits;
+      memcpy(&bits, &double_value, sizeof(bits));
+      PutBinaryInt(bits, sizeof(bits));
+    } break;
+
+    // the binary format of text is the text itself
+    case VALUE_TYPE_VARCHAR:
+    case VALUE_TYPE_VARBINARY:
+      PutText(reinterpret_cast<const char *>(
+                  ValuePeeker::PeekObjectValueWithoutNull(value)),
+              ValuePeeker::PeekObjectLengthWithoutNull(value));
+      break;
+
+    case VALUE_TYPE_DATE:
+      PutBinaryInt(static_cast<uint32_t>(ValuePeeker::PeekDate(value) -
+                                         POSTGRES_EPOCH_DAYS),
+                   4);
+      break;
+    case VALUE_TYPE_TIMESTAMP:
+      PutBinaryInt(static_cast<uint64_t>(ValuePeeker::PeekTimestamp(value) -
+                                         POSTGRES_EPOCH_USECS),
+                   8);
+      break;
+
+    case VALUE_TYPE_DECIMAL:
+      PutBinaryNumeric(ValuePeeker::PeekDecimalString(value));
+      break;
+
+    default:
+      LOG_ERROR("No binary format for value type %d, sending text",
+                value.GetValueType());
+      PutValue(value);
+      break;
+  }
+}
+
+// Reads a "width" byte int in network byte order
+static uint64_t GetBinaryInt(const uchar *data, size_t width) {
+  uint64_t bits = 0;
+  for (size_t byte_itr = 0; byte_itr < width; byte_itr++) {
+    bits = (bits << 8) | data[byte_itr];
+  }
+  return bits;
+}
+
+// Days between the unix epoch and a date of the proleptic gregorian calendar
+static int32_t DaysFromCivil(int year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+  const unsigned day_of_year =
+      (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const unsigned day_of_era =
+      year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + static_cast<int>(day_of_era) - 719468;
+}
+
+// Turns the base 10000 binary format of numeric back into text
+static bool GetNumericString(const uchar *data, size_t len, std::string &text) {
+  if (len < 4 * sizeof(int16_t)) return false;
+
+  int16_t ndigits = GetBinaryInt(data, 2);
+  int16_t weight = GetBinaryInt(data + 2, 2);
+  uint16_t sign = GetBinaryInt(data + 4, 2);
+  int16_t dscale = GetBinaryInt(data + 6, 2);
+  if (ndigits < 0 || dscale < 0 ||
+      len != (4 + static_cast<size_t>(ndigits)) * sizeof(int16_t) ||
+      (sign != NUMERIC_POS && sign != NUMERIC_NEG)) {
+    return false;
+  }
+
+  auto digit_at = [&](int digit_weight) -> int {
+    int digit_idx = weight - digit_weight;
+    if (digit_idx < 0 || digit_idx >= ndigits) return 0;
+    return static_cast<int16_t>(GetBinaryInt(data + 8 + 2 * digit_idx, 2));
+  };
+
+  char group[8];
+  std::string int_part;
+  for (int digit_weight = weight; digit_weight >= 0; digit_weight--) {
+    snprintf(group, sizeof(group), "%04d", digit_at(digit_weight));
+    int_part += group;
+  }
+  size_t int_begin = int_part.find_first_not_of('0');
+  int_part =
+      (int_begin == std::string::npos) ? "0" : int_part.substr(int_begin);
+
+  std::string frac_part;
+  for (int digit_weight = -1;
+       frac_part.size() < static_cast<size_t>(dscale); digit_weight--) {
+    snprintf(group, sizeof(group), "%04d", digit_at(digit_weight));
+    frac_part += group;
+  }
+  frac_part.resize(dscale);
+
+  text = (sign == NUMERIC_NEG) ? "-" : "";
+  text += int_part;
+  if (dscale > 0) text += "." + frac_part;
+  return true;
+}
+
+static bool GetBinaryValue(PostgresValueType type, const uchar *data,
+                           size_t len, VarlenPool *pool, Value &value) {
+  switch (type) {
+    case POSTGRES_VALUE_TYPE_BOOLEAN:
+      if (len != 1) return false;
+      value = ValueFactory::GetBooleanValue(data[0] != 0);
+      return true;
+
+    case POSTGRES_VALUE_TYPE_SMALLINT:
+      if (len != 2) return false;
+      value = ValueFactory::GetSmallIntValue(GetBinaryInt(data, 2));
+      return true;
+    case POSTGRES_VALUE_TYPE_INTEGER:
+      if (len != 4) return false;
+      value = ValueFactory::GetIntegerValue(GetBinaryInt(data, 4));
+      return true;
+    case POSTGRES_VALUE_TYPE_BIGINT:
+      if (len != 8) return false;
+      value = ValueFactory::GetBigIntValue(GetBinaryInt(data, 8));
+      return true;
+
+    case POSTGRES_VALUE_TYPE_REAL: {
+      if (len != 4) return false;
+      uint32_t bits = GetBinaryInt(data, 4);
+      float real_value;
+      memcpy(&real_value, &bits, sizeof(bits));
+      value = ValueFactory::GetDoubleValue(real_value);
+      return true;
+    }
+    case POSTGRES_VALUE_TYPE_DOUBLE: {
+      if (len != 8) return false;
+      uint64_t bits = GetBinaryInt(data, 8);
+      double double_value;
+      memcpy(&double_value, &bits, sizeof(bits));
+      value = ValueFactory::GetDoubleValue(double_value);
+      return true;
+    }
+
+    case POSTGRES_VALUE_TYPE_DATE:
+      if (len != 4) return false;
+      value = ValueFactory::GetDateValue(
+          static_cast<int32_t>(GetBinaryInt(data, 4)) + POSTGRES_EPOCH_DAYS);
+      return true;
+    case POSTGRES_VALUE_TYPE_TIMESTAMPS:
+    case POSTGRES_VALUE_TYPE_TIMESTAMPS2:
+      if (len != 8) return false;
+      value = ValueFactory::GetTimestampValue(
+          static_cast<int64_t>(GetBinaryInt(data, 8)) + POSTGRES_EPOCH_USECS);
+      return true;
+
+    case POSTGRES_VALUE_TYPE_DECIMAL: {
+      std::string text;
+      if (GetNumericString(data, len, text) == false) return false;
+      value = ValueFactory::GetDecimalValueFromString(text);
+      return true;
+    }
+
+    case POSTGRES_VALUE_TYPE_TEXT:
+    case POSTGRES_VALUE_TYPE_BPCHAR:
+    case POSTGRES_VALUE_TYPE_BPCHAR2:
+    case POSTGRES_VALUE_TYPE_VARCHAR:
+    case POSTGRES_VALUE_TYPE_VARCHAR2:
+      value = ValueFactory::GetStringValue(
+          std::string(data, data + len), pool);
+      return true;
+
+    default:
+      LOG_ERROR("Parsing error: no binary format for type %d", type);
+      return false;
+  }
+}
+
+static bool GetTextValue(PostgresValueType type, const std::string &text,
+                         VarlenPool *pool, Value &value) {
+  const char *begin = text.c_str();
+  char *end = nullptr;
+
+  switch (type) {
+    case POSTGRES_VALUE_TYPE_BOOLEAN:
+      value = ValueFactory::GetBooleanValue(
+          text == "on" || (text.empty() == false &&
+                           strchr("tTyY1", text[0]) != nullptr));
+      return true;
+
+    case POSTGRES_VALUE_TYPE_SMALLINT:
+    case POSTGRES_VALUE_TYPE_INTEGER:
+    case POSTGRES_VALUE_TYPE_BIGINT: {
+      long long int_value = strtoll(begin, &end, 10);
+      if (end == begin || *end != '\0') return false;
+      if (type == POSTGRES_VALUE_TYPE_SMALLINT)
+        value = ValueFactory::GetSmallIntValue(int_value);
+      else if (type == POSTGRES_VALUE_TYPE_INTEGER)
+        value = ValueFactory::GetIntegerValue(int_value);
+      else
+        value = ValueFactory::GetBigIntValue(int_value);
+      return true;
+    }
+
+    case POSTGRES_VALUE_TYPE_REAL:
+    case POSTGRES_VALUE_TYPE_DOUBLE: {
+      double double_value = strtod(begin, &end);
+      if (end == begin || *end != '\0') return false;
+      value = ValueFactory::GetDoubleValue(double_value);
+      return true;
+    }
+
+    case POSTGRES_VALUE_TYPE_DATE: {
+      int year, month, day;
+      if (sscanf(begin, "%d-%d-%d", &year, &month, &day) != 3) return false;
+      value = ValueFactory::GetDateValue(DaysFromCivil(year, month, day));
+      return true;
+    }
+
+    // timestamps and decimals have their own parsers
+    case POSTGRES_VALUE_TYPE_TIMESTAMPS:
+    case POSTGRES_VALUE_TYPE_TIMESTAMPS2:
+      value = ValueFactory::GetTempStringValue(text).CastAs(
+          VALUE_TYPE_TIMESTAMP);
+      return true;
+    case POSTGRES_VALUE_TYPE_DECIMAL:
+      value = ValueFactory::GetDecimalValueFromString(text);
+      return true;
+
+    // everything else is kept as a string
+    default:
+      value = ValueFactory::GetStringValue(text, pool);
+      return true;
+  }
+}
+
+bool GetValue(const uchar *data, size_t len, int16_t format, int32_t type,
+              VarlenPool *pool, Value &value) {
+  auto postgres_type = static_cast<PostgresValueType>(type);
+
+  // the parsers of Value throw on malformed text
+  try {
+    if (format == 0) {
+      return GetTextValue(postgres_type, std::string(data, data + len), pool,
+                          value);
+    }
+
+    // without a declared type the bytes are taken as they are
+    if (type == 0) {
+      value = ValueFactory::GetStringValue(std::string(data, data + len),
+                                           pool);
+      return true;
+    }
+    return GetBinaryValue(postgres_type, data, len, pool, value);
+  } catch (Exception &e) {
+    LOG_ERROR("Parsing error: %s", e.what());
+    return false;
+  }
+}
+
+bool PacketGetValue(Packet *pkt, size_t len, int16_t format, int32_t type,
+                    VarlenPool *pool, Value &value) {
+  if (pkt->ptr + len > pkt->len) {
+    LOG_ERROR("Parsing error: parameter runs past the packet");
+    return false;
+  }
+
+  const uchar *data = pkt->buf.data() + pkt->ptr;
+  pkt->ptr += len;
+
+  return GetValue(data, len, format, type, pool, value);
+}
+
 /*
  * read_packet - Tries to read a single packet, returns true on success,
  * 		false on failure. Accepts pointer to an empty packet, and if the
@@ -213,7 +729,15 @@ bool WritePackets(std::vector<std::unique_ptr<Packet>> &packets,
   // iterate through all the packets
   for (size_t i = 0; i < packets.size(); i++) {
     auto pkt = packets[i].get();
-    if (!client->sock->BufferWriteBytes(pkt->buf, pkt->len, pkt->msg_type)) {
+    bool status;
+    if (pkt->framed) {
+      // already holds whole messages, no need to stage them in the buffer
+      status = client->sock->WriteFramedBytes(pkt->buf, pkt->len);
+    } else {
+      status =
+          client->sock->BufferWriteBytes(pkt->buf, pkt->len, pkt->msg_type);
+    }
+    if (!status) {
       packets.clear();
       return false;
     }
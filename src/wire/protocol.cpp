@@ -11,30 +11,42 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <algorithm>
 #include <cstdio>
 #include <unordered_map>
 
-#include "common/cache.h"
 #include "common/types.h"
 #include "common/macros.h"
+#include "catalog/bootstrapper.h"
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
 
 #include "wire/marshal.h"
+#include "common/pool.h"
 #include "common/portal.h"
+#include "common/value_factory.h"
+#include "executor/logical_tile.h"
+#include "executor/plan_executor.h"
+#include "parser/postgres_parser.h"
+#include "parser/peloton/copy_parse.h"
+#include "planner/seq_scan_plan.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
 #include "tcop/tcop.h"
+#include "wire/copy.h"
 
 #include <boost/algorithm/string.hpp>
 
 #define PROTO_MAJOR_VERSION(x) x >> 16
 
+// Guess of the encoded size of a row, used to size the send buffer once per
+// result tile: type, length and column count, then per attribute a length and
+// a few bytes of text
+#define DATA_ROW_SIZE_HINT(colcount) (7 + (colcount) * 12)
+
 namespace peloton {
 namespace wire {
 
-// Prepares statment cache
-thread_local peloton::Cache<std::string, Statement> statement_cache_;
-
-// Query portal handler
-thread_local std::unordered_map<std::string, std::shared_ptr<Portal>> portals_;
-
 // Hardcoded authentication strings used during session startup. To be removed
 const std::unordered_map<std::string, std::string>
     PacketManager::parameter_status_map =
@@ -45,6 +57,14 @@ const std::unordered_map<std::string, std::string>
             "server_version", "9.5devel")("session_authorization", "postgres")(
             "standard_conforming_strings", "on")("TimeZone", "US/Eastern");
 
+PacketManager::PacketManager(SocketManager<PktBuf> *sock)
+    : client(sock), txn_state(TXN_IDLE) {}
+
+PacketManager::~PacketManager() {
+  // a client that goes away in the middle of COPY FROM loses the data
+  copy_loader_.reset();
+}
+
 /*
  * close_client - Close the socket of the underlying client
  */
@@ -114,9 +134,20 @@ bool PacketManager::ProcessStartupPacket(Packet *pkt,
   return true;
 }
 
+/*
+ * GetResultFormat - Format code of a result column: no codes means text, a
+ * 	single code applies to every column
+ */
+static int16_t GetResultFormat(const std::vector<int16_t> &formats,
+                               size_t column) {
+  if (formats.empty()) return 0;
+  if (formats.size() == 1) return formats[0];
+  return column < formats.size() ? formats[column] : 0;
+}
+
 void PacketManager::PutTupleDescriptor(
     const std::vector<FieldInfoType> &tuple_descriptor,
-    ResponseBuffer &responses) {
+    ResponseBuffer &responses, const std::vector<int16_t> &formats) {
 
   if (tuple_descriptor.empty()) return;
 
@@ -126,7 +157,8 @@ void PacketManager::PutTupleDescriptor(
   pkt->msg_type = 'T';
   PacketPutInt(pkt, tuple_descriptor.size(), 2);
 
-  for (auto col : tuple_descriptor) {
+  for (size_t col_itr = 0; col_itr < tuple_descriptor.size(); col_itr++) {
+    auto &col = tuple_descriptor[col_itr];
     LOG_INFO("column name: %s", std::get<0>(col).c_str());
     PacketPutString(pkt, std::get<0>(col));
     // TODO: Table Oid (int32)
@@ -139,35 +171,144 @@ void PacketManager::PutTupleDescriptor(
     PacketPutInt(pkt, std::get<2>(col), 2);
     // Type modifier (int32)
     PacketPutInt(pkt, -1, 4);
-    // Format code for text
-    PacketPutInt(pkt, 0, 2);
+    // Format code
+    PacketPutInt(pkt, GetResultFormat(formats, col_itr), 2);
   }
   responses.push_back(std::move(pkt));
 }
 
-void PacketManager::SendDataRows(std::vector<ResultType> &results, int colcount,
-                                 int &rows_affected,
-                                 ResponseBuffer &responses) {
-  if (!results.size() || !colcount) return;
-
-  LOG_INFO("Flatten result size: %lu", results.size());
-  size_t numrows = results.size() / colcount;
-
-  // 1 packet per row
-  for (size_t i = 0; i < numrows; i++) {
-    std::unique_ptr<Packet> pkt(new Packet());
-    pkt->msg_type = 'D';
-    PacketPutInt(pkt, colcount, 2);
-    for (int j = 0; j < colcount; j++) {
-      // length of the row attribute
-      PacketPutInt(pkt, results[i * colcount + j].second.size(), 4);
-      // contents of the row attribute
-      PacketPutBytes(pkt, results[i * colcount + j].second);
+bool PacketManager::FlushResponses(ResponseBuffer &responses) {
+  if (!flusher_) return true;
+  return flusher_(responses);
+}
+
+//===--------------------------------------------------------------------===//
+// Data Row Sink
+//===--------------------------------------------------------------------===//
+
+/*
+ * DataRowSink - Encodes the output tiles of a plan into DataRow messages as
+ * 	the executor produces them, and flushes every batch to the client right
+ * 	away. With a row limit (the max_rows of Execute) the sink fills up once
+ * 	the limit is reached, which suspends the portal.
+ */
+class DataRowSink : public bridge::ResultSink {
+ public:
+  DataRowSink(PacketManager &packet_manager, ResponseBuffer &responses,
+              std::shared_ptr<Statement> statement,
+              const std::vector<int16_t> &formats, bool send_descriptor,
+              size_t max_rows)
+      : packet_manager_(packet_manager),
+        responses_(responses),
+        statement_(statement),
+        formats_(formats),
+        send_descriptor_(send_descriptor),
+        max_rows_(max_rows) {}
+
+  bool Consume(std::unique_ptr<executor::LogicalTile> &tile) override;
+
+  size_t GetRowCount() const { return row_count_; }
+
+ private:
+  // Describe the columns on the first tile
+  void DescribeColumns(executor::LogicalTile *tile);
+
+  PacketManager &packet_manager_;
+
+  ResponseBuffer &responses_;
+
+  // statement whose tuple descriptor is filled in, may be null
+  std::shared_ptr<Statement> statement_;
+
+  const std::vector<int16_t> &formats_;
+
+  // whether the client needs a RowDescription before the rows
+  bool send_descriptor_;
+
+  // 0 means no limit
+  size_t max_rows_;
+
+  size_t row_count_ = 0;
+
+  bool described_ = false;
+
+  std::vector<int16_t> column_formats_;
+};
+
+void DataRowSink::DescribeColumns(executor::LogicalTile *tile) {
+  std::vector<FieldInfoType> tuple_descriptor;
+  if (statement_ != nullptr) {
+    tuple_descriptor = statement_->GetTupleDescriptor();
+  }
+
+  // The output columns are known once the plan produced a tile
+  if (tuple_descriptor.empty()) {
+    tuple_descriptor = tcop::TrafficCop::GenerateTupleDescriptor(tile);
+    if (statement_ != nullptr) {
+      statement_->SetTupleDescriptor(tuple_descriptor);
+    }
+  }
+
+  if (send_descriptor_) {
+    packet_manager_.PutTupleDescriptor(tuple_descriptor, responses_,
+                                       formats_);
+  }
+
+  for (size_t column_itr = 0; column_itr < tile->GetColumnCount();
+       column_itr++) {
+    column_formats_.push_back(GetResultFormat(formats_, column_itr));
+  }
+  described_ = true;
+}
+
+bool DataRowSink::Consume(std::unique_ptr<executor::LogicalTile> &tile) {
+  if (described_ == false) {
+    DescribeColumns(tile.get());
+  }
+
+  int colcount = tile->GetColumnCount();
+
+  // The rows of the tile go into one framed packet, formatted in place
+  std::unique_ptr<Packet> pkt(new Packet());
+  pkt->framed = true;
+  pkt->buf.reserve(tile->GetTupleCount() * DATA_ROW_SIZE_HINT(colcount));
+  DataRowEncoder encoder(pkt->buf);
+
+  std::vector<oid_t> sent_rows;
+  bool full = false;
+  for (oid_t tuple_id : *tile) {
+    if (max_rows_ > 0 && row_count_ == max_rows_) {
+      full = true;
+      break;
+    }
+
+    encoder.BeginRow(colcount);
+    for (int column_itr = 0; column_itr < colcount; column_itr++) {
+      encoder.PutValue(tile->GetValue(tuple_id, column_itr),
+                       column_formats_[column_itr]);
+    }
+    encoder.EndRow();
+    row_count_++;
+
+    if (max_rows_ > 0) sent_rows.push_back(tuple_id);
+  }
+
+  if (pkt->buf.empty() == false) {
+    pkt->len = pkt->buf.size();
+    responses_.push_back(std::move(pkt));
+  }
+
+  if (full) {
+    // the rest of the tile waits for the next Execute
+    for (auto tuple_id : sent_rows) {
+      tile->RemoveVisibility(tuple_id);
     }
-    responses.push_back(std::move(pkt));
+  } else {
+    tile.reset();
   }
-  rows_affected = numrows;
-  LOG_INFO("Rows affected: %d", rows_affected);
+
+  // Stalls while the client falls behind, instead of buffering the result
+  return packet_manager_.FlushResponses(responses_);
 }
 
 /* Gets the first token of a query */
@@ -230,35 +371,48 @@ void PacketManager::ExecQueryMessage(Packet *pkt, ResponseBuffer &responses) {
   PacketGetString(pkt, pkt->len, q_str);
   LOG_INFO("Query Received: %s \n", q_str.c_str());
 
-  std::vector<std::string> queries;
-  boost::split(queries, q_str, boost::is_any_of(";"));
+  // The statements are split by the scanner of the parser, so semicolons in
+  // literals and comments do not break them apart
+  pending_queries_ =
+      parser::PostgresParser::GetInstance().SplitStatements(q_str);
+  next_query_ = 0;
 
-  // just a ';' sent
-  if (queries.size() == 1) {
+  // nothing but blanks, comments or ';' sent
+  if (pending_queries_.empty()) {
     SendEmptyQueryResponse(responses);
     SendReadyForQuery(txn_state, responses);
     return;
   }
 
+  RunPendingQueries(responses);
+}
+
+void PacketManager::RunPendingQueries(ResponseBuffer &responses) {
   // Get traffic cop
   auto &tcop = tcop::TrafficCop::GetInstance();
 
-  // iterate till before the trivial string after the last ';'
-  for (auto query : queries) {
-    if (query.empty()) {
-      SendEmptyQueryResponse(responses);
-      SendReadyForQuery(TXN_IDLE, responses);
-      return;
+  // The responses of all statements go out together with ReadyForQuery
+  while (next_query_ < pending_queries_.size()) {
+    auto &query = pending_queries_[next_query_++];
+    auto query_type = boost::to_upper_copy(get_query_type(query));
+
+    // COPY talks to the client itself
+    if (query_type == "COPY") {
+      if (ExecCopyStatement(query, responses) == false) break;
+
+      // the rest waits until the data of COPY FROM STDIN is in
+      if (copy_loader_ != nullptr) return;
+      continue;
     }
 
-    std::vector<ResultType> result;
-    std::vector<FieldInfoType> tuple_descriptor;
     std::string error_message;
     int rows_affected;
 
-    // execute the query in Sqlite
-    auto status = tcop.ExecuteStatement(query, result, tuple_descriptor,
-                                        rows_affected, error_message);
+    // the attribute names and the rows are sent as the query runs
+    std::vector<int16_t> formats;
+    DataRowSink sink(*this, responses, nullptr, formats, true, 0);
+    auto status =
+        tcop.ExecuteStatement(query, sink, rows_affected, error_message);
 
     // check status
     if (status == Result::RESULT_FAILURE) {
@@ -267,16 +421,170 @@ void PacketManager::ExecQueryMessage(Packet *pkt, ResponseBuffer &responses) {
       break;
     }
 
-    // send the attribute names
-    PutTupleDescriptor(tuple_descriptor, responses);
+    if (sink.GetRowCount() > 0) {
+      rows_affected = sink.GetRowCount();
+    }
+
+    CompleteCommand(query_type, rows_affected, responses);
+  }
+
+  pending_queries_.clear();
+  next_query_ = 0;
+  SendReadyForQuery(txn_state, responses);
+}
 
-    // send the result rows
-    SendDataRows(result, tuple_descriptor.size(), rows_affected, responses);
+/*
+ * SendCopyResponse - CopyInResponse ('G') or CopyOutResponse ('H'): the
+ * 	format of the data, then the same format code for every column
+ */
+static void SendCopyResponse(uchar msg_type, const CopyOptions &options,
+                             size_t column_count, ResponseBuffer &responses) {
+  int16_t format = (options.format == COPY_FORMAT_BINARY) ? 1 : 0;
 
-    // TODO: should change to query_type
-    CompleteCommand(query, rows_affected, responses);
+  std::unique_ptr<Packet> pkt(new Packet());
+  pkt->msg_type = msg_type;
+  PacketPutByte(pkt, format);
+  PacketPutInt(pkt, column_count, 2);
+  for (size_t column_itr = 0; column_itr < column_count; column_itr++) {
+    PacketPutInt(pkt, format, 2);
   }
-  SendReadyForQuery('I', responses);
+  responses.push_back(std::move(pkt));
+}
+
+bool PacketManager::ExecCopyStatement(const std::string &query,
+                                      ResponseBuffer &responses) {
+  auto parse_tree = parser::PostgresParser::GetInstance().BuildParseTree(query);
+  if (parse_tree == nullptr ||
+      parse_tree->GetParseNodeType() != PARSE_NODE_TYPE_COPY) {
+    SendErrorResponse({{'M', "syntax error in COPY"}}, responses);
+    return false;
+  }
+  auto copy_parse = static_cast<parser::CopyParse *>(parse_tree.get());
+
+  // Files and programs live on the client side
+  if (copy_parse->IsStdio() == false || copy_parse->GetTableName().empty()) {
+    SendErrorResponse({{'M', "only COPY table FROM STDIN and COPY table TO "
+                             "STDOUT are supported"}},
+                      responses);
+    return false;
+  }
+
+  std::string error_message;
+  CopyOptions options;
+  if (CopyOptions::FromParse(*copy_parse, options, error_message) == false) {
+    SendErrorResponse({{'M', error_message}}, responses);
+    return false;
+  }
+
+  storage::DataTable *table = nullptr;
+  auto database = catalog::Bootstrapper::global_catalog == nullptr
+                      ? nullptr
+                      : catalog::Bootstrapper::global_catalog
+                            ->GetDatabaseWithName("default_database");
+  if (database != nullptr) {
+    table = database->GetTableWithName(copy_parse->GetTableName());
+  }
+  if (table == nullptr) {
+    SendErrorResponse({{'M', "relation \"" + copy_parse->GetTableName() +
+                                 "\" does not exist"}},
+                      responses);
+    return false;
+  }
+
+  // The data has the columns in the order of the statement, or all of them
+  auto schema = table->GetSchema();
+  std::vector<oid_t> column_ids;
+  for (auto &column_name : copy_parse->GetColumnNames()) {
+    oid_t column_id = 0;
+    while (column_id < schema->GetColumnCount() &&
+           schema->GetColumn(column_id).GetName() != column_name) {
+      column_id++;
+    }
+    if (column_id == schema->GetColumnCount()) {
+      SendErrorResponse({{'M', "column \"" + column_name +
+                                   "\" does not exist"}},
+                        responses);
+      return false;
+    }
+    column_ids.push_back(column_id);
+  }
+  if (column_ids.empty()) {
+    for (oid_t column_id = 0; column_id < schema->GetColumnCount();
+         column_id++) {
+      column_ids.push_back(column_id);
+    }
+  }
+
+  if (copy_parse->IsFrom()) {
+    copy_loader_.reset(new CopyLoader(table, column_ids, options));
+    SendCopyResponse('G', options, column_ids.size(), responses);
+    return true;
+  }
+
+  // COPY TO streams a scan of the table
+  SendCopyResponse('H', options, column_ids.size(), responses);
+  CopyOutSink sink(*this, responses, options);
+  sink.PutHeader();
+
+  planner::SeqScanPlan seq_scan_node(table, nullptr, column_ids);
+  std::vector<Value> params;
+  if (bridge::PlanExecutor::ExecutePlan(&seq_scan_node, params, sink) < 0) {
+    SendErrorResponse({{'M', "COPY TO failed"}}, responses);
+    return false;
+  }
+
+  sink.PutTrailer();
+  std::unique_ptr<Packet> pkt(new Packet());
+  pkt->msg_type = 'c';
+  responses.push_back(std::move(pkt));
+
+  CompleteCommand("COPY", sink.GetRowCount(), responses);
+  return true;
+}
+
+void PacketManager::ExecCopyMessage(Packet *pkt, ResponseBuffer &responses) {
+  // the rest of the data of a failed COPY is dropped
+  if (copy_loader_ == nullptr) {
+    LOG_TRACE("Skipping packet outside of COPY: %c", pkt->msg_type);
+    return;
+  }
+
+  switch (pkt->msg_type) {
+    case 'd': {
+      // CopyData
+      if (copy_loader_->Append(pkt->buf.data() + pkt->ptr,
+                               pkt->len - pkt->ptr)) {
+        return;
+      }
+      SendErrorResponse({{'M', copy_loader_->GetErrorMessage()}}, responses);
+    } break;
+
+    case 'c': {
+      // CopyDone
+      if (copy_loader_->Finish()) {
+        CompleteCommand("COPY", copy_loader_->GetRowCount(), responses);
+        copy_loader_.reset();
+        RunPendingQueries(responses);
+        return;
+      }
+      SendErrorResponse({{'M', copy_loader_->GetErrorMessage()}}, responses);
+    } break;
+
+    case 'f': {
+      // CopyFail
+      std::string fail_message;
+      PacketGetString(pkt, pkt->len, fail_message);
+      copy_loader_->Abort();
+      SendErrorResponse({{'M', "COPY from stdin failed: " + fail_message}},
+                        responses);
+    } break;
+  }
+
+  // the statements after the COPY are dropped with it
+  copy_loader_.reset();
+  pending_queries_.clear();
+  next_query_ = 0;
+  SendReadyForQuery(txn_state, responses);
 }
 
 /*
@@ -316,8 +624,7 @@ void PacketManager::ExecParseMessage(Packet *pkt, ResponseBuffer &responses) {
       tcop.PrepareStatement(statement_name, query_string, error_message));
 
   if (statement.get() == nullptr) {
-    SendErrorResponse({{'M', error_message}}, responses);
-    SendReadyForQuery(txn_state, responses);
+    SendExtendedErrorResponse(error_message, responses);
     return;
   }
 
@@ -343,8 +650,7 @@ void PacketManager::ExecParseMessage(Packet *pkt, ResponseBuffer &responses) {
     unnamed_statement = statement;
   } else {
     LOG_INFO("Setting named statement with name : %s", statement_name.c_str());
-    auto entry = std::make_pair(statement_name, statement);
-    statement_cache_.insert(entry);
+    statement_cache_[statement_name] = statement;
   }
 
   // Send Parse complete response
@@ -379,12 +685,13 @@ void PacketManager::ExecBindMessage(Packet *pkt, ResponseBuffer &responses) {
     formats[i] = PacketGetInt(pkt, 2);
   }
 
-  // error handling
+  // error handling: no format code means all text, a single one applies to
+  // every parameter
   int num_params = PacketGetInt(pkt, 2);
-  if (num_params_format != num_params) {
+  if (num_params_format > 1 && num_params_format != num_params) {
     std::string error_message =
         "Malformed request: num_params_format is not equal to num_params";
-    SendErrorResponse({{'M', error_message}}, responses);
+    SendExtendedErrorResponse(error_message, responses);
     return;
   }
 
@@ -399,20 +706,20 @@ void PacketManager::ExecBindMessage(Packet *pkt, ResponseBuffer &responses) {
     if (statement.get() == nullptr) {
       std::string error_message = "Invalid unnamed statement";
       LOG_ERROR("%s", error_message.c_str());
-      SendErrorResponse({{'M', error_message}}, responses);
+      SendExtendedErrorResponse(error_message, responses);
       return;
     }
   } else {
     auto statement_cache_itr = statement_cache_.find(statement_name);
-    // Did not find statement with same name
+    // Found statement with same name
     if (statement_cache_itr != statement_cache_.end()) {
-      statement = *statement_cache_itr;
+      statement = statement_cache_itr->second;
     }
-    // Found statement with same name
+    // Did not find statement with same name
     else {
-      std::string error_message = "Prepared statement name already exists";
+      std::string error_message = "Prepared statement does not exist";
       LOG_ERROR("%s", error_message.c_str());
-      SendErrorResponse({{'M', error_message}}, responses);
+      SendExtendedErrorResponse(error_message, responses);
       return;
     }
   }
@@ -433,58 +740,60 @@ void PacketManager::ExecBindMessage(Packet *pkt, ResponseBuffer &responses) {
     return;
   }
 
-  // Group the parameter types and thae parameters in this vector
-  std::vector<std::pair<int, std::string>> bind_parameters;
+  // Decode the parameters, strings are kept in a pool owned by the portal
+  std::vector<Value> parameters;
+  std::unique_ptr<VarlenPool> parameter_pool(new VarlenPool(BACKEND_TYPE_MM));
   auto param_types = statement->GetParamTypes();
 
-  PktBuf param;
   for (int param_idx = 0; param_idx < num_params; param_idx++) {
+    int16_t format = 0;
+    if (num_params_format == 1)
+      format = formats[0];
+    else if (num_params_format > 1)
+      format = formats[param_idx];
+
+    // parameters the client did not declare a type for are unknown (0)
+    int32_t param_type = 0;
+    if (param_idx < static_cast<int>(param_types.size()))
+      param_type = param_types[param_idx];
+
     int param_len = PacketGetInt(pkt, 4);
     // BIND packet NULL parameter case
     if (param_len == -1) {
-      // NULL mode
-      bind_parameters.push_back(
-          std::make_pair(ValueType::VALUE_TYPE_INTEGER, std::string("")));
-    } else {
-      PacketGetBytes(pkt, param_len, param);
-
-      if (formats[param_idx] == 0) {
-        // TEXT mode
-        std::string param_str = std::string(std::begin(param), std::end(param));
-        bind_parameters.push_back(
-            std::make_pair(ValueType::VALUE_TYPE_VARCHAR, param_str));
-      } else {
-        // BINARY mode
-        switch (param_types[param_idx]) {
-          case POSTGRES_VALUE_TYPE_INTEGER: {
-            int int_val = 0;
-            for (size_t i = 0; i < sizeof(int); ++i) {
-              int_val = (int_val << 8) | param[i];
-            }
-            bind_parameters.push_back(std::make_pair(
-                ValueType::VALUE_TYPE_INTEGER, std::to_string(int_val)));
-          } break;
-          case POSTGRES_VALUE_TYPE_DOUBLE: {
-            double float_val = 0;
-            unsigned long buf = 0;
-            for (size_t i = 0; i < sizeof(double); ++i) {
-              buf = (buf << 8) | param[i];
-            }
-            memcpy(&float_val, &buf, sizeof(double));
-            bind_parameters.push_back(std::make_pair(
-                ValueType::VALUE_TYPE_DOUBLE, std::to_string(float_val)));
-            // LOG_INFO("Bind param (size: %d) : %lf", param_len, float_val);
-          } break;
-          default: {
-            LOG_ERROR("Do not support data type: %d", param_types[param_idx]);
-          } break;
-        }
-      }
+      parameters.push_back(ValueFactory::GetNullValueByType(
+          PostgresValueTypeToPelotonValueType(
+              static_cast<PostgresValueType>(param_type))));
+      continue;
+    }
+
+    Value param;
+    if (param_len < 0 ||
+        PacketGetValue(pkt, param_len, format, param_type,
+                       parameter_pool.get(), param) == false) {
+      std::string error_message =
+          "Malformed request: invalid value for parameter " +
+          std::to_string(param_idx + 1);
+      SendExtendedErrorResponse(error_message, responses);
+      return;
+    }
+    parameters.push_back(param);
+  }
+
+  // Read the result column formats, same rules as for the parameters
+  std::vector<int16_t> result_formats;
+  if (pkt->ptr + 2 <= pkt->len) {
+    int num_result_formats = PacketGetInt(pkt, 2);
+    for (int format_itr = 0;
+         format_itr < num_result_formats && pkt->ptr + 2 <= pkt->len;
+         format_itr++) {
+      result_formats.push_back(PacketGetInt(pkt, 2));
     }
   }
 
   // Construct a portal
-  auto portal = new Portal(portal_name, statement, bind_parameters);
+  auto portal = new Portal(portal_name, statement, std::move(parameters),
+                           std::move(parameter_pool),
+                           std::move(result_formats));
   std::shared_ptr<Portal> portal_reference(portal);
 
   auto itr = portals_.find(portal_name);
@@ -533,18 +842,21 @@ void PacketManager::ExecDescribeMessage(Packet *pkt,
     }
 
     auto statement = portal->GetStatement();
-    PutTupleDescriptor(statement->GetTupleDescriptor(), responses);
+    PutTupleDescriptor(statement->GetTupleDescriptor(), responses,
+                       portal->GetResultFormats());
   }
 }
 
 void PacketManager::ExecExecuteMessage(Packet *pkt, ResponseBuffer &responses) {
   // EXECUTE message
   LOG_INFO("EXECUTE message");
-  std::vector<ResultType> results;
   std::string error_message, portal_name;
   int rows_affected = 0;
   GetStringToken(pkt, portal_name);
 
+  // Rows to return before the portal is suspended, zero means all
+  int max_rows = PacketGetInt(pkt, 4);
+
   // covers weird JDBC edge case of sending double BEGIN statements. Don't
   // execute them
   if (skipped_stmt_) {
@@ -557,8 +869,7 @@ void PacketManager::ExecExecuteMessage(Packet *pkt, ResponseBuffer &responses) {
   auto portal = portals_[portal_name];
   if (portal.get() == nullptr) {
     LOG_INFO("Did not find portal : %s", portal_name.c_str());
-    SendErrorResponse({{'M', error_message}}, responses);
-    SendReadyForQuery(txn_state, responses);
+    SendExtendedErrorResponse("Portal does not exist", responses);
     return;
   }
 
@@ -566,17 +877,13 @@ void PacketManager::ExecExecuteMessage(Packet *pkt, ResponseBuffer &responses) {
 
   if (statement.get() == nullptr) {
     LOG_INFO("Did not find statement in portal : %s", portal_name.c_str());
-    SendErrorResponse({{'M', error_message}}, responses);
-    SendReadyForQuery(txn_state, responses);
+    SendExtendedErrorResponse("Portal has no statement", responses);
     return;
   }
 
   const auto &query_string = statement->GetQueryString();
   const auto &query_type = statement->GetQueryType();
 
-  auto statement_name = statement->GetStatementName();
-  bool unnamed = statement_name.empty();
-
   LOG_INFO("Executing query: %s", query_string.c_str());
 
   // acquire the mutex if we are starting a txn
@@ -585,13 +892,16 @@ void PacketManager::ExecExecuteMessage(Packet *pkt, ResponseBuffer &responses) {
   }
 
   auto &tcop = tcop::TrafficCop::GetInstance();
-  auto status = tcop.ExecuteStatement(statement, unnamed, results,
-                                      rows_affected, error_message);
+  DataRowSink sink(*this, responses, statement, portal->GetResultFormats(),
+                   false, std::max(max_rows, 0));
+  bool suspended = false;
+  auto status = tcop.ExecuteStatement(portal, sink, suspended, rows_affected,
+                                      error_message);
 
   if (status == Result::RESULT_FAILURE) {
     LOG_INFO("Failed to execute: %s", error_message.c_str());
-    SendErrorResponse({{'M', error_message}}, responses);
-    SendReadyForQuery(txn_state, responses);
+    SendExtendedErrorResponse(error_message, responses);
+    return;
   }
 
   // release the mutex after a txn commit
@@ -599,9 +909,17 @@ void PacketManager::ExecExecuteMessage(Packet *pkt, ResponseBuffer &responses) {
     LOG_WARN("COMMIT - release lock");
   }
 
-  // put_row_desc(portal->rowdesc, responses);
-  auto tuple_descriptor = statement->GetTupleDescriptor();
-  SendDataRows(results, tuple_descriptor.size(), rows_affected, responses);
+  // the portal has more rows, the client asks for them with another Execute
+  if (suspended) {
+    std::unique_ptr<Packet> response(new Packet());
+    response->msg_type = 's';
+    responses.push_back(std::move(response));
+    return;
+  }
+
+  if (sink.GetRowCount() > 0) {
+    rows_affected = sink.GetRowCount();
+  }
   CompleteCommand(query_type, rows_affected, responses);
 }
 
@@ -610,6 +928,17 @@ void PacketManager::ExecExecuteMessage(Packet *pkt, ResponseBuffer &responses) {
  *  Returns false if the session needs to be closed.
  */
 bool PacketManager::ProcessPacket(Packet *pkt, ResponseBuffer &responses) {
+  // After an error the rest of the pipeline is ignored up to the next Sync
+  if (skip_to_sync_ && pkt->msg_type != 'S' && pkt->msg_type != 'X') {
+    LOG_TRACE("Skipping packet until Sync: %c", pkt->msg_type);
+    return true;
+  }
+
+  // Extended query messages keep the batch open until Sync or Flush, the
+  // responses stay buffered meanwhile
+  batch_open_ = (pkt->msg_type == 'P' || pkt->msg_type == 'B' ||
+                 pkt->msg_type == 'D' || pkt->msg_type == 'E');
+
   switch (pkt->msg_type) {
     case 'Q': {
       ExecQueryMessage(pkt, responses);
@@ -626,10 +955,19 @@ bool PacketManager::ProcessPacket(Packet *pkt, ResponseBuffer &responses) {
     case 'E': {
       ExecExecuteMessage(pkt, responses);
     } break;
+    case 'd':
+    case 'c':
+    case 'f': {
+      ExecCopyMessage(pkt, responses);
+    } break;
     case 'S': {
       // SYNC message
+      skip_to_sync_ = false;
       SendReadyForQuery(txn_state, responses);
     } break;
+    case 'H': {
+      // FLUSH message, closing the batch sends what is buffered
+    } break;
     case 'X': {
       LOG_INFO("Closing client");
       return false;
@@ -664,6 +1002,12 @@ void PacketManager::SendErrorResponse(
   responses.push_back(std::move(pkt));
 }
 
+void PacketManager::SendExtendedErrorResponse(
+    const std::string &error_message, ResponseBuffer &responses) {
+  SendErrorResponse({{'M', error_message}}, responses);
+  skip_to_sync_ = true;
+}
+
 void PacketManager::SendReadyForQuery(uchar txn_status,
                                       ResponseBuffer &responses) {
   std::unique_ptr<Packet> pkt(new Packet());
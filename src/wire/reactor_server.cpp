@@ -0,0 +1,555 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// reactor_server.cpp
+//
+// Identification: src/wire/reactor_server.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <algorithm>
+#include <chrono>
+
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
+
+#include "wire/reactor_server.h"
+
+#include "tcop/admission_control.h"
+
+// number of events fetched by one epoll_wait
+#define REACTOR_EVENT_BATCH 256
+
+// number of write buffer segments sent by one writev
+#define WRITE_IOV_COUNT 64
+
+// unsent bytes at which a streaming query waits for the client to catch up
+#define WRITE_HIGH_WATERMARK (1 << 20)
+
+// unsent bytes that are worth a write before the client asks for them
+#define WRITE_LOW_WATERMARK (1 << 16)
+
+DECLARE_string(socket_family);
+
+namespace peloton {
+namespace wire {
+
+//===--------------------------------------------------------------------===//
+// Connection
+//===--------------------------------------------------------------------===//
+
+Connection::Connection(int sock_fd, Reactor *reactor)
+    : sock_fd_(sock_fd),
+      reactor_(reactor),
+      sock_(sock_fd),
+      packet_manager_(&sock_) {
+  packet_manager_.SetResponseFlusher([this](ResponseBuffer &responses) {
+    return StreamPackets(responses);
+  });
+}
+
+bool Connection::FillReadBuffer() {
+  // drop what the protocol already consumed
+  if (rbuf_ptr_ > 0) {
+    rbuf_.erase(rbuf_.begin(), rbuf_.begin() + rbuf_ptr_);
+    rbuf_ptr_ = 0;
+  }
+
+  for (;;) {
+    size_t old_size = rbuf_.size();
+    rbuf_.resize(old_size + SOCKET_BUFFER_SIZE);
+
+    ssize_t bytes_read = read(sock_fd_, &rbuf_[old_size], SOCKET_BUFFER_SIZE);
+    if (bytes_read < 0) {
+      rbuf_.resize(old_size);
+      if (errno == EINTR) {
+        // interrupts are OK
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // drained the socket
+        return true;
+      }
+
+      LOG_ERROR("Socket error: could not receive data from client");
+      return false;
+    }
+
+    rbuf_.resize(old_size + bytes_read);
+
+    if (bytes_read == 0) {
+      // EOF
+      return false;
+    }
+
+    // a short read means the socket is drained
+    if (static_cast<size_t>(bytes_read) < SOCKET_BUFFER_SIZE) {
+      return true;
+    }
+  }
+}
+
+bool Connection::HasPacket() const {
+  size_t header_size = sizeof(int32_t) + (startup_done_ ? 1 : 0);
+  size_t window = rbuf_.size() - rbuf_ptr_;
+  if (window < header_size) return false;
+
+  uint32_t pkt_size;
+  std::copy(rbuf_.begin() + rbuf_ptr_ + header_size - sizeof(int32_t),
+            rbuf_.begin() + rbuf_ptr_ + header_size,
+            reinterpret_cast<uchar *>(&pkt_size));
+
+  // a malformed size is reported as a packet, ReadPacket rejects it
+  pkt_size = ntohl(pkt_size);
+  if (pkt_size < sizeof(int32_t)) return true;
+
+  return window >= header_size - sizeof(int32_t) + pkt_size;
+}
+
+bool Connection::ReadPacket(Packet *pkt) {
+  if (HasPacket() == false) return false;
+
+  size_t header_size = sizeof(int32_t) + (startup_done_ ? 1 : 0);
+  auto pkt_begin = rbuf_.begin() + rbuf_ptr_;
+
+  if (startup_done_) {
+    pkt->msg_type = *pkt_begin;
+  }
+
+  uint32_t pkt_size;
+  std::copy(pkt_begin + header_size - sizeof(int32_t), pkt_begin + header_size,
+            reinterpret_cast<uchar *>(&pkt_size));
+  pkt_size = ntohl(pkt_size);
+
+  if (pkt_size < sizeof(int32_t)) {
+    LOG_ERROR("Protocol error: invalid packet size %u", pkt_size);
+    closing_ = true;
+    return false;
+  }
+
+  // packet size includes the size field as well
+  pkt_size -= sizeof(int32_t);
+  pkt->buf.insert(std::end(pkt->buf), pkt_begin + header_size,
+                  pkt_begin + header_size + pkt_size);
+  pkt->len = pkt_size;
+
+  rbuf_ptr_ += header_size + pkt_size;
+  return true;
+}
+
+void Connection::BufferPackets(ResponseBuffer &responses) {
+  for (auto &pkt : responses) {
+    if (pkt->framed) {
+      // hand the whole batch over to the socket without copying it
+      pkt->buf.resize(pkt->len);
+      wbufs_.push_back(std::move(pkt->buf));
+      continue;
+    }
+
+    if (wbufs_.empty()) {
+      wbufs_.emplace_back();
+    }
+    auto &wbuf = wbufs_.back();
+
+    if (pkt->msg_type != 0) {
+      wbuf.push_back(pkt->msg_type);
+    }
+
+    // make len include its field size as well
+    uint32_t len_nb = htonl(pkt->len + sizeof(int32_t));
+    wbuf.insert(std::end(wbuf), reinterpret_cast<uchar *>(&len_nb),
+                reinterpret_cast<uchar *>(&len_nb) + sizeof(int32_t));
+    wbuf.insert(std::end(wbuf), std::begin(pkt->buf),
+                std::begin(pkt->buf) + pkt->len);
+  }
+  responses.clear();
+}
+
+size_t Connection::GetPendingWriteBytes() const {
+  size_t pending_bytes = 0;
+  for (auto &wbuf : wbufs_) {
+    pending_bytes += wbuf.size();
+  }
+  return pending_bytes - wbuf_ptr_;
+}
+
+bool Connection::WaitForClient() {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(FLAGS_client_write_timeout_ms);
+  while (GetPendingWriteBytes() > WRITE_HIGH_WATERMARK) {
+    auto wait_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (wait_time.count() <= 0) {
+      // the unsent rest is dropped, so the reactor closes the socket
+      LOG_ERROR("Client stopped reading, canceling the query");
+      wbufs_.clear();
+      wbuf_ptr_ = 0;
+      return false;
+    }
+
+    struct pollfd poll_fd;
+    poll_fd.fd = sock_fd_;
+    poll_fd.events = POLLOUT;
+    poll_fd.revents = 0;
+
+    int ready = poll(&poll_fd, 1, static_cast<int>(wait_time.count()));
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (ready == 0) continue;
+
+    if ((poll_fd.revents & (POLLERR | POLLHUP | POLLNVAL)) ||
+        FlushWriteBuffer() == false) {
+      LOG_INFO("Client went away while receiving a result");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Connection::StreamPackets(ResponseBuffer &responses) {
+  BufferPackets(responses);
+
+  // Small results wait for the end of the batch and go out in one write
+  if (GetPendingWriteBytes() < WRITE_LOW_WATERMARK) {
+    return true;
+  }
+
+  if (FlushWriteBuffer() == false) {
+    closing_ = true;
+    return false;
+  }
+
+  if (GetPendingWriteBytes() <= WRITE_HIGH_WATERMARK) {
+    return true;
+  }
+
+  // Backpressure: the query waits while the client is not reading, so the
+  // result does not pile up in the write buffer. Its admission slot goes to
+  // other queries meanwhile, the worker and the transaction stay with it.
+  auto admission = tcop::AdmissionGuard::GetCurrent();
+  if (admission != nullptr) {
+    admission->Suspend();
+  }
+
+  if (WaitForClient() == false) {
+    closing_ = true;
+    return false;
+  }
+
+  if (admission != nullptr && admission->Resume() == false) {
+    LOG_ERROR("No admission slot after the client caught up, canceling the "
+              "query");
+    return false;
+  }
+  return true;
+}
+
+bool Connection::ProcessPackets() {
+  ResponseBuffer responses;
+  Packet pkt;
+
+  while (closing_ == false && ReadPacket(&pkt)) {
+    bool status;
+    if (startup_done_ == false) {
+      status = packet_manager_.ProcessStartupPacket(&pkt, responses);
+      startup_done_ = true;
+    } else {
+      status = packet_manager_.ProcessPacket(&pkt, responses);
+    }
+
+    BufferPackets(responses);
+    if (status == false) {
+      closing_ = true;
+    }
+    pkt.Reset();
+  }
+
+  return closing_ == false;
+}
+
+bool Connection::HoldsWrites() const {
+  return closing_ == false && packet_manager_.IsBatchOpen() &&
+         GetPendingWriteBytes() < WRITE_LOW_WATERMARK;
+}
+
+bool Connection::FlushWriteBuffer() {
+  while (wbufs_.empty() == false) {
+    struct iovec iov[WRITE_IOV_COUNT];
+    int iov_count = 0;
+    for (auto &wbuf : wbufs_) {
+      if (iov_count == WRITE_IOV_COUNT) break;
+      size_t skip = (iov_count == 0) ? wbuf_ptr_ : 0;
+      iov[iov_count].iov_base = wbuf.data() + skip;
+      iov[iov_count].iov_len = wbuf.size() - skip;
+      iov_count++;
+    }
+
+    // MSG_NOSIGNAL: a client that went away must not kill the server
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
+
+    ssize_t written_bytes = sendmsg(sock_fd_, &msg, MSG_NOSIGNAL);
+    if (written_bytes < 0) {
+      if (errno == EINTR) {
+        // interrupts are ok, try again
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // socket is full, the reactor waits for it to drain
+        return true;
+      }
+
+      // fatal errors
+      return false;
+    }
+
+    // drop the segments that went out completely
+    size_t written = written_bytes;
+    while (wbufs_.empty() == false &&
+           written >= wbufs_.front().size() - wbuf_ptr_) {
+      written -= wbufs_.front().size() - wbuf_ptr_;
+      wbufs_.pop_front();
+      wbuf_ptr_ = 0;
+    }
+    wbuf_ptr_ += written;
+  }
+
+  return true;
+}
+
+//===--------------------------------------------------------------------===//
+// Reactor
+//===--------------------------------------------------------------------===//
+
+Reactor::Reactor(ReactorServer *server) : server_(server) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0) {
+    LOG_ERROR("Server error: could not create epoll instance");
+    exit(EXIT_FAILURE);
+  }
+}
+
+Reactor::~Reactor() { close(epoll_fd_); }
+
+void Reactor::Start() {
+  thread_ = std::thread(&Reactor::EventLoop, this);
+  thread_.detach();
+}
+
+bool Reactor::AddConnection(Connection *connection) {
+  struct epoll_event event;
+  event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  event.data.ptr = connection;
+
+  // epoll_ctl is thread safe, so the acceptor registers the socket directly
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, connection->GetSocketFd(), &event) <
+      0) {
+    LOG_ERROR("Server error: could not watch client socket");
+    return false;
+  }
+
+  return true;
+}
+
+void Reactor::ArmConnection(Connection *connection) {
+  struct epoll_event event;
+  event.events = EPOLLRDHUP | EPOLLONESHOT;
+  event.events |= connection->IsDraining() ? EPOLLOUT : EPOLLIN;
+  event.data.ptr = connection;
+
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection->GetSocketFd(), &event) <
+      0) {
+    LOG_ERROR("Server error: could not re-arm client socket");
+    CloseConnection(connection);
+  }
+}
+
+void Reactor::ResumeConnection(Connection *connection) {
+  // In the middle of a pipeline the responses wait for its Sync
+  if (connection->HoldsWrites() == false &&
+      connection->FlushWriteBuffer() == false) {
+    CloseConnection(connection);
+    return;
+  }
+
+  // the last responses of a closing session still have to go out
+  if (connection->IsClosing() && connection->HasPendingWrites() == false) {
+    CloseConnection(connection);
+    return;
+  }
+
+  ArmConnection(connection);
+}
+
+void Reactor::CloseConnection(Connection *connection) {
+  LOG_TRACE("Closing client fd: %d", connection->GetSocketFd());
+
+  // closing the socket also drops it from the epoll set
+  connection->CloseSocket();
+  delete connection;
+
+  server_->ConnectionClosed();
+}
+
+void Reactor::HandleEvent(Connection *connection, uint32_t events) {
+  // waiting for the socket to drain
+  if (connection->IsDraining()) {
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      CloseConnection(connection);
+      return;
+    }
+
+    ResumeConnection(connection);
+    return;
+  }
+
+  // EOF and errors are reported by the read itself
+  if (connection->FillReadBuffer() == false) {
+    CloseConnection(connection);
+    return;
+  }
+
+  if (connection->HasPacket()) {
+    server_->ProcessConnection(connection);
+  } else {
+    ArmConnection(connection);
+  }
+}
+
+void Reactor::EventLoop() {
+  struct epoll_event events[REACTOR_EVENT_BATCH];
+
+  for (;;) {
+    int event_count = epoll_wait(epoll_fd_, events, REACTOR_EVENT_BATCH, -1);
+    if (event_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      LOG_ERROR("Server error: epoll_wait failed");
+      exit(EXIT_FAILURE);
+    }
+
+    for (int event_itr = 0; event_itr < event_count; event_itr++) {
+      HandleEvent(static_cast<Connection *>(events[event_itr].data.ptr),
+                  events[event_itr].events);
+    }
+  }
+}
+
+//===--------------------------------------------------------------------===//
+// Reactor Server
+//===--------------------------------------------------------------------===//
+
+static size_t GetReactorCount() {
+  if (FLAGS_reactor_threads != 0) return FLAGS_reactor_threads;
+
+  // reactors only do socket I/O, a few of them go a long way
+  return std::max(std::thread::hardware_concurrency() / 4, 1u);
+}
+
+static size_t GetWorkerCount() {
+  if (FLAGS_worker_threads != 0) return FLAGS_worker_threads;
+
+  return std::max(std::thread::hardware_concurrency(), 2u);
+}
+
+// Every connection is a descriptor, so allow as many as the hard limit does
+static void RaiseDescriptorLimit() {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+      LOG_ERROR("Server error: could not raise the descriptor limit");
+    }
+  }
+}
+
+ReactorServer::ReactorServer(Server *server)
+    : server_(server), workers_(GetWorkerCount()), connection_count_(0) {
+  size_t reactor_count = GetReactorCount();
+  for (size_t reactor_itr = 0; reactor_itr < reactor_count; reactor_itr++) {
+    reactors_.emplace_back(new Reactor(this));
+  }
+
+  LOG_INFO("Wire server with %lu reactors and %lu workers", reactors_.size(),
+           workers_.GetNumThreads());
+}
+
+void ReactorServer::ProcessConnection(Connection *connection) {
+  workers_.Enqueue([connection] {
+    if (connection->ProcessPackets() == false) {
+      LOG_TRACE("Client fd %d is done", connection->GetSocketFd());
+    }
+    connection->GetReactor()->ResumeConnection(connection);
+  });
+}
+
+void ReactorServer::HandleConnections() {
+  RaiseDescriptorLimit();
+
+  for (auto &reactor : reactors_) {
+    reactor->Start();
+  }
+
+  size_t next_reactor = 0;
+  for (;;) {
+    // block and wait for incoming connection
+    int connfd = accept4(server_->server_fd, NULL, NULL,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (connfd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (errno == EMFILE || errno == ENFILE) {
+        // out of descriptors, back off until some clients leave
+        LOG_ERROR("Server error: out of descriptors for new connections");
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        continue;
+      }
+
+      LOG_ERROR("Server error: Connection not established");
+      exit(EXIT_FAILURE);
+    }
+
+    if (connection_count_ >= static_cast<size_t>(server_->max_connections)) {
+      LOG_ERROR("Server error: too many connections");
+      close(connfd);
+      continue;
+    }
+
+    // queries are sent as small packets that should go out right away
+    if (FLAGS_socket_family == "AF_INET") {
+      int yes = 1;
+      setsockopt(connfd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+
+    auto &reactor = reactors_[next_reactor];
+    next_reactor = (next_reactor + 1) % reactors_.size();
+
+    Connection *connection = new Connection(connfd, reactor.get());
+    connection_count_++;
+
+    LOG_TRACE("Client fd %d handed to reactor", connfd);
+    if (reactor->AddConnection(connection) == false) {
+      reactor->CloseConnection(connection);
+    }
+  }
+}
+
+}  // End wire namespace
+}  // End peloton namespace
@@ -189,6 +189,51 @@ bool SocketManager<B>::FlushWriteBuffer() {
   return true;
 }
 
+template <typename B>
+bool SocketManager<B>::WriteFramedBytes(B &pkt_buf, size_t len) {
+  struct iovec iov[2];
+  iov[0].iov_base = wbuf.buf.data();
+  iov[0].iov_len = wbuf.buf_size;
+  iov[1].iov_base = pkt_buf.data();
+  iov[1].iov_len = len;
+
+  int iov_idx = 0;
+  while (iov_idx < 2) {
+    // skip whatever is done
+    if (iov[iov_idx].iov_len == 0) {
+      iov_idx++;
+      continue;
+    }
+
+    ssize_t written_bytes = writev(sock_fd, &iov[iov_idx], 2 - iov_idx);
+    if (written_bytes < 0) {
+      if (errno == EINTR) {
+        // interrupts are ok, try again
+        continue;
+      }
+      // fatal errors
+      return false;
+    }
+
+    // update bookkeeping over the partially written vectors
+    size_t written = written_bytes;
+    while (iov_idx < 2 && written >= iov[iov_idx].iov_len) {
+      written -= iov[iov_idx].iov_len;
+      iov[iov_idx].iov_len = 0;
+      iov_idx++;
+    }
+    if (iov_idx < 2) {
+      iov[iov_idx].iov_base =
+          reinterpret_cast<uchar *>(iov[iov_idx].iov_base) + written;
+      iov[iov_idx].iov_len -= written;
+    }
+  }
+
+  // buffer is empty
+  wbuf.Reset();
+  return true;
+}
+
 /*
  * read - Tries to read "bytes" bytes into packet's buffer. Returns true on
  * success.
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// layout_tuner_test.cpp
+//
+// Identification: test/brain/layout_tuner_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "common/harness.h"
+
+#include "brain/layout_tuner.h"
+#include "brain/sample.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "executor/executor_tests_util.h"
+#include "storage/data_table.h"
+#include "storage/tile_group.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Layout Tuner Tests
+//===--------------------------------------------------------------------===//
+
+class LayoutTunerTests : public PelotonTest {};
+
+TEST_F(LayoutTunerTests, BasicTest) {
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+
+  // Two full tile groups, in the row layout
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(tuple_count, false));
+  ExecutorTestsUtil::PopulateTable(data_table.get(), tuple_count * 2, false,
+                                   false, true);
+  txn_manager.CommitTransaction();
+
+  auto value = data_table->GetTileGroup(0)->GetValue(1, 2);
+  EXPECT_EQ(1U, data_table->GetTileGroup(0)->GetTileCount());
+
+  // The workload only reads the first two columns
+  std::vector<double> columns_accessed = {1, 1, 0, 0};
+  for (int sample_itr = 0; sample_itr < 100; sample_itr++) {
+    data_table->RecordSample(brain::Sample(columns_accessed));
+  }
+
+  auto &layout_tuner = brain::LayoutTuner::GetInstance();
+  EXPECT_EQ(2U, layout_tuner.TuneTable(data_table.get()));
+  EXPECT_EQ(0U, data_table->GetSampleCount());
+
+  // The columns read together share a tile
+  auto &partition = data_table->GetDefaultPartition();
+  EXPECT_EQ(partition.at(0).first, partition.at(1).first);
+  EXPECT_NE(partition.at(0).first, partition.at(2).first);
+
+  auto tile_group = data_table->GetTileGroup(0);
+  EXPECT_LT(1U, tile_group->GetTileCount());
+  EXPECT_EQ(0, value.Compare(tile_group->GetValue(1, 2)));
+
+  auto stats = layout_tuner.GetStats()[data_table->GetOid()];
+  EXPECT_EQ(1U, stats.partition_update_count);
+  EXPECT_EQ(2U, stats.transformed_tile_group_count);
+
+  // Nothing left to move
+  EXPECT_EQ(0U, layout_tuner.TuneTable(data_table.get()));
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// pool_test.cpp
+//
+// Identification: test/common/pool_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/harness.h"
+
+#include "common/pool.h"
+#include "common/varlen.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Varlen Pool Tests
+//===--------------------------------------------------------------------===//
+
+class VarlenPoolTests : public PelotonTest {};
+
+TEST_F(VarlenPoolTests, FreeTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+
+  auto first_block = pool.Allocate(100);
+  auto second_block = pool.Allocate(100);
+  EXPECT_NE(first_block, second_block);
+  EXPECT_TRUE(pool.IsOwner(first_block));
+
+  // A freed block goes to the next allocation of its size class
+  pool.Free(first_block);
+  EXPECT_FALSE(pool.IsOwner(first_block));
+  EXPECT_LT(100, pool.GetFreeMemory());
+  EXPECT_EQ(first_block, pool.Allocate(110));
+  EXPECT_EQ(0, pool.GetFreeMemory());
+
+  // Blocks of other pools are left alone
+  VarlenPool other_pool(BACKEND_TYPE_MM, 4096, 1);
+  auto other_block = other_pool.Allocate(100);
+  pool.Free(other_block);
+  EXPECT_EQ(0, pool.GetFreeMemory());
+  EXPECT_TRUE(other_pool.IsOwner(other_block));
+
+  // Oversize blocks are given back right away
+  auto memory = pool.GetAllocatedMemory();
+  auto large_block = pool.Allocate(10000);
+  EXPECT_LT(memory, pool.GetAllocatedMemory());
+  pool.Free(large_block);
+  EXPECT_EQ(memory, pool.GetAllocatedMemory());
+}
+
+TEST_F(VarlenPoolTests, VarlenTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+
+  // A destroyed string leaves room for the next one
+  auto varlen = Varlen::Create(200, &pool);
+  Varlen::Destroy(varlen, &pool);
+  auto free_memory = pool.GetFreeMemory();
+  EXPECT_LT(200, free_memory);
+
+  varlen = Varlen::Create(200, &pool);
+  EXPECT_EQ(0, pool.GetFreeMemory());
+  auto memory = pool.GetAllocatedMemory();
+  for (int varlen_itr = 0; varlen_itr < 1000; varlen_itr++) {
+    Varlen::Destroy(varlen, &pool);
+    varlen = Varlen::Create(200, &pool);
+  }
+  EXPECT_EQ(memory, pool.GetAllocatedMemory());
+  Varlen::Destroy(varlen, &pool);
+}
+
+void AllocateHelper(VarlenPool *pool, UNUSED_ATTRIBUTE uint64_t thread_itr) {
+  std::vector<void *> blocks;
+  for (int round_itr = 0; round_itr < 10; round_itr++) {
+    for (int block_itr = 0; block_itr < 100; block_itr++) {
+      auto block = pool->Allocate(8 + block_itr);
+      PL_MEMSET(block, block_itr, 8 + block_itr);
+      blocks.push_back(block);
+    }
+    for (auto block : blocks) {
+      pool->Free(block);
+    }
+    blocks.clear();
+  }
+}
+
+TEST_F(VarlenPoolTests, ConcurrencyTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+
+  LaunchParallelTest(4, AllocateHelper, &pool);
+
+  // Every round reuses what the previous one freed
+  EXPECT_LT(0, pool.GetFreeMemory());
+  EXPECT_GE(pool.GetAllocatedMemory(), pool.GetFreeMemory());
+  EXPECT_GT(4 * 100 * 4096, pool.GetAllocatedMemory());
+}
+
+TEST_F(VarlenPoolTests, ForeignFreeTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+  const int thread_count = 4;
+  const int round_count = 50;
+  const int block_count = 100;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<void *> blocks;
+  int allocated_count = 0;
+  int freed_round = 0;
+
+  // Workers allocate, and one other thread frees what they allocated, like
+  // the garbage collector does with the strings of old versions
+  std::vector<std::thread> workers;
+  for (int thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    workers.emplace_back([&]() {
+      for (int round_itr = 0; round_itr < round_count; round_itr++) {
+        std::vector<void *> round_blocks;
+        for (int block_itr = 0; block_itr < block_count; block_itr++) {
+          round_blocks.push_back(pool.Allocate(100));
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        blocks.insert(blocks.end(), round_blocks.begin(), round_blocks.end());
+        allocated_count++;
+        cv.notify_all();
+        cv.wait(lock, [&] { return freed_round > round_itr; });
+      }
+    });
+  }
+
+  std::thread collector([&]() {
+    for (int round_itr = 0; round_itr < round_count; round_itr++) {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return allocated_count == thread_count; });
+      for (auto block : blocks) {
+        pool.Free(block);
+      }
+      blocks.clear();
+      allocated_count = 0;
+      freed_round++;
+      cv.notify_all();
+    }
+  });
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  collector.join();
+
+  // The workers reuse the blocks of the first round
+  EXPECT_GT(2 * thread_count * block_count * 128, pool.GetAllocatedMemory());
+}
+
+}  // End test namespace
+}  // End peloton namespace
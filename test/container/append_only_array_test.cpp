@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// append_only_array_test.cpp
+//
+// Identification: test/container/append_only_array_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <vector>
+
+#include "container/append_only_array.h"
+
+#include "common/harness.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Append Only Array Test
+//===--------------------------------------------------------------------===//
+
+class AppendOnlyArrayTest : public PelotonTest {};
+
+// Test basic functionality
+TEST_F(AppendOnlyArrayTest, BasicTest) {
+  AppendOnlyArray<oid_t> array;
+  EXPECT_EQ(0U, array.GetSize());
+
+  // Spans a few chunks
+  oid_t const element_count = APPEND_ONLY_ARRAY_CHUNK_SIZE * 3 + 1;
+  for (oid_t element = 0; element < element_count; element++) {
+    EXPECT_EQ(element, array.Append(element * 2));
+  }
+
+  EXPECT_EQ(element_count, array.GetSize());
+  for (oid_t element = 0; element < element_count; element++) {
+    EXPECT_EQ(element * 2, array.Get(element));
+  }
+  EXPECT_TRUE(array.Contains(4));
+  EXPECT_FALSE(array.Contains(3));
+
+  array.Clear();
+  EXPECT_EQ(0U, array.GetSize());
+  EXPECT_FALSE(array.Contains(4));
+  EXPECT_EQ(0U, array.Append(7));
+  EXPECT_EQ(7U, array.Get(0));
+}
+
+#define APPEND_COUNT 10000
+
+void AppendTest(AppendOnlyArray<oid_t> *array, uint64_t thread_itr) {
+  for (oid_t element = 0; element < APPEND_COUNT; element++) {
+    auto offset = array->Append(thread_itr * APPEND_COUNT + element);
+
+    // Our item is visible once the append returns
+    EXPECT_LT(offset, array->GetSize());
+    EXPECT_EQ(thread_itr * APPEND_COUNT + element, array->Get(offset));
+  }
+}
+
+// Test concurrent appends
+TEST_F(AppendOnlyArrayTest, ConcurrentTest) {
+  AppendOnlyArray<oid_t> array;
+  size_t const thread_count = 4;
+
+  LaunchParallelTest(thread_count, AppendTest, &array);
+
+  EXPECT_EQ(thread_count * APPEND_COUNT, array.GetSize());
+  std::vector<bool> seen(thread_count * APPEND_COUNT, false);
+  for (size_t offset = 0; offset < array.GetSize(); offset++) {
+    auto element = array.Get(offset);
+    ASSERT_LT(element, seen.size());
+    EXPECT_FALSE(seen[element]);
+    seen[element] = true;
+  }
+}
+
+}  // End test namespace
+}  // End peloton namespace
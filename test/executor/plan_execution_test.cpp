@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_execution_test.cpp
+//
+// Identification: test/executor/plan_execution_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "common/harness.h"
+
+#include "common/value_peeker.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "executor/logical_tile.h"
+#include "executor/plan_executor.h"
+#include "planner/seq_scan_plan.h"
+#include "storage/data_table.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Plan Execution Tests
+//===--------------------------------------------------------------------===//
+
+class PlanExecutionTests : public PelotonTest {};
+
+// Takes at most row_limit rows per run, like a portal with max_rows
+class LimitedSink : public bridge::ResultSink {
+ public:
+  LimitedSink(size_t row_limit) : row_limit(row_limit) {}
+
+  bool Consume(std::unique_ptr<executor::LogicalTile> &tile) override {
+    std::vector<oid_t> taken_rows;
+    bool full = false;
+    for (oid_t tuple_id : *tile) {
+      if (row_count == row_limit) {
+        full = true;
+        break;
+      }
+      values.push_back(ValuePeeker::PeekInteger(tile->GetValue(tuple_id, 0)));
+      taken_rows.push_back(tuple_id);
+      row_count++;
+    }
+
+    if (full == false) {
+      tile.reset();
+      return true;
+    }
+
+    for (auto tuple_id : taken_rows) {
+      tile->RemoveVisibility(tuple_id);
+    }
+    return true;
+  }
+
+  size_t row_limit;
+
+  size_t row_count = 0;
+
+  std::vector<int> values;
+};
+
+TEST_F(PlanExecutionTests, SuspendAndResumeTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateAndPopulateTable());
+  const size_t tuple_count =
+      TESTS_TUPLES_PER_TILEGROUP * DEFAULT_TILEGROUP_COUNT;
+
+  std::vector<oid_t> column_ids({0});
+  planner::SeqScanPlan seq_scan_node(table.get(), nullptr, column_ids);
+
+  std::vector<Value> params;
+  bridge::PlanExecution execution(&seq_scan_node, params);
+
+  // Fetch a few rows at a time, across tile boundaries
+  const size_t row_limit = 3;
+  LimitedSink sink(row_limit);
+  size_t run_count = 0;
+  int processed;
+  do {
+    sink.row_count = 0;
+    processed = execution.Run(sink);
+    run_count++;
+
+    // a suspended execution parks its transaction
+    if (execution.IsSuspended()) {
+      EXPECT_EQ(row_limit, sink.row_count);
+      EXPECT_TRUE(concurrency::current_txn == nullptr);
+    }
+  } while (execution.IsSuspended());
+
+  EXPECT_LE(0, processed);
+  EXPECT_EQ(tuple_count, sink.values.size());
+  EXPECT_LE(tuple_count / row_limit, run_count);
+
+  // Every row shows up exactly once
+  std::set<int> values(sink.values.begin(), sink.values.end());
+  EXPECT_EQ(tuple_count, values.size());
+  for (oid_t tuple_id = 0; tuple_id < tuple_count; tuple_id++) {
+    EXPECT_EQ(1U, values.count(ExecutorTestsUtil::PopulatedValue(tuple_id, 0)));
+  }
+}
+
+TEST_F(PlanExecutionTests, AbandonSuspendedTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateAndPopulateTable());
+
+  std::vector<oid_t> column_ids({0, 1});
+  planner::SeqScanPlan seq_scan_node(table.get(), nullptr, column_ids);
+
+  // Closing a suspended portal aborts its transaction
+  {
+    std::vector<Value> params;
+    bridge::PlanExecution execution(&seq_scan_node, params);
+    LimitedSink sink(1);
+    EXPECT_EQ(0, execution.Run(sink));
+    EXPECT_TRUE(execution.IsSuspended());
+  }
+  EXPECT_TRUE(concurrency::current_txn == nullptr);
+
+  // The table is still readable afterwards
+  std::vector<Value> params;
+  std::vector<std::unique_ptr<executor::LogicalTile>> result_tiles;
+  EXPECT_LE(0, bridge::PlanExecutor::ExecutePlan(&seq_scan_node, params,
+                                                 result_tiles));
+  EXPECT_FALSE(result_tiles.empty());
+}
+
+}  // End test namespace
+}  // End peloton namespace
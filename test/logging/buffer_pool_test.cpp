@@ -12,7 +12,7 @@
 
 
 #include "common/harness.h"
-#include "logging/circular_buffer_pool.h"
+#include "logging/log_buffer_ring.h"
 #include "logging/logging_tests_util.h"
 #include "executor/executor_tests_util.h"
 #include <stdlib.h>
@@ -26,20 +26,31 @@ namespace test {
 
 class BufferPoolTests : public PelotonTest {};
 
-void EnqueueTest(logging::CircularBufferPool *buffer_pool, unsigned int count) {
-  for (unsigned int i = 0; i < count; i++) {
-    std::unique_ptr<logging::LogBuffer> buf(new logging::LogBuffer(nullptr));
-    buf->SetSize(i);
-    buffer_pool->Put(std::move(buf));
+void WriteTest(logging::LogBufferRing *ring, unsigned int count) {
+  for (unsigned int i = 1; i <= count; i++) {
+    logging::TransactionRecord record(LOGRECORD_TYPE_TRANSACTION_COMMIT, i);
+    CopySerializeOutput output_buffer;
+    record.Serialize(output_buffer);
+    EXPECT_TRUE(ring->WriteRecord(&record));
   }
 }
 
-void DequeueTest(logging::CircularBufferPool *buffer_pool, unsigned int count) {
-  for (unsigned int i = 0; i < count; i++) {
-    auto buf = std::move(buffer_pool->Get());
-    PL_ASSERT(buf);
-    EXPECT_EQ(buf->GetSize(), i);
+// Collect until the expected number of bytes has been seen
+void CollectTest(logging::LogBufferRing *ring, size_t expected_size) {
+  size_t total_size = 0;
+  while (total_size < expected_size) {
+    std::vector<logging::LogBufferSlice> slices;
+    ring->CollectLogBuffers(slices);
+    for (auto &slice : slices) {
+      EXPECT_LE(slice.begin, slice.end);
+      total_size += slice.end - slice.begin;
+      if (slice.release) {
+        ring->ReleaseLogBuffer(slice.buffer);
+      }
+    }
+    std::this_thread::yield();
   }
+  EXPECT_EQ(total_size, expected_size);
 }
 
 void BackendThread(logging::WriteAheadBackendLogger *logger,
@@ -69,24 +80,55 @@ void FrontendThread(logging::WriteAheadFrontendLogger *logger,
   }
 }
 
-TEST_F(BufferPoolTests, BufferPoolBasicTest) {
-  logging::CircularBufferPool buffer_pool0;
-  EnqueueTest(&buffer_pool0, 5);
-  EXPECT_EQ(buffer_pool0.GetSize(), 5);
-
-  DequeueTest(&buffer_pool0, 5);
-  EXPECT_EQ(buffer_pool0.GetSize(), 0);
-
-  EnqueueTest(&buffer_pool0, BUFFER_POOL_SIZE);
-  EXPECT_EQ(buffer_pool0.GetSize(), BUFFER_POOL_SIZE);
+TEST_F(BufferPoolTests, LogBufferRingBasicTest) {
+  auto &log_manager = logging::LogManager::GetInstance();
+  auto log_buffer_capacity = log_manager.GetLogBufferCapacity();
 
+  logging::TransactionRecord record(LOGRECORD_TYPE_TRANSACTION_COMMIT, 1);
+  CopySerializeOutput output_buffer;
+  record.Serialize(output_buffer);
+  size_t record_size = record.GetMessageLength();
+
+  // each buffer holds four records
+  log_manager.SetLogBufferCapacity(record_size * 4);
+
+  logging::LogBufferRing ring(nullptr);
+  WriteTest(&ring, 10);
+
+  // two sealed buffers and the partially filled one
+  std::vector<logging::LogBufferSlice> slices;
+  EXPECT_TRUE(ring.CollectLogBuffers(slices));
+  EXPECT_EQ(slices.size(), 3);
+  EXPECT_TRUE(slices[0].release);
+  EXPECT_TRUE(slices[1].release);
+  EXPECT_FALSE(slices[2].release);
+  EXPECT_EQ(slices[2].end - slices[2].begin, record_size * 2);
+  EXPECT_EQ(slices[2].max_log_id, 10);
+
+  // nothing new has been published
+  slices.clear();
+  EXPECT_FALSE(ring.CollectLogBuffers(slices));
+  EXPECT_EQ(slices.size(), 0);
+
+  // only the new record of the current buffer is collected
+  WriteTest(&ring, 1);
+  EXPECT_TRUE(ring.CollectLogBuffers(slices));
+  EXPECT_EQ(slices.size(), 1);
+  EXPECT_EQ(slices[0].begin, record_size * 2);
+  EXPECT_EQ(slices[0].end, record_size * 3);
+
+  // the backend laps the ring while the frontend releases buffers
   for (int i = 0; i < 10; i++) {
-    logging::CircularBufferPool buffer_pool1;
-    std::thread enqueue_thread(EnqueueTest, &buffer_pool1, BUFFER_POOL_SIZE);
-    std::thread dequeue_thread(DequeueTest, &buffer_pool1, BUFFER_POOL_SIZE);
-    enqueue_thread.join();
-    dequeue_thread.join();
+    logging::LogBufferRing concurrent_ring(nullptr);
+    unsigned int count = LOG_BUFFER_RING_SIZE * 4 * 4;
+    std::thread write_thread(WriteTest, &concurrent_ring, count);
+    std::thread collect_thread(CollectTest, &concurrent_ring,
+                               record_size * count);
+    write_thread.join();
+    collect_thread.join();
   }
+
+  log_manager.SetLogBufferCapacity(log_buffer_capacity);
 }
 
 TEST_F(BufferPoolTests, LogBufferBasicTest) {
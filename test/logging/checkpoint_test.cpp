@@ -16,6 +16,7 @@
 #include "logging/logging_util.h"
 #include "logging/loggers/wal_backend_logger.h"
 #include "logging/checkpoint/simple_checkpoint.h"
+#include "logging/checkpoint/parallel_checkpoint.h"
 #include "logging/checkpoint_manager.h"
 #include "storage/database.h"
 
@@ -113,6 +114,113 @@ TEST_F(CheckpointTests, CheckpointIntegrationTest) {
   logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
 }
 
+TEST_F(CheckpointTests, ParallelCheckpointIncrementalTest) {
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+
+  size_t tile_group_size = TESTS_TUPLES_PER_TILEGROUP;
+  size_t table_tile_group_count = 3;
+
+  oid_t default_table_oid = 13;
+  // table has 3 tile groups
+  storage::DataTable *target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  ExecutorTestsUtil::PopulateTable(target_table,
+                                   tile_group_size * table_tile_group_count,
+                                   false, false, false);
+  txn_manager.CommitTransaction();
+
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(target_table);
+  catalog_manager.AddDatabase(db);
+
+  auto &checkpoint_manager = logging::CheckpointManager::GetInstance();
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetGlobalMaxFlushedCommitId(txn_manager.GetNextCommitId());
+  checkpoint_manager.Configure(CHECKPOINT_TYPE_PARALLEL, false, 1);
+  checkpoint_manager.DestroyCheckpointers();
+  checkpoint_manager.InitCheckpointers();
+  auto checkpointer = dynamic_cast<logging::ParallelCheckpoint *>(
+      checkpoint_manager.GetCheckpointer(0));
+  ASSERT_NE(nullptr, checkpointer);
+  checkpointer->SetThreadCount(2);
+
+  // first checkpoint is always a full one
+  checkpointer->DoCheckpoint();
+  EXPECT_FALSE(checkpointer->IsLastCheckpointDelta());
+  EXPECT_EQ(checkpointer->GetCheckpointedTileGroupCount(),
+            table_tile_group_count);
+
+  // fill one more tile group
+  txn_manager.BeginTransaction();
+  ExecutorTestsUtil::PopulateTable(target_table, tile_group_size, false, false,
+                                   false);
+  txn_manager.CommitTransaction();
+
+  // only the new tile group is dirty
+  log_manager.SetGlobalMaxFlushedCommitId(txn_manager.GetNextCommitId());
+  checkpointer->DoCheckpoint();
+  EXPECT_TRUE(checkpointer->IsLastCheckpointDelta());
+  EXPECT_EQ(checkpointer->GetCheckpointedTileGroupCount(), 1UL);
+
+  // destroy and restart
+  checkpoint_manager.DestroyCheckpointers();
+  checkpoint_manager.InitCheckpointers();
+
+  // recovery from the full checkpoint and the delta
+  log_manager.PrepareRecovery();
+  auto recovery_checkpointer = checkpoint_manager.GetCheckpointer(0);
+  recovery_checkpointer->DoRecovery();
+
+  EXPECT_EQ(db->GetTable(0)->GetNumberOfTuples(),
+            tile_group_size * (table_tile_group_count + 1));
+  catalog_manager.DropDatabaseWithOid(db->GetOid());
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+}
+
+TEST_F(CheckpointTests, ParallelCheckpointInFlightCommitTest) {
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+
+  size_t tile_group_size = TESTS_TUPLES_PER_TILEGROUP;
+  oid_t default_table_oid = 13;
+  storage::DataTable *target_table =
+      ExecutorTestsUtil::CreateTable(tile_group_size, true, default_table_oid);
+  ExecutorTestsUtil::PopulateTable(target_table, tile_group_size, false, false,
+                                   false);
+  txn_manager.CommitTransaction();
+
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(target_table);
+  catalog_manager.AddDatabase(db);
+
+  auto &checkpoint_manager = logging::CheckpointManager::GetInstance();
+  checkpoint_manager.Configure(CHECKPOINT_TYPE_PARALLEL, false, 1);
+  checkpoint_manager.DestroyCheckpointers();
+  checkpoint_manager.InitCheckpointers();
+  auto checkpointer = checkpoint_manager.GetCheckpointer(0);
+
+  // A commit is still installing while the log is flushed past it
+  auto in_flight_commit_id = txn_manager.BeginCommit();
+  auto &log_manager = logging::LogManager::GetInstance();
+  log_manager.SetGlobalMaxFlushedCommitId(txn_manager.GetNextCommitId());
+
+  // The checkpoint stays below it, the log keeps it
+  checkpointer->DoCheckpoint();
+  EXPECT_EQ(in_flight_commit_id - 1,
+            checkpointer->GetMostRecentCheckpointCid());
+  txn_manager.EndCommit(in_flight_commit_id);
+  EXPECT_EQ(MAX_CID, txn_manager.GetOldestInFlightCommitId());
+
+  checkpoint_manager.DestroyCheckpointers();
+  catalog_manager.DropDatabaseWithOid(db->GetOid());
+  logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
+}
+
 TEST_F(CheckpointTests, CheckpointScanTest) {
   logging::LoggingUtil::RemoveDirectory("pl_checkpoint", false);
 
@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_reader_test.cpp
+//
+// Identification: test/logging/log_reader_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "common/harness.h"
+
+#include "common/crc32c.h"
+#include "common/pool.h"
+#include "logging/log_reader.h"
+#include "logging/logging_util.h"
+#include "logging/records/transaction_record.h"
+#include "logging/records/tuple_record.h"
+#include "storage/tuple.h"
+
+#include "executor/executor_tests_util.h"
+#include "logging/logging_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Log Reader Tests
+//===--------------------------------------------------------------------===//
+
+class LogReaderTests : public PelotonTest {};
+
+// Serialize a begin, an insert and a commit record back to back
+std::vector<char> BuildLogSegment(storage::Tuple *tuple,
+                                  std::vector<size_t> &record_sizes) {
+  std::vector<char> segment;
+  CopySerializeOutput output_buffer;
+
+  logging::TransactionRecord begin_record(LOGRECORD_TYPE_TRANSACTION_BEGIN, 2);
+  logging::TupleRecord insert_record(LOGRECORD_TYPE_WAL_TUPLE_INSERT, 2, 1,
+                                     ItemPointer(1, 3), INVALID_ITEMPOINTER,
+                                     tuple, DEFAULT_DB_ID);
+  logging::TransactionRecord commit_record(LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                                           2);
+
+  std::vector<logging::LogRecord *> records = {&begin_record, &insert_record,
+                                               &commit_record};
+  for (auto record : records) {
+    record->Serialize(output_buffer);
+    segment.insert(segment.end(), record->GetMessage(),
+                   record->GetMessage() + record->GetMessageLength());
+    record_sizes.push_back(record->GetMessageLength());
+  }
+
+  return segment;
+}
+
+TEST_F(LogReaderTests, Crc32cTest) {
+  // Standard check value of CRC32C
+  const char *data = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32c::Compute(data, 9));
+
+  // Extending a checksum is the same as computing it at once
+  auto partial = Crc32c::Compute(data, 4);
+  EXPECT_EQ(0xE3069283, Crc32c::Compute(data + 4, 5, partial));
+}
+
+TEST_F(LogReaderTests, ReadRecordsTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(5));
+  auto tuples = LoggingTestsUtil::BuildTuples(table.get(), 1, false, false);
+
+  std::vector<size_t> record_sizes;
+  auto segment = BuildLogSegment(tuples[0].get(), record_sizes);
+
+  logging::LogReader reader;
+  reader.Open(segment.data(), segment.size());
+
+  logging::LogRecordView record;
+
+  // Begin
+  EXPECT_TRUE(reader.Next(record));
+  EXPECT_EQ(LOGRECORD_TYPE_TRANSACTION_BEGIN, record.type);
+  EXPECT_TRUE(record.body == nullptr);
+  logging::TransactionRecord begin_record(record.type);
+  ReferenceSerializeInputBE begin_header(record.header, record.header_length);
+  begin_record.Deserialize(begin_header);
+  EXPECT_EQ(2UL, begin_record.GetTransactionId());
+
+  // Insert
+  EXPECT_TRUE(reader.Next(record));
+  EXPECT_EQ(LOGRECORD_TYPE_WAL_TUPLE_INSERT, record.type);
+  logging::TupleRecord insert_record(record.type);
+  ReferenceSerializeInputBE insert_header(record.header, record.header_length);
+  insert_record.DeserializeHeader(insert_header);
+  EXPECT_EQ(1U, insert_record.GetTableId());
+  EXPECT_EQ(3U, insert_record.GetInsertLocation().offset);
+
+  VarlenPool pool(BACKEND_TYPE_MM);
+  storage::Tuple tuple(table->GetSchema(), true);
+  ReferenceSerializeInputBE tuple_body(record.body, record.body_length);
+  tuple.DeserializeFrom(tuple_body, &pool);
+  for (oid_t column_itr = 0; column_itr < table->GetSchema()->GetColumnCount();
+       column_itr++) {
+    EXPECT_EQ(0, tuple.GetValue(column_itr)
+                     .Compare(tuples[0]->GetValue(column_itr)));
+  }
+
+  // Commit
+  EXPECT_TRUE(reader.Next(record));
+  EXPECT_EQ(LOGRECORD_TYPE_TRANSACTION_COMMIT, record.type);
+
+  EXPECT_FALSE(reader.Next(record));
+  EXPECT_FALSE(reader.IsTornTail());
+  EXPECT_EQ(segment.size(), reader.GetPosition());
+}
+
+TEST_F(LogReaderTests, TornTailTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(5));
+  auto tuples = LoggingTestsUtil::BuildTuples(table.get(), 1, false, false);
+
+  std::vector<size_t> record_sizes;
+  auto segment = BuildLogSegment(tuples[0].get(), record_sizes);
+  logging::LogRecordView record;
+
+  // Cut the commit record short
+  {
+    logging::LogReader reader;
+    reader.Open(segment.data(), segment.size() - 2);
+
+    EXPECT_TRUE(reader.Next(record));
+    EXPECT_TRUE(reader.Next(record));
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_TRUE(reader.IsTornTail());
+    EXPECT_EQ(record_sizes[0] + record_sizes[1], reader.GetPosition());
+  }
+
+  // Flip a byte inside the tuple body
+  {
+    auto corrupted_segment = segment;
+    corrupted_segment[record_sizes[0] + record_sizes[1] - 8] ^= 0x1;
+
+    logging::LogReader reader;
+    reader.Open(corrupted_segment.data(), corrupted_segment.size());
+
+    EXPECT_TRUE(reader.Next(record));
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_TRUE(reader.IsTornTail());
+    EXPECT_EQ(record_sizes[0], reader.GetPosition());
+  }
+}
+
+TEST_F(LogReaderTests, MappedFileTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(5));
+  auto tuples = LoggingTestsUtil::BuildTuples(table.get(), 1, false, false);
+
+  std::vector<size_t> record_sizes;
+  auto segment = BuildLogSegment(tuples[0].get(), record_sizes);
+
+  // Log files start with the max log id and the max delimiter
+  std::string file_name = "log_reader_test.log";
+  FILE *fp = fopen(file_name.c_str(), "wb");
+  cid_t file_header[2] = {2, 2};
+  fwrite(file_header, sizeof(file_header), 1, fp);
+  fwrite(segment.data(), sizeof(char), segment.size(), fp);
+  fclose(fp);
+
+  logging::LogReader reader;
+  EXPECT_TRUE(reader.Open(file_name, sizeof(file_header)));
+  EXPECT_EQ(segment.size(), reader.GetLength());
+
+  size_t record_count = 0;
+  logging::LogRecordView record;
+  while (reader.Next(record)) {
+    record_count++;
+  }
+  EXPECT_EQ(3UL, record_count);
+  EXPECT_FALSE(reader.IsTornTail());
+
+  reader.Close();
+  remove(file_name.c_str());
+}
+
+}  // End test namespace
+}  // End peloton namespace
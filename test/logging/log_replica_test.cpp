@@ -0,0 +1,233 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_replica_test.cpp
+//
+// Identification: test/logging/log_replica_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+#include "common/harness.h"
+
+#include "catalog/manager.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "logging/log_replayer.h"
+#include "logging/log_shipper.h"
+#include "logging/records/transaction_record.h"
+#include "logging/records/tuple_record.h"
+#include "networking/peloton_service.h"
+#include "networking/rpc_controller.h"
+#include "networking/rpc_server.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tuple.h"
+
+#include "executor/executor_tests_util.h"
+#include "logging/logging_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Log Replica Tests
+//===--------------------------------------------------------------------===//
+
+class LogReplicaTests : public PelotonTest {};
+
+void AppendLogRecord(logging::LogRecord &record, std::string &segment) {
+  CopySerializeOutput output_buffer;
+  record.Serialize(output_buffer);
+  segment.append(record.GetMessage(), record.GetMessageLength());
+}
+
+TEST_F(LogReplicaTests, ReplaySegmentsTest) {
+  auto replica_table = ExecutorTestsUtil::CreateTable(1024);
+  auto &manager = catalog::Manager::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(replica_table);
+  manager.AddDatabase(db);
+
+  auto tuples = LoggingTestsUtil::BuildTuples(replica_table, 2, false, false);
+  cid_t commit_id = 2;
+
+  // The transaction straddles both segments
+  std::string first_segment, second_segment;
+  logging::TransactionRecord begin_record(LOGRECORD_TYPE_TRANSACTION_BEGIN,
+                                          commit_id);
+  AppendLogRecord(begin_record, first_segment);
+  for (oid_t tuple_itr = 0; tuple_itr < tuples.size(); tuple_itr++) {
+    logging::TupleRecord insert_record(
+        LOGRECORD_TYPE_WAL_TUPLE_INSERT, commit_id, replica_table->GetOid(),
+        ItemPointer(100, tuple_itr), INVALID_ITEMPOINTER,
+        tuples[tuple_itr].get(), DEFAULT_DB_ID);
+    AppendLogRecord(insert_record,
+                    (tuple_itr == 0) ? first_segment : second_segment);
+  }
+  logging::TransactionRecord commit_record(LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                                           commit_id);
+  AppendLogRecord(commit_record, second_segment);
+
+  networking::PelotonService service;
+  networking::RpcController controller;
+  networking::LogRecordReplayRequest request;
+  networking::LogRecordReplayResponse response;
+
+  // Nothing is visible until the commit record arrives
+  request.set_log(first_segment);
+  request.set_sequence_number(1);
+  request.set_logger_id(0);
+  service.LogRecordReplay(&controller, &request, &response, nullptr);
+  EXPECT_EQ(1, response.sequence_number());
+  EXPECT_EQ(0, replica_table->GetNumberOfTuples());
+
+  request.set_log(second_segment);
+  request.set_sequence_number(2);
+  service.LogRecordReplay(&controller, &request, &response, nullptr);
+  EXPECT_EQ(2, response.sequence_number());
+  EXPECT_EQ(2, replica_table->GetNumberOfTuples());
+
+  // Segments that were already applied are acknowledged but skipped
+  request.set_log(second_segment);
+  request.set_sequence_number(1);
+  service.LogRecordReplay(&controller, &request, &response, nullptr);
+  EXPECT_EQ(2, response.sequence_number());
+  EXPECT_EQ(2, replica_table->GetNumberOfTuples());
+
+  // A segment after a missing one is rejected, the acknowledgement stays at
+  // the last segment applied in sequence
+  request.set_log(second_segment);
+  request.set_sequence_number(4);
+  service.LogRecordReplay(&controller, &request, &response, nullptr);
+  EXPECT_EQ(2, response.sequence_number());
+  EXPECT_EQ(2, replica_table->GetNumberOfTuples());
+  EXPECT_EQ(2,
+            logging::LogReplayer::GetInstance().GetReplayedSequenceNumber(0));
+
+  // Snapshots taken from now on see the replayed transaction
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  EXPECT_TRUE(txn_manager.GetCurrentCommitId() > commit_id);
+
+  logging::LogReplayer::GetInstance().Reset();
+  manager.DropDatabaseWithOid(DEFAULT_DB_ID);
+}
+
+// Serve the rpcs in the background, the way the peloton binary does
+static void StartRpcServer(int port) {
+  std::thread rpc_thread([port] {
+    auto rpc_server = new networking::RpcServer(port);
+    auto service = new networking::PelotonService();
+    rpc_server->RegisterService(service);
+    rpc_server->Start();
+  });
+  rpc_thread.detach();
+}
+
+// Wait until something accepts connections on the local port
+static bool WaitForListener(int port) {
+  for (int attempt = 0; attempt < 100; attempt++) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    PL_MEMSET(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool connected =
+        connect(fd, reinterpret_cast<struct sockaddr *>(&addr),
+                sizeof(addr)) == 0;
+    close(fd);
+    if (connected) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return false;
+}
+
+TEST_F(LogReplicaTests, ShipToReplicaProcessTest) {
+  const int primary_port = 9311;
+  const int replica_port = 9312;
+
+  // Both processes have the same table, only the replica gets the log
+  auto table = ExecutorTestsUtil::CreateTable(1024);
+  auto &manager = catalog::Manager::GetInstance();
+  storage::Database *db(new storage::Database(DEFAULT_DB_ID));
+  db->AddTable(table);
+  manager.AddDatabase(db);
+
+  pid_t replica_pid = fork();
+  ASSERT_NE(-1, replica_pid);
+
+  if (replica_pid == 0) {
+    StartRpcServer(replica_port);
+
+    // Report through the exit status whether the rows showed up
+    for (int attempt = 0; attempt < 200; attempt++) {
+      if (table->GetNumberOfTuples() == 2) _exit(0);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    _exit(1);
+  }
+
+  // The primary needs its own server to receive the acknowledgements
+  StartRpcServer(primary_port);
+  ASSERT_TRUE(WaitForListener(primary_port));
+  ASSERT_TRUE(WaitForListener(replica_port));
+
+  auto tuples = LoggingTestsUtil::BuildTuples(table, 2, false, false);
+  cid_t commit_id = 2;
+
+  std::string first_segment, second_segment;
+  logging::TransactionRecord begin_record(LOGRECORD_TYPE_TRANSACTION_BEGIN,
+                                          commit_id);
+  AppendLogRecord(begin_record, first_segment);
+  for (oid_t tuple_itr = 0; tuple_itr < tuples.size(); tuple_itr++) {
+    logging::TupleRecord insert_record(
+        LOGRECORD_TYPE_WAL_TUPLE_INSERT, commit_id, table->GetOid(),
+        ItemPointer(100, tuple_itr), INVALID_ITEMPOINTER,
+        tuples[tuple_itr].get(), DEFAULT_DB_ID);
+    AppendLogRecord(insert_record, first_segment);
+  }
+  logging::TransactionRecord commit_record(LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                                           commit_id);
+  AppendLogRecord(commit_record, second_segment);
+
+  // The replica misses the first segment, rejects the second one and gets
+  // both again
+  auto &log_shipper = logging::LogShipper::GetInstance();
+  log_shipper.ShipLogSegment(first_segment, 0);
+  log_shipper.AddSubscriber("127.0.0.1:" + std::to_string(replica_port));
+  log_shipper.ShipLogSegment(second_segment, 0);
+  EXPECT_EQ(2, log_shipper.GetShippedSequenceNumber(0));
+
+  // The replica acknowledges both segments
+  for (int attempt = 0;
+       attempt < 200 && log_shipper.GetAcknowledgedSequenceNumber(0) < 2;
+       attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(2, log_shipper.GetAcknowledgedSequenceNumber(0));
+
+  int status = 0;
+  ASSERT_EQ(replica_pid, waitpid(replica_pid, &status, 0));
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+
+  // Nothing was replayed on the primary
+  EXPECT_EQ(0, table->GetNumberOfTuples());
+
+  manager.DropDatabaseWithOid(DEFAULT_DB_ID);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -18,6 +18,8 @@
 #include "storage/data_table.h"
 #include "storage/tile.h"
 #include "logging/loggers/wal_frontend_logger.h"
+#include "logging/loggers/wbl_backend_logger.h"
+#include "logging/records/transaction_record.h"
 #include "logging/logging_util.h"
 #include "storage/table_factory.h"
 
@@ -162,5 +164,40 @@ TEST_F(WriteBehindLoggingTests, DirtyRangeVisibilityTest) {
   txn_manager.AbortTransaction();
 }
 
+TEST_F(WriteBehindLoggingTests, DirtyRangeTest) {
+  logging::WriteBehindBackendLogger backend_logger;
+
+  std::vector<ItemPointer> locations = {ItemPointer(5, 3), ItemPointer(5, 7),
+                                        ItemPointer(6, 0)};
+  for (auto location : locations) {
+    std::unique_ptr<logging::LogRecord> record(backend_logger.GetTupleRecord(
+        LOGRECORD_TYPE_TUPLE_INSERT, 2, 1, DEFAULT_DB_ID, location,
+        INVALID_ITEMPOINTER));
+    backend_logger.Log(record.get());
+  }
+
+  // Nothing is handed to the frontend before the transaction is done
+  logging::WriteBehindBackendLogger::DirtyRangeMap dirty_ranges;
+  backend_logger.CollectDirtyRanges(dirty_ranges);
+  EXPECT_TRUE(dirty_ranges.empty());
+
+  logging::TransactionRecord commit_record(LOGRECORD_TYPE_TRANSACTION_COMMIT,
+                                           2);
+  backend_logger.Log(&commit_record);
+
+  // One covering range per tile group
+  backend_logger.CollectDirtyRanges(dirty_ranges);
+  EXPECT_EQ(2UL, dirty_ranges.size());
+  EXPECT_EQ(3U, dirty_ranges[5].first);
+  EXPECT_EQ(8U, dirty_ranges[5].second);
+  EXPECT_EQ(0U, dirty_ranges[6].first);
+  EXPECT_EQ(1U, dirty_ranges[6].second);
+
+  // The ranges are handed over only once
+  logging::WriteBehindBackendLogger::DirtyRangeMap next_dirty_ranges;
+  backend_logger.CollectDirtyRanges(next_dirty_ranges);
+  EXPECT_TRUE(next_dirty_ranges.empty());
+}
+
 }  // End test namespace
 }  // End peloton namespace
@@ -14,7 +14,19 @@
 #include "common/harness.h"
 #include "networking/rpc_server.h"
 #include "networking/peloton_service.h"
+#include "networking/plan_stream.h"
+#include "networking/rpc_controller.h"
+#include "planner/limit_plan.h"
+#include "planner/materialization_plan.h"
 #include "planner/seq_scan_plan.h"
+#include "expression/expression_util.h"
+
+#include "catalog/manager.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/database.h"
+#include "storage/table_factory.h"
+
+#include "executor/executor_tests_util.h"
 
 namespace peloton {
 namespace test {
@@ -33,5 +45,155 @@ TEST_F(RpcQueryPlanTests, BasicTest) {
   // Becuase the plan is not completed, so it is false
   EXPECT_EQ(serialize, false);
 }
+
+TEST_F(RpcQueryPlanTests, UnsupportedPlanTest) {
+  // Predicates can't be shipped
+  planner::SeqScanPlan predicate_plan(
+      nullptr, expression::ExpressionUtil::ConstantValueFactory(
+                   Value::GetTrue()),
+      {0});
+  CopySerializeOutput predicate_output;
+  EXPECT_FALSE(predicate_plan.SerializeTree(predicate_output));
+
+  // Nor any plan other than SeqScan and Limit, wherever it is in the tree
+  planner::LimitPlan limit_plan(1, 0);
+  std::unique_ptr<planner::AbstractPlan> materialization_plan(
+      new planner::MaterializationPlan(true));
+  limit_plan.AddChild(std::move(materialization_plan));
+  CopySerializeOutput limit_output;
+  EXPECT_FALSE(limit_plan.SerializeTree(limit_output));
+
+  // The other site refuses them too
+  CopySerializeOutput unsupported_output;
+  unsupported_output.WriteByte(
+      static_cast<int8_t>(PLAN_NODE_TYPE_MATERIALIZE));
+  unsupported_output.WriteInt(0);
+
+  networking::PelotonService service;
+  networking::RpcController controller;
+  networking::QueryPlanExecRequest request;
+  request.set_plan(unsupported_output.Data(), unsupported_output.Size());
+  networking::QueryPlanExecResponse response;
+  service.QueryPlan(&controller, &request, &response, nullptr);
+  EXPECT_EQ(-1, response.tuple_count());
+  EXPECT_FALSE(response.has_more());
+}
+
+// Number of tuples in a serialized tile, see Tile::SerializeTo
+int GetTileTupleCount(const std::string &tile_bytes) {
+  ReferenceSerializeInputBE input(tile_bytes.c_str(), tile_bytes.size());
+  input.ReadInt();
+  int header_size = input.ReadInt();
+  input.GetRawPointer(header_size);
+  return input.ReadInt();
+}
+
+TEST_F(RpcQueryPlanTests, StreamTest) {
+  // A table the catalog knows about
+  const oid_t database_oid = 12345, table_oid = 123456;
+  auto table_schema = new catalog::Schema(
+      {ExecutorTestsUtil::GetColumnInfo(0), ExecutorTestsUtil::GetColumnInfo(1),
+       ExecutorTestsUtil::GetColumnInfo(2),
+       ExecutorTestsUtil::GetColumnInfo(3)});
+  auto table = storage::TableFactory::GetDataTable(
+      database_oid, table_oid, table_schema, "TEST_TABLE",
+      TESTS_TUPLES_PER_TILEGROUP, true, false);
+  auto database = new storage::Database(database_oid);
+  database->AddTable(table);
+  auto &manager = catalog::Manager::GetInstance();
+  manager.AddDatabase(database);
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  ExecutorTestsUtil::PopulateTable(table, 10 * TESTS_TUPLES_PER_TILEGROUP,
+                                   false, false, false);
+  txn_manager.CommitTransaction();
+
+  // LIMIT over a scan of all columns
+  const int limit = 7 * TESTS_TUPLES_PER_TILEGROUP + 2;
+  planner::LimitPlan limit_plan(limit, 0);
+  std::unique_ptr<planner::AbstractPlan> seq_scan_plan(
+      new planner::SeqScanPlan(table, nullptr, {0, 1, 2, 3}));
+  limit_plan.AddChild(std::move(seq_scan_plan));
+
+  CopySerializeOutput output_plan;
+  EXPECT_TRUE(limit_plan.SerializeTree(output_plan));
+
+  networking::PelotonService service;
+  networking::RpcController controller;
+  networking::QueryPlanExecRequest request;
+  request.set_plan(output_plan.Data(), output_plan.Size());
+  request.set_chunk_tuples(2 * TESTS_TUPLES_PER_TILEGROUP);
+
+  // Fetch chunk by chunk
+  int tuple_count = 0, chunk_count = 0;
+  int64_t query_id = 0;
+  while (true) {
+    networking::QueryPlanExecResponse response;
+    service.QueryPlan(&controller, &request, &response, nullptr);
+    EXPECT_LE(0, response.tuple_count());
+    EXPECT_GE(2 * TESTS_TUPLES_PER_TILEGROUP, response.tuple_count());
+
+    int result_tuple_count = 0;
+    for (int result_itr = 0; result_itr < response.result_size();
+         result_itr++) {
+      result_tuple_count += GetTileTupleCount(response.result(result_itr));
+    }
+    EXPECT_EQ(response.tuple_count(), result_tuple_count);
+    tuple_count += response.tuple_count();
+    chunk_count++;
+
+    if (response.has_more() == false) break;
+    if (query_id != 0) {
+      EXPECT_EQ(query_id, response.query_id());
+    }
+    query_id = response.query_id();
+    request.set_query_id(query_id);
+  }
+  EXPECT_EQ(limit, tuple_count);
+  EXPECT_LE(4, chunk_count);
+
+  auto &plan_stream_manager = networking::PlanStreamManager::GetInstance();
+  EXPECT_EQ(0U, plan_stream_manager.GetStreamCount());
+
+  // A finished query can't be fetched any more
+  networking::QueryPlanExecResponse response;
+  service.QueryPlan(&controller, &request, &response, nullptr);
+  EXPECT_EQ(-1, response.tuple_count());
+
+  // Canceling drops the rest
+  request.clear_query_id();
+  networking::QueryPlanExecResponse first_response;
+  service.QueryPlan(&controller, &request, &first_response, nullptr);
+  EXPECT_TRUE(first_response.has_more());
+  EXPECT_EQ(1U, plan_stream_manager.GetStreamCount());
+
+  request.set_query_id(first_response.query_id());
+  request.set_cancel(true);
+  networking::QueryPlanExecResponse cancel_response;
+  service.QueryPlan(&controller, &request, &cancel_response, nullptr);
+  EXPECT_EQ(0, cancel_response.tuple_count());
+  EXPECT_EQ(0U, plan_stream_manager.GetStreamCount());
+
+  // A query that is not fetched any more is dropped once it is idle
+  request.clear_query_id();
+  request.set_cancel(false);
+  networking::QueryPlanExecResponse idle_response;
+  service.QueryPlan(&controller, &request, &idle_response, nullptr);
+  EXPECT_TRUE(idle_response.has_more());
+  EXPECT_EQ(0U, plan_stream_manager.DropIdleStreams(std::chrono::minutes(1)));
+  EXPECT_EQ(1U, plan_stream_manager.GetStreamCount());
+  EXPECT_EQ(1U, plan_stream_manager.DropIdleStreams(
+                    std::chrono::milliseconds(0)));
+  EXPECT_EQ(0U, plan_stream_manager.GetStreamCount());
+
+  request.set_query_id(idle_response.query_id());
+  networking::QueryPlanExecResponse dropped_response;
+  service.QueryPlan(&controller, &request, &dropped_response, nullptr);
+  EXPECT_EQ(-1, dropped_response.tuple_count());
+
+  manager.DropDatabaseWithOid(database_oid);
+}
+
 }
 }
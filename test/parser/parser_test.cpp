@@ -16,6 +16,8 @@
 
 #include "common/harness.h"
 #include "parser/parser/pg_query.h"
+#include "parser/postgres_parser.h"
+#include "parser/peloton/copy_parse.h"
 
 namespace peloton {
 namespace test {
@@ -167,5 +169,56 @@ TEST_F(ParserTest, DDLTest2) {
   ParseSQLStrings(sqlStrings, expect_failure);
 }
 
+TEST_F(ParserTest, SplitStatementsTest) {
+  auto &parser = parser::PostgresParser::GetInstance();
+
+  auto statements = parser.SplitStatements(
+      "INSERT INTO a VALUES ('x;y'); ;\n"
+      "SELECT \"b;c\" FROM a -- trailing; comment\n"
+      "/* ; */ ;  UPDATE a SET b = 1  ");
+  EXPECT_EQ(3U, statements.size());
+  EXPECT_EQ("INSERT INTO a VALUES ('x;y')", statements[0]);
+  EXPECT_EQ("SELECT \"b;c\" FROM a", statements[1]);
+  EXPECT_EQ("UPDATE a SET b = 1", statements[2]);
+
+  // Nothing to run
+  EXPECT_TRUE(parser.SplitStatements(" ; -- only a comment").empty());
+
+  // The rest of a statement the scanner rejects is kept for the parser
+  statements = parser.SplitStatements("SELECT 1; SELECT 'open");
+  EXPECT_EQ(2U, statements.size());
+  EXPECT_EQ("SELECT 'open", statements[1]);
+}
+
+TEST_F(ParserTest, CopyTest) {
+  auto &parser = parser::PostgresParser::GetInstance();
+
+  auto parse_tree = parser.BuildParseTree(
+      "COPY foo (a, b) FROM STDIN WITH CSV HEADER DELIMITER ';' NULL 'x'");
+  EXPECT_EQ(PARSE_NODE_TYPE_COPY, parse_tree->GetParseNodeType());
+  auto copy_parse = static_cast<parser::CopyParse *>(parse_tree.get());
+  EXPECT_EQ("foo", copy_parse->GetTableName());
+  EXPECT_TRUE(copy_parse->IsFrom());
+  EXPECT_TRUE(copy_parse->IsStdio());
+  EXPECT_EQ(2U, copy_parse->GetColumnNames().size());
+  EXPECT_EQ("csv", copy_parse->GetFormat());
+  EXPECT_EQ(";", copy_parse->GetDelimiter());
+  EXPECT_TRUE(copy_parse->HasNullString());
+  EXPECT_EQ("x", copy_parse->GetNullString());
+  EXPECT_TRUE(copy_parse->HasHeader());
+
+  // The option list syntax
+  parse_tree = parser.BuildParseTree("COPY foo TO STDOUT (FORMAT binary)");
+  copy_parse = static_cast<parser::CopyParse *>(parse_tree.get());
+  EXPECT_FALSE(copy_parse->IsFrom());
+  EXPECT_EQ("binary", copy_parse->GetFormat());
+  EXPECT_FALSE(copy_parse->HasHeader());
+
+  // A file on the server
+  parse_tree = parser.BuildParseTree("COPY foo FROM '/tmp/foo'");
+  copy_parse = static_cast<parser::CopyParse *>(parse_tree.get());
+  EXPECT_FALSE(copy_parse->IsStdio());
+}
+
 }  // End test namespace
 }  // End peloton namespace
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column_test.cpp
+//
+// Identification: test/storage/compressed_column_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <memory>
+#include <string>
+
+#include "common/harness.h"
+
+#include "common/value_factory.h"
+#include "common/value_peeker.h"
+#include "storage/compressed_column.h"
+#include "storage/tile.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Compressed Column Tests
+//===--------------------------------------------------------------------===//
+
+class CompressedColumnTests : public PelotonTest {};
+
+#define TUPLE_COUNT 1000
+
+static int32_t RangeValue(oid_t tuple_itr) {
+  return static_cast<int32_t>(tuple_itr % 50) - 1000;
+}
+
+static int64_t RunValue(oid_t tuple_itr) {
+  return 1000000000000L + tuple_itr / 100;
+}
+
+// Distinct values across the whole range
+static int32_t SpreadValue(oid_t tuple_itr) {
+  return (tuple_itr % 2) ? INT32_MAX - static_cast<int32_t>(tuple_itr)
+                         : -INT32_MAX + static_cast<int32_t>(tuple_itr);
+}
+
+TEST_F(CompressedColumnTests, IntegerTest) {
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  catalog::Column column2(VALUE_TYPE_BIGINT, GetTypeSize(VALUE_TYPE_BIGINT),
+                          "B", true);
+  catalog::Schema schema({column1, column2});
+  std::unique_ptr<storage::Tile> tile(
+      storage::TileFactory::GetTempTile(schema, TUPLE_COUNT));
+
+  // A small range, and long runs
+  for (oid_t tuple_itr = 0; tuple_itr < TUPLE_COUNT; tuple_itr++) {
+    tile->SetValue(ValueFactory::GetIntegerValue(RangeValue(tuple_itr)),
+                   tuple_itr, 0);
+    tile->SetValue(ValueFactory::GetBigIntValue(RunValue(tuple_itr)),
+                   tuple_itr, 1);
+  }
+
+  std::unique_ptr<storage::CompressedColumn> range_column(
+      storage::CompressedColumn::Compress(tile.get(), 0, TUPLE_COUNT));
+  ASSERT_TRUE(range_column != nullptr);
+  EXPECT_EQ(COMPRESSION_TYPE_BITPACKING, range_column->GetCompressionType());
+  EXPECT_GT(TUPLE_COUNT * sizeof(int32_t) / 4, range_column->GetSize());
+
+  std::unique_ptr<storage::CompressedColumn> run_column(
+      storage::CompressedColumn::Compress(tile.get(), 1, TUPLE_COUNT));
+  ASSERT_TRUE(run_column != nullptr);
+  EXPECT_EQ(COMPRESSION_TYPE_RLE, run_column->GetCompressionType());
+  EXPECT_GT(TUPLE_COUNT * sizeof(int64_t) / 100, run_column->GetSize());
+
+  // Values read the same through the tile, once it is compressed
+  EXPECT_TRUE(tile->Compress());
+  EXPECT_TRUE(tile->IsCompressed());
+  tile->ReleaseUncompressedData();
+  for (oid_t tuple_itr = 0; tuple_itr < TUPLE_COUNT; tuple_itr++) {
+    EXPECT_EQ(RangeValue(tuple_itr),
+              ValuePeeker::PeekInteger(tile->GetValue(tuple_itr, 0)));
+    EXPECT_EQ(RunValue(tuple_itr),
+              ValuePeeker::PeekBigInt(tile->GetValue(tuple_itr, 1)));
+  }
+}
+
+TEST_F(CompressedColumnTests, StringTest) {
+  catalog::Column column1(VALUE_TYPE_VARCHAR, 64, "A", false);
+  catalog::Column column2(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "B", true);
+  catalog::Schema schema({column1, column2});
+  std::unique_ptr<storage::Tile> tile(
+      storage::TileFactory::GetTempTile(schema, TUPLE_COUNT));
+
+  // Few distinct strings, some of them null
+  const std::string strings[] = {"warehouse", "district", "customer"};
+  for (oid_t tuple_itr = 0; tuple_itr < TUPLE_COUNT; tuple_itr++) {
+    if (tuple_itr % 4 == 3) {
+      tile->SetValue(ValueFactory::GetNullStringValue(), tuple_itr, 0);
+    } else {
+      tile->SetValue(ValueFactory::GetStringValue(strings[tuple_itr % 4]),
+                     tuple_itr, 0);
+    }
+    tile->SetValue(ValueFactory::GetIntegerValue(SpreadValue(tuple_itr)),
+                   tuple_itr, 1);
+  }
+
+  std::unique_ptr<storage::CompressedColumn> string_column(
+      storage::CompressedColumn::Compress(tile.get(), 0, TUPLE_COUNT));
+  ASSERT_TRUE(string_column != nullptr);
+  EXPECT_EQ(COMPRESSION_TYPE_DICTIONARY, string_column->GetCompressionType());
+
+  // Distinct values don't shrink, so the tile stays as it is
+  EXPECT_TRUE(storage::CompressedColumn::Compress(tile.get(), 1,
+                                                  TUPLE_COUNT) == nullptr);
+  EXPECT_FALSE(tile->Compress());
+  EXPECT_FALSE(tile->IsCompressed());
+
+  // The strings outlive the tile pool
+  for (oid_t tuple_itr = 0; tuple_itr < TUPLE_COUNT; tuple_itr++) {
+    tile->SetValue(ValueFactory::GetIntegerValue(tuple_itr % 7), tuple_itr,
+                   1);
+  }
+  EXPECT_TRUE(tile->Compress());
+  tile->ReleaseUncompressedData();
+  for (oid_t tuple_itr = 0; tuple_itr < TUPLE_COUNT; tuple_itr++) {
+    auto value = tile->GetValue(tuple_itr, 0);
+    if (tuple_itr % 4 == 3) {
+      EXPECT_TRUE(value.IsNull());
+    } else {
+      EXPECT_EQ(0, value.Compare(
+                       ValueFactory::GetStringValue(strings[tuple_itr % 4])));
+    }
+    EXPECT_EQ(static_cast<int32_t>(tuple_itr % 7),
+              ValuePeeker::PeekInteger(tile->GetValue(tuple_itr, 1)));
+  }
+}
+
+}  // End test namespace
+}  // End peloton namespace
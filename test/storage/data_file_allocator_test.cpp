@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// data_file_allocator_test.cpp
+//
+// Identification: test/storage/data_file_allocator_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "common/harness.h"
+
+#include "storage/data_file_allocator.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Data File Allocator Tests
+//===--------------------------------------------------------------------===//
+
+class DataFileAllocatorTests : public PelotonTest {};
+
+#define SEGMENT_SIZE (1024 * 1024UL)
+
+static int CreateDataFile(std::string &file_name) {
+  char file_template[] = "/tmp/peloton_data_file_XXXXXX";
+  int data_fd = mkstemp(file_template);
+  EXPECT_LE(0, data_fd);
+  file_name = file_template;
+  return data_fd;
+}
+
+TEST_F(DataFileAllocatorTests, ReuseTest) {
+  std::string file_name;
+  std::unique_ptr<storage::DataFileAllocator> allocator(
+      new storage::DataFileAllocator(CreateDataFile(file_name), SEGMENT_SIZE));
+
+  auto first_tile = allocator->Allocate(10000);
+  auto second_tile = allocator->Allocate(10000);
+  PL_MEMSET(first_tile, 'a', 10000);
+  PL_MEMSET(second_tile, 'b', 10000);
+
+  auto stats = allocator->GetStats();
+  EXPECT_EQ(1U, stats.segment_count);
+  EXPECT_EQ(SEGMENT_SIZE, stats.file_size);
+  size_t extent_size = stats.live_bytes / 2;
+  EXPECT_LE(10000U, extent_size);
+
+  // A dropped tile leaves its extent to the next one of its size class
+  allocator->Release(first_tile);
+  EXPECT_EQ(extent_size, allocator->GetStats().free_bytes);
+  auto third_tile = allocator->Allocate(9000);
+  EXPECT_EQ(first_tile, third_tile);
+  EXPECT_EQ(0U, allocator->GetStats().free_bytes);
+
+  // The free extents are found again in the file
+  allocator->Release(third_tile);
+  allocator.reset();
+  int data_fd = open(file_name.c_str(), O_RDWR);
+  allocator.reset(new storage::DataFileAllocator(data_fd, SEGMENT_SIZE));
+
+  stats = allocator->GetStats();
+  EXPECT_EQ(extent_size, stats.live_bytes);
+  EXPECT_EQ(extent_size, stats.free_bytes);
+
+  allocator.reset();
+  unlink(file_name.c_str());
+}
+
+TEST_F(DataFileAllocatorTests, GrowthTest) {
+  std::string file_name;
+  storage::DataFileAllocator allocator(CreateDataFile(file_name),
+                                       SEGMENT_SIZE);
+  const size_t tile_size = 400 * 1024;
+
+  // Two tiles fill a segment, the third one grows the file
+  auto first_tile = allocator.Allocate(tile_size);
+  auto second_tile = allocator.Allocate(tile_size);
+  auto third_tile = allocator.Allocate(tile_size);
+  auto stats = allocator.GetStats();
+  EXPECT_EQ(2U, stats.segment_count);
+  EXPECT_EQ(2 * SEGMENT_SIZE, stats.file_size);
+
+  // An empty segment is given back, and refilled before the file grows
+  allocator.Release(first_tile);
+  allocator.Release(second_tile);
+  stats = allocator.GetStats();
+  EXPECT_EQ(1U, stats.reclaimed_segment_count);
+  EXPECT_EQ(0U, stats.free_bytes);
+
+  auto fourth_tile = allocator.Allocate(tile_size);
+  auto fifth_tile = allocator.Allocate(tile_size);
+  EXPECT_EQ(first_tile, fifth_tile);
+  EXPECT_EQ(2 * SEGMENT_SIZE, allocator.GetStats().file_size);
+
+  allocator.Release(third_tile);
+  allocator.Release(fourth_tile);
+  allocator.Release(fifth_tile);
+  unlink(file_name.c_str());
+}
+
+TEST_F(DataFileAllocatorTests, RelocateTest) {
+  std::string file_name;
+  storage::DataFileAllocator allocator(CreateDataFile(file_name),
+                                       SEGMENT_SIZE);
+  const size_t tile_size = 100 * 1000;
+  const size_t tile_count = 8;
+
+  void *tiles[tile_count];
+  for (size_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    tiles[tile_itr] = allocator.Allocate(tile_size);
+    PL_MEMSET(tiles[tile_itr], 'a' + tile_itr, tile_size);
+  }
+
+  // Move on to a second segment
+  auto large_tile = allocator.Allocate(6 * tile_size);
+
+  // Leave the first segment sparse
+  for (size_t tile_itr = 2; tile_itr < tile_count; tile_itr++) {
+    allocator.Release(tiles[tile_itr]);
+  }
+  EXPECT_EQ(1U, allocator.SelectSegmentsToEvacuate(0.5));
+  EXPECT_TRUE(allocator.IsEvacuating(tiles[0]));
+  EXPECT_FALSE(allocator.IsEvacuating(large_tile));
+
+  // The live tiles move out, and the segment is given back
+  for (size_t tile_itr = 0; tile_itr < 2; tile_itr++) {
+    auto new_tile = allocator.Relocate(tiles[tile_itr]);
+    EXPECT_FALSE(allocator.IsEvacuating(new_tile));
+    EXPECT_EQ(0, memcmp(new_tile, tiles[tile_itr], tile_size));
+
+    allocator.Release(tiles[tile_itr]);
+    tiles[tile_itr] = new_tile;
+  }
+
+  auto stats = allocator.GetStats();
+  EXPECT_EQ(0U, stats.evacuating_segment_count);
+  EXPECT_EQ(1U, stats.reclaimed_segment_count);
+  EXPECT_EQ(2U, stats.relocated_count);
+
+  allocator.Release(tiles[0]);
+  allocator.Release(tiles[1]);
+  allocator.Release(large_tile);
+  unlink(file_name.c_str());
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -11,10 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 
+#include <set>
+
 #include "common/harness.h"
 
 #include "storage/data_table.h"
 #include "storage/tile_group.h"
+#include "storage/tile_group_header.h"
 #include "concurrency/transaction_manager_factory.h"
 #include "executor/executor_tests_util.h"
 
@@ -68,6 +71,18 @@ TEST_F(DataTableTests, TransformTileGroupTest) {
 
   // Transform the tile group
   data_table->TransformTileGroup(0, theta);
+
+  // The transformed tile group shares the header of the frozen one it
+  // replaces, so a slot claimed through the replaced one stays claimed
+  auto orig_tile_group = data_table->GetTileGroup(0);
+  auto new_tile_group = data_table->TransformTileGroup(0, theta, true);
+  ASSERT_NE(nullptr, new_tile_group);
+  EXPECT_EQ(orig_tile_group->GetHeader(), new_tile_group->GetHeader());
+
+  const txn_id_t txn_id = 12345;
+  EXPECT_TRUE(orig_tile_group->GetHeader()->SetAtomicTransactionId(0, txn_id));
+  orig_tile_group.reset();
+  EXPECT_EQ(txn_id, new_tile_group->GetHeader()->GetTransactionId(0));
 }
 
 std::unique_ptr<storage::DataTable> data_table_test_table;
@@ -88,5 +103,52 @@ TEST_F(DataTableTests, GlobalTableTest) {
   data_table_test_table.release();
 }
 
+#define INSERT_THREAD_COUNT 4U
+
+void InsertTest(storage::DataTable *table,
+                std::vector<std::vector<ItemPointer>> *locations,
+                uint64_t thread_itr) {
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  for (oid_t tuple_itr = 0; tuple_itr < TESTS_TUPLES_PER_TILEGROUP * 10U;
+       tuple_itr++) {
+    auto tuple = ExecutorTestsUtil::GetTuple(table, tuple_itr, testing_pool);
+    (*locations)[thread_itr].push_back(table->InsertTuple(tuple.get()));
+  }
+}
+
+TEST_F(DataTableTests, ConcurrentInsertTest) {
+  // Every thread gets a tile group of its own
+  FLAGS_active_tile_group_count = INSERT_THREAD_COUNT;
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(TESTS_TUPLES_PER_TILEGROUP, false));
+  FLAGS_active_tile_group_count = 1;
+  EXPECT_EQ(INSERT_THREAD_COUNT, data_table->GetTileGroupCount());
+
+  std::vector<std::vector<ItemPointer>> locations(INSERT_THREAD_COUNT);
+  LaunchParallelTest(INSERT_THREAD_COUNT, InsertTest, data_table.get(),
+                     &locations);
+
+  // No slot is handed out twice, and all of them are in the table
+  std::set<std::pair<oid_t, oid_t>> slots;
+  std::set<oid_t> tile_group_ids;
+  for (auto &thread_locations : locations) {
+    for (auto &location : thread_locations) {
+      EXPECT_NE(INVALID_OID, location.block);
+      oid_t block = location.block, offset = location.offset;
+      EXPECT_TRUE(slots.emplace(block, offset).second);
+      tile_group_ids.insert(block);
+    }
+  }
+  EXPECT_EQ(INSERT_THREAD_COUNT * TESTS_TUPLES_PER_TILEGROUP * 10U,
+            slots.size());
+
+  for (oid_t tile_group_itr = 0;
+       tile_group_itr < data_table->GetTileGroupCount(); tile_group_itr++) {
+    tile_group_ids.erase(
+        data_table->GetTileGroup(tile_group_itr)->GetTileGroupId());
+  }
+  EXPECT_TRUE(tile_group_ids.empty());
+}
+
 }  // End test namespace
 }  // End peloton namespace
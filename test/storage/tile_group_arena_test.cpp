@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_arena_test.cpp
+//
+// Identification: test/storage/tile_group_arena_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <cstdint>
+
+#include "common/harness.h"
+
+#include "storage/tile_group_arena.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Tile Group Arena Tests
+//===--------------------------------------------------------------------===//
+
+class TileGroupArenaTests : public PelotonTest {};
+
+TEST_F(TileGroupArenaTests, ReuseTest) {
+  storage::TileGroupArena arena(true, true);
+  const size_t tile_size = 3 * ARENA_MIN_BLOCK_SIZE + 100;
+
+  auto first_tile = arena.Allocate(tile_size);
+  auto second_tile = arena.Allocate(tile_size);
+  PL_MEMSET(first_tile, 'a', tile_size);
+  PL_MEMSET(second_tile, 'b', tile_size);
+
+  // Cache line aligned, from the same region
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(first_tile) % 64);
+  auto stats = arena.GetStats();
+  EXPECT_EQ(1U, stats.region_count);
+  EXPECT_LE(1U, stats.node_count);
+
+  // A dropped tile leaves its memory to the next one of its size
+  arena.Release(first_tile);
+  EXPECT_LE(tile_size, arena.GetStats().free_bytes);
+  auto third_tile = arena.Allocate(tile_size - 10);
+  EXPECT_EQ(first_tile, third_tile);
+
+  stats = arena.GetStats();
+  EXPECT_EQ(1U, stats.reuse_count);
+  EXPECT_EQ(0U, stats.free_bytes);
+
+  arena.Release(second_tile);
+  arena.Release(third_tile);
+}
+
+TEST_F(TileGroupArenaTests, SizeTest) {
+  storage::TileGroupArena arena(false, false);
+
+  // Small ones come from the heap
+  auto small_block = arena.Allocate(256);
+  PL_MEMSET(small_block, '-', 256);
+  EXPECT_EQ(0U, arena.GetStats().region_count);
+  arena.Release(small_block);
+
+  // Large ones get their own mapping, which is given back
+  const size_t large_size = ARENA_MAX_BLOCK_SIZE + 1;
+  auto large_block = arena.Allocate(large_size);
+  PL_MEMSET(large_block, '-', large_size);
+  auto stats = arena.GetStats();
+  EXPECT_EQ(1U, stats.mapping_count);
+  EXPECT_LE(large_size, stats.mapped_bytes);
+  EXPECT_EQ(0U, stats.hugetlb_mapping_count);
+
+  arena.Release(large_block);
+  EXPECT_EQ(0U, arena.GetStats().mapped_bytes);
+}
+
+}  // End test namespace
+}  // End peloton namespace
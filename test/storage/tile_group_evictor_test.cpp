@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_evictor_test.cpp
+//
+// Identification: test/storage/tile_group_evictor_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "common/harness.h"
+
+#include "catalog/manager.h"
+#include "common/serializer.h"
+#include "concurrency/epoch_manager.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "executor/executor_tests_util.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "storage/tile.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_evictor.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Tile Group Evictor Tests
+//===--------------------------------------------------------------------===//
+
+class TileGroupEvictorTests : public PelotonTest {};
+
+TEST_F(TileGroupEvictorTests, BasicTest) {
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+  const oid_t database_oid = 23456;
+
+  // Two full tile groups of a table the catalog knows about
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  auto data_table = ExecutorTestsUtil::CreateTable(tuple_count, false);
+  ExecutorTestsUtil::PopulateTable(data_table, tuple_count * 2, false, false,
+                                   true);
+  txn_manager.CommitTransaction();
+
+  auto database = new storage::Database(database_oid);
+  database->AddTable(data_table);
+  auto &manager = catalog::Manager::GetInstance();
+  manager.AddDatabase(database);
+
+  auto value = data_table->GetTileGroup(0)->GetValue(1, 2);
+
+  // What a checkpoint writes for a few tuples of the second tile group
+  std::vector<oid_t> tuple_slots = {0, 2, 5};
+  auto tile_group = data_table->PeekTileGroup(1);
+  CopySerializeOutput expected_output;
+  for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount();
+       tile_itr++) {
+    tile_group->GetTile(tile_itr)->SerializeTuplesTo(expected_output,
+                                                     tuple_slots);
+  }
+  tile_group.reset();
+
+  // Nobody reads the table for a few rounds
+  auto &evictor = storage::TileGroupEvictor::GetInstance();
+  size_t tile_group_count = 0;
+  for (int round_itr = 0; round_itr < TILE_GROUP_EVICTION_COLD_ROUNDS;
+       round_itr++) {
+    EXPECT_EQ(0U, tile_group_count);
+    tile_group_count += evictor.EvictOnce();
+  }
+  EXPECT_EQ(2U, tile_group_count);
+  EXPECT_TRUE(data_table->PeekTileGroup(0)->IsEvicted());
+  EXPECT_TRUE(data_table->PeekTileGroup(1)->IsEvicted());
+
+  // The tiles drop their data once older transactions are gone
+  for (int wait_itr = 0;
+       wait_itr < 100 && evictor.GetRetiredTileGroupCount() > 0; wait_itr++) {
+    txn_manager.BeginTransaction();
+    txn_manager.CommitTransaction();
+    std::this_thread::sleep_for(std::chrono::milliseconds(EPOCH_LENGTH));
+    evictor.ReleaseRetiredTileGroups();
+  }
+  EXPECT_EQ(0U, evictor.GetRetiredTileGroupCount());
+  EXPECT_EQ(0U, data_table->PeekTileGroup(0)->GetTile(0)->GetResidentSize());
+
+  // The tuples can be written from the file, the tile group stays evicted
+  CopySerializeOutput output;
+  EXPECT_TRUE(evictor.SerializeEvictedTuples(
+      data_table->PeekTileGroup(1).get(), tuple_slots, output));
+  ASSERT_EQ(expected_output.Size(), output.Size());
+  EXPECT_EQ(0, memcmp(expected_output.Data(), output.Data(), output.Size()));
+  EXPECT_TRUE(data_table->PeekTileGroup(1)->IsEvicted());
+  EXPECT_EQ(0U, evictor.GetStats().fault_in_count);
+
+  // Looking the tile group up brings it back
+  tile_group = data_table->GetTileGroup(0);
+  EXPECT_FALSE(tile_group->IsEvicted());
+  EXPECT_EQ(0, value.Compare(tile_group->GetValue(1, 2)));
+  EXPECT_TRUE(data_table->PeekTileGroup(1)->IsEvicted());
+  output.Reset();
+  EXPECT_FALSE(evictor.SerializeEvictedTuples(tile_group.get(), tuple_slots,
+                                              output));
+  EXPECT_EQ(0U, output.Size());
+
+  auto stats = evictor.GetStats();
+  EXPECT_EQ(2U, stats.eviction_count);
+  EXPECT_EQ(1U, stats.fault_in_count);
+  EXPECT_EQ(1U, stats.evicted_tile_group_count);
+
+  // Dropping the table forgets the copy that is left
+  manager.DropDatabaseWithOid(database_oid);
+  EXPECT_EQ(0U, evictor.GetStats().evicted_tile_group_count);
+}
+
+}  // End test namespace
+}  // End peloton namespace
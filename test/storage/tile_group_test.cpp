@@ -13,15 +13,21 @@
 
 #include "common/harness.h"
 
+#include "common/serializer.h"
 #include "common/value_factory.h"
+#include "common/value_peeker.h"
 #include "concurrency/transaction.h"
 #include "concurrency/transaction_manager_factory.h"
+#include "executor/executor_tests_util.h"
+#include "storage/data_table.h"
 #include "storage/tile_group.h"
 #include "storage/tile_group_factory.h"
 #include "storage/tile.h"
 #include "storage/tuple.h"
 #include "storage/tile_group.h"
 #include "storage/tile_group_header.h"
+#include "storage/storage_manager.h"
+#include "storage/zone_map.h"
 
 namespace peloton {
 namespace test {
@@ -346,6 +352,220 @@ TEST_F(TileGroupTests, StressTest) {
 //  delete schema2;
 //}
 
+TEST_F(TileGroupTests, HeaderLayoutTest) {
+  const oid_t tuple_count = 100;
+  storage::TileGroupHeader header(BACKEND_TYPE_MM, tuple_count);
+
+  for (oid_t tuple_slot_id = 0; tuple_slot_id < tuple_count;
+       tuple_slot_id++) {
+    EXPECT_EQ(INVALID_TXN_ID, header.GetTransactionId(tuple_slot_id));
+    EXPECT_EQ(MAX_CID, header.GetBeginCommitId(tuple_slot_id));
+    EXPECT_EQ(MAX_CID, header.GetEndCommitId(tuple_slot_id));
+    EXPECT_TRUE(header.GetNextItemPointer(tuple_slot_id).IsNull());
+
+    header.SetTransactionId(tuple_slot_id, tuple_slot_id + 1);
+    header.SetBeginCommitId(tuple_slot_id, tuple_slot_id + 2);
+    header.SetEndCommitId(tuple_slot_id, tuple_slot_id + 3);
+    header.SetNextItemPointer(tuple_slot_id, ItemPointer(tuple_slot_id, 4));
+    header.SetPrevItemPointer(tuple_slot_id, ItemPointer(tuple_slot_id, 5));
+    header.SetInsertCommit(tuple_slot_id, true);
+    PL_MEMSET(header.GetReservedFieldRef(tuple_slot_id), 0xff,
+              storage::TileGroupHeader::GetReservedSize());
+  }
+
+  // No field overlaps another one, of this slot or of its neighbours
+  for (oid_t tuple_slot_id = 0; tuple_slot_id < tuple_count;
+       tuple_slot_id++) {
+    EXPECT_EQ(tuple_slot_id + 1, header.GetTransactionId(tuple_slot_id));
+    EXPECT_EQ(tuple_slot_id + 2, header.GetBeginCommitId(tuple_slot_id));
+    EXPECT_EQ(tuple_slot_id + 3, header.GetEndCommitId(tuple_slot_id));
+    EXPECT_EQ(4U, header.GetNextItemPointer(tuple_slot_id).offset);
+    EXPECT_EQ(5U, header.GetPrevItemPointer(tuple_slot_id).offset);
+    EXPECT_TRUE(header.GetInsertCommit(tuple_slot_id));
+    EXPECT_FALSE(header.GetDeleteCommit(tuple_slot_id));
+  }
+
+  // A slot takes no more room than in a single entry
+  size_t header_entry_size = storage::TileGroupHeader::header_entry_size;
+  EXPECT_EQ(66U, header_entry_size);
+
+  // Every array starts on a cache line, and no txn id or commit id of a
+  // slot straddles two of them
+  std::vector<storage::SyncRange> ranges;
+  header.GetSyncRanges(0, tuple_count, ranges);
+  ASSERT_EQ(7U, ranges.size());
+  for (auto &range : ranges) {
+    EXPECT_EQ(0U,
+              reinterpret_cast<uintptr_t>(range.address) % CACHELINE_SIZE);
+  }
+  for (oid_t tuple_slot_id = 0; tuple_slot_id < tuple_count;
+       tuple_slot_id++) {
+    auto address = reinterpret_cast<uintptr_t>(
+        header.GetTransactionIdLocation(tuple_slot_id));
+    EXPECT_EQ(address / CACHELINE_SIZE,
+              (address + sizeof(txn_id_t) - 1) / CACHELINE_SIZE);
+  }
+}
+
+TEST_F(TileGroupTests, CopyTuplesTest) {
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  catalog::Column column2(VALUE_TYPE_BIGINT, GetTypeSize(VALUE_TYPE_BIGINT),
+                          "B", true);
+  catalog::Column column3(VALUE_TYPE_TINYINT, GetTypeSize(VALUE_TYPE_TINYINT),
+                          "C", true);
+  catalog::Column column4(VALUE_TYPE_VARCHAR, 25, "D", false);
+  catalog::Schema schema({column1, column2, column3, column4});
+
+  // Columns are spread over the tiles out of order
+  std::vector<catalog::Schema> schemas;
+  schemas.push_back(catalog::Schema({column1, column3}));
+  schemas.push_back(catalog::Schema({column2, column4}));
+  storage::column_map_type column_map;
+  column_map[0] = std::make_pair(0, 0);
+  column_map[1] = std::make_pair(1, 0);
+  column_map[2] = std::make_pair(0, 1);
+  column_map[3] = std::make_pair(1, 1);
+
+  const oid_t tuple_count = 10;
+  std::shared_ptr<storage::TileGroup> tile_group(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          column_map, tuple_count));
+
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  std::vector<const storage::Tuple *> tuple_ptrs;
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count - 1; tuple_itr++) {
+    std::unique_ptr<storage::Tuple> tuple(new storage::Tuple(&schema, true));
+    tuple->SetValue(0, ValueFactory::GetIntegerValue(tuple_itr), pool);
+    tuple->SetValue(1, ValueFactory::GetBigIntValue(tuple_itr * 1000L), pool);
+    tuple->SetValue(2, ValueFactory::GetTinyIntValue(tuple_itr % 3), pool);
+    if (tuple_itr % 2) {
+      tuple->SetValue(3, ValueFactory::GetNullStringValue(), pool);
+    } else {
+      tuple->SetValue(
+          3, ValueFactory::GetStringValue("row " + std::to_string(tuple_itr)),
+          pool);
+    }
+    tuple_ptrs.push_back(tuple.get());
+    tuples.push_back(std::move(tuple));
+  }
+
+  // All but the first slot
+  tile_group->CopyTuples(tuple_ptrs.data(), tuple_ptrs.size(), 1);
+
+  // The tuples go away, their strings stay in the tiles
+  tuples.clear();
+
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count - 1; tuple_itr++) {
+    auto tile_tuple_id = tuple_itr + 1;
+    auto tile0 = tile_group->GetTile(0);
+    auto tile1 = tile_group->GetTile(1);
+    EXPECT_EQ(static_cast<int32_t>(tuple_itr),
+              ValuePeeker::PeekInteger(tile0->GetValue(tile_tuple_id, 0)));
+    EXPECT_EQ(static_cast<int64_t>(tuple_itr * 1000L),
+              ValuePeeker::PeekBigInt(tile1->GetValue(tile_tuple_id, 0)));
+    EXPECT_EQ(static_cast<int8_t>(tuple_itr % 3),
+              ValuePeeker::PeekTinyInt(tile0->GetValue(tile_tuple_id, 1)));
+    auto string_value = tile1->GetValue(tile_tuple_id, 1);
+    if (tuple_itr % 2) {
+      EXPECT_TRUE(string_value.IsNull());
+    } else {
+      EXPECT_EQ(0, string_value.Compare(ValueFactory::GetStringValue(
+                       "row " + std::to_string(tuple_itr))));
+    }
+  }
+
+  // Overwriting a slot in place gives its old string back to the pool
+  auto tile_pool = tile_group->GetTile(1)->GetPool();
+  storage::Tuple tuple(&schema, true);
+  tuple.SetValue(0, ValueFactory::GetIntegerValue(0), pool);
+  tuple.SetValue(1, ValueFactory::GetBigIntValue(0), pool);
+  tuple.SetValue(2, ValueFactory::GetTinyIntValue(0), pool);
+  tuple.SetValue(3, ValueFactory::GetStringValue("first version"), pool);
+  tile_group->CopyTuple(&tuple, 2);
+
+  // The new string is cloned before the old one is freed
+  tile_group->CopyTuple(&tuple, 2);
+  auto memory = tile_pool->GetAllocatedMemory();
+  for (int version_itr = 0; version_itr < 100; version_itr++) {
+    tuple.SetValue(3, ValueFactory::GetStringValue(
+                          "version " + std::to_string(version_itr)),
+                   pool);
+    tile_group->CopyTuple(&tuple, 2);
+  }
+  EXPECT_EQ(memory, tile_pool->GetAllocatedMemory());
+  EXPECT_EQ(0, tile_group->GetTile(1)->GetValue(2, 1).Compare(
+                   ValueFactory::GetStringValue("version 99")));
+}
+
+TEST_F(TileGroupTests, RecoveryReplayTest) {
+  const oid_t tuple_count = 10;
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(tuple_count, false));
+  auto schema = table->GetSchema();
+
+  // The tiles hold the columns in reverse table order
+  std::vector<catalog::Schema> schemas;
+  schemas.push_back(catalog::Schema({schema->GetColumn(3),
+                                     schema->GetColumn(2)}));
+  schemas.push_back(catalog::Schema({schema->GetColumn(1),
+                                     schema->GetColumn(0)}));
+  storage::column_map_type column_map;
+  column_map[0] = std::make_pair(1, 1);
+  column_map[1] = std::make_pair(1, 0);
+  column_map[2] = std::make_pair(0, 1);
+  column_map[3] = std::make_pair(0, 0);
+
+  std::shared_ptr<storage::TileGroup> tile_group(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), table.get(),
+          schemas, column_map, tuple_count));
+
+  // Tuples are logged in table order
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  const cid_t commit_id = 5;
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    storage::Tuple tuple(schema, true);
+    tuple.SetValue(0, ValueFactory::GetIntegerValue(tuple_itr), pool);
+    tuple.SetValue(1, ValueFactory::GetIntegerValue(tuple_itr * 10), pool);
+    tuple.SetValue(2, ValueFactory::GetDoubleValue(tuple_itr * 1.5), pool);
+    tuple.SetValue(
+        3, ValueFactory::GetStringValue("row " + std::to_string(tuple_itr)),
+        pool);
+
+    CopySerializeOutput output;
+    tuple.SerializeTo(output);
+    ReferenceSerializeInputBE input(output.Data(), output.Size());
+    EXPECT_EQ(tuple_itr,
+              tile_group->InsertTupleFromRecovery(commit_id, tuple_itr, input));
+  }
+
+  auto tile_group_header = tile_group->GetHeader();
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    EXPECT_EQ(commit_id, tile_group_header->GetBeginCommitId(tuple_itr));
+    EXPECT_EQ(static_cast<int32_t>(tuple_itr),
+              ValuePeeker::PeekInteger(tile_group->GetValue(tuple_itr, 0)));
+    EXPECT_EQ(static_cast<int32_t>(tuple_itr * 10),
+              ValuePeeker::PeekInteger(tile_group->GetValue(tuple_itr, 1)));
+    EXPECT_EQ(tuple_itr * 1.5,
+              ValuePeeker::PeekDouble(tile_group->GetValue(tuple_itr, 2)));
+    EXPECT_EQ(0, tile_group->GetValue(tuple_itr, 3).Compare(
+                     ValueFactory::GetStringValue("row " +
+                                                  std::to_string(tuple_itr))));
+  }
+
+  // The replayed tuples are covered by the zone map
+  auto zone_map = tile_group->GetZoneMap();
+  EXPECT_EQ(tuple_count, zone_map->GetTupleCount());
+  EXPECT_EQ(0, ValuePeeker::PeekInteger(zone_map->GetMin(1)));
+  EXPECT_EQ(static_cast<int32_t>((tuple_count - 1) * 10),
+            ValuePeeker::PeekInteger(zone_map->GetMax(1)));
+}
+
 TEST_F(TileGroupTests, TileCopyTest) {
   std::vector<catalog::Column> columns;
   std::vector<std::string> tile_column_names;
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// zone_map_test.cpp
+//
+// Identification: test/storage/zone_map_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <memory>
+#include <string>
+
+#include "common/harness.h"
+
+#include "common/value_factory.h"
+#include "common/value_peeker.h"
+#include "expression/abstract_expression.h"
+#include "expression/expression_util.h"
+#include "storage/tile_group.h"
+#include "storage/tile_group_factory.h"
+#include "storage/tuple.h"
+#include "storage/zone_map.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Zone Map Tests
+//===--------------------------------------------------------------------===//
+
+class ZoneMapTests : public PelotonTest {};
+
+// Column B compared with a constant
+static expression::AbstractExpression *Compare(ExpressionType type,
+                                               int64_t constant) {
+  return expression::ExpressionUtil::ComparisonFactory(
+      type, expression::ExpressionUtil::TupleValueFactory(VALUE_TYPE_BIGINT, 0,
+                                                          1),
+      expression::ExpressionUtil::ConstantValueFactory(
+          ValueFactory::GetBigIntValue(constant)));
+}
+
+static bool CouldMatch(storage::TileGroup *tile_group,
+                       expression::AbstractExpression *predicate) {
+  std::unique_ptr<expression::AbstractExpression> owned_predicate(predicate);
+  return tile_group->GetZoneMap()->CouldMatch(predicate, nullptr);
+}
+
+TEST_F(ZoneMapTests, BasicTest) {
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  catalog::Column column2(VALUE_TYPE_BIGINT, GetTypeSize(VALUE_TYPE_BIGINT),
+                          "B", true);
+  catalog::Column column3(VALUE_TYPE_VARCHAR, 25, "C", false);
+  catalog::Schema schema({column1, column2, column3});
+
+  std::vector<catalog::Schema> schemas;
+  schemas.push_back(catalog::Schema({column1}));
+  schemas.push_back(catalog::Schema({column2, column3}));
+  storage::column_map_type column_map;
+  column_map[0] = std::make_pair(0, 0);
+  column_map[1] = std::make_pair(1, 0);
+  column_map[2] = std::make_pair(1, 1);
+
+  const oid_t tuple_count = 100;
+  std::shared_ptr<storage::TileGroup> tile_group(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          column_map, tuple_count));
+
+  // Nothing written yet, so nothing matches
+  auto zone_map = tile_group->GetZoneMap();
+  EXPECT_EQ(0U, zone_map->GetTupleCount());
+  EXPECT_FALSE(CouldMatch(tile_group.get(),
+                          Compare(EXPRESSION_TYPE_COMPARE_EQUAL, 1000)));
+
+  // Column A is always null, B covers [1000, 1099]
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    storage::Tuple tuple(&schema, true);
+    tuple.SetValue(0, ValueFactory::GetNullValue(), pool);
+    tuple.SetValue(1, ValueFactory::GetBigIntValue(1099 - tuple_itr), pool);
+    tuple.SetValue(2, ValueFactory::GetStringValue(std::to_string(tuple_itr)),
+                   pool);
+    EXPECT_EQ(tuple_itr, tile_group->InsertTuple(&tuple));
+  }
+
+  EXPECT_EQ(tuple_count, zone_map->GetTupleCount());
+  EXPECT_FALSE(zone_map->HasRange(0));
+  EXPECT_EQ(tuple_count, zone_map->GetNullCount(0));
+  EXPECT_EQ(1000, ValuePeeker::PeekBigInt(zone_map->GetMin(1)));
+  EXPECT_EQ(1099, ValuePeeker::PeekBigInt(zone_map->GetMax(1)));
+  EXPECT_FALSE(zone_map->IsTracked(2));
+
+  EXPECT_TRUE(CouldMatch(tile_group.get(),
+                         Compare(EXPRESSION_TYPE_COMPARE_EQUAL, 1050)));
+  EXPECT_FALSE(CouldMatch(tile_group.get(),
+                          Compare(EXPRESSION_TYPE_COMPARE_EQUAL, 1100)));
+  EXPECT_TRUE(CouldMatch(tile_group.get(),
+                         Compare(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                 1000)));
+  EXPECT_FALSE(CouldMatch(tile_group.get(),
+                          Compare(EXPRESSION_TYPE_COMPARE_LESSTHAN, 1000)));
+  EXPECT_FALSE(CouldMatch(tile_group.get(),
+                          Compare(EXPRESSION_TYPE_COMPARE_GREATERTHAN, 1099)));
+  EXPECT_TRUE(CouldMatch(
+      tile_group.get(),
+      Compare(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, 1099)));
+
+  // A constant on the left
+  EXPECT_FALSE(CouldMatch(
+      tile_group.get(),
+      expression::ExpressionUtil::ComparisonFactory(
+          EXPRESSION_TYPE_COMPARE_LESSTHAN,
+          expression::ExpressionUtil::ConstantValueFactory(
+              ValueFactory::GetIntegerValue(2000)),
+          expression::ExpressionUtil::TupleValueFactory(VALUE_TYPE_BIGINT, 0,
+                                                        1))));
+
+  // Both sides of a conjunction have to match, one of a disjunction
+  EXPECT_FALSE(CouldMatch(
+      tile_group.get(),
+      expression::ExpressionUtil::ConjunctionFactory(
+          EXPRESSION_TYPE_CONJUNCTION_AND,
+          Compare(EXPRESSION_TYPE_COMPARE_GREATERTHAN, 1010),
+          Compare(EXPRESSION_TYPE_COMPARE_LESSTHAN, 990))));
+  EXPECT_TRUE(CouldMatch(
+      tile_group.get(),
+      expression::ExpressionUtil::ConjunctionFactory(
+          EXPRESSION_TYPE_CONJUNCTION_OR,
+          Compare(EXPRESSION_TYPE_COMPARE_GREATERTHAN, 1010),
+          Compare(EXPRESSION_TYPE_COMPARE_LESSTHAN, 990))));
+
+  // A column that is all null matches no comparison
+  EXPECT_FALSE(CouldMatch(
+      tile_group.get(),
+      expression::ExpressionUtil::ComparisonFactory(
+          EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+          expression::ExpressionUtil::TupleValueFactory(VALUE_TYPE_INTEGER, 0,
+                                                        0),
+          expression::ExpressionUtil::ConstantValueFactory(
+              ValueFactory::GetIntegerValue(1)))));
+
+  // Strings are not tracked
+  EXPECT_TRUE(CouldMatch(
+      tile_group.get(),
+      expression::ExpressionUtil::ComparisonFactory(
+          EXPRESSION_TYPE_COMPARE_EQUAL,
+          expression::ExpressionUtil::TupleValueFactory(VALUE_TYPE_VARCHAR, 0,
+                                                        2),
+          expression::ExpressionUtil::ConstantValueFactory(
+              ValueFactory::GetStringValue("none")))));
+
+  // Rebuilding gives the same ranges
+  tile_group->RebuildZoneMap();
+  EXPECT_EQ(tuple_count, zone_map->GetTupleCount());
+  EXPECT_EQ(1000, ValuePeeker::PeekBigInt(zone_map->GetMin(1)));
+  EXPECT_EQ(1099, ValuePeeker::PeekBigInt(zone_map->GetMax(1)));
+  EXPECT_EQ(tuple_count, zone_map->GetNullCount(0));
+}
+
+TEST_F(ZoneMapTests, RawTypesTest) {
+  catalog::Column column1(VALUE_TYPE_SMALLINT,
+                          GetTypeSize(VALUE_TYPE_SMALLINT), "A", true);
+  catalog::Column column2(VALUE_TYPE_DOUBLE, GetTypeSize(VALUE_TYPE_DOUBLE),
+                          "B", true);
+  catalog::Column column3(VALUE_TYPE_TIMESTAMP,
+                          GetTypeSize(VALUE_TYPE_TIMESTAMP), "C", true);
+  catalog::Schema schema({column1, column2, column3});
+
+  std::vector<catalog::Schema> schemas;
+  schemas.push_back(schema);
+  storage::column_map_type column_map;
+  column_map[0] = std::make_pair(0, 0);
+  column_map[1] = std::make_pair(0, 1);
+  column_map[2] = std::make_pair(0, 2);
+
+  const oid_t tuple_count = 10;
+  std::shared_ptr<storage::TileGroup> tile_group(
+      storage::TileGroupFactory::GetTileGroup(
+          INVALID_OID, INVALID_OID,
+          TestingHarness::GetInstance().GetNextTileGroupId(), nullptr, schemas,
+          column_map, tuple_count));
+
+  // Every other value of A is null
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    storage::Tuple tuple(&schema, true);
+    if (tuple_itr % 2 == 0) {
+      tuple.SetValue(0, ValueFactory::GetNullValue(), pool);
+    } else {
+      tuple.SetValue(
+          0, ValueFactory::GetSmallIntValue(-static_cast<int16_t>(tuple_itr)),
+          pool);
+    }
+    tuple.SetValue(1, ValueFactory::GetDoubleValue(tuple_itr * 0.5), pool);
+    tuple.SetValue(2, ValueFactory::GetTimestampValue(1000 + tuple_itr), pool);
+    EXPECT_EQ(tuple_itr, tile_group->InsertTuple(&tuple));
+  }
+
+  auto zone_map = tile_group->GetZoneMap();
+  EXPECT_EQ(tuple_count, zone_map->GetTupleCount());
+  EXPECT_EQ(tuple_count / 2, zone_map->GetNullCount(0));
+  EXPECT_EQ(-9, ValuePeeker::PeekSmallInt(zone_map->GetMin(0)));
+  EXPECT_EQ(-1, ValuePeeker::PeekSmallInt(zone_map->GetMax(0)));
+  EXPECT_EQ(0, zone_map->GetNullCount(1));
+  EXPECT_EQ(0.0, ValuePeeker::PeekDouble(zone_map->GetMin(1)));
+  EXPECT_EQ(4.5, ValuePeeker::PeekDouble(zone_map->GetMax(1)));
+  EXPECT_EQ(1000, ValuePeeker::PeekTimestamp(zone_map->GetMin(2)));
+  EXPECT_EQ(1009, ValuePeeker::PeekTimestamp(zone_map->GetMax(2)));
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// admission_control_test.cpp
+//
+// Identification: test/tcop/admission_control_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "common/harness.h"
+
+#include "planner/limit_plan.h"
+#include "planner/order_by_plan.h"
+#include "tcop/admission_control.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Admission Control Tests
+//===--------------------------------------------------------------------===//
+
+class AdmissionControlTests : public PelotonTest {};
+
+TEST_F(AdmissionControlTests, CapacityTest) {
+  tcop::AdmissionControl admission_control(2, 1, 10);
+
+  EXPECT_TRUE(admission_control.Admit(tcop::QUERY_CLASS_ANALYTIC));
+  EXPECT_TRUE(admission_control.Admit(tcop::QUERY_CLASS_OLTP));
+
+  // Full, nobody gives a slot back in time
+  EXPECT_FALSE(admission_control.Admit(tcop::QUERY_CLASS_OLTP));
+
+  // A free slot, but the analytic bound is reached
+  admission_control.Release(tcop::QUERY_CLASS_OLTP);
+  EXPECT_FALSE(admission_control.Admit(tcop::QUERY_CLASS_ANALYTIC));
+  EXPECT_TRUE(admission_control.Admit(tcop::QUERY_CLASS_OLTP));
+
+  auto stats = admission_control.GetStats();
+  EXPECT_EQ(2U, stats.admitted_count[tcop::QUERY_CLASS_OLTP]);
+  EXPECT_EQ(1U, stats.admitted_count[tcop::QUERY_CLASS_ANALYTIC]);
+  EXPECT_EQ(1U, stats.timeout_count[tcop::QUERY_CLASS_OLTP]);
+  EXPECT_EQ(1U, stats.timeout_count[tcop::QUERY_CLASS_ANALYTIC]);
+  EXPECT_EQ(2U, stats.active_count);
+  EXPECT_EQ(0U, stats.waiting_count);
+
+  // No bound at all
+  tcop::AdmissionControl unbounded(0, 0, 10);
+  for (int query_itr = 0; query_itr < 100; query_itr++) {
+    EXPECT_TRUE(unbounded.Admit(tcop::QUERY_CLASS_ANALYTIC));
+  }
+}
+
+TEST_F(AdmissionControlTests, HandOffTest) {
+  tcop::AdmissionControl admission_control(1, 1, 10000);
+  EXPECT_TRUE(admission_control.Admit(tcop::QUERY_CLASS_OLTP));
+
+  // An analytic query queues first, an OLTP one after it
+  std::atomic<int> admitted_order(0);
+  int analytic_order = 0, oltp_order = 0;
+  std::thread analytic_thread([&]() {
+    EXPECT_TRUE(admission_control.Admit(tcop::QUERY_CLASS_ANALYTIC));
+    analytic_order = ++admitted_order;
+    admission_control.Release(tcop::QUERY_CLASS_ANALYTIC);
+  });
+  while (admission_control.GetStats().waiting_count < 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::thread oltp_thread([&]() {
+    EXPECT_TRUE(admission_control.Admit(tcop::QUERY_CLASS_OLTP));
+    oltp_order = ++admitted_order;
+    admission_control.Release(tcop::QUERY_CLASS_OLTP);
+  });
+  while (admission_control.GetStats().waiting_count < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // The slot goes to the OLTP query, then on to the analytic one
+  admission_control.Release(tcop::QUERY_CLASS_OLTP);
+  analytic_thread.join();
+  oltp_thread.join();
+  EXPECT_EQ(1, oltp_order);
+  EXPECT_EQ(2, analytic_order);
+
+  auto stats = admission_control.GetStats();
+  EXPECT_EQ(1U, stats.queued_count[tcop::QUERY_CLASS_OLTP]);
+  EXPECT_EQ(1U, stats.queued_count[tcop::QUERY_CLASS_ANALYTIC]);
+  EXPECT_EQ(0U, stats.active_count);
+}
+
+TEST_F(AdmissionControlTests, GuardTest) {
+  tcop::AdmissionControl admission_control(1, 1, 10);
+  EXPECT_EQ(nullptr, tcop::AdmissionGuard::GetCurrent());
+
+  // The slot is given back when the query leaves with an exception
+  try {
+    tcop::AdmissionGuard admission(admission_control, tcop::QUERY_CLASS_OLTP);
+    EXPECT_TRUE(admission.IsAdmitted());
+    EXPECT_EQ(&admission, tcop::AdmissionGuard::GetCurrent());
+    throw std::runtime_error("query failed");
+  } catch (std::runtime_error &) {
+  }
+  EXPECT_EQ(nullptr, tcop::AdmissionGuard::GetCurrent());
+  EXPECT_EQ(0U, admission_control.GetStats().active_count);
+
+  // A suspended query lets another one run, and only resumes once it is done
+  tcop::AdmissionGuard admission(admission_control, tcop::QUERY_CLASS_OLTP);
+  EXPECT_TRUE(admission.IsAdmitted());
+  admission.Suspend();
+  EXPECT_FALSE(admission.IsAdmitted());
+  {
+    tcop::AdmissionGuard other(admission_control, tcop::QUERY_CLASS_OLTP);
+    EXPECT_TRUE(other.IsAdmitted());
+    EXPECT_FALSE(admission.Resume());
+  }
+  EXPECT_TRUE(admission.Resume());
+  EXPECT_EQ(1U, admission_control.GetStats().active_count);
+}
+
+TEST_F(AdmissionControlTests, ClassifyTest) {
+  planner::LimitPlan limit_plan(1, 0);
+  EXPECT_EQ(tcop::QUERY_CLASS_OLTP, tcop::AdmissionControl::Classify(
+                                        &limit_plan));
+
+  // A sort anywhere in the tree makes an analytic query
+  std::unique_ptr<planner::AbstractPlan> order_by_plan(
+      new planner::OrderByPlan({0}, {false}, {0}));
+  limit_plan.AddChild(std::move(order_by_plan));
+  EXPECT_EQ(tcop::QUERY_CLASS_ANALYTIC,
+            tcop::AdmissionControl::Classify(&limit_plan));
+}
+
+}  // End test namespace
+}  // End peloton namespace
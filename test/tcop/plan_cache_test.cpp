@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// plan_cache_test.cpp
+//
+// Identification: test/tcop/plan_cache_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "common/harness.h"
+
+#include "catalog/manager.h"
+#include "planner/limit_plan.h"
+#include "tcop/plan_cache.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Plan Cache Tests
+//===--------------------------------------------------------------------===//
+
+class PlanCacheTests : public PelotonTest {};
+
+TEST_F(PlanCacheTests, FingerprintTest) {
+  auto fingerprint = tcop::PlanCache::GetFingerprint(
+      "  SELECT a,\n\tb FROM  Foo -- comment\n WHERE b = 'Bar  Baz';");
+  EXPECT_EQ("select a, b from foo where b = 'Bar  Baz'", fingerprint);
+
+  // Same statement, different spelling
+  EXPECT_EQ(fingerprint,
+            tcop::PlanCache::GetFingerprint(
+                "select /* all */ a, b from foo where b = 'Bar  Baz'"));
+
+  // Literals are part of the statement
+  EXPECT_NE(fingerprint, tcop::PlanCache::GetFingerprint(
+                             "select a, b from foo where b = 'bar  baz'"));
+
+  // Dollar quoted bodies are literals as well
+  EXPECT_EQ("select $$Foo$$, $Tag$Bar; $Tag$ from t",
+            tcop::PlanCache::GetFingerprint(
+                "SELECT $$Foo$$, $Tag$Bar; $Tag$ FROM T"));
+  EXPECT_NE(tcop::PlanCache::GetFingerprint("SELECT $$Foo$$"),
+            tcop::PlanCache::GetFingerprint("SELECT $$foo$$"));
+
+  // An escaped quote does not end the literal
+  EXPECT_EQ("select e'It\\'s A' from t",
+            tcop::PlanCache::GetFingerprint("SELECT e'It\\'s A' FROM T;"));
+  EXPECT_NE(tcop::PlanCache::GetFingerprint("SELECT E'\\'A'"),
+            tcop::PlanCache::GetFingerprint("SELECT E'\\'a'"));
+
+  // Quoted identifiers keep their case, plain ones do not
+  EXPECT_EQ("select \"MixedCase\", plain from t",
+            tcop::PlanCache::GetFingerprint(
+                "SELECT \"MixedCase\", Plain FROM T"));
+}
+
+TEST_F(PlanCacheTests, HitMissTest) {
+  tcop::PlanCache plan_cache(PLAN_CACHE_SHARD_COUNT);
+  auto &manager = catalog::Manager::GetInstance();
+
+  std::shared_ptr<planner::AbstractPlan> plan(new planner::LimitPlan(1, 0));
+  EXPECT_TRUE(plan_cache.Find("select 1") == nullptr);
+
+  plan_cache.Insert("select 1", plan, manager.GetCatalogVersion());
+  EXPECT_EQ(plan.get(), plan_cache.Find("select 1").get());
+  EXPECT_EQ(plan.get(), plan_cache.Find("select 1").get());
+
+  auto stats = plan_cache.GetStats();
+  EXPECT_EQ(2U, stats.hit_count);
+  EXPECT_EQ(1U, stats.miss_count);
+  EXPECT_EQ(1U, stats.entry_count);
+
+  // DDL makes the plan stale
+  manager.IncrementCatalogVersion();
+  EXPECT_TRUE(plan_cache.Find("select 1") == nullptr);
+
+  stats = plan_cache.GetStats();
+  EXPECT_EQ(1U, stats.invalidation_count);
+  EXPECT_EQ(0U, stats.entry_count);
+}
+
+TEST_F(PlanCacheTests, EvictionTest) {
+  // one plan per shard
+  tcop::PlanCache plan_cache(PLAN_CACHE_SHARD_COUNT);
+  auto catalog_version = catalog::Manager::GetInstance().GetCatalogVersion();
+
+  const int plan_count = 10 * PLAN_CACHE_SHARD_COUNT;
+  for (int plan_itr = 0; plan_itr < plan_count; plan_itr++) {
+    std::shared_ptr<planner::AbstractPlan> plan(
+        new planner::LimitPlan(plan_itr, 0));
+    plan_cache.Insert("select " + std::to_string(plan_itr), plan,
+                      catalog_version);
+  }
+
+  auto stats = plan_cache.GetStats();
+  EXPECT_GE(static_cast<size_t>(PLAN_CACHE_SHARD_COUNT), stats.entry_count);
+  EXPECT_EQ(plan_count - stats.entry_count, stats.eviction_count);
+
+  // A disabled cache keeps nothing
+  tcop::PlanCache disabled_cache(0);
+  std::shared_ptr<planner::AbstractPlan> plan(new planner::LimitPlan(1, 0));
+  disabled_cache.Insert("select 1", plan, catalog_version);
+  EXPECT_TRUE(disabled_cache.Find("select 1") == nullptr);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// copy_test.cpp
+//
+// Identification: test/wire/copy_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/harness.h"
+
+#include "executor/plan_executor.h"
+#include "index/index.h"
+#include "planner/seq_scan_plan.h"
+#include "storage/data_table.h"
+#include "wire/copy.h"
+#include "wire/marshal.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Copy Tests
+//===--------------------------------------------------------------------===//
+
+class CopyTests : public PelotonTest {};
+
+// Feed the data in small pieces, so that rows span CopyData messages
+bool LoadData(wire::CopyLoader &loader, const std::string &data) {
+  const size_t piece_size = 7;
+  for (size_t offset = 0; offset < data.size(); offset += piece_size) {
+    size_t len = std::min(piece_size, data.size() - offset);
+    if (loader.Append(reinterpret_cast<const wire::uchar *>(data.data()) +
+                          offset,
+                      len) == false) {
+      return false;
+    }
+  }
+  return loader.Finish();
+}
+
+// Dump all columns of the table and return the payload of the CopyData
+std::string DumpTable(storage::DataTable *table,
+                      const wire::CopyOptions &options, size_t &row_count) {
+  wire::PacketManager packet_manager(nullptr);
+  wire::ResponseBuffer responses;
+  wire::CopyOutSink sink(packet_manager, responses, options);
+
+  std::vector<oid_t> column_ids({0, 1, 2, 3});
+  planner::SeqScanPlan seq_scan_node(table, nullptr, column_ids);
+  std::vector<Value> params;
+  sink.PutHeader();
+  EXPECT_LE(0, bridge::PlanExecutor::ExecutePlan(&seq_scan_node, params, sink));
+  sink.PutTrailer();
+  row_count = sink.GetRowCount();
+
+  std::string data;
+  for (auto &pkt : responses) {
+    if (pkt->framed == false) {
+      EXPECT_EQ('d', pkt->msg_type);
+      data.append(pkt->buf.begin(), pkt->buf.begin() + pkt->len);
+      continue;
+    }
+
+    // back to back CopyData messages
+    size_t offset = 0;
+    while (offset < pkt->len) {
+      EXPECT_EQ('d', pkt->buf[offset]);
+      uint32_t len;
+      std::copy(pkt->buf.begin() + offset + 1,
+                pkt->buf.begin() + offset + 1 + sizeof(len),
+                reinterpret_cast<unsigned char *>(&len));
+      len = ntohl(len);
+      data.append(pkt->buf.begin() + offset + 1 + sizeof(len),
+                  pkt->buf.begin() + offset + 1 + len);
+      offset += 1 + len;
+    }
+  }
+  return data;
+}
+
+TEST_F(CopyTests, CsvLoadAndDumpTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(TESTS_TUPLES_PER_TILEGROUP, true));
+
+  // several tile groups worth of rows, after a header
+  const size_t row_count = 3 * TESTS_TUPLES_PER_TILEGROUP + 2;
+  std::string data = "a,b,c,d\r\n";
+  for (size_t row_itr = 0; row_itr < row_count; row_itr++) {
+    data += std::to_string(row_itr) + "," + std::to_string(row_itr + 1) +
+            ",0.5,\"str," + std::to_string(row_itr) + "\"\n";
+  }
+
+  wire::CopyOptions options;
+  options.format = wire::COPY_FORMAT_CSV;
+  options.delimiter = ',';
+  options.null_string = "";
+  options.header = true;
+
+  wire::CopyLoader loader(table.get(), {0, 1, 2, 3}, options);
+  EXPECT_TRUE(LoadData(loader, data));
+  EXPECT_EQ(row_count, loader.GetRowCount());
+
+  // Every index has an entry per row
+  for (oid_t index_itr = 0; index_itr < table->GetIndexCount(); index_itr++) {
+    std::vector<ItemPointer> locations;
+    table->GetIndex(index_itr)->ScanAllKeys(locations);
+    EXPECT_EQ(row_count, locations.size());
+  }
+
+  size_t dumped_count;
+  options.header = false;
+  auto dump = DumpTable(table.get(), options, dumped_count);
+  EXPECT_EQ(row_count, dumped_count);
+
+  // the delimiter in the string gets it quoted
+  EXPECT_NE(std::string::npos, dump.find("0,1,0.5,\"str,0\"\n"));
+  EXPECT_NE(std::string::npos, dump.find("7,8,0.5,\"str,7\"\n"));
+}
+
+TEST_F(CopyTests, TextFormatTest) {
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(TESTS_TUPLES_PER_TILEGROUP, false));
+
+  // NULL, escapes and the end marker
+  wire::CopyOptions options;
+  std::string data =
+      "1\t\\N\t2.5\tab\\tc\n"
+      "2\t3\t4.5\tx\\\\y\n"
+      "\\.\n"
+      "9\t9\t9\tz\n";
+  wire::CopyLoader loader(table.get(), {0, 1, 2, 3}, options);
+  EXPECT_TRUE(LoadData(loader, data));
+  EXPECT_EQ(2U, loader.GetRowCount());
+
+  size_t dumped_count;
+  auto dump = DumpTable(table.get(), options, dumped_count);
+  EXPECT_EQ(2U, dumped_count);
+  EXPECT_NE(std::string::npos, dump.find("1\t\\N\t2.5\tab\\tc\n"));
+  EXPECT_NE(std::string::npos, dump.find("2\t3\t4.5\tx\\\\y\n"));
+
+  // Malformed rows fail the load
+  wire::CopyLoader bad_value_loader(table.get(), {0, 1, 2, 3}, options);
+  EXPECT_FALSE(LoadData(bad_value_loader, "x\t1\t1\tfoo\n"));
+  EXPECT_FALSE(bad_value_loader.GetErrorMessage().empty());
+
+  wire::CopyLoader missing_column_loader(table.get(), {0, 1, 2, 3}, options);
+  EXPECT_FALSE(LoadData(missing_column_loader, "1\t1\n"));
+  EXPECT_FALSE(missing_column_loader.GetErrorMessage().empty());
+}
+
+TEST_F(CopyTests, BinaryRoundTripTest) {
+  std::unique_ptr<storage::DataTable> source_table(
+      ExecutorTestsUtil::CreateAndPopulateTable());
+  std::unique_ptr<storage::DataTable> target_table(
+      ExecutorTestsUtil::CreateTable(TESTS_TUPLES_PER_TILEGROUP, true));
+
+  wire::CopyOptions options;
+  options.format = wire::COPY_FORMAT_BINARY;
+
+  size_t source_count;
+  auto dump = DumpTable(source_table.get(), options, source_count);
+  EXPECT_LT(0U, source_count);
+
+  wire::CopyLoader loader(target_table.get(), {0, 1, 2, 3}, options);
+  EXPECT_TRUE(LoadData(loader, dump));
+  EXPECT_EQ(source_count, loader.GetRowCount());
+
+  // Dumping the copy gives the same data
+  size_t target_count;
+  EXPECT_EQ(dump, DumpTable(target_table.get(), options, target_count));
+  EXPECT_EQ(source_count, target_count);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// data_row_encoder_test.cpp
+//
+// Identification: test/wire/data_row_encoder_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include "common/harness.h"
+
+#include "common/pool.h"
+#include "common/value_factory.h"
+#include "common/value_peeker.h"
+#include "wire/marshal.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Data Row Encoder Tests
+//===--------------------------------------------------------------------===//
+
+class DataRowEncoderTests : public PelotonTest {};
+
+// Read a 32-bit int in network byte order
+int32_t GetInt(const wire::PktBuf &buf, size_t offset) {
+  uint32_t value;
+  std::copy(buf.begin() + offset, buf.begin() + offset + sizeof(value),
+            reinterpret_cast<unsigned char *>(&value));
+  return ntohl(value);
+}
+
+// Read one attribute and move the offset past it
+std::string GetAttribute(const wire::PktBuf &buf, size_t &offset) {
+  int32_t len = GetInt(buf, offset);
+  offset += sizeof(int32_t);
+  if (len < 0) return "<NULL>";
+
+  std::string attribute(buf.begin() + offset, buf.begin() + offset + len);
+  offset += len;
+  return attribute;
+}
+
+TEST_F(DataRowEncoderTests, EncodeRowsTest) {
+  wire::PktBuf buf;
+  wire::DataRowEncoder encoder(buf);
+
+  const int colcount = 6;
+  for (int row_itr = 0; row_itr < 2; row_itr++) {
+    encoder.BeginRow(colcount);
+    encoder.PutValue(ValueFactory::GetIntegerValue(-42 * row_itr));
+    encoder.PutValue(ValueFactory::GetBigIntValue(INT64_MAX));
+    encoder.PutValue(ValueFactory::GetDoubleValue(0.5));
+    encoder.PutValue(ValueFactory::GetBooleanValue(row_itr == 0));
+    encoder.PutValue(ValueFactory::GetStringValue("peloton"));
+    encoder.PutValue(ValueFactory::GetNullValueByType(VALUE_TYPE_INTEGER));
+    encoder.EndRow();
+  }
+
+  size_t offset = 0;
+  for (int row_itr = 0; row_itr < 2; row_itr++) {
+    size_t row_begin = offset;
+    EXPECT_EQ('D', buf[offset]);
+    offset++;
+
+    // the length covers everything but the type byte
+    int32_t row_len = GetInt(buf, offset);
+    offset += sizeof(int32_t);
+
+    int16_t row_colcount;
+    std::copy(buf.begin() + offset, buf.begin() + offset + sizeof(int16_t),
+              reinterpret_cast<unsigned char *>(&row_colcount));
+    EXPECT_EQ(colcount, ntohs(row_colcount));
+    offset += sizeof(int16_t);
+
+    EXPECT_EQ(std::to_string(-42 * row_itr), GetAttribute(buf, offset));
+    EXPECT_EQ(std::to_string(INT64_MAX), GetAttribute(buf, offset));
+    EXPECT_EQ("0.5", GetAttribute(buf, offset));
+    EXPECT_EQ(row_itr == 0 ? "t" : "f", GetAttribute(buf, offset));
+    EXPECT_EQ("peloton", GetAttribute(buf, offset));
+    EXPECT_EQ("<NULL>", GetAttribute(buf, offset));
+
+    EXPECT_EQ(row_begin + 1 + row_len, offset);
+  }
+
+  EXPECT_EQ(buf.size(), offset);
+}
+
+TEST_F(DataRowEncoderTests, BinaryRoundTripTest) {
+  std::vector<std::pair<Value, PostgresValueType>> values = {
+      {ValueFactory::GetBooleanValue(true), POSTGRES_VALUE_TYPE_BOOLEAN},
+      {ValueFactory::GetSmallIntValue(-7), POSTGRES_VALUE_TYPE_SMALLINT},
+      {ValueFactory::GetIntegerValue(-42), POSTGRES_VALUE_TYPE_INTEGER},
+      {ValueFactory::GetBigIntValue(INT64_MAX), POSTGRES_VALUE_TYPE_BIGINT},
+      {ValueFactory::GetDoubleValue(0.25), POSTGRES_VALUE_TYPE_DOUBLE},
+      {ValueFactory::GetStringValue("peloton"), POSTGRES_VALUE_TYPE_VARCHAR2},
+      {ValueFactory::GetDateValue(16800), POSTGRES_VALUE_TYPE_DATE},
+      {ValueFactory::GetTimestampValue(1451606400000000LL),
+       POSTGRES_VALUE_TYPE_TIMESTAMPS},
+      {ValueFactory::GetDecimalValueFromString("-12345.0607"),
+       POSTGRES_VALUE_TYPE_DECIMAL},
+      {ValueFactory::GetDecimalValueFromString("0.5"),
+       POSTGRES_VALUE_TYPE_DECIMAL}};
+
+  wire::PktBuf buf;
+  wire::DataRowEncoder encoder(buf);
+  for (auto &value : values) {
+    encoder.PutBinaryValue(value.first);
+  }
+
+  // Decoding every attribute gives back the original value
+  wire::Packet pkt;
+  pkt.buf = buf;
+  pkt.len = buf.size();
+  VarlenPool pool(BACKEND_TYPE_MM);
+  for (auto &value : values) {
+    int32_t len = wire::PacketGetInt(&pkt, 4);
+    Value decoded;
+    EXPECT_TRUE(wire::PacketGetValue(&pkt, len, 1, value.second, &pool,
+                                     decoded));
+    EXPECT_EQ(0, decoded.Compare(value.first));
+  }
+  EXPECT_EQ(pkt.len, pkt.ptr);
+
+  // The binary format of 2000-01-01 is zero
+  buf.clear();
+  encoder.PutBinaryValue(ValueFactory::GetDateValue(10957));
+  EXPECT_EQ(0, GetInt(buf, sizeof(int32_t)));
+}
+
+TEST_F(DataRowEncoderTests, TextParameterTest) {
+  VarlenPool pool(BACKEND_TYPE_MM);
+  std::string text = "2016-01-01";
+  wire::Packet pkt;
+  pkt.buf.assign(text.begin(), text.end());
+  pkt.len = pkt.buf.size();
+
+  Value date;
+  EXPECT_TRUE(wire::PacketGetValue(&pkt, pkt.len, 0, POSTGRES_VALUE_TYPE_DATE,
+                                   &pool, date));
+  EXPECT_EQ(16801, ValuePeeker::PeekDate(date));
+
+  // Malformed integers are rejected
+  text = "12ab";
+  pkt.buf.assign(text.begin(), text.end());
+  pkt.len = pkt.buf.size();
+  pkt.ptr = 0;
+  Value integer;
+  EXPECT_FALSE(wire::PacketGetValue(&pkt, pkt.len, 0,
+                                    POSTGRES_VALUE_TYPE_INTEGER, &pool,
+                                    integer));
+}
+
+}  // End test namespace
+}  // End peloton namespace
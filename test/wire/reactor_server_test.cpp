@@ -0,0 +1,264 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// reactor_server_test.cpp
+//
+// Identification: test/wire/reactor_server_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "common/harness.h"
+
+#include "catalog/bootstrapper.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager_factory.h"
+#include "storage/data_table.h"
+#include "storage/database.h"
+#include "wire/reactor_server.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Reactor Server Tests
+//===--------------------------------------------------------------------===//
+
+class ReactorServerTests : public PelotonTest {};
+
+// Connect a blocking client to the local port
+static int ConnectClient(int port, int receive_buffer_size) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  // a small window makes the server's writes partial
+  if (receive_buffer_size > 0) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer_size,
+               sizeof(receive_buffer_size));
+  }
+
+  // a broken server fails the test instead of hanging it
+  struct timeval timeout;
+  timeout.tv_sec = 10;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in addr;
+  PL_MEMSET(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) !=
+      0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static bool SendBytes(int fd, const std::string &bytes) {
+  size_t offset = 0;
+  while (offset < bytes.size()) {
+    ssize_t sent = send(fd, bytes.data() + offset, bytes.size() - offset, 0);
+    if (sent <= 0) return false;
+    offset += sent;
+  }
+  return true;
+}
+
+static bool ReceiveBytes(int fd, size_t len, std::string &bytes) {
+  bytes.resize(len);
+  size_t offset = 0;
+  while (offset < len) {
+    ssize_t received = recv(fd, &bytes[offset], len - offset, 0);
+    if (received <= 0) return false;
+    offset += received;
+  }
+  return true;
+}
+
+static void PutInt(std::string &bytes, uint32_t value) {
+  uint32_t value_nb = htonl(value);
+  bytes.append(reinterpret_cast<char *>(&value_nb), sizeof(value_nb));
+}
+
+// Read the next message, its length field is not part of the body
+static bool ReceiveMessage(int fd, char &msg_type, std::string &body) {
+  std::string header;
+  if (ReceiveBytes(fd, 1 + sizeof(int32_t), header) == false) return false;
+
+  uint32_t len;
+  std::copy(header.begin() + 1, header.end(), reinterpret_cast<char *>(&len));
+  msg_type = header[0];
+  return ReceiveBytes(fd, ntohl(len) - sizeof(int32_t), body);
+}
+
+// Read messages up to ReadyForQuery, returns the types in order
+static std::string ReceiveUntilReady(int fd, std::string &last_tag) {
+  std::string msg_types;
+  char msg_type;
+  std::string body;
+  while (ReceiveMessage(fd, msg_type, body)) {
+    msg_types.push_back(msg_type);
+    if (msg_type == 'C') last_tag = body.c_str();
+    if (msg_type == 'Z') break;
+  }
+  return msg_types;
+}
+
+static bool SendStartup(int fd) {
+  std::string options("user");
+  options.push_back('\0');
+  options.append("postgres");
+  options.push_back('\0');
+  options.append("database");
+  options.push_back('\0');
+  options.append("default_database");
+  options.push_back('\0');
+  options.push_back('\0');
+
+  // the startup packet has no type byte, version 3.0
+  std::string pkt;
+  PutInt(pkt, 2 * sizeof(int32_t) + options.size());
+  PutInt(pkt, 3 << 16);
+  pkt.append(options);
+  return SendBytes(fd, pkt);
+}
+
+static bool SendQuery(int fd, const std::string &query) {
+  std::string pkt("Q");
+  PutInt(pkt, sizeof(int32_t) + query.size() + 1);
+  pkt.append(query);
+  pkt.push_back('\0');
+  return SendBytes(fd, pkt);
+}
+
+static bool WaitForConnectionCount(wire::ReactorServer *reactor_server,
+                                   size_t connection_count) {
+  for (int attempt = 0; attempt < 100; attempt++) {
+    if (reactor_server->GetConnectionCount() == connection_count) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return false;
+}
+
+TEST_F(ReactorServerTests, LoopbackTest) {
+  const int port = 9331;
+  const int row_count = 100000;
+
+  // COPY TO looks the table up in the default database
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto global_catalog = catalog::Bootstrapper::bootstrap();
+  txn_manager.BeginTransaction();
+  global_catalog->CreateDatabase("default_database");
+  std::unique_ptr<catalog::Schema> schema(new catalog::Schema(
+      {ExecutorTestsUtil::GetColumnInfo(0), ExecutorTestsUtil::GetColumnInfo(1),
+       ExecutorTestsUtil::GetColumnInfo(2),
+       ExecutorTestsUtil::GetColumnInfo(3)}));
+  global_catalog->CreateTable("default_database", "reactor_table",
+                              std::move(schema));
+  txn_manager.CommitTransaction();
+
+  auto table = global_catalog->GetDatabaseWithName("default_database")
+                   ->GetTableWithName("reactor_table");
+  ASSERT_NE(nullptr, table);
+  txn_manager.BeginTransaction();
+  ExecutorTestsUtil::PopulateTable(table, row_count, false, false, false);
+  txn_manager.CommitTransaction();
+
+  // The server listens once StartServer returns, the accept loop never does
+  auto server = new wire::Server();
+  server->port = port;
+  wire::StartServer(server);
+  auto reactor_server = new wire::ReactorServer(server);
+  std::thread server_thread([reactor_server] {
+    reactor_server->HandleConnections();
+  });
+  server_thread.detach();
+
+  int fd = ConnectClient(port, 4096);
+  ASSERT_LE(0, fd);
+
+  // Startup: AuthenticationOk, the parameters, then ReadyForQuery
+  std::string tag;
+  ASSERT_TRUE(SendStartup(fd));
+  auto msg_types = ReceiveUntilReady(fd, tag);
+  ASSERT_FALSE(msg_types.empty());
+  EXPECT_EQ('R', msg_types.front());
+  EXPECT_EQ('Z', msg_types.back());
+  EXPECT_TRUE(WaitForConnectionCount(reactor_server, 1));
+
+  // Simple query with two statements
+  ASSERT_TRUE(SendQuery(fd, "BEGIN; COMMIT;"));
+  msg_types = ReceiveUntilReady(fd, tag);
+  EXPECT_EQ("CCZ", msg_types);
+  EXPECT_EQ("COMMIT", tag);
+
+  // A result much larger than the socket buffers goes out in pieces, and
+  // the client only starts reading once the server had to wait for it
+  ASSERT_TRUE(SendQuery(fd, "COPY reactor_table TO STDOUT;"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  char msg_type;
+  std::string body;
+  size_t line_count = 0;
+  ASSERT_TRUE(ReceiveMessage(fd, msg_type, body));
+  EXPECT_EQ('H', msg_type);
+  while (ReceiveMessage(fd, msg_type, body) && msg_type == 'd') {
+    line_count += std::count(body.begin(), body.end(), '\n');
+  }
+  EXPECT_EQ('c', msg_type);
+  EXPECT_EQ(static_cast<size_t>(row_count), line_count);
+  msg_types = ReceiveUntilReady(fd, tag);
+  EXPECT_EQ("CZ", msg_types);
+  EXPECT_EQ("COPY " + std::to_string(row_count), tag);
+
+  // The session still works after the large write
+  ASSERT_TRUE(SendQuery(fd, "BEGIN; COMMIT;"));
+  EXPECT_EQ("CCZ", ReceiveUntilReady(fd, tag));
+
+  // Closing the client frees its connection
+  close(fd);
+  EXPECT_TRUE(WaitForConnectionCount(reactor_server, 0));
+
+  // The server keeps accepting clients
+  fd = ConnectClient(port, 0);
+  ASSERT_LE(0, fd);
+  ASSERT_TRUE(SendStartup(fd));
+  msg_types = ReceiveUntilReady(fd, tag);
+  ASSERT_FALSE(msg_types.empty());
+  EXPECT_EQ('Z', msg_types.back());
+  close(fd);
+  EXPECT_TRUE(WaitForConnectionCount(reactor_server, 0));
+
+  // A client that stops reading has its query canceled and its session
+  // closed, instead of holding a worker forever
+  auto write_timeout = FLAGS_client_write_timeout_ms;
+  FLAGS_client_write_timeout_ms = 100;
+  fd = ConnectClient(port, 4096);
+  ASSERT_LE(0, fd);
+  ASSERT_TRUE(SendStartup(fd));
+  msg_types = ReceiveUntilReady(fd, tag);
+  ASSERT_TRUE(SendQuery(fd, "COPY reactor_table TO STDOUT;"));
+  EXPECT_TRUE(WaitForConnectionCount(reactor_server, 0));
+  close(fd);
+  FLAGS_client_write_timeout_ms = write_timeout;
+}
+
+}  // End test namespace
+}  // End peloton namespace